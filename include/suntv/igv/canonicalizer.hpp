@@ -9,7 +9,9 @@ class Graph;
  * Canonicalizer: post-processes a parsed IGV graph.
  *
  * Responsibilities:
- * - Validate well-formedness (single Start/Root, acyclicity, etc.)
+ * - Validate well-formedness: a single Start/Root is required; the
+ *   structural checks of VerifyGraph (arity, Phi/Region, value cycles,
+ *   control reachability) are logged as warnings
  * - Set special node pointers (start_, root_) in Graph
  * - Future: Type inference, comparison normalization
  *
@@ -29,7 +31,8 @@ class Canonicalizer {
  private:
   bool ValidateWellFormed(Graph* g, std::string& error);
   bool CheckSingleStartRoot(Graph* g, std::string& error);
-  // Future: CheckAcyclicity, InferTypes, NormalizeComparisons
+  void ReportStructuralIssues(const Graph* g);
+  // Future: InferTypes, NormalizeComparisons
 };
 
 }  // namespace sun
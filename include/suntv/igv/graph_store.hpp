@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "suntv/igv/igv_pipeline.hpp"
+
+namespace sun {
+class ConstantPool;
+class Graph;
+class StringInterner;
+
+/** A phase of a stored compilation: its name and the key of its graph. */
+struct StoredPhase {
+  std::string name;
+  uint64_t key = 0;
+};
+
+/** A compilation as it was imported: its phases in dump order. */
+struct StoredCompilation {
+  std::string method;
+  std::string source;  // Dump it was imported from
+  std::vector<StoredPhase> phases;
+};
+
+/** One graph as GraphStore::Scan hands it over. */
+struct StoredGraph {
+  uint64_t key = 0;
+  std::string_view method;  // Where the graph was first imported from
+  std::string_view name;
+  std::string_view bytes;   // EncodeGraph's encoding
+};
+
+struct StoreImportStats {
+  PipelineStats pipeline;
+  uint64_t added = 0;
+  uint64_t duplicates = 0;    // Graphs already stored under their key
+  uint64_t rejected = 0;      // Not parsed, not canonicalized or no Root
+  uint64_t compilations = 0;  // Newly recorded
+};
+
+/**
+ * Content-addressed store of graphs, for corpora too large to keep as IGV
+ * XML: many of the phase graphs of a regression corpus recur unchanged
+ * across dumps and JDK builds, and are stored once.
+ *
+ * A graph's key is its structural hash (StructuralHashes::graph()), so
+ * graphs that differ only in node IDs or in properties that do not change
+ * what they compute share a key, and the first one imported is kept. The
+ * store is a directory of pack files, each a run of records (the method
+ * and phase the graph was first seen as, then EncodeGraph's bytes), with a
+ * sorted index of keys, offsets and sizes beside it. A pack's index is
+ * written, to a temporary file renamed into place, only once the pack is
+ * complete, so packs without one (an interrupted import) are ignored. Beside
+ * the packs, a text file lists every imported compilation as its method,
+ * source dump and the keys of its phases in order, from which phase
+ * sequences (for bisection, or lowering a post-matching phase) are rebuilt.
+ *
+ * Opening a store reads the indices into one sorted table, so Load is a
+ * binary search and one read. Scan streams the packs in the order they were
+ * written, one record at a time. Added graphs go to a pack of their own and
+ * are seen by Load, Resolve and Scan once the pack is sealed by Flush, by
+ * reaching its size limit or by the destructor. One writer at a time.
+ */
+class GraphStore {
+ public:
+  static constexpr size_t kPackBytes = size_t{256} << 20;
+
+  // Opens the store in `dir`, creating the directory if needed. Throws
+  // std::runtime_error if it cannot be created or read.
+  explicit GraphStore(std::string dir, size_t pack_bytes = kPackBytes);
+  ~GraphStore();  // Flushes; errors are logged
+
+  GraphStore(const GraphStore&) = delete;
+  GraphStore& operator=(const GraphStore&) = delete;
+
+  // True if `dir` holds a store
+  static bool IsStore(const std::string& dir);
+  // The key of g: its structural hash, 0 (not storable) without a Root
+  static uint64_t Key(const Graph& g);
+  // A key as 16 hex digits, as Resolve reads it back
+  static std::string KeyString(uint64_t key);
+
+  const std::string& dir() const { return dir_; }
+  size_t size() const { return entries_.size(); }  // Sealed graphs
+  size_t num_packs() const { return packs_.size(); }
+  uint64_t bytes() const { return bytes_; }  // Packs and indices on disk
+
+  // Stored or pending under `key`
+  bool Contains(uint64_t key) const;
+  // The key whose hex form starts with `prefix`; nullopt if none or
+  // several do
+  std::optional<uint64_t> Resolve(std::string_view prefix) const;
+  // The graph stored under `key`, decoded into the given tables (the
+  // graph's own when null); null if there is none. Throws
+  // std::runtime_error when its pack cannot be read.
+  std::unique_ptr<Graph> Load(uint64_t key, StringInterner* strings = nullptr,
+                              ConstantPool* constants = nullptr) const;
+  // Every sealed graph, pack by pack, in the order added; `visit` returns
+  // false to stop, and so does Scan then. Throws std::runtime_error when a
+  // pack cannot be read.
+  bool Scan(const std::function<bool(const StoredGraph&)>& visit) const;
+
+  const std::vector<StoredCompilation>& compilations() const {
+    return compilations_;
+  }
+
+  // Adds an encoded graph under `key` unless one is stored or pending;
+  // true if added
+  bool Add(uint64_t key, std::string_view method, std::string_view name,
+           std::string_view bytes);
+  // Encodes and adds g under Key(g); false if a graph with its key is
+  // stored or pending, or g has no Root
+  bool Add(const Graph& g, std::string_view method, std::string_view name);
+  // Recorded with the next Flush, unless the same method, source and
+  // phases are recorded already; its phases must have been added. True if
+  // it will be recorded.
+  bool AddCompilation(StoredCompilation compilation);
+  // Seals the open pack and records the pending compilations. Throws
+  // std::runtime_error on a write error.
+  void Flush();
+
+  /**
+   * Import every graph of IGV dumps through an IGVPipeline: the pools
+   * parse, canonicalize, hash and encode, and the graphs are added in
+   * corpus order, so a store built from the same dumps is the same. Each
+   * <group> becomes a compilation. Flushes at the end.
+   */
+  StoreImportStats Import(const std::vector<std::string>& paths,
+                          const PipelineOptions& options = {});
+
+ private:
+  struct Entry {
+    uint64_t key;
+    uint32_t pack;  // Index into packs_
+    uint32_t size;
+    uint64_t offset;
+  };
+
+  void ReadIndex(uint32_t number);
+  void ReadCompilations();
+  void Seal();
+  // Method, source and phases of a compilation, as one string
+  static std::string Signature(const StoredCompilation& compilation);
+
+  std::string dir_;
+  size_t pack_bytes_;
+  std::vector<std::string> packs_;  // Paths of the sealed packs
+  std::vector<Entry> entries_;      // Sealed, by key
+  std::vector<StoredCompilation> compilations_;
+  std::unordered_set<std::string> signatures_;  // Recorded or pending
+  uint64_t bytes_ = 0;
+  uint32_t next_pack_ = 1;  // Number of the next pack file
+
+  // The pack being written
+  std::ofstream out_;
+  std::string out_path_;
+  uint64_t out_size_ = 0;
+  std::vector<Entry> pending_;
+  std::unordered_set<uint64_t> pending_keys_;
+  std::vector<StoredCompilation> pending_compilations_;
+};
+
+}  // namespace sun
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <optional>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sun {
+
+/**
+ * Selection criteria for IGVFilter. Empty criteria match everything; a graph
+ * is selected only if it satisfies all non-empty criteria.
+ */
+struct IGVFilterSpec {
+  // Substrings of the method (group) name; any one must match
+  std::vector<std::string> methods;
+  // Regex searched in the graph (phase) name
+  std::optional<std::regex> phase;
+  // Inclusive [first, last] ranges of the graph index within its group
+  std::vector<std::pair<size_t, size_t>> index_ranges;
+
+  bool Matches(const std::string& method, const std::string& graph_name,
+               size_t index) const;
+};
+
+/**
+ * Counters reported by a filter run.
+ */
+struct IGVFilterStats {
+  size_t groups_seen = 0;
+  size_t graphs_seen = 0;
+  size_t graphs_written = 0;
+  size_t bytes_read = 0;
+  std::vector<std::string> outputs;  // Files written, in creation order
+};
+
+/**
+ * Streaming graph selector for large IGV dumps.
+ *
+ * Makes a single IGVStreamReader pass over the input and copies the byte
+ * ranges of matching <graph> elements (plus the header of their enclosing
+ * <group>) verbatim to the output; no DOM is built, so memory use is bounded
+ * by the largest selected graph rather than the file size.
+ */
+class IGVFilter {
+ public:
+  /**
+   * Write all matching graphs to a single IGV XML file.
+   * @return true on success, false on I/O or structural error
+   */
+  static bool Filter(const std::string& input_path, const IGVFilterSpec& spec,
+                     const std::string& output_path,
+                     IGVFilterStats* stats = nullptr);
+
+  /**
+   * Write the matching graphs of each group to its own file in output_dir,
+   * named "<group ordinal>-<sanitized method name>.xml". Groups with no
+   * matching graph produce no file.
+   * @return true on success, false on I/O or structural error
+   */
+  static bool Split(const std::string& input_path, const IGVFilterSpec& spec,
+                    const std::string& output_dir,
+                    IGVFilterStats* stats = nullptr);
+
+  /**
+   * Parse an index range list such as "0-3,7,10-12".
+   * @return false if the list is malformed
+   */
+  static bool ParseIndexRanges(const std::string& text,
+                               std::vector<std::pair<size_t, size_t>>* out);
+};
+
+}  // namespace sun
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "suntv/igv/igv_stream.hpp"
+
+namespace sun {
+class Graph;
+
+/**
+ * One graph on its way through an IGVPipeline. Each stage fills in the
+ * next field; a graph that fails to parse or canonicalize keeps flowing,
+ * with `error` set and no `graph`, so the writer still sees it.
+ */
+struct PipelineGraph {
+  uint64_t sequence = 0;  // Corpus order: files as given, graphs as dumped
+  size_t file = 0;        // Index into the paths
+  std::string method;     // Name of the enclosing <group>
+  std::string name;       // Graph (phase) name
+  size_t index = 0;       // Index within its group
+  uint64_t key = 0;       // GraphStore key, for a graph read from a store
+  // The <graph> element or, from a store, the graph's encoding, until
+  // parsed
+  std::string bytes;
+  std::unique_ptr<Graph> graph;
+  std::string error;      // Why the graph was not executed
+  std::string output;     // Set by the execute stage
+};
+
+struct PipelineOptions {
+  // Workers per pool; 0 = hardware concurrency. Idle workers sleep on
+  // their input queue, so every pool can have a thread per core and the
+  // cores go to whichever stage has work.
+  size_t parse_threads = 0;
+  size_t canonicalize_threads = 0;
+  size_t execute_threads = 0;
+  size_t queue_capacity = 64;  // Graphs held between two stages
+  // Graphs to run (all when empty); decided before a graph is buffered
+  std::function<bool(const IGVGraphRef&)> select;
+};
+
+struct PipelineStageStats {
+  const char* name = "";
+  size_t threads = 0;
+  uint64_t items = 0;
+  double busy_seconds = 0;  // Summed over its threads, not counting waits
+};
+
+struct PipelineStats {
+  uint64_t files = 0;
+  uint64_t files_failed = 0;  // Unreadable or truncated
+  uint64_t bytes = 0;
+  uint64_t graphs = 0;
+  uint64_t graphs_failed = 0;  // Not parsed or not canonicalized
+  double seconds = 0;          // Wall clock
+  // read, parse, canonicalize, execute, write
+  std::vector<PipelineStageStats> stages;
+
+  std::string ToString() const;
+};
+
+/**
+ * Loads and runs every graph of a corpus of IGV dumps as a pipeline:
+ *
+ *   reader -> parse pool -> canonicalize pool -> execute pool -> writer
+ *
+ * The reader streams the files in order (IGVStreamReader) and hands each
+ * selected <graph> element on; the pools parse it (IGVParser), validate it
+ * (Canonicalizer) and execute it; the writer receives the graphs back in
+ * corpus order. A path that is a GraphStore directory is streamed from its
+ * packs instead (GraphStore::Scan): the parse pool decodes those graphs,
+ * and canonicalization, done when they were stored, is skipped. Stages
+ * are connected by BoundedQueues, so I/O, parsing and execution of
+ * different graphs overlap, and a slow stage holds the ones before it back
+ * instead of letting work pile up. The reader also keeps at most a fixed
+ * window of graphs between itself and the writer, which bounds the graphs
+ * the writer holds while it waits for an earlier, slower one.
+ */
+class IGVPipeline {
+ public:
+  // Sets g.output for a graph that parsed and canonicalized; `worker` is
+  // below execute_threads, so callers can keep per-thread state. A thrown
+  // std::exception becomes g.error.
+  using Execute = std::function<void(PipelineGraph& g, size_t worker)>;
+  // Every selected graph, in corpus order, on the calling thread; must
+  // not throw
+  using Write = std::function<void(const PipelineGraph& g)>;
+
+  static PipelineStats Run(const std::vector<std::string>& paths,
+                           const Execute& execute, const Write& write,
+                           const PipelineOptions& options = {});
+
+  // Workers a pool gets for a requested count (0 = hardware concurrency)
+  static size_t Threads(size_t requested);
+};
+
+}  // namespace sun
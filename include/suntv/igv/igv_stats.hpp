@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "suntv/ir/opcode.hpp"
+
+namespace sun {
+
+/**
+ * Power-of-two histogram of non-negative counts.
+ * Bucket 0 holds 0; bucket i > 0 holds values in [2^(i-1), 2^i).
+ */
+struct Log2Histogram {
+  static constexpr size_t kNumBuckets = 33;
+
+  std::array<uint64_t, kNumBuckets> buckets{};
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t min = UINT64_MAX;
+  uint64_t max = 0;
+
+  void Add(uint64_t value);
+  void Merge(const Log2Histogram& other);
+};
+
+/**
+ * Aggregated opcode and shape statistics over a corpus of IGV dumps.
+ * Size is bounded by the number of distinct opcode names, not the corpus.
+ */
+struct CorpusStats {
+  static constexpr size_t kNumOpcodes = static_cast<size_t>(Opcode::kUnknown);
+
+  uint64_t files = 0;
+  uint64_t files_failed = 0;
+  uint64_t bytes = 0;
+  uint64_t groups = 0;
+  uint64_t graphs = 0;
+  uint64_t graphs_failed = 0;  // Graphs whose XML could not be parsed
+  uint64_t nodes = 0;
+  uint64_t edges = 0;
+
+  // Node counts per recognized opcode, indexed by Opcode
+  std::array<uint64_t, kNumOpcodes> opcodes{};
+  // Node counts per raw name that StringToOpcode maps to kUnknown
+  std::map<std::string, uint64_t> unknown_opcodes;
+
+  Log2Histogram graph_nodes;  // Nodes per graph
+
+  uint64_t loops = 0;  // Loop head nodes (Loop, CountedLoop, ...)
+  uint64_t graphs_with_loops = 0;
+  uint64_t max_loops_per_graph = 0;
+
+  uint64_t phis = 0;
+  uint64_t max_phi_arity = 0;  // Value inputs, excluding the Region input
+
+  // Longest run of stores linked through their memory input, per graph
+  Log2Histogram memory_chain;
+
+  void Merge(const CorpusStats& other);
+  std::string ToJson() const;
+};
+
+/**
+ * Corpus statistics collector behind `sunigv stats`.
+ */
+class IGVStats {
+ public:
+  /**
+   * Stream every file with IGVStreamReader, spreading files over
+   * num_threads workers (0 = hardware concurrency). Each worker holds at
+   * most one graph in memory at a time.
+   * @return true if every file was read successfully; stats cover all
+   *         files that could be read either way
+   */
+  static bool Collect(const std::vector<std::string>& paths,
+                      size_t num_threads, CorpusStats* stats);
+
+  /**
+   * Add the statistics of one <graph> element given as raw XML bytes.
+   * @return false if the bytes cannot be parsed
+   */
+  static bool AddGraph(std::string_view graph_xml, CorpusStats* stats);
+};
+
+}  // namespace sun
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace sun {
+
+/**
+ * Position of one <graph> element within a streamed IGV file.
+ * The referenced strings are only valid during the visitor callback.
+ */
+struct IGVGraphRef {
+  const std::string& method;        // Name of the enclosing <group>
+  const std::string& group_header;  // Bytes from <group> up to its first graph
+  const std::string& name;          // Graph (phase) name
+  size_t group_ordinal;             // Index of the group in the file
+  size_t index;                     // Index of the graph within its group
+};
+
+/**
+ * Single-pass, DOM-free reader for (possibly multi-GB) IGV dumps.
+ *
+ * The file is read in fixed-size chunks and scanned for markup only. Graphs
+ * the visitor selects are handed over as the exact byte range of their
+ * <graph> element; the window grows to hold the largest selected graph, so
+ * memory use is independent of the file size. Unselected graphs are skipped
+ * without being buffered. Groups are assumed not to nest, which holds for
+ * HotSpot C2 dumps.
+ */
+class IGVStreamReader {
+ public:
+  class Visitor {
+   public:
+    virtual ~Visitor() = default;
+
+    // Whether OnGraph should receive this graph's bytes
+    virtual bool SelectGraph(const IGVGraphRef& ref) {
+      (void)ref;
+      return true;
+    }
+
+    // Called with the complete <graph>...</graph> bytes.
+    // Returning false aborts the scan.
+    virtual bool OnGraph(const IGVGraphRef& ref, std::string_view bytes) = 0;
+
+    // Called after the last graph of each group. Returning false aborts.
+    virtual bool OnGroupEnd(size_t group_ordinal) {
+      (void)group_ordinal;
+      return true;
+    }
+  };
+
+  explicit IGVStreamReader(std::string path);
+
+  /**
+   * Scan the whole file, invoking the visitor.
+   * @return false on I/O error, malformed/truncated input or visitor abort
+   */
+  bool Run(Visitor* visitor);
+
+  size_t bytes_read() const { return bytes_read_; }
+  size_t groups_seen() const { return groups_seen_; }
+  size_t graphs_seen() const { return graphs_seen_; }
+
+ private:
+  std::string path_;
+  size_t bytes_read_ = 0;
+  size_t groups_seen_ = 0;
+  size_t graphs_seen_ = 0;
+};
+
+}  // namespace sun
@@ -1,9 +1,23 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace sun {
 class Graph;
+class StringInterner;
+class ConstantPool;
+
+/**
+ * One graph parsed out of a multi-graph IGV file.
+ */
+struct ParsedGraph {
+  std::string method;  // Name of the enclosing <group>
+  std::string name;    // Graph (phase) name
+  size_t index;        // Index within the group (0-based)
+  std::unique_ptr<Graph> graph;
+};
 
 /**
  * IGV XML Parser.
@@ -12,6 +26,12 @@ class Graph;
 class IGVParser {
  public:
   IGVParser();
+
+  /**
+   * Create a parser whose graphs intern property strings and constants into
+   * the given shared tables, which must outlive every graph produced.
+   */
+  IGVParser(StringInterner* strings, ConstantPool* constants);
   ~IGVParser();
 
   /**
@@ -20,6 +40,21 @@ class IGVParser {
    */
   std::unique_ptr<Graph> Parse(const std::string& path);
 
+  /**
+   * Parse every graph of every group in an IGV XML file.
+   * Graphs that fail canonicalization are skipped with a warning.
+   * Returns an empty vector if the file cannot be read.
+   */
+  std::vector<ParsedGraph> ParseAll(const std::string& path);
+
+  /**
+   * Parse one <graph> element, as IGVStreamReader hands it over.
+   * With canonicalize false the graph is returned as read, for the caller
+   * to run Canonicalizer on. Returns nullptr on malformed XML.
+   */
+  std::unique_ptr<Graph> ParseGraphXml(std::string_view xml,
+                                       bool canonicalize = true);
+
  private:
   class Impl;
   std::unique_ptr<Impl> impl_;
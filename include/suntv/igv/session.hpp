@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "suntv/ir/constant_pool.hpp"
+#include "suntv/util/arena.hpp"
+#include "suntv/util/interner.hpp"
+
+namespace sun {
+class Graph;
+class GraphStore;
+struct StoredCompilation;
+
+/**
+ * A set of graphs loaded together, typically every phase of one or more
+ * IGV dumps.
+ *
+ * All graphs share the session's string table and constant pool, so opcode
+ * names, property keys, types and constant payloads that repeat across the
+ * phases are stored once. Interned handles and Constant pointers obtained from
+ * different graphs of the same session are directly comparable.
+ */
+class GraphSession {
+ public:
+  GraphSession();
+  ~GraphSession();
+
+  GraphSession(const GraphSession&) = delete;
+  GraphSession& operator=(const GraphSession&) = delete;
+
+  /**
+   * Load every graph in an IGV XML file.
+   * Returns the number of graphs added (0 on error).
+   */
+  size_t Load(const std::string& path);
+
+  /**
+   * Load every phase of a compilation recorded in a GraphStore, under its
+   * method name. Returns the number of graphs added; throws
+   * std::runtime_error if a phase is missing from the store.
+   */
+  size_t Load(const GraphStore& store, const StoredCompilation& compilation);
+
+  size_t num_graphs() const { return entries_.size(); }
+  Graph* graph(size_t i) const { return entries_[i].graph.get(); }
+  const std::string& graph_name(size_t i) const { return entries_[i].name; }
+  const std::string& method_name(size_t i) const { return entries_[i].method; }
+
+  // First graph with the given name, or nullptr.
+  Graph* FindGraph(const std::string& name) const;
+
+  StringInterner& strings() { return strings_; }
+  ConstantPool& constants() { return constants_; }
+
+ private:
+  struct Entry {
+    std::string method;
+    std::string name;
+    std::unique_ptr<Graph> graph;
+  };
+
+  // Declaration order matters: the shared tables must outlive the graphs.
+  Arena arena_;
+  StringInterner strings_;
+  ConstantPool constants_;
+  std::vector<Entry> entries_;
+};
+
+}  // namespace sun
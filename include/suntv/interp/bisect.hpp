@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "suntv/interp/differential.hpp"
+#include "suntv/interp/value.hpp"
+#include "suntv/ir/graph.hpp"
+
+namespace sun {
+
+struct BisectStep {
+  size_t phase;  // Index into the phases
+  EngineResult result;
+};
+
+struct BisectReport {
+  EngineResult reference;  // The first phase on the input
+  // Set when a phase disagrees with the reference: `good` agrees with it,
+  // `bad` does not, and every phase between them could not be run
+  std::optional<size_t> good;
+  std::optional<size_t> bad;
+  std::vector<BisectStep> steps;  // One per phase executed, in order
+
+  bool found() const { return bad.has_value(); }
+};
+
+/**
+ * Find the phase of a compilation that first changes what the method
+ * computes on one input.
+ *
+ * `phases` are the graphs of one method in phase order. The first is the
+ * reference; the last is run next, and if it agrees with the reference
+ * there is nothing to find. Otherwise the phases between the last one known
+ * to agree and the first one known to differ are halved until the two are
+ * adjacent, so a sequence of n phases takes about 2 + log2(n) executions.
+ * That finds the first differing phase when, as for a miscompilation, the
+ * change persists through the later phases; otherwise it finds some phase
+ * where the result changes.
+ *
+ * Post-matching graphs are lowered (LowerMachGraph) with the phases before
+ * them as history. Phases that cannot be lowered or run (kError) say
+ * nothing either way: the probe moves to the nearest runnable phase, and
+ * the report's pair may end up with only such phases between them. No
+ * phase runs twice. Results are compared with EngineResult::Matches.
+ */
+BisectReport BisectPhases(const std::vector<const Graph*>& phases,
+                          const std::vector<Value>& inputs,
+                          const DiffEngine& engine);
+
+// Same, on a fresh interpreter per phase
+BisectReport BisectPhases(const std::vector<const Graph*>& phases,
+                          const std::vector<Value>& inputs);
+
+}  // namespace sun
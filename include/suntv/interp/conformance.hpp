@@ -0,0 +1,169 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "suntv/interp/value.hpp"
+
+namespace sun {
+
+// X(Name, arity, lhs domain, rhs domain); rhs is unused for unary ops.
+// Long shifts take an int count, as in Java.
+#define SUN_CONFORMANCE_OPS(X) \
+  X(AddI, 2, I32, I32)         \
+  X(SubI, 2, I32, I32)         \
+  X(MulI, 2, I32, I32)         \
+  X(DivI, 2, I32, I32)         \
+  X(ModI, 2, I32, I32)         \
+  X(AndI, 2, I32, I32)         \
+  X(OrI, 2, I32, I32)          \
+  X(XorI, 2, I32, I32)         \
+  X(LShiftI, 2, I32, I32)      \
+  X(RShiftI, 2, I32, I32)      \
+  X(URShiftI, 2, I32, I32)     \
+  X(CmpEqI, 2, I32, I32)       \
+  X(CmpNeI, 2, I32, I32)       \
+  X(CmpLtI, 2, I32, I32)       \
+  X(CmpLeI, 2, I32, I32)       \
+  X(CmpGtI, 2, I32, I32)       \
+  X(CmpGeI, 2, I32, I32)       \
+  X(AbsI, 1, I32, I32)         \
+  X(AddL, 2, I64, I64)         \
+  X(SubL, 2, I64, I64)         \
+  X(MulL, 2, I64, I64)         \
+  X(DivL, 2, I64, I64)         \
+  X(ModL, 2, I64, I64)         \
+  X(AndL, 2, I64, I64)         \
+  X(OrL, 2, I64, I64)          \
+  X(XorL, 2, I64, I64)         \
+  X(LShiftL, 2, I64, I32)      \
+  X(RShiftL, 2, I64, I32)      \
+  X(URShiftL, 2, I64, I32)     \
+  X(CmpLtL, 2, I64, I64)       \
+  X(CmpLeL, 2, I64, I64)       \
+  X(CmpGtL, 2, I64, I64)       \
+  X(CmpGeL, 2, I64, I64)       \
+  X(AbsL, 1, I64, I64)         \
+  X(CmpF3, 2, F32, F32)        \
+  X(CmpD3, 2, F64, F64)        \
+  X(ConvI2L, 1, I32, I32)      \
+  X(ConvL2I, 1, I64, I64)      \
+  X(ConvI2F, 1, I32, I32)      \
+  X(ConvI2D, 1, I32, I32)      \
+  X(ConvL2F, 1, I64, I64)      \
+  X(ConvL2D, 1, I64, I64)      \
+  X(ConvF2I, 1, F32, F32)      \
+  X(ConvF2L, 1, F32, F32)      \
+  X(ConvD2I, 1, F64, F64)      \
+  X(ConvD2L, 1, F64, F64)      \
+  X(ConvF2D, 1, F32, F32)      \
+  X(ConvD2F, 1, F64, F64)      \
+  X(MoveF2I, 1, F32, F32)      \
+  X(MoveI2F, 1, I32, I32)      \
+  X(MoveD2L, 1, F64, F64)      \
+  X(MoveL2D, 1, I64, I64)
+
+enum class ConformanceOp {
+#define SUN_CONFORMANCE_ENUM(name, arity, lhs, rhs) k##name,
+  SUN_CONFORMANCE_OPS(SUN_CONFORMANCE_ENUM)
+#undef SUN_CONFORMANCE_ENUM
+};
+
+inline constexpr size_t kNumConformanceOps = 0
+#define SUN_CONFORMANCE_COUNT(name, arity, lhs, rhs) +1
+    SUN_CONFORMANCE_OPS(SUN_CONFORMANCE_COUNT);
+#undef SUN_CONFORMANCE_COUNT
+
+/**
+ * An implementation of the integer and conversion opcodes under test.
+ *
+ * Entry points take and return Values the way Evaluator does and throw
+ * EvalException where Java throws ArithmeticException. Ops without an
+ * entry are reported as skipped, so a partial engine (say, a SIMD kernel
+ * set that only covers int arithmetic) can still be checked.
+ */
+struct ConformanceEngine {
+  using UnaryFn = Value (*)(Value);
+  using BinaryFn = Value (*)(Value, Value);
+
+  std::string name;
+  std::array<UnaryFn, kNumConformanceOps> unary{};
+  std::array<BinaryFn, kNumConformanceOps> binary{};
+};
+
+struct ConformanceOptions {
+  uint64_t seed = 1;
+  // Random operand pairs per op, on top of the boundary grid
+  uint64_t samples = 1 << 20;
+  // Check every pair of the boundary grid (every value for unary ops)
+  bool grid = true;
+  size_t num_threads = 0;  // 0 = hardware concurrency
+  // Ops to check; empty = all
+  std::vector<ConformanceOp> ops;
+  // Mismatches kept with operands; all of them are counted
+  size_t max_failures = 16;
+};
+
+struct ConformanceFailure {
+  ConformanceOp op;
+  Value lhs;
+  Value rhs;             // Null for unary ops
+  std::string expected;  // "ArithmeticException" when Java throws
+  std::string actual;
+};
+
+struct ConformanceReport {
+  uint64_t checks = 0;
+  uint64_t mismatches = 0;
+  std::vector<ConformanceFailure> failures;  // First max_failures, by op
+  std::vector<ConformanceOp> skipped;        // No entry in the engine
+
+  bool ok() const { return mismatches == 0; }
+};
+
+/**
+ * Java semantic conformance harness for integer arithmetic, shifts,
+ * comparisons and conversions.
+ *
+ * Every op is checked against an independent reference written with
+ * overflow-free wide arithmetic: int ops are computed exactly in 64 bits
+ * and truncated, long ops in unsigned 64-bit modular arithmetic (division
+ * on magnitudes), so MIN_VALUE / -1, Math.abs(MIN_VALUE) and over-wide
+ * shift counts come out of the arithmetic rather than special cases that
+ * could repeat an engine's mistake. Floats compare bit for bit, except
+ * that any NaN matches any NaN outside the raw Move ops.
+ *
+ * Operands are the full cross product of a dense boundary grid (0, +-1,
+ * MIN/MAX and their neighbours, +-2^k and +-2^k+-1 for every k, shift
+ * counts past the width; for floats signed zeros, infinities, NaNs,
+ * subnormals and the neighbours of the int/long saturation bounds) plus
+ * seeded random sampling biased towards the grid. Work is split into
+ * chunks over num_threads workers; results do not depend on the thread
+ * count.
+ */
+class Conformance {
+ public:
+  // Evaluator's static entry points, for every op
+  static ConformanceEngine EvaluatorEngine();
+
+  // Every built-in engine, so CI can check each variant
+  static std::vector<ConformanceEngine> Engines();
+
+  static ConformanceReport Run(const ConformanceEngine& engine,
+                               const ConformanceOptions& options = {});
+
+  // Java result of `op`, or nullopt when Java throws ArithmeticException.
+  // `rhs` is ignored for unary ops.
+  static std::optional<Value> Reference(ConformanceOp op, Value lhs,
+                                        Value rhs);
+
+  static std::string_view OpName(ConformanceOp op);
+  static std::optional<ConformanceOp> OpFromName(std::string_view name);
+  static int Arity(ConformanceOp op);
+};
+
+}  // namespace sun
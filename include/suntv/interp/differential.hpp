@@ -0,0 +1,125 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "suntv/interp/value.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/random_program.hpp"
+
+namespace sun {
+class ConcreteHeap;
+class Interpreter;
+
+/**
+ * What one engine made of one run, normalized for comparison: an Outcome,
+ * or an EvalException that escaped Execute (a Java exception raised on a
+ * control path), or any other error (unsupported graph, step limit).
+ */
+struct EngineResult {
+  enum class Kind { kReturn, kThrow, kError };
+
+  Kind kind = Kind::kError;
+  std::optional<Value> value;  // kReturn
+  std::string message;         // Java exception class, or error text
+  std::string heap;            // Final heap (CanonicalDump), if any
+
+  // Same kind, value (bit for bit), exception kind and heap. Errors only
+  // need to agree that the graph could not run.
+  bool Matches(const EngineResult& other) const;
+  std::string ToString() const;
+};
+
+/**
+ * Run `interp` once, on an initial heap when one is given, and normalize
+ * what happened into an EngineResult.
+ */
+EngineResult CaptureRun(Interpreter& interp, const std::vector<Value>& inputs,
+                        const ConcreteHeap* heap = nullptr);
+
+/**
+ * An execution engine under test. `run` executes one graph on a batch of
+ * inputs and returns one result per input vector; an engine may keep state
+ * across the batch (that is what "interpreter-reused" checks).
+ */
+struct DiffEngine {
+  std::string name;
+  std::function<std::vector<EngineResult>(
+      const Graph& graph, const std::vector<std::vector<Value>>& inputs)>
+      run;
+};
+
+struct DiffOptions {
+  uint64_t seed = 1;
+  uint64_t cases = 1000;  // Random programs
+  int inputs_per_case = 8;
+  size_t num_threads = 0;  // 0 = hardware concurrency
+  bool shrink = true;
+  // Candidate programs tried while shrinking one failure
+  int max_shrink_steps = 5000;
+  RandomProgramOptions program;
+};
+
+struct DiffFailure {
+  uint64_t case_seed = 0;  // Replays the case (see DifferentialTester)
+  RandomProgram program;   // Shrunk, if shrinking is on
+  std::vector<Value> inputs;
+  std::string engine_a;
+  std::string engine_b;
+  EngineResult result_a;
+  EngineResult result_b;
+  int shrink_steps = 0;
+
+  std::string ToString() const;
+};
+
+struct DiffReport {
+  uint64_t cases = 0;  // Cases run (all, unless a failure stopped early)
+  uint64_t runs = 0;   // Executions of the first engine
+  uint64_t returns = 0;
+  uint64_t throws = 0;
+  uint64_t errors = 0;
+  // Failure of the lowest-numbered failing case
+  std::optional<DiffFailure> failure;
+
+  bool ok() const { return !failure; }
+};
+
+/**
+ * Property-based differential testing of execution engines.
+ *
+ * Case i of a run gets its own seed, derived from the run seed, which
+ * alone determines the random program (RandomProgram::Generate) and its
+ * inputs: boundary ints plus random ones. Every engine runs the lowered
+ * graph on every input, and each result must Match the first engine's.
+ *
+ * Cases are spread over worker threads. Whatever the thread count, the
+ * report names the lowest-numbered failing case, then shrinks it: the
+ * failing input is moved towards zero and the program replaced by smaller
+ * variants (RandomProgram::Shrinks) for as long as the engines still
+ * disagree. The case seed in the report replays the original case with
+ * CheckCase.
+ */
+class DifferentialTester {
+ public:
+  // Built-in engines: the interpreter with a fresh instance per run, one
+  // instance reused for all runs of a graph, and a fresh instance on a copy
+  // of the graph with reversed node order and renumbered IDs
+  static std::vector<DiffEngine> Engines();
+
+  static DiffReport Run(const std::vector<DiffEngine>& engines,
+                        const DiffOptions& options = {});
+
+  // Seed of case `index` in a run seeded with `seed`
+  static uint64_t CaseSeed(uint64_t seed, uint64_t index);
+
+  // Run one case; nullopt when all engines agree. Shrinks per options.
+  static std::optional<DiffFailure> CheckCase(
+      const std::vector<DiffEngine>& engines, uint64_t case_seed,
+      const DiffOptions& options = {});
+};
+
+}  // namespace sun
@@ -10,6 +10,7 @@ namespace sun {
 /**
  * Evaluator for per-opcode concrete semantics.
  * Implements arithmetic, bitwise, comparison, and conversion operations.
+ * Float and double operations follow Java semantics (see FloatKernels).
  */
 class Evaluator {
  public:
@@ -29,6 +30,29 @@ class Evaluator {
   static Value EvalModL(Value a, Value b);
   static Value EvalAbsL(Value a);
 
+  // Arithmetic - Float
+  static Value EvalAddF(Value a, Value b);
+  static Value EvalSubF(Value a, Value b);
+  static Value EvalMulF(Value a, Value b);
+  static Value EvalDivF(Value a, Value b);  // x/0 is +-Infinity or NaN
+  static Value EvalModF(Value a, Value b);
+  static Value EvalNegF(Value a);
+  static Value EvalAbsF(Value a);
+  static Value EvalMinF(Value a, Value b);
+  static Value EvalMaxF(Value a, Value b);
+
+  // Arithmetic - Double
+  static Value EvalAddD(Value a, Value b);
+  static Value EvalSubD(Value a, Value b);
+  static Value EvalMulD(Value a, Value b);
+  static Value EvalDivD(Value a, Value b);
+  static Value EvalModD(Value a, Value b);
+  static Value EvalNegD(Value a);
+  static Value EvalAbsD(Value a);
+  static Value EvalSqrtD(Value a);
+  static Value EvalMinD(Value a, Value b);
+  static Value EvalMaxD(Value a, Value b);
+
   // Bitwise - Int32
   static Value EvalAndI(Value a, Value b);
   static Value EvalOrI(Value a, Value b);
@@ -59,14 +83,34 @@ class Evaluator {
   static Value EvalCmpEqP(Value a, Value b);  // Pointer equality
   static Value EvalCmpNeP(Value a, Value b);  // Pointer inequality
 
+  // Comparison - Float (returns i32 -1/0/1; unordered gives -1)
+  static Value EvalCmpF3(Value a, Value b);
+  static Value EvalCmpD3(Value a, Value b);
+
   // Conversions
   static Value EvalConvI2L(Value a);  // Sign-extend i32 to i64
   static Value EvalConvL2I(Value a);  // Truncate i64 to i32
+  static Value EvalConvI2F(Value a);
+  static Value EvalConvI2D(Value a);
+  static Value EvalConvL2F(Value a);
+  static Value EvalConvL2D(Value a);
+  static Value EvalConvF2I(Value a);  // Saturating, NaN -> 0
+  static Value EvalConvF2L(Value a);  // Saturating, NaN -> 0
+  static Value EvalConvD2I(Value a);  // Saturating, NaN -> 0
+  static Value EvalConvD2L(Value a);  // Saturating, NaN -> 0
+  static Value EvalConvF2D(Value a);
+  static Value EvalConvD2F(Value a);
+  static Value EvalMoveF2I(Value a);  // Raw bits, NaN payload preserved
+  static Value EvalMoveI2F(Value a);
+  static Value EvalMoveD2L(Value a);
+  static Value EvalMoveL2D(Value a);
 
   // Conditional move
   static Value EvalCMoveI(Value cond, Value true_val, Value false_val);
   static Value EvalCMoveL(Value cond, Value true_val, Value false_val);
   static Value EvalCMoveP(Value cond, Value true_val, Value false_val);
+  static Value EvalCMoveF(Value cond, Value true_val, Value false_val);
+  static Value EvalCMoveD(Value cond, Value true_val, Value false_val);
 };
 
 /**
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace sun {
+
+/**
+ * Java floating-point semantics on raw float/double values.
+ *
+ * Plain IEEE 754 operations with round-to-nearest already match the JVM
+ * (strictfp is the default since Java 17), so the kernels only spell out
+ * the places where Java differs from C++: saturating float-to-integral
+ * conversion, NaN ordering in compares, Math.min/max on NaN and signed
+ * zeros. Each kernel is a single IEEE operation per element, so no fused
+ * multiply-add contraction can change a result.
+ *
+ * The batch forms apply one kernel across spans of equal length, as plain
+ * loops the compiler can auto-vectorize. The interpreter uses the scalar
+ * forms node by node; both agree bit for bit.
+ */
+class FloatKernels {
+ public:
+  static_assert(FLT_EVAL_METHOD == 0,
+                "Java float semantics need evaluation in the declared type "
+                "(no x87 excess precision)");
+
+  // Three-way compare as fcmpl/dcmpl: -1, 0, 1; unordered gives -1
+  static int32_t CmpF3(float a, float b) {
+    return a > b ? 1 : (a == b ? 0 : -1);
+  }
+  static int32_t CmpD3(double a, double b) {
+    return a > b ? 1 : (a == b ? 0 : -1);
+  }
+
+  // f2i/f2l/d2i/d2l: NaN -> 0, out-of-range saturates, else truncates
+  static int32_t D2I(double d) {
+    if (d != d) return 0;
+    if (d >= 0x1p31) return std::numeric_limits<int32_t>::max();
+    if (d <= -0x1p31) return std::numeric_limits<int32_t>::min();
+    return static_cast<int32_t>(d);
+  }
+  static int64_t D2L(double d) {
+    if (d != d) return 0;
+    if (d >= 0x1p63) return std::numeric_limits<int64_t>::max();
+    if (d <= -0x1p63) return std::numeric_limits<int64_t>::min();
+    return static_cast<int64_t>(d);
+  }
+  static int32_t F2I(float f) { return D2I(f); }  // float -> double is exact
+  static int64_t F2L(float f) { return D2L(f); }
+
+  // Math.min/max: NaN if either is NaN; -0.0 is below +0.0
+  template <typename T>
+  static T Min(T a, T b) {
+    if (a != a) return a;
+    if (a == 0 && b == 0) return std::signbit(a) ? a : b;
+    return a <= b ? a : b;
+  }
+  template <typename T>
+  static T Max(T a, T b) {
+    if (a != a) return a;
+    if (a == 0 && b == 0) return std::signbit(a) ? b : a;
+    return a >= b ? a : b;
+  }
+
+  // frem/drem truncate like C fmod (not IEEE remainder), which is exact
+  static float ModF(float a, float b) { return std::fmod(a, b); }
+  static double ModD(double a, double b) { return std::fmod(a, b); }
+
+  // Float.floatToRawIntBits and friends: no NaN canonicalization
+  static int32_t MoveF2I(float f) { return std::bit_cast<int32_t>(f); }
+  static float MoveI2F(int32_t i) { return std::bit_cast<float>(i); }
+  static int64_t MoveD2L(double d) { return std::bit_cast<int64_t>(d); }
+  static double MoveL2D(int64_t l) { return std::bit_cast<double>(l); }
+
+  // Batch forms; all spans must have the same length
+  static void AddF(std::span<const float> a, std::span<const float> b,
+                   std::span<float> out);
+  static void SubF(std::span<const float> a, std::span<const float> b,
+                   std::span<float> out);
+  static void MulF(std::span<const float> a, std::span<const float> b,
+                   std::span<float> out);
+  static void DivF(std::span<const float> a, std::span<const float> b,
+                   std::span<float> out);
+  static void AddD(std::span<const double> a, std::span<const double> b,
+                   std::span<double> out);
+  static void SubD(std::span<const double> a, std::span<const double> b,
+                   std::span<double> out);
+  static void MulD(std::span<const double> a, std::span<const double> b,
+                   std::span<double> out);
+  static void DivD(std::span<const double> a, std::span<const double> b,
+                   std::span<double> out);
+  static void CmpD3(std::span<const double> a, std::span<const double> b,
+                    std::span<int32_t> out);
+  static void D2I(std::span<const double> in, std::span<int32_t> out);
+  static void D2L(std::span<const double> in, std::span<int64_t> out);
+  static void F2I(std::span<const float> in, std::span<int32_t> out);
+};
+
+}  // namespace sun
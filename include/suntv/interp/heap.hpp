@@ -1,5 +1,6 @@
 #pragma once
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -9,13 +10,25 @@ namespace sun {
 
 using FieldID = std::string;
 
+/** Bytes held by a heap's objects and arrays (see util/memory_usage). */
+struct HeapMemory {
+  size_t objects = 0;  // Allocated objects
+  size_t arrays = 0;   // Allocated arrays
+  size_t field_bytes = 0;
+  size_t array_bytes = 0;  // Elements plus per-array bookkeeping
+
+  size_t total() const { return field_bytes + array_bytes; }
+};
+
 class ConcreteHeap {
  public:
   ConcreteHeap() : next_ref_(1) {}  // Start ref allocation at 1
 
   // Allocation
   Ref AllocateObject();
-  Ref AllocateArray(int32_t length);
+  // Arrays default-initialize to zero of their element kind. Float and
+  // double arrays are stored unboxed and only accept values of that kind.
+  Ref AllocateArray(int32_t length, Value::Kind elem = Value::Kind::kI32);
 
   // Field access
   Value ReadField(Ref obj, const FieldID& field) const;
@@ -25,15 +38,54 @@ class ConcreteHeap {
   Value ReadArray(Ref arr, int32_t index) const;
   void WriteArray(Ref arr, int32_t index, Value val);
   int32_t ArrayLength(Ref arr) const;
+  Value::Kind ArrayElementKind(Ref arr) const;
+
+  // Contiguous storage of a float/double array, e.g. for FloatKernels batch
+  // forms. Throws if the array has another element kind.
+  std::span<float> FloatArrayData(Ref arr);
+  std::span<double> DoubleArrayData(Ref arr);
 
   // Get entire array contents as a vector (for testing/validation)
   std::vector<Value> GetArrayContents(Ref arr) const;
 
+  // Memory accounting. bytes() is kept up to date on every allocation and
+  // equals MemoryUsage().total(), which walks the heap for a breakdown.
+  size_t bytes() const { return bytes_; }
+  HeapMemory MemoryUsage() const;
+
+  // Soft limit on bytes() (0 = none). An allocation or first field write
+  // that would exceed it throws MemoryLimitExceeded and changes nothing.
+  void set_limit(size_t bytes) { limit_ = bytes; }
+  size_t limit() const { return limit_; }
+
   // Debugging
   std::string Dump() const;
+  // Allocation numbering independent of allocation order: refs reachable
+  // from `roots` (return value, then parameters) numbered 1, 2, ... in
+  // breadth-first order, fields by name and elements by index. Objects and
+  // arrays no root reaches follow, by their contents (refs among them not
+  // yet numbered), each with what it reaches; only ties in contents fall
+  // back to allocation order. Objects never written or reached are not
+  // numbered.
+  std::map<Ref, Ref> CanonicalNumbering(std::span<const Value> roots) const;
+  // Contents under CanonicalNumbering, in canonical order, with stored
+  // references by canonical number: equal for heaps that are the same
+  // object graph up to how refs were numbered.
+  std::string CanonicalDump(std::span<const Value> roots = {}) const;
 
  private:
+  // Account for `bytes` more, or throw if that would pass the limit
+  void Reserve(size_t bytes);
+  size_t FieldBytes(const FieldID& field) const;
+  size_t ArrayBytes(int32_t length, Value::Kind elem) const;
+  // References stored in an object or array, fields by name
+  std::vector<Ref> Successors(Ref ref) const;
+  // An object's or array's contents, refs by number ("?" if none yet)
+  std::string Contents(Ref ref, const std::map<Ref, Ref>& number) const;
+
   Ref next_ref_;  // Next available reference
+  size_t bytes_ = 0;
+  size_t limit_ = 0;
 
   // Heap storage: (ref, field) -> value
   std::map<std::pair<Ref, FieldID>, Value> fields_;
@@ -41,8 +93,15 @@ class ConcreteHeap {
   // Array storage: ref -> vector of values
   std::map<Ref, std::vector<Value>> arrays_;
 
+  // Typed float array storage: ref -> unboxed elements
+  std::map<Ref, std::vector<float>> float_arrays_;
+  std::map<Ref, std::vector<double>> double_arrays_;
+
   // Array lengths: ref -> length
   std::map<Ref, int32_t> array_lengths_;
+
+  // Element kind each array was allocated with
+  std::map<Ref, Value::Kind> array_kinds_;
 };
 
 }  // namespace sun
@@ -1,17 +1,29 @@
 #pragma once
 #include <map>
-#include <set>
 #include <vector>
 
 #include "suntv/interp/evaluator.hpp"
 #include "suntv/interp/heap.hpp"
+#include "suntv/interp/method_registry.hpp"
 #include "suntv/interp/outcome.hpp"
 #include "suntv/interp/value.hpp"
+#include "suntv/ir/loop_info.hpp"
+#include "suntv/ir/node_table.hpp"
 
 namespace sun {
 class Graph;
 class Node;
 
+/** Bytes held by an Interpreter (see util/memory_usage). */
+struct InterpreterMemory {
+  size_t prepared = 0;  // Per-graph state: control successors, loop plans
+  size_t run = 0;       // Per-run tables and scratch, kept between runs
+  HeapMemory heap;      // Heap of the last run
+  size_t self = 0;      // The Interpreter object
+
+  size_t total() const { return prepared + run + heap.total() + self; }
+};
+
 /**
  * Concrete interpreter for Sea-of-Nodes graphs.
  *
@@ -23,11 +35,19 @@ class Node;
  * 2. When control node needs a value (e.g., If condition), evaluate data
  * subgraph
  * 3. Value evaluation is recursive with memoization (DAG-aware)
- * 4. Loops are handled by traversing back-edges iteratively
+ * 4. Loops are handled by traversing back-edges iteratively; counted loops
+ *    with a straight-line body iterate in place (see RunCountedLoop)
+ * 5. CallStaticJava runs when control reaches it if the MethodRegistry has
+ *    a target for it; other calls are passed through as uncommon traps
+ *
+ * An Interpreter is meant to be reused: everything derived from the graph is
+ * computed by the first run, and the per-run state lives in NodeTables that
+ * the next run clears in O(1). After a warm-up run, executing a graph
+ * without heap operations does not allocate (with logging below INFO).
  */
 class Interpreter {
  public:
-  explicit Interpreter(const Graph& g);
+  explicit Interpreter(const Graph& g, MethodRegistry* registry = nullptr);
 
   /**
    * Execute the graph with given input values.
@@ -45,16 +65,47 @@ class Interpreter {
   Outcome ExecuteWithHeap(const std::vector<Value>& inputs,
                           const ConcreteHeap& initial_heap);
 
+  // Soft limit on the heap of each run (0 = none); a run that would pass
+  // it fails with MemoryLimitExceeded
+  void set_heap_limit(size_t bytes) { heap_limit_ = bytes; }
+
+  // State kept since the last run, including its heap
+  InterpreterMemory MemoryUsage() const;
+
  private:
   const Graph& graph_;
 
+  // Call targets; not owned, may be null
+  MethodRegistry* registry_;
+
+  // Nesting of this frame below the outermost Execute
+  int call_depth_ = 0;
+  static constexpr int kMaxCallDepth = 64;
+
+  // Control successors, counted loops, parameters and Region Phis depend
+  // only on the graph
+  bool prepared_ = false;
+
+  // Resolved registry method of each CallStaticJava (null: pass through)
+  std::map<const Node*, MethodRegistry::Method*> call_targets_;
+
   // Precomputed control-flow successors (control producer -> control
   // consumers). This avoids repeated global scans and makes traversal
   // deterministic.
   std::map<const Node*, std::vector<const Node*>> control_successors_;
 
+  // Successor of each control node with several, taken from the graph's
+  // block schedule when it has one; FindControlSuccessor then skips scoring
+  NodeTable<const Node*> scheduled_successors_;
+
+  // Data Parms in input order
+  std::vector<const Node*> params_;
+
+  // Data Phis of each Region, in graph order
+  std::map<const Node*, std::vector<const Node*>> region_phis_;
+
   // Memoization: node -> computed value
-  std::map<const Node*, Value> value_cache_;
+  NodeTable<Value> value_cache_;
 
   // Recursion guard for value evaluation.
   int eval_depth_ = 0;
@@ -62,33 +113,66 @@ class Interpreter {
   static constexpr int kMaxEvalDepth = 2000;
 
   // Detect accidental cyclic value evaluation (not just Phi self-cycles).
-  std::set<const Node*> eval_active_;
+  NodeSet eval_active_;
+
+  // VerifyGraph found no issue: every value cycle passes a node that
+  // MayCloseValueCycle, so release builds only track those in eval_active_
+  bool verified_ = false;
 
   // Execution context: track which control predecessor was taken at each Region
   // This is needed for Phi node evaluation
-  std::map<const Node*, const Node*> region_predecessor_;
+  NodeTable<const Node*> region_predecessor_;
 
   // Loop iteration tracking: Region -> iteration count (for loop termination)
-  std::map<const Node*, int> loop_iterations_;
+  NodeTable<int> loop_iterations_;
 
   // Maximum loop iterations before aborting (prevent infinite loops)
   static constexpr int kMaxLoopIterations = 100;
 
+  // Counted loop that can iterate without control stepping: its body is
+  // straight-line and all Phis at its head are data Phis.
+  struct CountedLoopPlan {
+    CountedLoopInfo info;
+    std::vector<const Node*> phis;     // Data Phis at the head
+    std::vector<const Node*> next;     // Back-edge input of each Phi
+    std::vector<const Node*> variant;  // Non-Phi values that change per trip
+  };
+
+  // Fast-path counted loops, keyed by loop head
+  std::map<const Node*, CountedLoopPlan> counted_loops_;
+
+  // Trips per entry into a fast-path counted loop before aborting
+  static constexpr int64_t kMaxCountedLoopTrips = int64_t{1} << 24;
+
   // Heap state
   ConcreteHeap heap_;
+  size_t heap_limit_ = 0;
 
   // Phi update mode (used to break recursive Phi definitions on back-edges)
   bool in_phi_update_ = false;
   const Node* updating_region_ = nullptr;
-  std::map<const Node*, Value> phi_old_values_;
+  NodeTable<Value> phi_old_values_;
   const Node* updating_phi_ = nullptr;
-  std::set<const Node*> phi_update_active_;
+  NodeSet phi_update_active_;
 
   // Detect accidental cyclic Phi evaluation outside of update mode.
-  std::set<const Node*> phi_eval_stack_;
+  NodeSet phi_eval_stack_;
 
   // Track visited memory nodes to prevent infinite recursion in memory chain
-  std::set<const Node*> memory_chain_visited_;
+  NodeSet memory_chain_visited_;
+
+  // Stack of Phi values computed before any is installed, by
+  // UpdateRegionPhis and RunCountedLoop; empty between them
+  std::vector<Value> pending_phi_values_;
+
+  // Derive the per-graph state on the first run
+  void Prepare();
+
+  // Clear the per-run state for the next run
+  void ResetRunState();
+
+  // Execute from Start on the current heap_; outcome.heap is left empty
+  Outcome Run(const std::vector<Value>& inputs);
 
   // Main control flow traversal
   const Node* StepControl(const Node* ctrl);
@@ -96,10 +180,23 @@ class Interpreter {
   // Build control successor map once per graph.
   void BuildControlSuccessors();
 
+  // Resolve control successors from the graph's Schedule, if any.
+  void BuildScheduledSuccessors();
+
   // Find control successor for a given control node
   const Node* FindControlSuccessor(const Node* ctrl);
 
-  // Check if a Region is a loop header (has back-edge)
+  // Collect the counted loops eligible for RunCountedLoop.
+  void BuildCountedLoops();
+
+  // Collect the data Parms and the data Phis of every Region.
+  void BuildParamsAndPhis();
+
+  // Run a counted loop from its entry to its exit projection, updating the
+  // head's Phis in place each trip. Returns the exit projection.
+  const Node* RunCountedLoop(const CountedLoopPlan& loop);
+
+  // Check if a Region-like node is a loop header (has back-edge)
   bool IsLoopHeader(const Node* region) const;
 
   // Select the Phi input corresponding to the active Region predecessor.
@@ -146,9 +243,12 @@ class Interpreter {
   // Evaluate ThreadLocal (thread-local variable access)
   Value EvalThreadLocal(const Node* n);
 
-  // Evaluate CallStaticJava (skip uncommon_trap)
+  // Evaluate CallStaticJava (skip uncommon_trap, run registry targets)
   Value EvalCallStaticJava(const Node* n);
 
+  // Registry target of a CallStaticJava, or null to pass it through
+  MethodRegistry::Method* ResolveCall(const Node* call);
+
   // Evaluate Halt (abnormal termination)
   Value EvalHalt(const Node* n);
 
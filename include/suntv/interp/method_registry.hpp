@@ -0,0 +1,89 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "suntv/interp/heap.hpp"
+#include "suntv/interp/value.hpp"
+#include "suntv/ir/method_signature.hpp"
+
+namespace sun {
+class Graph;
+class Interpreter;
+
+/**
+ * In-process targets for CallStaticJava.
+ *
+ * Maps a method to either another graph, run by the interpreter as a
+ * nested frame on the caller's heap, or a native stub (intrinsics such as
+ * Math.max). Methods are named "Holder::name(types)" or, to match every
+ * overload, "Holder::name"; '/' and ',' spacing are normalized, so keys can
+ * be written the way C2 prints them. Calls that match nothing keep the
+ * interpreter's pass-through behavior.
+ *
+ * Register methods before executing; graphs are borrowed and must outlive
+ * the registry. Each graph method keeps one prepared Interpreter per active
+ * recursion depth, so a callee's control successors and counted loops are
+ * built once rather than on every call.
+ */
+class MethodRegistry {
+ public:
+  using NativeMethod =
+      std::function<Value(std::span<const Value> args, ConcreteHeap& heap)>;
+
+  struct Method {
+    const Graph* graph = nullptr;  // Set for graph methods
+    NativeMethod native;           // Set for native methods
+    // Cached frames, indexed by recursion depth within this method
+    std::vector<std::unique_ptr<Interpreter>> frames;
+    // Bytes of each idle frame as of its last release (0 while active)
+    std::vector<size_t> frame_bytes;
+    size_t active = 0;  // Frames currently executing
+    uint64_t last_used = 0;
+  };
+
+  MethodRegistry();
+  ~MethodRegistry();
+  MethodRegistry(const MethodRegistry&) = delete;
+  MethodRegistry& operator=(const MethodRegistry&) = delete;
+
+  // Register a graph or native target; replaces an earlier registration
+  void AddGraph(std::string_view method, const Graph& callee);
+  void AddNative(std::string_view method, NativeMethod stub);
+
+  // Native java.lang.Math max/min/abs for int/long/float/double and sqrt
+  void AddJavaLangMath();
+
+  // Exact "Holder::name(types)" first, then "Holder::name"
+  Method* Find(const MethodSignature& sig);
+
+  size_t size() const { return methods_.size(); }
+
+  // Frame for the next activation of a graph method, built on first use
+  Interpreter& AcquireFrame(Method& method);
+  void ReleaseFrame(Method& method);
+
+  // Bytes held by idle cached frames (Interpreter::MemoryUsage)
+  size_t frame_cache_bytes() const { return frame_cache_bytes_; }
+  size_t frame_cache_evictions() const { return evictions_; }
+
+  // Soft limit on frame_cache_bytes() (0 = none). Releasing a frame past
+  // it drops idle frames, least recently used method first; they are
+  // rebuilt on demand.
+  void set_frame_cache_limit(size_t bytes) { frame_cache_limit_ = bytes; }
+
+ private:
+  void EvictFrames();
+
+  std::map<std::string, Method> methods_;
+  size_t frame_cache_bytes_ = 0;
+  size_t frame_cache_limit_ = 0;
+  size_t evictions_ = 0;
+  uint64_t tick_ = 0;
+};
+
+}  // namespace sun
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "suntv/interp/differential.hpp"
+#include "suntv/interp/heap.hpp"
+#include "suntv/interp/value.hpp"
+#include "suntv/ir/graph.hpp"
+
+namespace sun {
+
+/** One argument of a run: a scalar, or an array passed by a fresh ref. */
+struct WitnessArg {
+  Value value = Value::MakeI32(0);    // Scalar; unused for an array
+  std::optional<Value::Kind> array;   // Element kind, for an array
+  std::vector<Value> elements;
+};
+
+/**
+ * Arguments of one run, with the arrays they reference, in suni's
+ * argument syntax: scalars as Value::Parse reads them ("3", "7L", "1.5f",
+ * "null") and arrays as "[1,2,3]", with a "long", "float" or "double"
+ * prefix for other element kinds ("long[1,2]").
+ */
+struct Witness {
+  std::vector<WitnessArg> args;
+
+  // Throws std::invalid_argument on a malformed argument
+  static Witness Parse(const std::vector<std::string>& tokens);
+  // Scalars only
+  static Witness FromValues(const std::vector<Value>& values);
+  // Arguments of a witness file: its tokens, skipping '#' comment lines
+  static Witness Load(const std::string& path);
+
+  // Arguments separated by spaces; Parse reads them back
+  std::string ToString() const;
+  // Inputs of a run, allocating the arrays on `heap` in argument order
+  std::vector<Value> Materialize(ConcreteHeap& heap) const;
+};
+
+struct MinimizeOptions {
+  size_t max_runs = 100000;  // Executions of each graph
+};
+
+struct MinimizeResult {
+  Witness witness;
+  EngineResult before;  // Results of the two graphs on `witness`
+  EngineResult after;
+  size_t runs = 0;      // Executions of each graph
+  size_t steps = 0;     // Shrinking steps taken
+};
+
+/**
+ * Shrink a witness on which two graphs disagree to a small one on which
+ * they still do, by greedy delta debugging: each array argument is first
+ * tried as null, then with halves, quarters, ... of its elements cut;
+ * scalars and elements are moved to 0, then to 1 or -1, then halved or
+ * stepped towards 0. Candidates run on one interpreter per graph, reused
+ * for every run, and the first that still disagrees is kept and shrunk
+ * further. A disagreement is a pair of results that do not Match where
+ * neither is kError. Returns the last witness kept, with its results,
+ * once no candidate disagrees or the run budget is spent, or nullopt when
+ * `start` itself does not disagree.
+ */
+std::optional<MinimizeResult> MinimizeWitness(
+    const Graph& before, const Graph& after, const Witness& start,
+    const MinimizeOptions& options = {});
+
+/**
+ * A witness file: `comments` as '#' lines, then the arguments, for
+ * `suni --args FILE`.
+ */
+std::string WitnessFile(const Witness& witness,
+                        const std::vector<std::string>& comments);
+
+}  // namespace sun
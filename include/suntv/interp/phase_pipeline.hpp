@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "suntv/interp/differential.hpp"
+#include "suntv/interp/value.hpp"
+#include "suntv/ir/egraph.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/structural_hash.hpp"
+
+namespace sun {
+
+/** How one phase compares with the phase before it. */
+struct PhasePair {
+  enum class Verdict {
+    kIdentical,  // Same structure: not run
+    kProven,     // Rewritten into each other (ProveEquivalent): not run
+    kAgree,      // Same results on every input
+    kDiffer,     // Different results on some input
+    kUnknown,    // No difference where both ran, but some input could not
+  };
+
+  size_t before = 0;  // Phase indices, in the order added
+  size_t after = 0;
+  Verdict verdict = Verdict::kIdentical;
+  // Reachable nodes of `after` with no structural counterpart in `before`
+  size_t changed_nodes = 0;
+  // kDiffer: the first input they disagree on, and their results on it
+  std::optional<size_t> input;
+  EngineResult before_result;
+  EngineResult after_result;
+};
+
+const char* PhasePairVerdictName(PhasePair::Verdict verdict);
+
+/**
+ * Checks each phase of a compilation against the one before it, on a fixed
+ * batch of inputs, as the phases are added in order.
+ *
+ * Every phase takes part in two pairs, so what a pair needs of a phase is
+ * kept for the next one rather than recomputed: its StructuralHashes and
+ * its results on the inputs (its signature). A phase whose Root hash equals
+ * its predecessor's is kIdentical and inherits the signature without being
+ * run, so a chain of n phases runs each distinct phase once, and phases
+ * that change nothing cost one hashing pass. A signature is computed only
+ * when a pair needs it. Before running a pair, the pipeline tries to prove
+ * the phases equal by rewriting (ProveEquivalent, within the proof limits);
+ * a proven pair is kProven and, like kIdentical, passes the signature on
+ * unrun, so execution is the fallback for what rewriting cannot show
+ * (loops, control restructuring). Post-matching phases are lowered, once,
+ * with every earlier phase as history (LowerMachGraph); a phase that cannot
+ * be lowered gets kError results, which make its pairs kUnknown rather
+ * than kDiffer.
+ *
+ * Graphs are borrowed and must outlive the pipeline.
+ */
+class PhasePipeline {
+ public:
+  // Runs each signature through `engine`, one batch per phase
+  PhasePipeline(std::vector<std::vector<Value>> inputs, DiffEngine engine);
+  // Same, with one interpreter reused for the batch
+  explicit PhasePipeline(std::vector<std::vector<Value>> inputs);
+
+  // Budget of each proof attempt; nullopt runs every changed pair
+  void set_proof_limits(std::optional<SaturationLimits> limits) {
+    proof_limits_ = limits;
+  }
+
+  // Add the next phase; its pair with the previous phase, if any
+  std::optional<PhasePair> Add(const Graph& phase);
+
+  size_t num_phases() const { return history_.size(); }
+  // Phases run so far, each on the whole batch
+  size_t executions() const { return executions_; }
+
+ private:
+  struct PhaseState {
+    size_t index;
+    const Graph* graph;
+    StructuralHashes hashes;
+    std::optional<std::vector<EngineResult>> signature;
+    std::unique_ptr<Graph> lowered;  // Post-matching phases, once lowered
+    std::string error;               // Why it could not be lowered
+  };
+
+  // The graph to run or prove with: the phase, or its lowering; null if
+  // it cannot be lowered
+  const Graph* Runnable(PhaseState& state);
+  const std::vector<EngineResult>& Signature(PhaseState& state);
+
+  std::vector<std::vector<Value>> inputs_;
+  DiffEngine engine_;
+  std::optional<SaturationLimits> proof_limits_ = SaturationLimits{};
+  std::vector<const Graph*> history_;  // Every phase added, in order
+  std::unique_ptr<PhaseState> last_;
+  size_t executions_ = 0;
+};
+
+}  // namespace sun
@@ -7,7 +7,7 @@ namespace sun {
 using Ref = int32_t;
 
 struct Value {
-  enum class Kind { kI32, kI64, kBool, kRef, kNull };
+  enum class Kind { kI32, kI64, kBool, kRef, kNull, kF32, kF64 };
 
   Kind kind;
   union {
@@ -15,6 +15,8 @@ struct Value {
     int64_t i64;
     bool b;
     Ref ref;
+    float f32;
+    double f64;
   } data;
 
   // Factory methods
@@ -23,12 +25,25 @@ struct Value {
   static Value MakeBool(bool v);
   static Value MakeRef(Ref r);
   static Value MakeNull();
+  static Value MakeF32(float v);
+  static Value MakeF64(double v);
+
+  // Parse a command-line argument. Integers become int (long if out of
+  // range); "1.5", "1e3", "NaN" and "-Infinity" become double, and a
+  // trailing 'f' or 'L' (as in Java literals: "1.5f", "7L") makes a float
+  // or a long; "null" is the null reference. Throws std::invalid_argument
+  // or std::out_of_range otherwise.
+  static Value Parse(const std::string& text);
+  // Inverse of Parse for ints, longs, floats, doubles and null
+  std::string Literal() const;
 
   // Accessors (with type checking)
   int32_t as_i32() const;
   int64_t as_i64() const;
   bool as_bool() const;
   Ref as_ref() const;
+  float as_f32() const;
+  double as_f64() const;
 
   // Type queries
   bool is_i32() const { return kind == Kind::kI32; }
@@ -36,6 +51,8 @@ struct Value {
   bool is_bool() const { return kind == Kind::kBool; }
   bool is_ref() const { return kind == Kind::kRef; }
   bool is_null() const { return kind == Kind::kNull; }
+  bool is_f32() const { return kind == Kind::kF32; }
+  bool is_f64() const { return kind == Kind::kF64; }
 
   // String representation
   std::string ToString() const;
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include "suntv/ir/opcode.hpp"
+#include "suntv/util/arena.hpp"
+
+namespace sun {
+
+/**
+ * Decoded payload of a constant node (ConI/ConL/ConP/ConF/ConD).
+ * ConP only ever pools the null pointer (value 0). ConF/ConD hold the IEEE
+ * bit pattern, so -0.0 and +0.0 (and distinct NaNs) pool separately.
+ */
+struct Constant {
+  Opcode op;
+  int64_t value;
+  uint32_t id;  // Dense ID in pooling order
+};
+
+/**
+ * Hash-consing pool of constant payloads.
+ *
+ * Each distinct (opcode, value) pair is stored once; constants from different
+ * graphs that share a pool are equal iff their Constant pointers are equal.
+ * Constant *nodes* stay per graph because their edges are graph-local.
+ * Not thread-safe.
+ */
+class ConstantPool {
+ public:
+  explicit ConstantPool(Arena& arena);
+
+  ConstantPool(const ConstantPool&) = delete;
+  ConstantPool& operator=(const ConstantPool&) = delete;
+
+  const Constant* Intern(Opcode op, int64_t value);
+
+  /**
+   * Decode a C2 dump_spec (" #int:42", " #long:-5", " #null") for the given
+   * constant opcode and pool it. Returns nullptr if it cannot be decoded.
+   */
+  const Constant* InternDumpSpec(Opcode op, std::string_view spec);
+
+  size_t size() const { return size_; }
+
+  /**
+   * Decode the value of a C2 constant dump_spec without pooling it.
+   * Understands C2's symbolic bounds ("#int:max-1", "#long:minint").
+   * Float constants ("#ftcon:1.500000", "#dblcon:NaN") decode to their bit
+   * pattern; C2 prints them with "%f", so the dump may have lost digits.
+   */
+  static std::optional<int64_t> DecodeDumpSpec(Opcode op,
+                                               std::string_view spec);
+
+ private:
+  struct Key {
+    Opcode op;
+    int64_t value;
+    bool operator==(const Key& o) const {
+      return op == o.op && value == o.value;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& k) const {
+      return std::hash<int64_t>()(k.value) * 31 + static_cast<size_t>(k.op);
+    }
+  };
+
+  Arena& arena_;
+  std::pmr::unordered_map<Key, const Constant*, KeyHash> table_;
+  size_t size_ = 0;
+};
+
+}  // namespace sun
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "suntv/ir/opcode.hpp"
+
+namespace sun {
+class Graph;
+class Node;
+
+using EClassId = uint32_t;
+
+/**
+ * One operator application in an EGraph: an opcode, the payload that tells
+ * nodes of that opcode apart (constant value, Parm index, Proj number, Bool
+ * mask), an optional interned string for payloads that are text (memory
+ * slices, call signatures) and the e-classes of its inputs in order.
+ */
+struct ENode {
+  Opcode op = Opcode::kUnknown;
+  int64_t payload = 0;
+  uint32_t symbol = 0;  // 0: none
+  std::vector<EClassId> children;
+
+  bool operator==(const ENode& other) const = default;
+};
+
+struct ENodeHash {
+  size_t operator()(const ENode& n) const;
+};
+
+/**
+ * An e-graph: equivalence classes of terms over Sea-of-Nodes operators,
+ * with hash-consing and congruence closure.
+ *
+ * Add() hash-conses, so a term is stored once however often it is added.
+ * Merge() unions two classes; the congruences it implies (equal operators
+ * over now-equal children) are restored by Rebuild(), in one deferred pass
+ * over the parents of the merged classes, so a batch of merges costs about
+ * as much as the parents they touch. Find() is union-find with path
+ * halving. Each class tracks the integer constant it is known to equal, if
+ * any, which rewrites match through (see Rewrite).
+ */
+class EGraph {
+ public:
+  EGraph();
+  ~EGraph();
+
+  EGraph(const EGraph&) = delete;
+  EGraph& operator=(const EGraph&) = delete;
+
+  EClassId Add(ENode n);
+  // Class of the ConI/ConL (or other constant opcode) with this value
+  EClassId AddConstant(Opcode op, int64_t value);
+  // Interned symbol for ENode::symbol; never 0
+  uint32_t Intern(const std::string& text);
+
+  EClassId Find(EClassId id) const;
+  // Union two classes; false if they already were one. Call Rebuild()
+  // before the next Add() or match.
+  bool Merge(EClassId a, EClassId b);
+  void Rebuild();
+
+  // Known constant of a class, with its constant opcode
+  struct Constant {
+    Opcode op;
+    int64_t value;
+  };
+  std::optional<Constant> constant(EClassId id) const;
+
+  // Nodes of a class, in canonical form after Rebuild()
+  const std::vector<ENode>& nodes(EClassId id) const;
+  // Every class that is its own representative
+  std::vector<EClassId> classes() const;
+
+  size_t num_nodes() const { return memo_.size(); }
+  size_t num_classes() const { return num_classes_; }
+
+ private:
+  struct EClass {
+    std::vector<ENode> nodes;
+    std::vector<std::pair<ENode, EClassId>> parents;
+    std::optional<Constant> constant;
+  };
+
+  ENode Canonical(ENode n) const;
+  std::optional<Constant> Fold(const ENode& n) const;
+  void Repair(EClassId id);
+
+  mutable std::vector<EClassId> parent_;  // Union-find forest
+  std::vector<EClass> classes_;
+  std::unordered_map<ENode, EClassId, ENodeHash> memo_;
+  std::vector<EClassId> pending_;  // Merged since the last Rebuild()
+  std::unordered_map<std::string, uint32_t> symbols_;
+  size_t num_classes_ = 0;
+};
+
+/**
+ * A rewrite rule: a pattern over e-nodes and what a match is equal to.
+ *
+ * Patterns are s-expressions over opcode names: "(AddI ?a (ConI 0))".
+ * "?x" binds any class (repeated variables must bind the same class), and
+ * a constant pattern matches every class known to equal that constant, so
+ * rules see through folding. The right-hand side is either a pattern over
+ * the same variables or, for rules that compute (shift amounts, swapped
+ * condition masks), a function of the match that may decline.
+ */
+struct Rewrite {
+  struct Pattern;
+  using Bindings = std::vector<EClassId>;  // By variable number
+  using Builder =
+      std::function<std::optional<EClassId>(EGraph&, const Bindings&)>;
+
+  std::string name;
+  std::shared_ptr<const Pattern> lhs;
+  std::shared_ptr<const Pattern> rhs;  // Null when `build` is set
+  Builder build;
+  std::vector<std::string> variables;  // Names, by variable number
+
+  // Throws std::invalid_argument on a malformed pattern or a right-hand
+  // side that uses a variable the left-hand side does not bind
+  static Rewrite Parse(const std::string& name, const std::string& lhs,
+                       const std::string& rhs);
+  static Rewrite Parse(const std::string& name, const std::string& lhs,
+                       Builder build);
+
+  // Every binding of lhs to a term of class `id`
+  std::vector<Bindings> Match(const EGraph& g, EClassId id) const;
+  std::optional<EClassId> Apply(EGraph& g, const Bindings& b) const;
+};
+
+/**
+ * Identities of Java int and long arithmetic, all exact under two's-
+ * complement wraparound: commutativity and associativity of +, *, &, |
+ * and ^, their units and annihilators, x - y = x + (0 - y), distribution
+ * of * over +, shifts by a constant as multiplication, casts (CastII,
+ * CastLL, CastPP) as the identity, comparisons with swapped operands, and
+ * if-diamonds with empty arms as their If's control and Phis on them as
+ * CMoves.
+ * Division and remainder are only folded, never rewritten: they throw.
+ */
+const std::vector<Rewrite>& JavaIntegerRewrites();
+
+/**
+ * Read-over-write: a load whose memory is a store is the stored value when
+ * both access the same location, and the same load from the store's input
+ * memory when they provably access different ones. Locations are split by
+ * slice first (field, array element type, C2 alias index), then by
+ * address: equal address classes are the same location, and addresses that
+ * are one root at different constant offsets (AddP, integer adds) are
+ * distinct. Anything else may alias and is left alone.
+ */
+const std::vector<Rewrite>& ReadOverWriteRewrites();
+
+struct SaturationLimits {
+  size_t max_nodes = 20000;  // Stop once the e-graph holds this many
+  size_t max_iterations = 12;
+  double max_seconds = 0.05;
+};
+
+struct SaturationReport {
+  enum class Stop {
+    kSaturated,       // No rule changed anything
+    kGoal,            // The goal held
+    kNodeLimit,
+    kIterationLimit,
+    kTimeLimit,
+  };
+
+  Stop stop = Stop::kSaturated;
+  size_t iterations = 0;
+  size_t nodes = 0;
+  size_t classes = 0;
+};
+
+const char* SaturationStopName(SaturationReport::Stop stop);
+
+/**
+ * Equality saturation: apply every rule at every class, merge, rebuild and
+ * repeat until nothing changes, `goal` holds (checked after each rebuild),
+ * or a limit is reached. Matches are collected before any is applied, so
+ * the order of the rules does not matter.
+ */
+SaturationReport Saturate(EGraph& g, const std::vector<Rewrite>& rules,
+                          const SaturationLimits& limits = {},
+                          const std::function<bool()>& goal = {});
+
+/**
+ * Term of node n of a graph in an e-graph: every node reachable from n
+ * along inputs, with its opcode, payload and inputs in order. Null inputs
+ * and a node's inputs to itself (Root, Regions) become placeholder
+ * leaves. An allocation is identified by its term, that is by its position
+ * (control and memory inputs) and type, which matches it to the allocation
+ * at the same place in another graph. Returns nullopt for what a term
+ * cannot express: cycles (loops), two allocations of one graph with the
+ * same term, and nodes of unknown opcode.
+ */
+std::optional<EClassId> AddGraphTerm(EGraph& g, const Graph& graph,
+                                     const Node* n);
+
+struct EquivalenceProof {
+  bool proven = false;
+  std::string reason;  // Why not, when not proven
+  SaturationReport saturation;
+};
+
+/**
+ * Try to show two graphs compute the same thing by rewriting alone: add
+ * both Roots' terms (every return, store and branch they depend on) and
+ * saturate with JavaIntegerRewrites and ReadOverWriteRewrites until the
+ * Roots share a class. Sound but incomplete: graphs that differ in
+ * control structure or have loops are left to other checks.
+ */
+EquivalenceProof ProveEquivalent(const Graph& a, const Graph& b,
+                                 const SaturationLimits& limits = {});
+
+}  // namespace sun
@@ -1,21 +1,57 @@
 #pragma once
 
-#include <map>
 #include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "suntv/ir/constant_pool.hpp"
 #include "suntv/ir/node.hpp"
+#include "suntv/ir/schedule.hpp"
+#include "suntv/util/arena.hpp"
+#include "suntv/util/interner.hpp"
 
 namespace sun {
 
+/**
+ * Bytes held by a Graph. The arena figure is exact (chunks obtained from
+ * the allocator); nodes, edges and properties are the parts of it in use
+ * by live storage, the rest being the ID index, an owned string table and
+ * constant pool, and buffers abandoned by growth.
+ */
+struct GraphMemory {
+  size_t nodes = 0;       // Node objects
+  size_t edges = 0;       // Input arrays, by capacity
+  size_t properties = 0;  // Property slots, by capacity
+  size_t arena = 0;       // Arena chunks, including the three above
+  size_t other = 0;       // The Graph object, its node list and schedule
+
+  size_t total() const { return arena + other; }
+};
+
 /**
  * Graph container for Sea-of-Nodes IR.
+ *
+ * All per-graph storage (nodes, their input arrays and properties, the ID
+ * index) is allocated from a graph-owned arena and released in one shot when
+ * the graph is destroyed. Node destructors are not run.
+ *
+ * Property strings and constant payloads go to a string table and constant
+ * pool. By default the graph owns both; graphs loaded together (see
+ * GraphSession) can share them so identical strings and constants are stored
+ * once and compare by identity across graphs. Shared tables must outlive the
+ * graph.
  */
 class Graph {
  public:
   Graph();
+  Graph(StringInterner* strings, ConstantPool* constants);
   ~Graph();
 
+  Graph(const Graph&) = delete;
+  Graph& operator=(const Graph&) = delete;
+
   // Node access
   Node* node(NodeID id) const;
   Node* start() const { return start_; }
@@ -24,20 +60,40 @@ class Graph {
 
   // Node creation
   Node* AddNode(NodeID id, Opcode op);
+  // Copy of `src` (possibly from another graph) without its inputs:
+  // opcode, properties, type and pooled constant
+  Node* CloneNode(const Node& src, NodeID id);
 
   // Graph queries
   std::vector<Node*> GetParameterNodes() const;
   std::vector<Node*> GetControlNodes() const;
 
+  // C2's basic-block schedule, if the dump had one (null otherwise)
+  const Schedule* schedule() const { return schedule_.get(); }
+  void set_schedule(std::unique_ptr<Schedule> schedule) {
+    schedule_ = std::move(schedule);
+  }
+
+  // Storage
+  const Arena& arena() const { return arena_; }
+  GraphMemory MemoryUsage() const;
+  StringInterner& strings() const { return *strings_; }
+  ConstantPool& constants() const { return *constants_; }
+
   // Debugging
   void Dump() const;  // Print graph structure to stdout
 
  private:
-  std::vector<std::unique_ptr<Node>> owned_nodes_;
+  Arena arena_;  // Declared first: must outlive everything allocated in it
+  StringInterner own_strings_;
+  ConstantPool own_constants_;
+  StringInterner* strings_;
+  ConstantPool* constants_;
   std::vector<Node*> node_list_;  // All nodes (for iteration)
-  std::map<NodeID, Node*> id_to_node_;
+  std::pmr::unordered_map<NodeID, Node*> id_to_node_;
   Node* start_;
   Node* root_;
+  std::unique_ptr<Schedule> schedule_;
 };
 
 }  // namespace sun
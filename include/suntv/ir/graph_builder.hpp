@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "suntv/ir/graph.hpp"
+
+namespace sun {
+
+/**
+ * Builds graphs in the hand-written form the interpreter tests use.
+ *
+ * Parms are numbered by "index"; Regions have no self input, and a Phi's
+ * values follow its Region's inputs. Loops are a Region whose back edge is
+ * added once the body is built (AddInput on the Region and its Phis). Field
+ * and array accesses take the memory state explicitly and chain through
+ * their memory input; Return uses the C2 layout (control, I/O, memory,
+ * frame pointer, return address, value) so its memory state is flushed to
+ * the outcome heap.
+ *
+ * Node IDs are assigned in creation order; ConI nodes are shared per value.
+ */
+class GraphBuilder {
+ public:
+  // Mask of a Bool over CmpI: LT = 1, EQ = 2, GT = 4 (NE = 5, LE = 3, ...)
+  enum BoolMask : int32_t {
+    kLt = 1,
+    kEq = 2,
+    kLe = 3,
+    kGt = 4,
+    kNe = 5,
+    kGe = 6,
+  };
+
+  struct Branch {
+    Node* if_true;
+    Node* if_false;
+  };
+
+  GraphBuilder();  // Creates Root and Start
+
+  Graph& graph() { return *graph_; }
+  Node* start() const { return graph_->start(); }
+  Node* root() const { return graph_->root(); }
+
+  // Hand the graph over; the builder must not be used afterwards
+  std::unique_ptr<Graph> Finish() { return std::move(graph_); }
+
+  Node* Parm(int32_t index);
+  Node* ConI(int32_t value);
+  Node* Binary(Opcode op, Node* lhs, Node* rhs);
+  // Bool(CmpI(lhs, rhs), mask)
+  Node* Compare(Node* lhs, Node* rhs, int32_t mask);
+
+  Branch If(Node* ctrl, Node* cond);
+  Node* Region(const std::vector<Node*>& preds);
+  Node* Phi(Node* region, const std::vector<Node*>& values);
+
+  Node* Allocate(Node* ctrl);
+  Node* AllocateArray(Node* ctrl, Node* length);
+  Node* StoreField(Node* ctrl, Node* mem, Node* base, const std::string& field,
+                   Node* value);
+  Node* LoadField(Node* ctrl, Node* mem, Node* base, const std::string& field);
+  Node* StoreArray(Node* ctrl, Node* mem, Node* base, Node* index,
+                   Node* value);
+  Node* LoadArray(Node* ctrl, Node* mem, Node* base, Node* index);
+
+  // Return(ctrl, I/O, mem, frame, return address, value), wired to Root
+  Node* Return(Node* ctrl, Node* mem, Node* value);
+
+ private:
+  Node* Add(Opcode op, const std::vector<Node*>& inputs);
+
+  std::unique_ptr<Graph> graph_;
+  NodeID next_id_ = 0;
+  std::map<int32_t, Node*> int_constants_;
+};
+
+}  // namespace sun
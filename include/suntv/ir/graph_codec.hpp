@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace sun {
+class ConstantPool;
+class Graph;
+class StringInterner;
+
+/**
+ * Compact binary encoding of a graph, as GraphStore keeps it.
+ *
+ * Integers are LEB128 varints (signed ones zigzag-coded first). After the
+ * magic "SUNG" and a version byte come:
+ *
+ *   strings   count, then each as length and bytes
+ *   nodes     count, then per node: ID as a delta from the previous node's,
+ *             opcode name, type, constant (0, or 1 + its opcode name, then
+ *             its value), and properties: count, then each as key << 2 |
+ *             kind (int, long, string, bool) followed by the value
+ *   inputs    per node, count, then 0 for a null input or 1 + the input's
+ *             position in the node list
+ *   schedule  0, or 1 + block count, then the block names, then per
+ *             block its successors and node positions
+ *
+ * Opcode names, property keys and string values are written once per graph
+ * and referred to by their position in the string table, which is what
+ * makes the encoding an order of magnitude smaller than the IGV XML. Names
+ * rather than enum values keep stored graphs readable when opcodes are
+ * added. Inputs follow all the nodes, so back edges need no fix-up.
+ */
+std::string EncodeGraph(const Graph& g);
+
+/**
+ * Rebuild a graph from EncodeGraph's bytes into the given string table and
+ * constant pool (the graph's own when null; see GraphSession). Node IDs,
+ * order, properties, types, constants, inputs and schedule come back as
+ * they were. Throws std::runtime_error on truncated or malformed bytes.
+ */
+std::unique_ptr<Graph> DecodeGraph(std::string_view bytes,
+                                   StringInterner* strings = nullptr,
+                                   ConstantPool* constants = nullptr);
+
+}  // namespace sun
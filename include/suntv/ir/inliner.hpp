@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/method_signature.hpp"
+
+namespace sun {
+
+/**
+ * Callee graphs available for inlining, keyed like MethodRegistry:
+ * "Holder::name(types)" for one overload or "Holder::name" for all.
+ * Graphs are borrowed and must outlive the library.
+ */
+class CalleeLibrary {
+ public:
+  void Add(std::string_view method, const Graph& callee);
+
+  // Exact "Holder::name(types)" first, then "Holder::name"
+  const Graph* Find(const MethodSignature& sig) const;
+
+  size_t size() const { return graphs_.size(); }
+
+ private:
+  std::map<std::string, const Graph*> graphs_;
+};
+
+struct InlineOptions {
+  // Calls nested deeper than this inside inlined code stay calls, which
+  // bounds recursive methods
+  int max_depth = 8;
+  // Stop inlining once the result has this many nodes
+  size_t max_nodes = 100000;
+};
+
+struct InlineStats {
+  int inlined = 0;         // Call sites replaced by a callee body
+  int unknown = 0;         // Calls with no callee in the library
+  int depth_limited = 0;   // Calls kept at max_depth or max_nodes
+  int unsupported = 0;     // Calls whose outputs or arguments do not fit
+  int max_depth_seen = 0;  // Deepest nesting of inlined bodies
+};
+
+/**
+ * Build a copy of `caller` with its CallStaticJava sites replaced by the
+ * library's callee graphs, recursively.
+ *
+ * At each site the callee's Start stands for the call's control input and
+ * its Parms for the call's I/O, memory, frame pointer, return address and
+ * argument slots (by "con", or "index" in hand-built graphs). The call's
+ * projections are rewired to the callee's Return: #0 control, #1 I/O, #2
+ * memory, #5 result; several Returns are first merged by a Region with
+ * Phis. Callee exits other than Return (Halt for uncommon traps and
+ * throws) become inputs of the caller's Root.
+ *
+ * Caller nodes keep their IDs; callee nodes get fresh IDs above the
+ * caller's. A site stays a call when it has no callee, is nested deeper
+ * than max_depth, or has outputs other than those four projections (e.g.
+ * exception Catch nodes). Uncommon traps are never inlined.
+ *
+ * The result owns its string table and constant pool.
+ */
+std::unique_ptr<Graph> InlineCalls(const Graph& caller,
+                                   const CalleeLibrary& library,
+                                   const InlineOptions& options = {},
+                                   InlineStats* stats = nullptr);
+
+}  // namespace sun
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace sun {
+class Graph;
+class Node;
+
+/**
+ * Role of a counted loop after C2 iteration splitting (from its dump_spec).
+ */
+enum class LoopKind {
+  kNormal,  // Not split
+  kPre,     // Pre-loop aligning the main loop
+  kMain,    // Main (usually unrolled) loop
+  kPost,    // Post-loop running the remaining iterations
+};
+
+/**
+ * Structure of one C2 counted loop in canonical form:
+ *
+ *   head = CountedLoop(head, entry, back_control)
+ *   iv   = Phi(head, init, incr)
+ *   incr = AddI(iv, stride)
+ *   end  = CountedLoopEnd(ctrl, Bool(CmpI(incr, limit)))
+ *   back_control = IfTrue(end), exit = IfFalse(end)
+ *
+ * LongCountedLoop uses the AddL/CmpL forms.
+ */
+struct CountedLoopInfo {
+  const Node* head = nullptr;
+  const Node* end = nullptr;
+  const Node* back_control = nullptr;  // Back-edge projection of end
+  const Node* exit = nullptr;          // Exit projection of end
+  const Node* test = nullptr;          // Bool consumed by end
+  const Node* iv = nullptr;            // Trip counter Phi
+  const Node* init = nullptr;          // Value of iv on entry
+  const Node* incr = nullptr;          // iv + stride
+  const Node* limit = nullptr;         // Trip-count bound compared with incr
+  int64_t stride = 0;
+  LoopKind kind = LoopKind::kNormal;
+  // Enclosing OuterStripMinedLoop for strip-mined loops, else null
+  const Node* outer = nullptr;
+  // Every Phi merged at head (data and memory), by node ID
+  std::vector<const Node*> phis;
+
+  /**
+   * True if end is controlled by head directly, i.e. the body has no
+   * control flow of its own.
+   */
+  bool straight_line() const;
+};
+
+/**
+ * Find every CountedLoop/LongCountedLoop of g that is in canonical form, in
+ * node ID order of their heads. Loops whose trip counter cannot be matched
+ * are left out; they still execute as ordinary Regions. O(nodes + edges).
+ */
+std::vector<CountedLoopInfo> FindCountedLoops(const Graph& g);
+
+}  // namespace sun
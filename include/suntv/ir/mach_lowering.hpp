@@ -0,0 +1,47 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "suntv/ir/graph.hpp"
+
+namespace sun {
+
+/**
+ * True if g is a post-matching graph ("After matching", "Global code
+ * motion", "Final Code"): its instructions carry an idealOpcode.
+ */
+bool IsMachGraph(const Graph& g);
+
+/**
+ * Build the ideal-form equivalent of a post-matching (Mach) graph, which
+ * the interpreter can then run like any other phase.
+ *
+ * Each instruction becomes the node of its idealOpcode. Immediate operands,
+ * which are not edges but printed in dump_spec ("#16/0x00000010"), become
+ * ConI/ConL inputs; lea forms with a scaled register add the shift. Spill
+ * copies stand for their input and MachTemp operands are dropped. Start's
+ * projections become Parms. Goto instructions and Regions that merge a
+ * single path without Phis are bypassed, which restores the canonical
+ * counted-loop shape. CMove takes a Bool built from its cmpOp, in this
+ * repo's (condition, true value, false value) order. SafePoints keep only
+ * their control, calls their control, I/O, memory, frame, return address
+ * and the arguments of their signature. The <controlFlow> schedule carries
+ * over to the nodes that survive.
+ *
+ * Branch conditions are not in the dump, so each branch gets a copy of the
+ * Bool it had in the last ideal graph of `history`: the earlier graphs of
+ * the same compilation, in phase order. A branch is found there by ID, by
+ * the ID of its compare when that feeds branches under a single condition,
+ * or through an earlier Mach graph of the history when block layout gave
+ * it a new ID.
+ *
+ * Nodes keep their IDs; nodes added for immediates and conditions get
+ * fresh IDs above the graph's. Throws std::runtime_error, naming the node,
+ * on instructions that have no lowering yet (memory operands, loads,
+ * stores, implicit null checks) and on branches whose condition is not
+ * found. The result owns its string table and constant pool.
+ */
+std::unique_ptr<Graph> LowerMachGraph(const Graph& mach,
+                                      const std::vector<const Graph*>& history);
+
+}  // namespace sun
@@ -0,0 +1,35 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sun {
+
+/**
+ * Callee of a CallStaticJava, as printed in the call's dump_spec:
+ * "# Static  java/lang/Math::max int ( int, int ) C=0.000100 ...".
+ */
+struct MethodSignature {
+  std::string holder;  // Normalized to dots: "java.lang.Math"
+  std::string name;
+  std::string ret;  // "void" when the call has no result
+  // Domain types after TypeFunc::Parms, one per argument slot; the second
+  // slot of a long/double prints as "half"
+  std::vector<std::string> params;
+  bool has_params = false;  // False if the dump_spec was cut before '('
+
+  // Parse a CallStaticJava dump_spec; nullopt for uncommon traps and
+  // specs without a "Holder::name" method.
+  static std::optional<MethodSignature> Parse(std::string_view dump_spec);
+
+  // "java.lang.Math::max(int,int)", without the half slots
+  std::string Key() const;
+  // "java.lang.Math::max"
+  std::string ShortKey() const;
+
+  // Method names as keys: strip whitespace and turn '/' into '.'
+  static std::string NormalizeKey(std::string_view method);
+};
+
+}  // namespace sun
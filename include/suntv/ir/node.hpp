@@ -1,15 +1,19 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
 #include "suntv/ir/opcode.hpp"
 #include "suntv/ir/types.hpp"
+#include "suntv/util/interner.hpp"
 
 namespace sun {
+struct Constant;
 
 using NodeID = int32_t;
 
@@ -17,17 +21,34 @@ using NodeID = int32_t;
  * Property value (constants, field IDs, etc.)
  */
 using Property = std::variant<int32_t, int64_t, std::string, bool>;
+// A property read in place: strings view the node's string table
+using PropertyView = std::variant<int32_t, int64_t, std::string_view, bool>;
 
 /**
  * Node in the Sea-of-Nodes IR.
+ *
+ * Nodes created through Graph::AddNode keep their inputs and properties in
+ * the graph's arena and their property strings in the graph's (possibly
+ * shared) string table, so a whole graph is freed in one shot. Standalone
+ * nodes use the default heap resource and a private string table.
  */
 class Node {
  public:
   Node(NodeID id, Opcode opcode);
+  Node(NodeID id, Opcode opcode, Arena* arena, StringInterner* strings);
+  ~Node();
+
+  Node(const Node&) = delete;
+  Node& operator=(const Node&) = delete;
 
   NodeID id() const { return id_; }
   Opcode opcode() const { return opcode_; }
 
+  // Dense position in the owning graph's nodes(), for per-node tables
+  // (see NodeTable); kNoIndex for standalone nodes
+  static constexpr uint32_t kNoIndex = UINT32_MAX;
+  uint32_t index() const { return index_; }
+
   // Inputs (edges)
   size_t num_inputs() const { return inputs_.size(); }
   Node* input(size_t i) const;
@@ -46,12 +67,15 @@ class Node {
   // Value inputs (skips control/memory based on schema)
   std::vector<Node*> value_inputs() const;
   size_t num_value_inputs() const;
+  // Index of the first input value_inputs() considers; the value inputs are
+  // the non-null inputs from there on (none if it is num_inputs())
+  size_t value_inputs_begin() const;
 
   // Schema-specific accessors
   Node* region_input() const;             // For Phi (S2) - returns input[0]
   std::vector<Node*> phi_values() const;  // For Phi (S2) - returns input[1..n]
   std::vector<Node*> region_preds()
-      const;  // For Region (S2) - returns all inputs
+      const;  // For Region/loop head (S2) - returns all inputs
 
   Node* address_input()
       const;  // For Load/Store (S3, S4) - returns address input
@@ -64,19 +88,57 @@ class Node {
   bool has_prop(const std::string& key) const;
   Property prop(const std::string& key) const;
   void set_prop(const std::string& key, Property value);
+  // Copy every property of `other` (re-interned into this node's table)
+  void CopyPropsFrom(const Node& other);
+
+  // Properties by position, in the order they were first set
+  size_t num_props() const { return props_.size(); }
+  std::string_view prop_key(size_t i) const { return props_[i].key.view(); }
+  PropertyView prop_value(size_t i) const;
+
+  // Interned handle of a string property (null if absent or not a string).
+  // Handles from graphs sharing a string table compare by identity.
+  InternedString interned_prop(const std::string& key) const;
+
+  // Pooled payload of a constant node (null if not decoded).
+  const Constant* constant() const { return constant_; }
+  void set_constant(const Constant* c) { constant_ = c; }
 
   // Type
   TypeStamp type() const { return type_; }
   void set_type(TypeStamp t) { type_ = t; }
 
+  // Storage of the input array and property slots, by capacity
+  size_t input_bytes() const { return inputs_.capacity() * sizeof(Node*); }
+  size_t prop_bytes() const { return props_.capacity() * sizeof(PropSlot); }
+
   // Debugging
   std::string ToString() const;
 
  private:
+  // String table owned by a standalone node.
+  struct StandaloneStorage;
+
+  // Property as stored: keys and strings are interned handles.
+  using StoredProperty = std::variant<int32_t, int64_t, InternedString, bool>;
+  struct PropSlot {
+    InternedString key;
+    StoredProperty value;
+  };
+
+  const PropSlot* FindProp(const std::string& key) const;
+
+  friend class Graph;  // Assigns index_
+
+  std::unique_ptr<StandaloneStorage> standalone_;  // Null for graph nodes
   NodeID id_;
+  uint32_t index_ = kNoIndex;
   Opcode opcode_;
-  std::vector<Node*> inputs_;
-  std::map<std::string, Property> props_;
+  std::pmr::vector<Node*> inputs_;
+  // Nodes carry a handful of properties; a flat vector beats a tree here.
+  std::pmr::vector<PropSlot> props_;
+  StringInterner* strings_;
+  const Constant* constant_ = nullptr;
   TypeStamp type_;
 };
 
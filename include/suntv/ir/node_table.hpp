@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "suntv/ir/node.hpp"
+
+namespace sun {
+
+/**
+ * Map from the nodes of one graph to T, indexed by Node::index().
+ *
+ * Meant for per-run state that is rebuilt many times over the same graph.
+ * Every slot carries the epoch it was written in and only counts as present
+ * while that is the table's epoch, so Clear() is one increment; the slots
+ * are kept, and a table that has seen every node never allocates again.
+ * Lookups of nodes outside the table's range find nothing; inserting a
+ * node without an index (a standalone node) throws.
+ */
+template <typename T>
+class NodeTable {
+ public:
+  // Drops every entry in O(1)
+  void Clear() {
+    if (++epoch_ == 0) {
+      // Wrapped: stale stamps could match again
+      for (Slot& slot : slots_) slot.epoch = 0;
+      epoch_ = 1;
+    }
+  }
+
+  // Sizes the table for nodes with index below n, so that inserting them
+  // does not allocate
+  void Reserve(size_t n) {
+    if (n > slots_.size()) slots_.resize(n);
+  }
+
+  bool contains(const Node* n) const { return find(n) != nullptr; }
+
+  const T* find(const Node* n) const {
+    const uint32_t i = n->index();
+    if (i >= slots_.size() || slots_[i].epoch != epoch_) return nullptr;
+    return &slots_[i].value;
+  }
+  T* find(const Node* n) {
+    return const_cast<T*>(static_cast<const NodeTable*>(this)->find(n));
+  }
+
+  // Entry of n, value-initialized if absent
+  T& operator[](const Node* n) {
+    Slot& slot = SlotOf(n);
+    if (slot.epoch != epoch_) {
+      slot.epoch = epoch_;
+      slot.value = T();
+    }
+    return slot.value;
+  }
+
+  // Adds n with `value`; false (and no change) if present
+  bool insert(const Node* n, const T& value) {
+    Slot& slot = SlotOf(n);
+    if (slot.epoch == epoch_) return false;
+    slot.epoch = epoch_;
+    slot.value = value;
+    return true;
+  }
+
+  void erase(const Node* n) {
+    const uint32_t i = n->index();
+    if (i < slots_.size() && slots_[i].epoch == epoch_) slots_[i].epoch = 0;
+  }
+
+  size_t bytes() const { return slots_.capacity() * sizeof(Slot); }
+
+ private:
+  struct Slot {
+    uint32_t epoch = 0;  // Never a live epoch
+    T value{};
+  };
+
+  Slot& SlotOf(const Node* n) {
+    const uint32_t i = n->index();
+    if (i == Node::kNoIndex) {
+      throw std::invalid_argument("NodeTable: node " + std::to_string(n->id()) +
+                                  " belongs to no graph");
+    }
+    if (i >= slots_.size()) slots_.resize(i + 1);
+    return slots_[i];
+  }
+
+  std::vector<Slot> slots_;
+  uint32_t epoch_ = 1;
+};
+
+/** Set of the nodes of one graph with O(1) Clear(); see NodeTable. */
+class NodeSet {
+ public:
+  void Clear() { table_.Clear(); }
+  void Reserve(size_t n) { table_.Reserve(n); }
+
+  bool contains(const Node* n) const { return table_.contains(n); }
+  // False if n was already present
+  bool insert(const Node* n) { return table_.insert(n, Empty()); }
+  void erase(const Node* n) { table_.erase(n); }
+
+  size_t bytes() const { return table_.bytes(); }
+
+ private:
+  struct Empty {};
+  NodeTable<Empty> table_;
+};
+
+}  // namespace sun
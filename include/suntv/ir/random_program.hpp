@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "suntv/ir/graph.hpp"
+
+namespace sun {
+
+struct RandomProgramOptions {
+  int max_params = 3;
+  int max_locals = 4;
+  int max_stmts = 8;  // Per block
+  int max_depth = 2;  // Nesting of ifs and loops
+  bool loops = true;
+  bool memory = true;      // Field and array loads/stores
+  bool exceptions = true;  // DivI/ModI, which throw on a zero divisor
+};
+
+/**
+ * A random structured int program, lowered to a well-formed graph.
+ *
+ * The program works on a fixed set of int variables: the parameters, then
+ * locals with constant initial values. Every variable is defined
+ * everywhere, so any statement can be dropped or simplified and the
+ * program stays well formed. That is what makes shrinking simple: a
+ * failing program is reduced by trying smaller variants (Shrinks) until
+ * none of them fails.
+ *
+ * Lowering (see GraphBuilder) turns assignments into data nodes, ifs into
+ * If/Region diamonds with Phis for the variables either branch assigns,
+ * and loops into a Region head with Phis for the loop-carried variables, a
+ * counter and an exit test at the bottom: `for (i = 0, n = (a & 7) + 1;
+ * i < n; i++)` runs 1 to 8 times. Memory statements only appear at the
+ * top level and thread one memory state through one object and one int[8]
+ * array, indexed with `& 7`.
+ */
+struct RandomProgram {
+  struct Operand {
+    int var = -1;       // Variable, or -1 for a constant
+    int32_t value = 0;  // The constant
+  };
+
+  enum class StmtKind {
+    kAssign,      // dst = a op b
+    kIf,          // if (a mask b) body else orelse
+    kLoop,        // for (i = 0, n = (a & 7) + 1; i < n; i++) body
+    kStoreField,  // o.f<field> = a
+    kLoadField,   // dst = o.f<field>
+    kStoreArray,  // arr[a & 7] = b
+    kLoadArray,   // dst = arr[a & 7]
+  };
+
+  struct Stmt {
+    StmtKind kind = StmtKind::kAssign;
+    int dst = 0;
+    Opcode op = Opcode::kAddI;  // kAssign
+    int32_t mask = 0;           // kIf: GraphBuilder::BoolMask
+    int field = 0;
+    Operand a;
+    Operand b;
+    std::vector<Stmt> body;    // kIf then-branch, kLoop body
+    std::vector<Stmt> orelse;  // kIf else-branch
+  };
+
+  int num_params = 0;
+  std::vector<int32_t> locals;  // Initial values; variables num_params..
+  std::vector<Stmt> body;
+  int result = 0;  // Returned local
+
+  int num_vars() const { return num_params + static_cast<int>(locals.size()); }
+
+  // Statements, counting nested ones
+  size_t size() const;
+
+  static RandomProgram Generate(uint64_t seed,
+                                const RandomProgramOptions& options = {});
+
+  // Graph with `num_params` int parameters that returns `result`
+  std::unique_ptr<Graph> Lower() const;
+
+  // Strictly simpler variants, most aggressive first: a statement removed,
+  // an if or loop replaced by its body, an operation made a copy, an
+  // operand made constant, a constant moved towards zero
+  std::vector<RandomProgram> Shrinks() const;
+
+  // Java-like source
+  std::string ToString() const;
+};
+
+}  // namespace sun
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sun {
+class Node;
+
+/**
+ * Basic-block schedule of a graph, as C2 dumps it in <controlFlow> after
+ * Global code motion: blocks with their successors, and the nodes of each
+ * block in execution order.
+ *
+ * Placement is indexed by Node::index(), so block_of() and position_of() are
+ * O(1); a node is in at most one block. Nodes outside the schedule (e.g.
+ * ones C2 left unscheduled) have no block.
+ */
+class Schedule {
+ public:
+  static constexpr uint32_t kNoBlock = UINT32_MAX;
+
+  struct Block {
+    int32_t name;                      // C2 block number
+    std::vector<uint32_t> successors;  // Indices into blocks()
+    std::vector<const Node*> nodes;    // In execution order
+  };
+
+  // Appends an empty block; returns its index
+  uint32_t AddBlock(int32_t name);
+  void AddSuccessor(uint32_t block, uint32_t successor);
+  // Appends n to the block; false (and no change) if n is already placed
+  bool Place(const Node* n, uint32_t block);
+
+  const std::vector<Block>& blocks() const { return blocks_; }
+  const Block& block(uint32_t i) const { return blocks_[i]; }
+  // Index of the block named `name`, or kNoBlock
+  uint32_t FindBlock(int32_t name) const;
+
+  // Block holding n, or kNoBlock
+  uint32_t block_of(const Node* n) const;
+  // Position of n within its block; only meaningful if n is placed
+  uint32_t position_of(const Node* n) const;
+
+  size_t bytes() const;
+
+ private:
+  struct Placement {
+    uint32_t block = kNoBlock;
+    uint32_t position = 0;
+  };
+
+  std::vector<Block> blocks_;
+  std::vector<Placement> placement_;  // By Node::index()
+};
+
+}  // namespace sun
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "suntv/ir/node.hpp"
+
+namespace sun {
+class Graph;
+
+/**
+ * Hashes of the nodes of a graph that depend on its structure but not on
+ * node IDs, so two phases of a compilation can be compared node by node.
+ *
+ * A node's hash mixes its opcode, the properties that carry its semantics
+ * (constant payload, "con", "index", "mask", "field", "array", "elem",
+ * "value", "type", "dump_spec", and "name" for Mach instructions) and the
+ * hashes of its inputs in order. One iterative depth-first pass from Root,
+ * O(nodes + edges): an edge to a node still on the stack (a loop back
+ * edge) contributes that node's own label and its depth on the stack, so
+ * loops hash the same in every graph that has them. Nodes not reachable
+ * from Root, which cannot affect a run, hash to 0.
+ *
+ * Graphs with equal graph() hashes have the same reachable structure up to
+ * hash collisions, and so compute the same function.
+ */
+class StructuralHashes {
+ public:
+  explicit StructuralHashes(const Graph& g);
+
+  // Hash of n, a node of the graph; 0 if unreachable from Root
+  uint64_t of(const Node* n) const;
+  // Hash of Root; 0 for a graph without one
+  uint64_t graph() const { return graph_; }
+  // Reachable nodes
+  size_t size() const { return sorted_.size(); }
+
+  // Reachable nodes of this graph whose hash has no counterpart among the
+  // reachable nodes of `before` (multiset difference): O(nodes)
+  size_t CountChanged(const StructuralHashes& before) const;
+
+  size_t bytes() const;
+
+ private:
+  std::vector<uint64_t> hashes_;  // By Node::index()
+  std::vector<uint64_t> sorted_;  // Hashes of reachable nodes, ascending
+  uint64_t graph_ = 0;
+};
+
+}  // namespace sun
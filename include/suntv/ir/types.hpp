@@ -13,6 +13,8 @@ enum class TypeKind {
   kTop,      // Top type (unknown)
   kInt32,    // int32
   kInt64,    // int64
+  kFloat,    // IEEE 754 binary32
+  kDouble,   // IEEE 754 binary64
   kBool,     // boolean
   kPtr,      // pointer/reference
   kControl,  // control token
@@ -29,6 +31,8 @@ class TypeStamp {
 
   bool IsInt32() const { return kind_ == TypeKind::kInt32; }
   bool IsInt64() const { return kind_ == TypeKind::kInt64; }
+  bool IsFloat() const { return kind_ == TypeKind::kFloat; }
+  bool IsDouble() const { return kind_ == TypeKind::kDouble; }
   bool IsBool() const { return kind_ == TypeKind::kBool; }
   bool IsPtr() const { return kind_ == TypeKind::kPtr; }
   bool IsControl() const { return kind_ == TypeKind::kControl; }
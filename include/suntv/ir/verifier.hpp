@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "suntv/ir/node.hpp"
+
+namespace sun {
+class Graph;
+
+/** One structural problem found by VerifyGraph. */
+struct GraphIssue {
+  enum class Kind {
+    kDanglingInput,       // Input is not a node of the graph
+    kArity,               // Fewer inputs than the schema or opcode needs
+    kPhiRegion,           // Phi without a Region, or arity disagreeing with it
+    kValueCycle,          // Data cycle that does not pass through a Phi
+    kUnreachableControl,  // Control node not reachable from Start
+  };
+
+  Kind kind;
+  NodeID node;  // Node the issue is reported at
+  std::string message;
+
+  // "<kind> at node <id>: <message>"
+  std::string ToString() const;
+};
+
+const char* GraphIssueKindName(GraphIssue::Kind kind);
+
+// Phi, control and unknown-opcode nodes: the only nodes VerifyGraph lets a
+// data cycle pass, so every cycle of a verified graph contains one
+bool MayCloseValueCycle(const Node* n);
+
+/**
+ * Structural checks of a Sea-of-Nodes graph, each O(nodes + edges):
+ *
+ * - every input is a node of g (null holes are allowed: C2 dumps have
+ *   them, and Phis and Regions are aligned across them);
+ * - every node has the inputs its schema needs (Node::ValidateInputs), and
+ *   binary, unary and conditional operators their value inputs;
+ * - every Phi merges at a Region, with as many inputs as the Region, or
+ *   one more when the Region has no self input;
+ * - data edges form no cycle that avoids a Phi (control and Phi nodes
+ *   break cycles, so loops and memory Phis are fine);
+ * - every control node is reachable from Start along control edges.
+ *
+ * Nodes of unknown opcode (e.g. Mach nodes) are only checked for dangling
+ * inputs. Issues come in node order within each check; an empty result
+ * means the graph is well-formed.
+ */
+std::vector<GraphIssue> VerifyGraph(const Graph& g);
+
+}  // namespace sun
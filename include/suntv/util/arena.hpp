@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace sun {
+
+/**
+ * Monotonic bump allocator.
+ *
+ * Memory is carved out of geometrically growing chunks and is only returned
+ * when the arena is released or destroyed; deallocate() is a no-op. The arena
+ * is a std::pmr::memory_resource, so std::pmr containers can draw their
+ * storage from it.
+ *
+ * Objects created with New<T>() are never destroyed by the arena. Only place
+ * objects in it whose own storage also lives in the arena (or that are
+ * trivially destructible), so dropping them without running destructors
+ * leaks nothing.
+ */
+class Arena : public std::pmr::memory_resource {
+ public:
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+  static constexpr size_t kMaxChunkSize = 1024 * 1024;
+
+  explicit Arena(size_t initial_chunk_size = kDefaultChunkSize);
+  ~Arena() override;
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Allocate raw storage (never nullptr; throws std::bad_alloc).
+  void* Allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+  // Construct a T in arena storage. The destructor is never run.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    void* mem = Allocate(sizeof(T), alignof(T));
+    return ::new (mem) T(std::forward<Args>(args)...);
+  }
+
+  // Copy a string into the arena. The view stays valid until Release().
+  std::string_view CopyString(std::string_view s);
+
+  // Free every chunk at once. All pointers handed out become invalid.
+  void Release();
+
+  // Bytes handed out to callers (including alignment padding).
+  size_t bytes_used() const { return bytes_used_; }
+  // Bytes obtained from the system allocator for chunks.
+  size_t bytes_reserved() const { return bytes_reserved_; }
+  size_t num_chunks() const { return num_chunks_; }
+
+ protected:
+  void* do_allocate(size_t bytes, size_t align) override;
+  void do_deallocate(void* /*p*/, size_t /*bytes*/,
+                     size_t /*align*/) override {}
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+ private:
+  struct Chunk {
+    Chunk* next;
+    size_t size;  // Usable bytes following the header
+  };
+
+  void* AllocateSlow(size_t bytes, size_t align);
+
+  Chunk* head_ = nullptr;
+  char* cursor_ = nullptr;
+  char* limit_ = nullptr;
+  size_t next_chunk_size_;
+  size_t initial_chunk_size_;
+  size_t bytes_used_ = 0;
+  size_t bytes_reserved_ = 0;
+  size_t num_chunks_ = 0;
+};
+
+}  // namespace sun
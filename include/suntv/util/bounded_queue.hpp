@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace sun {
+
+/**
+ * Bounded multi-producer multi-consumer queue.
+ *
+ * A ring of cells, each stamped with the position it may be written or read
+ * at next (Vyukov's bounded queue): TryPush and TryPop claim a position with
+ * one compare-and-swap and never take a lock. Push and Pop block instead of
+ * failing, which is the backpressure between pipeline stages: a producer
+ * waits while the queue is full, a consumer while it is empty. Blocked
+ * threads sleep on an atomic counter (std::atomic::wait) rather than spin,
+ * so idle stages leave their cores to the busy ones.
+ *
+ * Close() ends the stream: Pop drains what is left, then returns false.
+ * Pushing after Close() is not allowed.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  // Capacity is rounded up to a power of two
+  explicit BoundedQueue(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity) n *= 2;
+    mask_ = n - 1;
+    cells_ = std::make_unique<Cell[]>(n);
+    for (size_t i = 0; i < n; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  bool TryPush(T& value) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      const size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // Full
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    Signal(pushed_);
+    return true;
+  }
+
+  bool TryPop(T& out) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      const size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // Empty
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    out = std::move(cell->value);
+    cell->value = T();
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    Signal(popped_);
+    return true;
+  }
+
+  // Blocks while the queue is full
+  void Push(T value) {
+    for (;;) {
+      const uint32_t seen = popped_.load(std::memory_order_acquire);
+      if (TryPush(value)) return;
+      popped_.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+  // Blocks while the queue is empty and open; false once closed and empty
+  bool Pop(T& out) {
+    for (;;) {
+      const uint32_t seen = pushed_.load(std::memory_order_acquire);
+      if (TryPop(out)) return true;
+      if (closed_.load(std::memory_order_acquire)) return TryPop(out);
+      pushed_.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+  void Close() {
+    closed_.store(true, std::memory_order_release);
+    pushed_.fetch_add(1, std::memory_order_release);
+    pushed_.notify_all();
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static void Signal(std::atomic<uint32_t>& counter) {
+    counter.fetch_add(1, std::memory_order_release);
+    counter.notify_one();
+  }
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_ = 0;
+  // Producers and consumers each get their own cache line
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<uint32_t> pushed_{0};  // Wakes consumers
+  alignas(64) std::atomic<uint32_t> popped_{0};  // Wakes producers
+  std::atomic<bool> closed_{false};
+};
+
+}  // namespace sun
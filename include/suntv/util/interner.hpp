@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "suntv/util/arena.hpp"
+
+namespace sun {
+
+/**
+ * Handle to a string stored once in a StringInterner.
+ *
+ * Handles from the same interner compare equal iff the strings are equal, so
+ * equality is a pointer comparison. A default-constructed handle is null.
+ */
+class InternedString {
+ public:
+  InternedString() = default;
+
+  std::string_view view() const {
+    return entry_ ? std::string_view(entry_->data, entry_->size)
+                  : std::string_view();
+  }
+  // Dense ID in interning order (0-based); only meaningful when non-null.
+  uint32_t id() const { return entry_ ? entry_->id : UINT32_MAX; }
+
+  explicit operator bool() const { return entry_ != nullptr; }
+  bool operator==(InternedString other) const {
+    return entry_ == other.entry_;
+  }
+  bool operator!=(InternedString other) const {
+    return entry_ != other.entry_;
+  }
+
+ private:
+  friend class StringInterner;
+  friend struct std::hash<InternedString>;
+
+  struct Entry {
+    const char* data;
+    uint32_t size;
+    uint32_t id;
+  };
+
+  explicit InternedString(const Entry* e) : entry_(e) {}
+
+  const Entry* entry_ = nullptr;
+};
+
+/**
+ * Deduplicating string table. Strings and bookkeeping live in the given
+ * arena and stay valid for the arena's lifetime. Not thread-safe.
+ */
+class StringInterner {
+ public:
+  explicit StringInterner(Arena& arena);
+
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  // Return the handle for s, storing it on first sight.
+  InternedString Intern(std::string_view s);
+
+  // Return the handle for s if it has been interned, otherwise null.
+  InternedString Find(std::string_view s) const;
+
+  // Handle for a previously returned id().
+  InternedString Lookup(uint32_t id) const;
+
+  size_t size() const { return by_id_.size(); }
+
+ private:
+  Arena& arena_;
+  std::pmr::unordered_map<std::string_view, const InternedString::Entry*>
+      table_;
+  std::pmr::vector<const InternedString::Entry*> by_id_;
+};
+
+}  // namespace sun
+
+template <>
+struct std::hash<sun::InternedString> {
+  size_t operator()(sun::InternedString s) const noexcept {
+    return std::hash<const void*>()(s.entry_);
+  }
+};
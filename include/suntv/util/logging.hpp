@@ -1,16 +1,93 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <type_traits>
 
 namespace sun {
 
 enum class LogLevel { TRACE, DEBUG, INFO, WARN, ERROR };
 
+/** One log line with its structured fields. */
+struct LogRecord {
+  uint64_t time_ns = 0;  // Since the logger started
+  LogLevel level = LogLevel::INFO;
+  uint32_t thread = 0;  // Dense index, in order of each thread's first log
+  std::string graph;    // LogContext of the logging thread, if any
+  int64_t node = -1;
+  std::string message;
+};
+
+/** Destination of log records. Only ever called from the writer thread. */
+class LogSink {
+ public:
+  virtual ~LogSink() = default;
+  virtual void Write(const LogRecord& record) = 0;
+  virtual void Flush() {}
+};
+
+/**
+ * "[INFO] message", with "[t<thread> <graph> #<node>] " after the level
+ * when the record has context or comes from a thread other than the
+ * first one to log.
+ */
+class TextLogSink : public LogSink {
+ public:
+  explicit TextLogSink(std::ostream& out) : out_(out) {}
+  void Write(const LogRecord& record) override;
+  void Flush() override { out_.flush(); }
+
+ private:
+  std::ostream& out_;
+};
+
+/**
+ * Length-prefixed records in host byte order: u32 length of the rest,
+ * u64 time, u8 level, u32 thread, i64 node, then graph and message as u32
+ * length plus bytes. Cheaper to write than text; Read decodes.
+ */
+class BinaryLogSink : public LogSink {
+ public:
+  explicit BinaryLogSink(std::ostream& out) : out_(out) {}
+  void Write(const LogRecord& record) override;
+  void Flush() override { out_.flush(); }
+
+  // Next record, or nullopt at end of input or on a truncated record
+  static std::optional<LogRecord> Read(std::istream& in);
+
+ private:
+  std::ostream& out_;
+};
+
+/**
+ * Process-wide logger.
+ *
+ * Logging never blocks on output. Records below the level are dropped
+ * with a single relaxed load. The rest are appended to a buffer owned by
+ * the calling thread, which is handed to a background writer through a
+ * lock-free multi-producer queue when it fills up, when a WARN or ERROR
+ * is logged, on Flush, and when the thread exits. The writer passes
+ * records to the sink in per-thread order; lines of different threads
+ * never interleave mid-line. ERROR also waits until its record is
+ * written, so it is out before a crash. The writer thread starts with
+ * the first record that passes the level.
+ */
 class Logger {
  public:
   static void SetLevel(LogLevel level);
   static LogLevel GetLevel();
+  static bool Enabled(LogLevel level) { return level >= GetLevel(); }
+
+  // Replaces the sink after writing everything logged so far. nullptr
+  // restores the default, text to std::cerr.
+  static void SetSink(std::unique_ptr<LogSink> sink);
+
+  // Writes the calling thread's records, and every record handed to the
+  // writer before, to the sink
+  static void Flush();
 
   static void Trace(const std::string& msg);
   static void Debug(const std::string& msg);
@@ -18,10 +95,80 @@ class Logger {
   static void Warn(const std::string& msg);
   static void Error(const std::string& msg);
 
+  // The concatenation of `parts` (strings and numbers), built only if the
+  // level is enabled, so a dropped record costs no allocation:
+  //   Logger::Info("node ", n->id(), " (", OpcodeName(op), ")");
+  template <typename... Parts>
+  static void Trace(const Parts&... parts) {
+    LogParts(LogLevel::TRACE, parts...);
+  }
+  template <typename... Parts>
+  static void Debug(const Parts&... parts) {
+    LogParts(LogLevel::DEBUG, parts...);
+  }
+  template <typename... Parts>
+  static void Info(const Parts&... parts) {
+    LogParts(LogLevel::INFO, parts...);
+  }
+  template <typename... Parts>
+  static void Warn(const Parts&... parts) {
+    LogParts(LogLevel::WARN, parts...);
+  }
+  template <typename... Parts>
+  static void Error(const Parts&... parts) {
+    LogParts(LogLevel::ERROR, parts...);
+  }
+
+ private:
+  static void Log(LogLevel level, const std::string& msg);
+
+  template <typename... Parts>
+  static void LogParts(LogLevel level, const Parts&... parts) {
+    if (!Enabled(level)) return;
+    std::string msg;
+    (AppendPart(msg, parts), ...);
+    Log(level, msg);
+  }
+
+  template <typename T>
+  static void AppendPart(std::string& out, const T& part) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      out += std::to_string(part);
+    } else {
+      out += part;
+    }
+  }
+};
+
+/**
+ * Sets the graph and node fields of records logged by the calling thread
+ * until it goes out of scope, then restores the previous ones. Scopes
+ * nest; -1 means no node.
+ */
+class LogContext {
+ public:
+  explicit LogContext(std::string graph, int64_t node = -1);
+  ~LogContext();
+
+  LogContext(const LogContext&) = delete;
+  LogContext& operator=(const LogContext&) = delete;
+
+  /** Sets only the node field, e.g. per evaluated node. */
+  class Node {
+   public:
+    explicit Node(int64_t node);
+    ~Node();
+
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+
+   private:
+    int64_t saved_;
+  };
+
  private:
-  static LogLevel level_;
-  static void Log(LogLevel level, const std::string& prefix,
-                  const std::string& msg);
+  std::string saved_graph_;
+  int64_t saved_node_;
 };
 
 }  // namespace sun
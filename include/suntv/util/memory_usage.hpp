@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sun {
+
+/**
+ * Helpers for byte accounting of standard containers.
+ *
+ * The figures are what the containers asked the allocator for, following
+ * the libstdc++ layouts: a std::map/std::set node is a red-black header
+ * (color and three links) followed by the value, a std::vector holds
+ * capacity() elements, and a std::string spills to the heap beyond its
+ * 15-byte inline buffer. Allocator rounding is not included.
+ */
+namespace memory {
+
+constexpr size_t kTreeNodeHeader = 4 * sizeof(void*);
+constexpr size_t kStringInlineCapacity = 15;
+
+// One node of a std::map or std::set
+template <typename Tree>
+constexpr size_t TreeNodeBytes() {
+  return kTreeNodeHeader + sizeof(typename Tree::value_type);
+}
+
+template <typename Tree>
+size_t TreeBytes(const Tree& tree) {
+  return tree.size() * TreeNodeBytes<Tree>();
+}
+
+template <typename T>
+size_t VectorBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+inline size_t StringBytes(const std::string& s) {
+  return s.capacity() > kStringInlineCapacity ? s.capacity() + 1 : 0;
+}
+
+}  // namespace memory
+
+/** A soft memory limit was hit; the operation that would exceed it failed. */
+class MemoryLimitExceeded : public std::runtime_error {
+ public:
+  explicit MemoryLimitExceeded(const std::string& msg)
+      : std::runtime_error(msg) {}
+};
+
+}  // namespace sun
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sun {
+
+/**
+ * splitmix64: a tiny seedable generator for test-case generation.
+ *
+ * Every output is a bijective mix of the seed and the call count, so two
+ * generators seeded differently never share a sequence and a seed alone
+ * reproduces a run.
+ */
+class SplitMix64 {
+ public:
+  explicit SplitMix64(uint64_t seed) : state_(seed) {}
+
+  uint64_t Next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, n), n > 0 (modulo bias is irrelevant here)
+  uint64_t Below(uint64_t n) { return Next() % n; }
+
+  // True with probability num/den
+  bool Chance(uint64_t num, uint64_t den) { return Below(den) < num; }
+
+ private:
+  uint64_t state_;
+};
+
+}  // namespace sun
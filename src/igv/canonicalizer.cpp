@@ -3,6 +3,7 @@
 #include "suntv/ir/graph.hpp"
 #include "suntv/ir/node.hpp"
 #include "suntv/ir/opcode.hpp"
+#include "suntv/ir/verifier.hpp"
 #include "suntv/util/logging.hpp"
 
 namespace sun {
@@ -28,15 +29,26 @@ bool Canonicalizer::ValidateWellFormed(Graph* g, std::string& error) {
     return false;
   }
 
-  // Future validations:
-  // - Check acyclicity (except for Region/Phi)
-  // - Validate Phi nodes correspond to Region nodes
-  // - Check that all nodes are reachable from Start
-  // - Verify edge consistency (input count matches opcode requirements)
+  // Structural issues are reported but not fatal: C2 dumps of late phases
+  // (e.g. Mach graphs) are still worth loading for inspection, and the
+  // interpreter rejects what it cannot execute
+  ReportStructuralIssues(g);
 
   return true;
 }
 
+void Canonicalizer::ReportStructuralIssues(const Graph* g) {
+  const std::vector<GraphIssue> issues = VerifyGraph(*g);
+  if (issues.empty()) {
+    return;
+  }
+  for (const GraphIssue& issue : issues) {
+    Logger::Info("Graph check: ", issue.ToString());
+  }
+  Logger::Warn("Graph has ", issues.size(), " structural issue(s), first: ",
+               issues.front().ToString());
+}
+
 bool Canonicalizer::CheckSingleStartRoot(Graph* g, std::string& error) {
   Node* start_node = nullptr;
   Node* root_node = nullptr;
@@ -0,0 +1,454 @@
+#include "suntv/igv/graph_store.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/graph_codec.hpp"
+#include "suntv/ir/structural_hash.hpp"
+#include "suntv/util/logging.hpp"
+
+namespace sun {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kPackMagic[] = {'S', 'U', 'N', 'P', 1};
+constexpr char kIndexMagic[] = {'S', 'U', 'N', 'X', 1};
+constexpr size_t kIndexEntryBytes = 20;  // Key, offset, size
+constexpr const char* kCompilations = "compilations";
+
+void PutLE(std::string& out, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; ++i) out.push_back(static_cast<char>(v >> 8 * i));
+}
+
+uint64_t GetLE(const char* p, int bytes) {
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i) {
+    v |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << 8 * i;
+  }
+  return v;
+}
+
+void PutString(std::string& out, std::string_view s) {
+  uint64_t n = s.size();
+  while (n >= 0x80) {
+    out.push_back(static_cast<char>(n | 0x80));
+    n >>= 7;
+  }
+  out.push_back(static_cast<char>(n));
+  out.append(s);
+}
+
+// A length-prefixed string of a record; false if it overruns
+bool GetString(std::string_view& in, std::string_view* s) {
+  uint64_t n = 0;
+  for (int shift = 0; !in.empty() && shift < 64; shift += 7) {
+    const uint8_t b = static_cast<uint8_t>(in[0]);
+    in.remove_prefix(1);
+    n |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if (b & 0x80) continue;
+    if (n > in.size()) return false;
+    *s = in.substr(0, n);
+    in.remove_prefix(n);
+    return true;
+  }
+  return false;
+}
+
+// A record: the method and phase the graph was first seen as, then its
+// encoding
+StoredGraph ParseRecord(uint64_t key, std::string_view record,
+                        const std::string& pack) {
+  StoredGraph g;
+  g.key = key;
+  if (!GetString(record, &g.method) || !GetString(record, &g.name)) {
+    throw std::runtime_error("corrupt record in '" + pack + "'");
+  }
+  g.bytes = record;
+  return g;
+}
+
+std::string PackPath(const std::string& dir, uint32_t number,
+                     const char* extension) {
+  char name[32];
+  snprintf(name, sizeof(name), "pack-%06u.%s", number, extension);
+  return (fs::path(dir) / name).string();
+}
+
+// Number of a "pack-NNNNNN.pack" file name, or 0
+uint32_t PackNumber(const std::string& name) {
+  unsigned number = 0;
+  int end = 0;
+  if (sscanf(name.c_str(), "pack-%u.pack%n", &number, &end) != 1 ||
+      static_cast<size_t>(end) != name.size()) {
+    return 0;
+  }
+  return number;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) throw std::runtime_error("cannot read '" + path + "'");
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+GraphStore::GraphStore(std::string dir, size_t pack_bytes)
+    : dir_(std::move(dir)), pack_bytes_(pack_bytes) {
+  std::error_code ec;
+  fs::create_directories(dir_, ec);
+  if (!fs::is_directory(dir_)) {
+    throw std::runtime_error("cannot create store '" + dir_ + "'");
+  }
+
+  std::vector<uint32_t> numbers;
+  for (const auto& file : fs::directory_iterator(dir_)) {
+    const uint32_t number = PackNumber(file.path().filename().string());
+    if (number == 0) continue;
+    numbers.push_back(number);
+    next_pack_ = std::max(next_pack_, number + 1);
+  }
+  std::sort(numbers.begin(), numbers.end());
+  for (uint32_t number : numbers) {
+    if (fs::exists(PackPath(dir_, number, "idx"))) ReadIndex(number);
+  }
+  // Keep the first pack's copy should two writers have stored a key twice
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry& a, const Entry& b) {
+                     return a.key < b.key;
+                   });
+  entries_.erase(std::unique(entries_.begin(), entries_.end(),
+                             [](const Entry& a, const Entry& b) {
+                               return a.key == b.key;
+                             }),
+                 entries_.end());
+  ReadCompilations();
+}
+
+GraphStore::~GraphStore() {
+  try {
+    Flush();
+  } catch (const std::exception& e) {
+    Logger::Error("Graph store '" + dir_ + "': " + e.what());
+  }
+}
+
+void GraphStore::ReadIndex(uint32_t number) {
+  const std::string path = PackPath(dir_, number, "idx");
+  const std::string index = ReadFile(path);
+  const size_t header = sizeof(kIndexMagic) + 8;
+  if (index.size() < header ||
+      index.compare(0, sizeof(kIndexMagic), kIndexMagic,
+                    sizeof(kIndexMagic)) != 0) {
+    throw std::runtime_error("'" + path + "' is not a pack index");
+  }
+  const uint64_t count = GetLE(index.data() + sizeof(kIndexMagic), 8);
+  if ((index.size() - header) / kIndexEntryBytes != count ||
+      (index.size() - header) % kIndexEntryBytes != 0) {
+    throw std::runtime_error("'" + path + "' is truncated");
+  }
+  const std::string pack = PackPath(dir_, number, "pack");
+  const auto pack_index = static_cast<uint32_t>(packs_.size());
+  for (uint64_t i = 0; i < count; ++i) {
+    const char* p = index.data() + header + i * kIndexEntryBytes;
+    entries_.push_back(Entry{GetLE(p, 8), pack_index,
+                             static_cast<uint32_t>(GetLE(p + 16, 4)),
+                             GetLE(p + 8, 8)});
+  }
+  packs_.push_back(pack);
+  bytes_ += index.size() + fs::file_size(pack);
+}
+
+void GraphStore::ReadCompilations() {
+  const fs::path path = fs::path(dir_) / kCompilations;
+  std::ifstream in(path);
+  if (!in) return;
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t tab = line.find('\t');
+    if (tab == std::string::npos) continue;
+    if (line.compare(0, tab, "compilation") == 0) {
+      const size_t source = line.find('\t', tab + 1);
+      StoredCompilation& c = compilations_.emplace_back();
+      c.method = line.substr(tab + 1, source - tab - 1);
+      if (source != std::string::npos) c.source = line.substr(source + 1);
+      continue;
+    }
+    std::optional<uint64_t> key;
+    if (tab == 16 && !compilations_.empty()) {
+      key = std::strtoull(line.substr(0, tab).c_str(), nullptr, 16);
+    }
+    if (!key) {
+      throw std::runtime_error("malformed line in '" + path.string() +
+                               "': " + line);
+    }
+    compilations_.back().phases.push_back({line.substr(tab + 1), *key});
+  }
+  for (const StoredCompilation& c : compilations_) {
+    signatures_.insert(Signature(c));
+  }
+}
+
+bool GraphStore::IsStore(const std::string& dir) {
+  std::error_code ec;
+  if (!fs::is_directory(dir, ec)) return false;
+  if (fs::exists(fs::path(dir) / kCompilations, ec)) return true;
+  for (const auto& file : fs::directory_iterator(dir, ec)) {
+    if (file.path().extension() == ".idx") return true;
+  }
+  return false;
+}
+
+uint64_t GraphStore::Key(const Graph& g) {
+  return StructuralHashes(g).graph();
+}
+
+std::string GraphStore::KeyString(uint64_t key) {
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%016" PRIx64, key);
+  return hex;
+}
+
+bool GraphStore::Contains(uint64_t key) const {
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), key,
+      [](const Entry& e, uint64_t k) { return e.key < k; });
+  return (it != entries_.end() && it->key == key) ||
+         pending_keys_.count(key) != 0;
+}
+
+std::optional<uint64_t> GraphStore::Resolve(std::string_view prefix) const {
+  if (prefix.empty() || prefix.size() > 16 ||
+      prefix.find_first_not_of("0123456789abcdefABCDEF") !=
+          std::string_view::npos) {
+    return std::nullopt;
+  }
+  const int shift = 4 * static_cast<int>(16 - prefix.size());
+  const uint64_t low =
+      std::strtoull(std::string(prefix).c_str(), nullptr, 16) << shift;
+  const uint64_t high = low | (shift == 0 ? 0 : ~uint64_t{0} >> (64 - shift));
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), low,
+      [](const Entry& e, uint64_t k) { return e.key < k; });
+  if (it == entries_.end() || it->key > high) return std::nullopt;
+  if (it + 1 != entries_.end() && (it + 1)->key <= high) return std::nullopt;
+  return it->key;
+}
+
+std::unique_ptr<Graph> GraphStore::Load(uint64_t key, StringInterner* strings,
+                                        ConstantPool* constants) const {
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), key,
+      [](const Entry& e, uint64_t k) { return e.key < k; });
+  if (it == entries_.end() || it->key != key) return nullptr;
+  const std::string& pack = packs_[it->pack];
+  std::ifstream in(pack, std::ios::binary);
+  std::string record(it->size, '\0');
+  in.seekg(static_cast<std::streamoff>(it->offset));
+  if (!in.read(record.data(), it->size)) {
+    throw std::runtime_error("cannot read '" + pack + "'");
+  }
+  return DecodeGraph(ParseRecord(key, record, pack).bytes, strings,
+                     constants);
+}
+
+bool GraphStore::Scan(
+    const std::function<bool(const StoredGraph&)>& visit) const {
+  std::vector<const Entry*> order;
+  order.reserve(entries_.size());
+  for (const Entry& e : entries_) order.push_back(&e);
+  std::sort(order.begin(), order.end(), [](const Entry* a, const Entry* b) {
+    return a->pack != b->pack ? a->pack < b->pack : a->offset < b->offset;
+  });
+
+  std::ifstream in;
+  uint32_t open = UINT32_MAX;
+  std::string record;
+  for (const Entry* e : order) {
+    const std::string& pack = packs_[e->pack];
+    if (e->pack != open) {
+      in = std::ifstream(pack, std::ios::binary);
+      open = e->pack;
+    }
+    // Records are back to back, so this only seeks past dropped ones
+    if (in.tellg() != static_cast<std::streamoff>(e->offset)) {
+      in.seekg(static_cast<std::streamoff>(e->offset));
+    }
+    record.resize(e->size);
+    if (!in.read(record.data(), e->size)) {
+      throw std::runtime_error("cannot read '" + pack + "'");
+    }
+    if (!visit(ParseRecord(e->key, record, pack))) return false;
+  }
+  return true;
+}
+
+bool GraphStore::Add(uint64_t key, std::string_view method,
+                     std::string_view name, std::string_view bytes) {
+  if (Contains(key)) return false;
+  if (!out_.is_open()) {
+    out_path_ = PackPath(dir_, next_pack_, "pack");
+    out_.open(out_path_, std::ios::binary | std::ios::trunc);
+    out_.write(kPackMagic, sizeof(kPackMagic));
+    out_size_ = sizeof(kPackMagic);
+  }
+  std::string record;
+  record.reserve(method.size() + name.size() + bytes.size() + 8);
+  PutString(record, method);
+  PutString(record, name);
+  record.append(bytes);
+  if (record.size() > UINT32_MAX) {
+    throw std::runtime_error("graph too large to store");
+  }
+  out_.write(record.data(), static_cast<std::streamsize>(record.size()));
+  if (!out_) throw std::runtime_error("cannot write '" + out_path_ + "'");
+  pending_.push_back(Entry{key, static_cast<uint32_t>(packs_.size()),
+                           static_cast<uint32_t>(record.size()), out_size_});
+  pending_keys_.insert(key);
+  out_size_ += record.size();
+  if (out_size_ >= pack_bytes_) Seal();
+  return true;
+}
+
+bool GraphStore::Add(const Graph& g, std::string_view method,
+                     std::string_view name) {
+  const uint64_t key = Key(g);
+  if (key == 0 || Contains(key)) return false;
+  return Add(key, method, name, EncodeGraph(g));
+}
+
+std::string GraphStore::Signature(const StoredCompilation& compilation) {
+  std::string signature = compilation.method + "\t" + compilation.source;
+  for (const StoredPhase& p : compilation.phases) {
+    signature += "\t" + KeyString(p.key) + p.name;
+  }
+  return signature;
+}
+
+bool GraphStore::AddCompilation(StoredCompilation compilation) {
+  if (!signatures_.insert(Signature(compilation)).second) return false;
+  pending_compilations_.push_back(std::move(compilation));
+  return true;
+}
+
+void GraphStore::Seal() {
+  if (!out_.is_open()) return;
+  out_.close();
+  if (!out_) throw std::runtime_error("cannot write '" + out_path_ + "'");
+
+  std::sort(pending_.begin(), pending_.end(),
+            [](const Entry& a, const Entry& b) { return a.key < b.key; });
+  std::string index(kIndexMagic, sizeof(kIndexMagic));
+  PutLE(index, pending_.size(), 8);
+  for (const Entry& e : pending_) {
+    PutLE(index, e.key, 8);
+    PutLE(index, e.offset, 8);
+    PutLE(index, e.size, 4);
+  }
+  const std::string path = PackPath(dir_, next_pack_, "idx");
+  const std::string temp = path + ".tmp";
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out.write(index.data(), static_cast<std::streamsize>(index.size()));
+    if (!out) throw std::runtime_error("cannot write '" + temp + "'");
+  }
+  fs::rename(temp, path);
+
+  packs_.push_back(out_path_);
+  const auto middle = static_cast<std::ptrdiff_t>(entries_.size());
+  entries_.insert(entries_.end(), pending_.begin(), pending_.end());
+  std::inplace_merge(
+      entries_.begin(), entries_.begin() + middle, entries_.end(),
+      [](const Entry& a, const Entry& b) { return a.key < b.key; });
+  bytes_ += out_size_ + index.size();
+  ++next_pack_;
+  pending_.clear();
+  pending_keys_.clear();
+}
+
+void GraphStore::Flush() {
+  Seal();
+  if (pending_compilations_.empty()) return;
+  const std::string path = (fs::path(dir_) / kCompilations).string();
+  std::string text;
+  for (const StoredCompilation& c : pending_compilations_) {
+    text += "compilation\t" + c.method + "\t" + c.source + "\n";
+    for (const StoredPhase& p : c.phases) {
+      text += KeyString(p.key) + "\t" + p.name + "\n";
+    }
+  }
+  std::ofstream out(path, std::ios::app);
+  out << text;
+  if (!out) throw std::runtime_error("cannot write '" + path + "'");
+  for (StoredCompilation& c : pending_compilations_) {
+    compilations_.push_back(std::move(c));
+  }
+  pending_compilations_.clear();
+}
+
+StoreImportStats GraphStore::Import(const std::vector<std::string>& paths,
+                                    const PipelineOptions& options) {
+  StoreImportStats stats;
+  auto execute = [](PipelineGraph& g, size_t) {
+    g.key = Key(*g.graph);
+    if (g.key == 0) throw std::runtime_error("graph has no Root");
+    g.output = EncodeGraph(*g.graph);
+  };
+
+  // A new <group> starts a compilation: another file or method, or an
+  // index that does not go up
+  std::optional<StoredCompilation> compilation;
+  std::exception_ptr failure;
+  size_t file = 0;
+  size_t index = 0;
+  auto finish = [&] {
+    if (compilation && !compilation->phases.empty() &&
+        AddCompilation(std::move(*compilation))) {
+      ++stats.compilations;
+    }
+    compilation.reset();
+  };
+  auto write = [&](const PipelineGraph& g) {
+    if (!compilation || g.file != file || g.method != compilation->method ||
+        g.index <= index) {
+      finish();
+      compilation = StoredCompilation{g.method, paths[g.file], {}};
+    }
+    file = g.file;
+    index = g.index;
+    if (!g.error.empty()) {
+      ++stats.rejected;
+      return;
+    }
+    if (failure) return;
+    try {
+      if (Add(g.key, g.method, g.name, g.output)) {
+        ++stats.added;
+      } else {
+        ++stats.duplicates;
+      }
+    } catch (const std::exception&) {
+      failure = std::current_exception();  // Rethrown once the pools stop
+      return;
+    }
+    compilation->phases.push_back({g.name, g.key});
+  };
+
+  stats.pipeline = IGVPipeline::Run(paths, execute, write, options);
+  if (failure) std::rethrow_exception(failure);
+  finish();
+  Flush();
+  return stats;
+}
+
+}  // namespace sun
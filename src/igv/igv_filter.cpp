@@ -0,0 +1,282 @@
+#include "suntv/igv/igv_filter.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string_view>
+
+#include "suntv/igv/igv_stream.hpp"
+#include "suntv/util/logging.hpp"
+
+namespace sun {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kDocHeader[] = "<?xml version=\"1.0\"?>\n<graphDocument>\n";
+constexpr char kDocFooter[] = "</graphDocument>\n";
+constexpr char kGroupFooter[] = "</group>\n";
+constexpr size_t kMaxFileStem = 96;
+
+std::string_view Trim(std::string_view s) {
+  size_t b = s.find_first_not_of(" \t\n\r");
+  if (b == std::string_view::npos) return {};
+  size_t e = s.find_last_not_of(" \t\n\r");
+  return s.substr(b, e - b + 1);
+}
+
+std::string SanitizeFileStem(const std::string& name) {
+  std::string out;
+  for (char c : name) {
+    bool keep = std::isalnum(static_cast<unsigned char>(c)) || c == '.' ||
+                c == '-';
+    if (keep) {
+      out += c;
+    } else if (out.empty() || out.back() != '_') {
+      out += '_';
+    }
+    if (out.size() >= kMaxFileStem) break;
+  }
+  return out.empty() ? "group" : out;
+}
+
+struct Output {
+  std::string path;
+  std::ofstream out;
+  bool group_open = false;
+};
+
+/**
+ * Copies selected graphs, wrapped in their group header, to a single output
+ * or to one output per group.
+ */
+class FilterVisitor : public IGVStreamReader::Visitor {
+ public:
+  // Empty split_dir selects single-file mode with output_path
+  FilterVisitor(const IGVFilterSpec& spec, std::string output_path,
+                std::string split_dir, IGVFilterStats* stats)
+      : spec_(spec),
+        output_path_(std::move(output_path)),
+        split_dir_(std::move(split_dir)),
+        stats_(stats) {}
+
+  bool Open() {
+    if (split_dir_.empty()) {
+      single_ = OpenOutput(output_path_);
+      return single_ != nullptr;
+    }
+    std::error_code ec;
+    fs::create_directories(split_dir_, ec);
+    if (ec) {
+      Logger::Error("Failed to create output directory: " + split_dir_);
+      return false;
+    }
+    return true;
+  }
+
+  bool Close() {
+    bool ok = true;
+    if (split_) ok = CloseOutput(split_.get()) && ok;
+    if (single_) ok = CloseOutput(single_.get()) && ok;
+    split_.reset();
+    single_.reset();
+    return ok;
+  }
+
+  bool SelectGraph(const IGVGraphRef& ref) override {
+    return spec_.Matches(ref.method, ref.name, ref.index);
+  }
+
+  bool OnGraph(const IGVGraphRef& ref, std::string_view bytes) override {
+    Output* out = OutputForGroup(ref);
+    if (!out) return false;
+    out->out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    out->out << "\n";
+    ++stats_->graphs_written;
+    return true;
+  }
+
+  bool OnGroupEnd(size_t group_ordinal) override {
+    (void)group_ordinal;
+    Output* out = single_ ? single_.get() : split_.get();
+    if (out && out->group_open) {
+      out->out << kGroupFooter;
+      out->group_open = false;
+    }
+    if (split_) {
+      bool ok = CloseOutput(split_.get());
+      split_.reset();
+      return ok;
+    }
+    return true;
+  }
+
+ private:
+  // Output receiving the current group, opening it (and writing the group
+  // header) on the group's first matching graph.
+  Output* OutputForGroup(const IGVGraphRef& ref) {
+    Output* out = single_.get();
+    if (!out) {
+      if (!split_) {
+        std::string stem = std::to_string(ref.group_ordinal);
+        stem.insert(0, stem.size() < 4 ? 4 - stem.size() : 0, '0');
+        fs::path path = fs::path(split_dir_) /
+                        (stem + "-" + SanitizeFileStem(ref.method) + ".xml");
+        split_ = OpenOutput(path.string());
+        if (!split_) return nullptr;
+      }
+      out = split_.get();
+    }
+    if (!out->group_open) {
+      out->out.write(ref.group_header.data(),
+                     static_cast<std::streamsize>(ref.group_header.size()));
+      out->group_open = true;
+    }
+    return out;
+  }
+
+  std::unique_ptr<Output> OpenOutput(const std::string& path) {
+    auto out = std::make_unique<Output>();
+    out->path = path;
+    out->out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out->out) {
+      Logger::Error("Failed to open output file: " + path);
+      return nullptr;
+    }
+    out->out << kDocHeader;
+    stats_->outputs.push_back(path);
+    return out;
+  }
+
+  bool CloseOutput(Output* out) {
+    if (out->group_open) {
+      out->out << kGroupFooter;
+      out->group_open = false;
+    }
+    out->out << kDocFooter;
+    out->out.close();
+    if (!out->out) {
+      Logger::Error("Failed to write output file: " + out->path);
+      return false;
+    }
+    return true;
+  }
+
+  const IGVFilterSpec& spec_;
+  std::string output_path_;
+  std::string split_dir_;
+  IGVFilterStats* stats_;
+  std::unique_ptr<Output> single_;
+  std::unique_ptr<Output> split_;
+};
+
+bool RunFilter(const std::string& input_path, const IGVFilterSpec& spec,
+               const std::string& output_path, const std::string& split_dir,
+               IGVFilterStats* stats) {
+  IGVFilterStats local;
+  if (!stats) stats = &local;
+  *stats = IGVFilterStats();
+
+  FilterVisitor visitor(spec, output_path, split_dir, stats);
+  if (!visitor.Open()) {
+    return false;
+  }
+  IGVStreamReader reader(input_path);
+  bool ok = reader.Run(&visitor);
+  ok = visitor.Close() && ok;
+
+  stats->groups_seen = reader.groups_seen();
+  stats->graphs_seen = reader.graphs_seen();
+  stats->bytes_read = reader.bytes_read();
+  if (!ok) {
+    return false;
+  }
+  Logger::Info("Filtered " + std::to_string(stats->graphs_written) + " of " +
+               std::to_string(stats->graphs_seen) + " graphs from " +
+               input_path + " into " + std::to_string(stats->outputs.size()) +
+               " file(s)");
+  return true;
+}
+
+}  // namespace
+
+bool IGVFilterSpec::Matches(const std::string& method,
+                            const std::string& graph_name,
+                            size_t index) const {
+  if (!methods.empty()) {
+    bool any = false;
+    for (const std::string& m : methods) {
+      if (method.find(m) != std::string::npos) {
+        any = true;
+        break;
+      }
+    }
+    if (!any) return false;
+  }
+  if (phase && !std::regex_search(graph_name, *phase)) {
+    return false;
+  }
+  if (!index_ranges.empty()) {
+    bool any = false;
+    for (const auto& [first, last] : index_ranges) {
+      if (index >= first && index <= last) {
+        any = true;
+        break;
+      }
+    }
+    if (!any) return false;
+  }
+  return true;
+}
+
+bool IGVFilter::Filter(const std::string& input_path,
+                       const IGVFilterSpec& spec,
+                       const std::string& output_path, IGVFilterStats* stats) {
+  return RunFilter(input_path, spec, output_path, "", stats);
+}
+
+bool IGVFilter::Split(const std::string& input_path, const IGVFilterSpec& spec,
+                      const std::string& output_dir, IGVFilterStats* stats) {
+  if (output_dir.empty()) {
+    Logger::Error("Split requires an output directory");
+    return false;
+  }
+  return RunFilter(input_path, spec, "", output_dir, stats);
+}
+
+bool IGVFilter::ParseIndexRanges(const std::string& text,
+                                 std::vector<std::pair<size_t, size_t>>* out) {
+  out->clear();
+  std::string_view rest(text);
+  while (!rest.empty()) {
+    size_t comma = rest.find(',');
+    std::string_view item = Trim(rest.substr(0, comma));
+    rest = comma == std::string_view::npos ? std::string_view()
+                                           : rest.substr(comma + 1);
+
+    size_t dash = item.find('-');
+    std::string_view lo_text = Trim(item.substr(0, dash));
+    std::string_view hi_text =
+        dash == std::string_view::npos ? lo_text : Trim(item.substr(dash + 1));
+
+    size_t lo = 0;
+    size_t hi = 0;
+    auto lo_res =
+        std::from_chars(lo_text.data(), lo_text.data() + lo_text.size(), lo);
+    auto hi_res =
+        std::from_chars(hi_text.data(), hi_text.data() + hi_text.size(), hi);
+    if (lo_text.empty() || hi_text.empty() || lo_res.ec != std::errc() ||
+        hi_res.ec != std::errc() ||
+        lo_res.ptr != lo_text.data() + lo_text.size() ||
+        hi_res.ptr != hi_text.data() + hi_text.size() || lo > hi) {
+      return false;
+    }
+    out->emplace_back(lo, hi);
+  }
+  return !out->empty();
+}
+
+}  // namespace sun
@@ -0,0 +1,291 @@
+#include "suntv/igv/igv_pipeline.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <exception>
+#include <map>
+#include <thread>
+
+#include "suntv/igv/canonicalizer.hpp"
+#include "suntv/igv/graph_store.hpp"
+#include "suntv/igv/parser.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/graph_codec.hpp"
+#include "suntv/util/bounded_queue.hpp"
+#include "suntv/util/logging.hpp"
+
+namespace sun {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Item = std::unique_ptr<PipelineGraph>;
+using Queue = BoundedQueue<Item>;
+
+// Counters of one stage, shared by its threads
+struct Stage {
+  std::atomic<uint64_t> items{0};
+  std::atomic<int64_t> busy_ns{0};
+  std::atomic<size_t> live{0};  // Threads still running
+
+  void Add(Clock::duration busy) {
+    items.fetch_add(1, std::memory_order_relaxed);
+    busy_ns.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+        std::memory_order_relaxed);
+  }
+
+  PipelineStageStats Stats(const char* name, size_t threads) const {
+    return {name, threads, items.load(), busy_ns.load() * 1e-9};
+  }
+};
+
+// One thread of a pool: the last of the pool to finish closes `out`
+template <typename Work>
+void Worker(Queue& in, Queue& out, Stage& stage, Work work) {
+  Item g;
+  while (in.Pop(g)) {
+    const Clock::time_point start = Clock::now();
+    work(*g);
+    stage.Add(Clock::now() - start);
+    out.Push(std::move(g));
+  }
+  if (stage.live.fetch_sub(1) == 1) out.Close();
+}
+
+class Reader : public IGVStreamReader::Visitor {
+ public:
+  Reader(const PipelineOptions& options, Queue& out,
+         std::atomic<uint64_t>& written, uint64_t window)
+      : options_(options), out_(out), written_(written), window_(window) {}
+
+  bool SelectGraph(const IGVGraphRef& ref) override {
+    return !options_.select || options_.select(ref);
+  }
+
+  bool OnGraph(const IGVGraphRef& ref, std::string_view bytes) override {
+    auto g = std::make_unique<PipelineGraph>();
+    g->method = ref.method;
+    g->name = ref.name;
+    g->index = ref.index;
+    g->bytes = bytes;
+    Push(std::move(g));
+    return true;
+  }
+
+  // A graph of a GraphStore, the `index`th of its scan
+  void OnStored(const StoredGraph& stored, size_t index) {
+    const std::string method(stored.method);
+    const std::string name(stored.name);
+    const std::string header;
+    if (!SelectGraph(IGVGraphRef{method, header, name, 0, index})) return;
+    auto g = std::make_unique<PipelineGraph>();
+    g->method = method;
+    g->name = name;
+    g->index = index;
+    g->key = stored.key;
+    g->bytes = stored.bytes;
+    Push(std::move(g));
+  }
+
+  void set_file(size_t file) { file_ = file; }
+  uint64_t graphs() const { return next_; }
+  Clock::duration waited() const { return waited_; }
+
+ private:
+  void Push(Item g) {
+    g->sequence = next_++;
+    g->file = file_;
+    // Wait for the writer to take all but `window_` earlier graphs
+    const Clock::time_point start = Clock::now();
+    for (uint64_t w = written_.load(); g->sequence >= w + window_;
+         w = written_.load()) {
+      written_.wait(w);
+    }
+    out_.Push(std::move(g));
+    waited_ += Clock::now() - start;
+  }
+
+  const PipelineOptions& options_;
+  Queue& out_;
+  std::atomic<uint64_t>& written_;
+  const uint64_t window_;
+  size_t file_ = 0;
+  uint64_t next_ = 0;
+  Clock::duration waited_{};
+};
+
+}  // namespace
+
+std::string PipelineStats::ToString() const {
+  char line[160];
+  snprintf(line, sizeof(line),
+           "%" PRIu64 " files (%" PRIu64 " failed), %.1f MiB, %" PRIu64
+           " graphs (%" PRIu64 " failed) in %.2fs\n",
+           files, files_failed, bytes / 1048576.0, graphs, graphs_failed,
+           seconds);
+  std::string out = line;
+  for (const PipelineStageStats& s : stages) {
+    // Share of its threads' time the stage spent working
+    const double busy =
+        seconds > 0 ? 100 * s.busy_seconds / (seconds * s.threads) : 0;
+    snprintf(line, sizeof(line),
+             "  %-13s %3zu threads %9" PRIu64 " graphs %9.2fs busy %5.1f%%\n",
+             s.name, s.threads, s.items, s.busy_seconds, busy);
+    out += line;
+  }
+  return out;
+}
+
+size_t IGVPipeline::Threads(size_t requested) {
+  if (requested != 0) return requested;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+PipelineStats IGVPipeline::Run(const std::vector<std::string>& paths,
+                               const Execute& execute, const Write& write,
+                               const PipelineOptions& options) {
+  const Clock::time_point started = Clock::now();
+  const size_t capacity = std::max<size_t>(options.queue_capacity, 1);
+  const size_t parse_threads = Threads(options.parse_threads);
+  const size_t canonicalize_threads = Threads(options.canonicalize_threads);
+  const size_t execute_threads = Threads(options.execute_threads);
+  const uint64_t window =
+      4 * capacity + parse_threads + canonicalize_threads + execute_threads;
+
+  Queue to_parse(capacity);
+  Queue to_canonicalize(capacity);
+  Queue to_execute(capacity);
+  Queue to_write(capacity);
+  std::atomic<uint64_t> written{0};
+  std::atomic<uint64_t> failed{0};
+  Stage read, parse, canonicalize, run, out;
+  parse.live = parse_threads;
+  canonicalize.live = canonicalize_threads;
+  run.live = execute_threads;
+
+  PipelineStats stats;
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] {
+    const Clock::time_point start = Clock::now();
+    Reader reader(options, to_parse, written, window);
+    for (size_t f = 0; f < paths.size(); ++f) {
+      LogContext log_context(paths[f]);
+      reader.set_file(f);
+      bool ok = true;
+      if (GraphStore::IsStore(paths[f])) {
+        try {
+          GraphStore store(paths[f]);
+          size_t index = 0;
+          store.Scan([&](const StoredGraph& stored) {
+            stats.bytes += stored.bytes.size();
+            reader.OnStored(stored, index++);
+            return true;
+          });
+        } catch (const std::exception& e) {
+          Logger::Warn(e.what());
+          ok = false;
+        }
+      } else {
+        IGVStreamReader stream(paths[f]);
+        ok = stream.Run(&reader);
+        stats.bytes += stream.bytes_read();
+      }
+      if (!ok) {
+        ++stats.files_failed;
+        Logger::Warn("Failed to read " + paths[f]);
+      }
+    }
+    stats.files = paths.size();
+    stats.graphs = reader.graphs();
+    read.items = reader.graphs();
+    read.busy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Clock::now() - start - reader.waited())
+                       .count();
+    to_parse.Close();
+  });
+
+  for (size_t t = 0; t < parse_threads; ++t) {
+    threads.emplace_back([&] {
+      IGVParser parser;
+      Worker(to_parse, to_canonicalize, parse, [&](PipelineGraph& g) {
+        LogContext log_context(paths[g.file]);
+        if (g.key != 0) {
+          try {
+            g.graph = DecodeGraph(g.bytes);
+          } catch (const std::exception& e) {
+            g.error = e.what();
+          }
+        } else {
+          g.graph = parser.ParseGraphXml(g.bytes, /*canonicalize=*/false);
+          if (!g.graph) g.error = "malformed graph XML";
+        }
+        g.bytes = std::string();
+        if (!g.graph) ++failed;
+      });
+    });
+  }
+
+  for (size_t t = 0; t < canonicalize_threads; ++t) {
+    threads.emplace_back([&] {
+      Worker(to_canonicalize, to_execute, canonicalize,
+             [&](PipelineGraph& g) {
+               if (!g.graph || g.key != 0) return;
+               LogContext log_context(paths[g.file]);
+               Canonicalizer canon;
+               if (!canon.Canonicalize(g.graph.get())) {
+                 g.graph.reset();
+                 g.error = "graph failed canonicalization";
+                 ++failed;
+               }
+             });
+    });
+  }
+
+  for (size_t t = 0; t < execute_threads; ++t) {
+    threads.emplace_back([&, t] {
+      Worker(to_execute, to_write, run, [&](PipelineGraph& g) {
+        if (!g.graph) return;
+        LogContext log_context(paths[g.file]);
+        try {
+          execute(g, t);
+        } catch (const std::exception& e) {
+          g.error = e.what();
+        }
+      });
+    });
+  }
+
+  // The writer runs here, restoring corpus order
+  std::map<uint64_t, Item> pending;
+  uint64_t next = 0;
+  Item g;
+  while (to_write.Pop(g)) {
+    const uint64_t sequence = g->sequence;
+    pending.emplace(sequence, std::move(g));
+    for (auto it = pending.begin();
+         it != pending.end() && it->first == next; it = pending.erase(it)) {
+      const Clock::time_point start = Clock::now();
+      write(*it->second);
+      out.Add(Clock::now() - start);
+      written.store(++next);
+      written.notify_one();
+    }
+  }
+  for (std::thread& t : threads) t.join();
+
+  stats.graphs_failed = failed.load();
+  stats.seconds =
+      std::chrono::duration<double>(Clock::now() - started).count();
+  stats.stages = {read.Stats("read", 1),
+                  parse.Stats("parse", parse_threads),
+                  canonicalize.Stats("canonicalize", canonicalize_threads),
+                  run.Stats("execute", execute_threads),
+                  out.Stats("write", 1)};
+  return stats;
+}
+
+}  // namespace sun
@@ -0,0 +1,334 @@
+#include "suntv/igv/igv_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <pugixml.hpp>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "suntv/igv/igv_stream.hpp"
+#include "suntv/util/logging.hpp"
+
+namespace sun {
+
+namespace {
+
+std::string_view Trim(std::string_view s) {
+  size_t b = s.find_first_not_of(" \t\n\r");
+  if (b == std::string_view::npos) return {};
+  size_t e = s.find_last_not_of(" \t\n\r");
+  return s.substr(b, e - b + 1);
+}
+
+std::string_view NodeName(pugi::xml_node node) {
+  for (pugi::xml_node p : node.child("properties").children("p")) {
+    if (std::strcmp(p.attribute("name").value(), "name") == 0) {
+      return Trim(p.child_value());
+    }
+  }
+  return {};
+}
+
+struct NodeInfo {
+  Opcode op = Opcode::kUnknown;
+  int memory_input = -1;  // Node ID at input 1, if any
+  int max_input = -1;     // Highest input index with an edge
+};
+
+// Longest chain of stores where each store's memory input is the previous
+// one. Chains are walked iteratively and memoized; a cycle (malformed graph)
+// ends the chain.
+uint64_t LongestStoreChain(const std::unordered_map<int, NodeInfo>& nodes) {
+  std::unordered_map<int, uint64_t> depth;
+  std::vector<int> path;
+  uint64_t longest = 0;
+
+  auto is_store = [&](int id) {
+    auto it = nodes.find(id);
+    return it != nodes.end() &&
+           GetSchema(it->second.op) == NodeSchema::kS4_Store;
+  };
+
+  for (const auto& [id, info] : nodes) {
+    if (!is_store(id) || depth.count(id)) continue;
+
+    path.clear();
+    int cur = id;
+    uint64_t base = 0;
+    while (is_store(cur)) {
+      auto memo = depth.find(cur);
+      if (memo != depth.end()) {
+        base = memo->second;
+        break;
+      }
+      if (std::find(path.begin(), path.end(), cur) != path.end()) break;
+      path.push_back(cur);
+      cur = nodes.at(cur).memory_input;
+    }
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+      depth[*it] = ++base;
+    }
+    longest = std::max(longest, base);
+  }
+  return longest;
+}
+
+void AppendJsonString(std::ostringstream& out, std::string_view s) {
+  out << '"';
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x",
+                        static_cast<unsigned>(c));
+          out << buf;
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+void AppendHistogram(std::ostringstream& out, const Log2Histogram& h,
+                     const std::string& indent) {
+  out << "{\n";
+  out << indent << "  \"count\": " << h.count << ",\n";
+  out << indent << "  \"min\": " << (h.count ? h.min : 0) << ",\n";
+  out << indent << "  \"max\": " << h.max << ",\n";
+  out << indent << "  \"mean\": "
+      << (h.count ? static_cast<double>(h.sum) / h.count : 0.0) << ",\n";
+  out << indent << "  \"buckets\": [";
+  bool first = true;
+  for (size_t i = 0; i < Log2Histogram::kNumBuckets; ++i) {
+    if (h.buckets[i] == 0) continue;
+    uint64_t lo = i == 0 ? 0 : uint64_t{1} << (i - 1);
+    uint64_t hi = i == 0 ? 0 : (uint64_t{1} << i) - 1;
+    out << (first ? "\n" : ",\n") << indent << "    {\"lo\": " << lo
+        << ", \"hi\": " << hi << ", \"count\": " << h.buckets[i] << "}";
+    first = false;
+  }
+  out << (first ? "]\n" : "\n" + indent + "  ]\n");
+  out << indent << "}";
+}
+
+class StatsVisitor : public IGVStreamReader::Visitor {
+ public:
+  explicit StatsVisitor(CorpusStats* stats) : stats_(stats) {}
+
+  bool OnGraph(const IGVGraphRef& ref, std::string_view bytes) override {
+    (void)ref;
+    IGVStats::AddGraph(bytes, stats_);
+    return true;
+  }
+
+ private:
+  CorpusStats* stats_;
+};
+
+}  // namespace
+
+void Log2Histogram::Add(uint64_t value) {
+  size_t bucket = std::min<size_t>(std::bit_width(value), kNumBuckets - 1);
+  ++buckets[bucket];
+  ++count;
+  sum += value;
+  min = std::min(min, value);
+  max = std::max(max, value);
+}
+
+void Log2Histogram::Merge(const Log2Histogram& other) {
+  for (size_t i = 0; i < kNumBuckets; ++i) buckets[i] += other.buckets[i];
+  count += other.count;
+  sum += other.sum;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+}
+
+void CorpusStats::Merge(const CorpusStats& other) {
+  files += other.files;
+  files_failed += other.files_failed;
+  bytes += other.bytes;
+  groups += other.groups;
+  graphs += other.graphs;
+  graphs_failed += other.graphs_failed;
+  nodes += other.nodes;
+  edges += other.edges;
+  for (size_t i = 0; i < kNumOpcodes; ++i) opcodes[i] += other.opcodes[i];
+  for (const auto& [name, n] : other.unknown_opcodes) {
+    unknown_opcodes[name] += n;
+  }
+  graph_nodes.Merge(other.graph_nodes);
+  loops += other.loops;
+  graphs_with_loops += other.graphs_with_loops;
+  max_loops_per_graph =
+      std::max(max_loops_per_graph, other.max_loops_per_graph);
+  phis += other.phis;
+  max_phi_arity = std::max(max_phi_arity, other.max_phi_arity);
+  memory_chain.Merge(other.memory_chain);
+}
+
+std::string CorpusStats::ToJson() const {
+  std::ostringstream out;
+  out << "{\n";
+  out << "  \"files\": " << files << ",\n";
+  out << "  \"files_failed\": " << files_failed << ",\n";
+  out << "  \"bytes\": " << bytes << ",\n";
+  out << "  \"groups\": " << groups << ",\n";
+  out << "  \"graphs\": " << graphs << ",\n";
+  out << "  \"graphs_failed\": " << graphs_failed << ",\n";
+  out << "  \"nodes\": " << nodes << ",\n";
+  out << "  \"edges\": " << edges << ",\n";
+
+  // Opcodes sorted by descending frequency, then name
+  std::vector<std::pair<std::string, uint64_t>> ops;
+  for (size_t i = 0; i < kNumOpcodes; ++i) {
+    if (opcodes[i]) {
+      ops.emplace_back(OpcodeToString(static_cast<Opcode>(i)), opcodes[i]);
+    }
+  }
+  std::vector<std::pair<std::string, uint64_t>> unknown(
+      unknown_opcodes.begin(), unknown_opcodes.end());
+  auto by_count = [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  };
+  std::sort(ops.begin(), ops.end(), by_count);
+  std::sort(unknown.begin(), unknown.end(), by_count);
+
+  for (const auto* table : {&ops, &unknown}) {
+    out << (table == &ops ? "  \"opcodes\": {" : "  \"unknown_opcodes\": {");
+    for (size_t i = 0; i < table->size(); ++i) {
+      out << (i ? ",\n    " : "\n    ");
+      AppendJsonString(out, (*table)[i].first);
+      out << ": " << (*table)[i].second;
+    }
+    out << (table->empty() ? "},\n" : "\n  },\n");
+  }
+
+  out << "  \"graph_nodes\": ";
+  AppendHistogram(out, graph_nodes, "  ");
+  out << ",\n";
+  out << "  \"loops\": {\"total\": " << loops
+      << ", \"graphs_with_loops\": " << graphs_with_loops
+      << ", \"max_per_graph\": " << max_loops_per_graph << "},\n";
+  out << "  \"phis\": {\"total\": " << phis
+      << ", \"max_arity\": " << max_phi_arity << "},\n";
+  out << "  \"memory_chain\": ";
+  AppendHistogram(out, memory_chain, "  ");
+  out << "\n}\n";
+  return out.str();
+}
+
+bool IGVStats::AddGraph(std::string_view graph_xml, CorpusStats* stats) {
+  ++stats->graphs;
+  pugi::xml_document doc;
+  if (!doc.load_buffer(graph_xml.data(), graph_xml.size())) {
+    ++stats->graphs_failed;
+    return false;
+  }
+  pugi::xml_node graph = doc.child("graph");
+
+  std::unordered_map<int, NodeInfo> nodes;
+  uint64_t num_nodes = 0;
+  uint64_t num_loops = 0;
+  for (pugi::xml_node node : graph.child("nodes").children("node")) {
+    std::string_view name = NodeName(node);
+    Opcode op = StringToOpcode(name);
+    if (op == Opcode::kUnknown) {
+      ++stats->unknown_opcodes[std::string(name)];
+    } else {
+      ++stats->opcodes[static_cast<size_t>(op)];
+    }
+    if (IsLoopHead(op)) ++num_loops;
+    nodes[std::atoi(node.attribute("id").value())].op = op;
+    ++num_nodes;
+  }
+
+  for (pugi::xml_node edge : graph.child("edges").children("edge")) {
+    ++stats->edges;
+    auto to = nodes.find(std::atoi(edge.attribute("to").value()));
+    if (to == nodes.end()) continue;
+    pugi::xml_attribute index = edge.attribute("toIndex");
+    if (!index) index = edge.attribute("index");
+    int i = index.as_int();
+    to->second.max_input = std::max(to->second.max_input, i);
+    if (i == 1) {
+      to->second.memory_input = std::atoi(edge.attribute("from").value());
+    }
+  }
+
+  for (const auto& [id, info] : nodes) {
+    (void)id;
+    if (info.op == Opcode::kPhi) {
+      ++stats->phis;
+      uint64_t arity = info.max_input > 0 ? info.max_input : 0;
+      stats->max_phi_arity = std::max(stats->max_phi_arity, arity);
+    }
+  }
+
+  stats->nodes += num_nodes;
+  stats->graph_nodes.Add(num_nodes);
+  stats->loops += num_loops;
+  if (num_loops) ++stats->graphs_with_loops;
+  stats->max_loops_per_graph = std::max(stats->max_loops_per_graph, num_loops);
+  stats->memory_chain.Add(LongestStoreChain(nodes));
+  return true;
+}
+
+bool IGVStats::Collect(const std::vector<std::string>& paths,
+                       size_t num_threads, CorpusStats* stats) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min(num_threads, std::max<size_t>(paths.size(), 1));
+
+  std::atomic<size_t> next{0};
+  std::mutex merge_mutex;
+  auto worker = [&]() {
+    CorpusStats local;
+    for (size_t i = next++; i < paths.size(); i = next++) {
+      LogContext log_context(paths[i]);
+      // Graph counts come from AddGraph; the reader only reports bytes/groups
+      StatsVisitor visitor(&local);
+      IGVStreamReader reader(paths[i]);
+      bool ok = reader.Run(&visitor);
+      ++local.files;
+      local.bytes += reader.bytes_read();
+      local.groups += reader.groups_seen();
+      if (!ok) {
+        ++local.files_failed;
+        Logger::Warn("Failed to read " + paths[i]);
+      }
+    }
+    std::lock_guard<std::mutex> lock(merge_mutex);
+    stats->Merge(local);
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) threads.emplace_back(worker);
+  worker();
+  for (std::thread& t : threads) t.join();
+
+  return stats->files_failed == 0;
+}
+
+}  // namespace sun
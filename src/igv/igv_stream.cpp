@@ -0,0 +1,358 @@
+#include "suntv/igv/igv_stream.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "suntv/util/logging.hpp"
+
+namespace sun {
+
+namespace {
+
+constexpr size_t kChunkSize = 1 << 20;
+constexpr size_t kNoPin = static_cast<size_t>(-1);
+
+std::string DecodeEntities(std::string_view s) {
+  std::string out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] != '&') {
+      out += s[i];
+      continue;
+    }
+    size_t semi = s.find(';', i);
+    if (semi == std::string_view::npos) {
+      out += s.substr(i);
+      break;
+    }
+    std::string_view ent = s.substr(i + 1, semi - i - 1);
+    if (ent == "lt") {
+      out += '<';
+    } else if (ent == "gt") {
+      out += '>';
+    } else if (ent == "amp") {
+      out += '&';
+    } else if (ent == "quot") {
+      out += '"';
+    } else if (ent == "apos") {
+      out += '\'';
+    } else {
+      out += s.substr(i, semi - i + 1);  // Keep unknown entities verbatim
+    }
+    i = semi;
+  }
+  return out;
+}
+
+std::string_view Trim(std::string_view s) {
+  size_t b = s.find_first_not_of(" \t\n\r");
+  if (b == std::string_view::npos) return {};
+  size_t e = s.find_last_not_of(" \t\n\r");
+  return s.substr(b, e - b + 1);
+}
+
+// Element name of an open or close tag ("<graph name='x'>" -> "graph")
+std::string_view TagName(std::string_view tag) {
+  size_t b = (tag.size() > 1 && tag[1] == '/') ? 2 : 1;
+  size_t e = b;
+  while (e < tag.size() && !std::strchr(" \t\r\n/>", tag[e])) ++e;
+  return tag.substr(b, e - b);
+}
+
+// Decoded value of attribute `name` in an open tag, or "" if absent
+std::string TagAttribute(std::string_view tag, std::string_view name) {
+  size_t pos = 0;
+  while ((pos = tag.find(name, pos)) != std::string_view::npos) {
+    size_t after = pos + name.size();
+    bool starts_word = pos > 0 && std::strchr(" \t\r\n", tag[pos - 1]);
+    if (starts_word && after < tag.size() && tag[after] == '=' &&
+        after + 1 < tag.size()) {
+      char quote = tag[after + 1];
+      size_t close = tag.find(quote, after + 2);
+      if (close != std::string_view::npos) {
+        return DecodeEntities(tag.substr(after + 2, close - after - 2));
+      }
+    }
+    pos = after;
+  }
+  return "";
+}
+
+// Method name of a group: text of the first <p name='name'> in its header
+std::string GroupName(std::string_view header) {
+  size_t pos = 0;
+  while ((pos = header.find("<p ", pos)) != std::string_view::npos) {
+    size_t gt = header.find('>', pos);
+    if (gt == std::string_view::npos) break;
+    if (TagAttribute(header.substr(pos, gt - pos + 1), "name") == "name") {
+      size_t end = header.find("</p>", gt);
+      if (end == std::string_view::npos) break;
+      return DecodeEntities(Trim(header.substr(gt + 1, end - gt - 1)));
+    }
+    pos = gt;
+  }
+  return "";
+}
+
+/**
+ * Sliding window over the input file. Bytes before pos() (or before the pin,
+ * if set) may be discarded by the next Fill(); callers hold offsets, never
+ * pointers, across fills.
+ */
+class ChunkReader {
+ public:
+  bool Open(const std::string& path) {
+    in_.open(path, std::ios::binary);
+    buf_.resize(kChunkSize);
+    return static_cast<bool>(in_);
+  }
+
+  const char* data() const { return buf_.data(); }
+  size_t pos() const { return pos_; }
+  size_t end() const { return end_; }
+  bool eof() const { return eof_; }
+  size_t bytes_read() const { return bytes_read_; }
+  void Advance(size_t to) { pos_ = to; }
+
+  // Keep bytes from offset on in the window until Unpin()
+  void Pin(size_t offset) { pin_ = offset; }
+  void Unpin() { pin_ = kNoPin; }
+  size_t pin() const { return pin_; }
+
+  /**
+   * Drop unneeded bytes and read more. Grows the window if the retained part
+   * already fills it. Returns false at end of input.
+   */
+  bool Fill() {
+    if (eof_) return false;
+    size_t keep = pin_ == kNoPin ? pos_ : std::min(pin_, pos_);
+    if (keep > 0) {
+      std::memmove(buf_.data(), buf_.data() + keep, end_ - keep);
+      end_ -= keep;
+      pos_ -= keep;
+      if (pin_ != kNoPin) pin_ -= keep;
+    }
+    if (end_ == buf_.size()) {
+      buf_.resize(buf_.size() * 2);
+    }
+    in_.read(buf_.data() + end_,
+             static_cast<std::streamsize>(buf_.size() - end_));
+    size_t got = static_cast<size_t>(in_.gcount());
+    end_ += got;
+    bytes_read_ += got;
+    if (got == 0) {
+      eof_ = true;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  std::ifstream in_;
+  std::vector<char> buf_;
+  size_t pos_ = 0;
+  size_t end_ = 0;
+  size_t pin_ = kNoPin;
+  size_t bytes_read_ = 0;
+  bool eof_ = false;
+};
+
+class Scanner {
+ public:
+  explicit Scanner(IGVStreamReader::Visitor* visitor) : visitor_(visitor) {}
+
+  bool Run(const std::string& path) {
+    if (!reader_.Open(path)) {
+      Logger::Error("Failed to open IGV file: " + path);
+      return false;
+    }
+    if (!Scan()) return false;
+    if (in_group_ || in_graph_) {
+      Logger::Error("Truncated IGV file: " + path);
+      return false;
+    }
+    return true;
+  }
+
+  size_t bytes_read() const { return reader_.bytes_read(); }
+  size_t groups_seen() const { return groups_seen_; }
+  size_t graphs_seen() const { return graphs_seen_; }
+
+ private:
+  bool Scan() {
+    while (true) {
+      const char* base = reader_.data();
+      size_t pos = reader_.pos();
+      size_t end = reader_.end();
+      const void* lt = std::memchr(base + pos, '<', end - pos);
+      if (!lt) {
+        Text(base + pos, end - pos);
+        reader_.Advance(end);
+        if (!reader_.Fill()) return true;
+        continue;
+      }
+
+      size_t tag_start = static_cast<const char*>(lt) - base;
+      Text(base + pos, tag_start - pos);
+      reader_.Advance(tag_start);
+
+      size_t tag_end = FindTagEnd();
+      while (tag_end == std::string_view::npos) {
+        bool more = reader_.Fill();
+        tag_end = FindTagEnd();
+        if (tag_end == std::string_view::npos && !more) {
+          Logger::Error("Unterminated XML markup at end of file");
+          return false;
+        }
+      }
+      size_t tag_pos = reader_.pos();
+      std::string_view tag(reader_.data() + tag_pos, tag_end - tag_pos);
+      reader_.Advance(tag_end);
+      if (!HandleTag(tag, tag_pos, tag_end)) return false;
+    }
+  }
+
+  // End offset (exclusive) of the markup starting at pos(), or npos if the
+  // window does not hold all of it yet.
+  size_t FindTagEnd() const {
+    std::string_view w(reader_.data() + reader_.pos(),
+                       reader_.end() - reader_.pos());
+    constexpr size_t kLongestPrefix = 9;  // "<![CDATA["
+    if (w.size() < kLongestPrefix && !reader_.eof()) {
+      return std::string_view::npos;
+    }
+
+    std::string_view terminator;
+    if (w.substr(0, 4) == "<!--") {
+      terminator = "-->";
+    } else if (w.substr(0, 9) == "<![CDATA[") {
+      terminator = "]]>";
+    } else if (w.substr(0, 2) == "<?") {
+      terminator = "?>";
+    }
+    if (!terminator.empty()) {
+      size_t t = w.find(terminator, 2);
+      return t == std::string_view::npos
+                 ? t
+                 : reader_.pos() + t + terminator.size();
+    }
+
+    // Element tag: '>' may legally appear inside quoted attribute values
+    char quote = 0;
+    for (size_t i = 1; i < w.size(); ++i) {
+      char c = w[i];
+      if (quote) {
+        if (c == quote) quote = 0;
+      } else if (c == '"' || c == '\'') {
+        quote = c;
+      } else if (c == '>') {
+        return reader_.pos() + i + 1;
+      }
+    }
+    return std::string_view::npos;
+  }
+
+  bool HandleTag(std::string_view tag, size_t tag_pos, size_t tag_end) {
+    if (tag.size() < 2 || tag[1] == '!' || tag[1] == '?') {
+      Text(tag.data(), tag.size());
+      return true;
+    }
+
+    std::string_view name = TagName(tag);
+    if (tag[1] == '/') {
+      if (name == "graph" && in_graph_) {
+        return EndGraph(tag_end);
+      }
+      if (name == "group" && in_group_ && !in_graph_) {
+        if (in_header_) FinishHeader();
+        in_group_ = false;
+        return visitor_->OnGroupEnd(group_ordinal_);
+      }
+      Text(tag.data(), tag.size());
+      return true;
+    }
+
+    bool self_closing = tag[tag.size() - 2] == '/';
+    if (name == "group" && !in_group_) {
+      group_ordinal_ = groups_seen_++;
+      if (self_closing) return visitor_->OnGroupEnd(group_ordinal_);
+      in_group_ = true;
+      in_header_ = true;
+      header_.assign(tag);
+      group_index_ = 0;
+      return true;
+    }
+
+    if (name == "graph" && in_group_ && !in_graph_) {
+      if (in_header_) FinishHeader();
+      graph_name_ = TagAttribute(tag, "name");
+      graph_index_ = group_index_++;
+      ++graphs_seen_;
+      capturing_ = visitor_->SelectGraph(Ref());
+      in_graph_ = true;
+      if (capturing_) reader_.Pin(tag_pos);
+      if (self_closing) return EndGraph(tag_end);
+      return true;
+    }
+
+    Text(tag.data(), tag.size());
+    return true;
+  }
+
+  bool EndGraph(size_t tag_end) {
+    in_graph_ = false;
+    if (!capturing_) return true;
+    capturing_ = false;
+    size_t begin = reader_.pin();
+    reader_.Unpin();
+    return visitor_->OnGraph(
+        Ref(), std::string_view(reader_.data() + begin, tag_end - begin));
+  }
+
+  // Text and markup outside graphs only matters while reading a group header
+  void Text(const char* data, size_t size) {
+    if (in_header_) header_.append(data, size);
+  }
+
+  void FinishHeader() {
+    in_header_ = false;
+    group_name_ = GroupName(header_);
+  }
+
+  IGVGraphRef Ref() const {
+    return IGVGraphRef{group_name_, header_, graph_name_, group_ordinal_,
+                       graph_index_};
+  }
+
+  IGVStreamReader::Visitor* visitor_;
+  ChunkReader reader_;
+
+  bool in_group_ = false;
+  bool in_header_ = false;  // Buffering bytes before the group's first graph
+  bool in_graph_ = false;
+  bool capturing_ = false;  // Current graph is pinned in the window
+  std::string header_;
+  std::string group_name_;
+  std::string graph_name_;
+  size_t group_ordinal_ = 0;
+  size_t group_index_ = 0;
+  size_t graph_index_ = 0;
+  size_t groups_seen_ = 0;
+  size_t graphs_seen_ = 0;
+};
+
+}  // namespace
+
+IGVStreamReader::IGVStreamReader(std::string path) : path_(std::move(path)) {}
+
+bool IGVStreamReader::Run(Visitor* visitor) {
+  Scanner scanner(visitor);
+  bool ok = scanner.Run(path_);
+  bytes_read_ = scanner.bytes_read();
+  groups_seen_ = scanner.groups_seen();
+  graphs_seen_ = scanner.graphs_seen();
+  return ok;
+}
+
+}  // namespace sun
@@ -4,9 +4,11 @@
 #include <pugixml.hpp>
 
 #include "suntv/igv/canonicalizer.hpp"
+#include "suntv/ir/constant_pool.hpp"
 #include "suntv/ir/graph.hpp"
 #include "suntv/ir/node.hpp"
 #include "suntv/ir/opcode.hpp"
+#include "suntv/ir/schedule.hpp"
 #include "suntv/util/logging.hpp"
 
 namespace sun {
@@ -14,6 +16,9 @@ namespace sun {
 // Implementation class (PIMPL pattern)
 class IGVParser::Impl {
  public:
+  Impl(StringInterner* strings, ConstantPool* constants)
+      : strings_(strings), constants_(constants) {}
+
   std::unique_ptr<Graph> Parse(const std::string& path) {
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_file(path.c_str());
@@ -36,9 +41,83 @@ class IGVParser::Impl {
     return ParseGraph(graph_node);
   }
 
+  std::vector<ParsedGraph> ParseAll(const std::string& path) {
+    std::vector<ParsedGraph> result;
+    pugi::xml_document doc;
+    pugi::xml_parse_result load = doc.load_file(path.c_str());
+
+    if (!load) {
+      Logger::Error("Failed to parse XML file: " + path);
+      Logger::Error(load.description());
+      return result;
+    }
+
+    for (pugi::xml_node group : doc.child("graphDocument").children("group")) {
+      std::string method = PropertyValue(group, "name");
+      size_t index = 0;
+      for (pugi::xml_node graph_node : group.children("graph")) {
+        std::string name = graph_node.attribute("name").value();
+        if (name.empty()) {
+          name = PropertyValue(graph_node, "name");
+        }
+        std::unique_ptr<Graph> graph = ParseGraph(graph_node);
+        if (!graph) {
+          Logger::Warn("Skipping graph " + std::to_string(index) + " (" +
+                       name + ") of " + method);
+        } else {
+          result.push_back(ParsedGraph{method, name, index, std::move(graph)});
+        }
+        ++index;
+      }
+    }
+    return result;
+  }
+
+  std::unique_ptr<Graph> ParseGraphXml(std::string_view xml,
+                                       bool canonicalize) {
+    pugi::xml_document doc;
+    if (!doc.load_buffer(xml.data(), xml.size())) {
+      Logger::Error("Failed to parse graph XML");
+      return nullptr;
+    }
+    pugi::xml_node graph_node = doc.child("graph");
+    if (!graph_node) {
+      Logger::Error("No graph found in graph XML");
+      return nullptr;
+    }
+    return canonicalize ? ParseGraph(graph_node) : ReadGraph(graph_node);
+  }
+
  private:
+  static std::string PropertyValue(pugi::xml_node owner, const char* key) {
+    for (pugi::xml_node p : owner.child("properties").children("p")) {
+      if (std::string(p.attribute("name").value()) == key) {
+        std::string value = p.child_value();
+        value.erase(0, value.find_first_not_of(" \t\n\r"));
+        value.erase(value.find_last_not_of(" \t\n\r") + 1);
+        return value;
+      }
+    }
+    return "";
+  }
+
   std::unique_ptr<Graph> ParseGraph(pugi::xml_node graph_node) {
-    auto graph = std::make_unique<Graph>();
+    std::unique_ptr<Graph> graph = ReadGraph(graph_node);
+
+    // Canonicalize and validate the graph
+    Canonicalizer canon;
+    Graph* validated = canon.Canonicalize(graph.get());
+    if (!validated) {
+      Logger::Error("Graph failed canonicalization/validation");
+      return nullptr;
+    }
+
+    return graph;
+  }
+
+  // Nodes, edges and schedule as they appear in the XML
+  std::unique_ptr<Graph> ReadGraph(pugi::xml_node graph_node) {
+    auto graph = std::make_unique<Graph>(strings_, constants_);
 
     // Parse nodes
     pugi::xml_node nodes = graph_node.child("nodes");
@@ -52,12 +131,10 @@ class IGVParser::Impl {
       ParseEdge(edge, graph.get());
     }
 
-    // Canonicalize and validate the graph
-    Canonicalizer canon;
-    Graph* validated = canon.Canonicalize(graph.get());
-    if (!validated) {
-      Logger::Error("Graph failed canonicalization/validation");
-      return nullptr;
+    // Parse C2's block schedule, present after Global code motion
+    pugi::xml_node control_flow = graph_node.child("controlFlow");
+    if (control_flow) {
+      graph->set_schedule(ParseControlFlow(control_flow, *graph));
     }
 
     return graph;
@@ -101,6 +178,8 @@ class IGVParser::Impl {
 
     // Create node
     Node* n = graph->AddNode(id, opcode);
+    // Unknown nodes keep their name (e.g. the Mach instruction "addI_rReg")
+    if (opcode == Opcode::kUnknown) n->set_prop("name", opcode_str);
 
     // Parse remaining properties
     for (pugi::xml_node p : props.children("p")) {
@@ -135,6 +214,16 @@ class IGVParser::Impl {
       n->set_prop(prop_name, prop_value);
     }
 
+    // Pool the decoded payload so the interpreter need not re-parse it.
+    // An explicit 'value' property takes precedence and is left alone.
+    if ((opcode == Opcode::kConI || opcode == Opcode::kConL ||
+         opcode == Opcode::kConP || opcode == Opcode::kConF ||
+         opcode == Opcode::kConD) &&
+        n->has_prop("dump_spec") && !n->has_prop("value")) {
+      n->set_constant(graph->constants().InternDumpSpec(
+          opcode, n->interned_prop("dump_spec").view()));
+    }
+
     Logger::Debug("Parsed node " + std::to_string(id) + ": " +
                   OpcodeToString(opcode));
   }
@@ -177,11 +266,52 @@ class IGVParser::Impl {
     Logger::Debug("Parsed edge: " + std::to_string(from_id) + " -> " +
                   std::to_string(to_id) + "[" + std::to_string(to_index) + "]");
   }
+
+  std::unique_ptr<Schedule> ParseControlFlow(pugi::xml_node control_flow,
+                                             const Graph& graph) {
+    auto schedule = std::make_unique<Schedule>();
+    // Successors may name later blocks: create every block first
+    for (pugi::xml_node block : control_flow.children("block")) {
+      schedule->AddBlock(block.attribute("name").as_int());
+    }
+
+    uint32_t b = 0;
+    for (pugi::xml_node block : control_flow.children("block")) {
+      for (pugi::xml_node succ : block.child("successors").children()) {
+        const uint32_t s = schedule->FindBlock(succ.attribute("name").as_int());
+        if (s == Schedule::kNoBlock) {
+          Logger::Warn("Block ", schedule->block(b).name,
+                       " has unknown successor, skipping");
+          continue;
+        }
+        schedule->AddSuccessor(b, s);
+      }
+      for (pugi::xml_node node : block.child("nodes").children("node")) {
+        const Node* n = graph.node(node.attribute("id").as_int());
+        if (!n) {
+          Logger::Warn("Block ", schedule->block(b).name,
+                       " refers to non-existent node, skipping");
+        } else if (!schedule->Place(n, b)) {
+          Logger::Warn("Node ", n->id(), " is in more than one block");
+        }
+      }
+      ++b;
+    }
+    Logger::Debug("Parsed schedule of ", schedule->blocks().size(),
+                  " blocks");
+    return schedule;
+  }
+
+  StringInterner* strings_;
+  ConstantPool* constants_;
 };
 
 // IGVParser implementation
 
-IGVParser::IGVParser() : impl_(std::make_unique<Impl>()) {}
+IGVParser::IGVParser() : IGVParser(nullptr, nullptr) {}
+
+IGVParser::IGVParser(StringInterner* strings, ConstantPool* constants)
+    : impl_(std::make_unique<Impl>(strings, constants)) {}
 
 IGVParser::~IGVParser() = default;
 
@@ -189,4 +319,13 @@ std::unique_ptr<Graph> IGVParser::Parse(const std::string& path) {
   return impl_->Parse(path);
 }
 
+std::vector<ParsedGraph> IGVParser::ParseAll(const std::string& path) {
+  return impl_->ParseAll(path);
+}
+
+std::unique_ptr<Graph> IGVParser::ParseGraphXml(std::string_view xml,
+                                                bool canonicalize) {
+  return impl_->ParseGraphXml(xml, canonicalize);
+}
+
 }  // namespace sun
@@ -0,0 +1,52 @@
+#include "suntv/igv/session.hpp"
+
+#include <stdexcept>
+
+#include "suntv/igv/graph_store.hpp"
+#include "suntv/igv/parser.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/util/logging.hpp"
+
+namespace sun {
+
+GraphSession::GraphSession() : strings_(arena_), constants_(arena_) {}
+
+GraphSession::~GraphSession() = default;
+
+size_t GraphSession::Load(const std::string& path) {
+  IGVParser parser(&strings_, &constants_);
+  std::vector<ParsedGraph> parsed = parser.ParseAll(path);
+  for (ParsedGraph& pg : parsed) {
+    entries_.push_back(
+        Entry{std::move(pg.method), std::move(pg.name), std::move(pg.graph)});
+  }
+  Logger::Info("Loaded " + std::to_string(parsed.size()) + " graphs from " +
+               path + " (" + std::to_string(strings_.size()) + " strings, " +
+               std::to_string(constants_.size()) + " constants)");
+  return parsed.size();
+}
+
+size_t GraphSession::Load(const GraphStore& store,
+                          const StoredCompilation& compilation) {
+  for (const StoredPhase& phase : compilation.phases) {
+    std::unique_ptr<Graph> graph =
+        store.Load(phase.key, &strings_, &constants_);
+    if (!graph) {
+      throw std::runtime_error("no graph " + GraphStore::KeyString(phase.key) +
+                               " in store '" + store.dir() + "'");
+    }
+    entries_.push_back(Entry{compilation.method, phase.name, std::move(graph)});
+  }
+  return compilation.phases.size();
+}
+
+Graph* GraphSession::FindGraph(const std::string& name) const {
+  for (const Entry& e : entries_) {
+    if (e.name == name) {
+      return e.graph.get();
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace sun
@@ -0,0 +1,109 @@
+#include "suntv/interp/bisect.hpp"
+
+#include <memory>
+
+#include "suntv/ir/mach_lowering.hpp"
+
+namespace sun {
+
+namespace {
+
+class Bisection {
+ public:
+  Bisection(const std::vector<const Graph*>& phases,
+            const std::vector<Value>& inputs, const DiffEngine& engine)
+      : phases_(phases),
+        inputs_(inputs),
+        engine_(engine),
+        results_(phases.size()) {}
+
+  BisectReport Run() {
+    if (phases_.empty()) {
+      report_.reference.message = "no phases";
+      return std::move(report_);
+    }
+    report_.reference = Result(0);
+    if (report_.reference.kind == EngineResult::Kind::kError) {
+      return std::move(report_);
+    }
+
+    // The last runnable phase must differ, or there is nothing to find
+    size_t lo = 0;
+    size_t hi = phases_.size() - 1;
+    while (hi > lo && !Runnable(hi)) --hi;
+    if (hi == lo || Agrees(hi)) return std::move(report_);
+
+    while (hi - lo > 1) {
+      std::optional<size_t> probe = Probe(lo, hi);
+      if (!probe) break;
+      if (Agrees(*probe)) {
+        lo = *probe;
+      } else {
+        hi = *probe;
+      }
+    }
+    report_.good = lo;
+    report_.bad = hi;
+    return std::move(report_);
+  }
+
+ private:
+  const EngineResult& Result(size_t i) {
+    if (results_[i]) return *results_[i];
+    EngineResult r;
+    try {
+      const Graph& g = *phases_[i];
+      if (IsMachGraph(g)) {
+        std::vector<const Graph*> history(phases_.begin(),
+                                          phases_.begin() + i);
+        std::unique_ptr<Graph> lowered = LowerMachGraph(g, history);
+        r = engine_.run(*lowered, {inputs_}).at(0);
+      } else {
+        r = engine_.run(g, {inputs_}).at(0);
+      }
+    } catch (const std::exception& e) {
+      r.kind = EngineResult::Kind::kError;
+      r.message = e.what();
+    }
+    report_.steps.push_back({i, r});
+    results_[i] = std::move(r);
+    return *results_[i];
+  }
+
+  bool Runnable(size_t i) {
+    return Result(i).kind != EngineResult::Kind::kError;
+  }
+
+  bool Agrees(size_t i) { return Result(i).Matches(report_.reference); }
+
+  // The runnable phase strictly between lo and hi nearest their midpoint
+  std::optional<size_t> Probe(size_t lo, size_t hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    for (size_t d = 0; d < mid - lo || d < hi - mid; ++d) {
+      if (d < mid - lo && Runnable(mid - d)) return mid - d;
+      if (d > 0 && d < hi - mid && Runnable(mid + d)) return mid + d;
+    }
+    return std::nullopt;
+  }
+
+  const std::vector<const Graph*>& phases_;
+  const std::vector<Value>& inputs_;
+  const DiffEngine& engine_;
+  std::vector<std::optional<EngineResult>> results_;
+  BisectReport report_;
+};
+
+}  // namespace
+
+BisectReport BisectPhases(const std::vector<const Graph*>& phases,
+                          const std::vector<Value>& inputs,
+                          const DiffEngine& engine) {
+  return Bisection(phases, inputs, engine).Run();
+}
+
+BisectReport BisectPhases(const std::vector<const Graph*>& phases,
+                          const std::vector<Value>& inputs) {
+  return BisectPhases(phases, inputs, DifferentialTester::Engines().front());
+}
+
+}  // namespace sun
@@ -0,0 +1,626 @@
+#include "suntv/interp/conformance.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "suntv/interp/evaluator.hpp"
+#include "suntv/util/random.hpp"
+
+namespace sun {
+
+namespace {
+
+enum class Domain { kI32, kI64, kF32, kF64 };
+
+struct OpInfo {
+  std::string_view name;
+  int arity;
+  Domain lhs;
+  Domain rhs;
+};
+
+constexpr OpInfo kOps[] = {
+#define SUN_CONFORMANCE_INFO(name, arity, lhs, rhs) \
+  {#name, arity, Domain::k##lhs, Domain::k##rhs},
+    SUN_CONFORMANCE_OPS(SUN_CONFORMANCE_INFO)
+#undef SUN_CONFORMANCE_INFO
+};
+static_assert(std::size(kOps) == kNumConformanceOps);
+
+const OpInfo& Info(ConformanceOp op) { return kOps[static_cast<size_t>(op)]; }
+
+// Grid rows per work item, and random samples per work item
+constexpr uint64_t kGridRowsPerItem = 8;
+constexpr uint64_t kSamplesPerItem = 1 << 15;
+
+// ----- Reference semantics ------------------------------------------------
+// Int ops run exactly in 64 bits and truncate; long ops run on uint64_t,
+// where C++ arithmetic is modular like Java's. Nothing here can overflow.
+
+int32_t TruncI32(int64_t v) {
+  return static_cast<int32_t>(static_cast<uint32_t>(v));
+}
+
+int64_t FromU64(uint64_t v) { return static_cast<int64_t>(v); }
+
+// Magnitude of a long, exact even for MIN_VALUE
+uint64_t Magnitude(int64_t v) {
+  return v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+}
+
+int64_t DivL(int64_t a, int64_t b) {
+  uint64_t q = Magnitude(a) / Magnitude(b);
+  return FromU64((a < 0) != (b < 0) ? 0 - q : q);
+}
+
+int64_t ModL(int64_t a, int64_t b) {
+  uint64_t r = Magnitude(a) % Magnitude(b);
+  return FromU64(a < 0 ? 0 - r : r);
+}
+
+int64_t ShrL(int64_t a, int32_t count) {
+  int n = count & 63;
+  uint64_t bits = static_cast<uint64_t>(a) >> n;
+  if (a < 0 && n > 0) bits |= ~(~uint64_t{0} >> n);  // Copy the sign down
+  return FromU64(bits);
+}
+
+// Signed order through unsigned compare with the sign bit flipped
+bool LessL(int64_t a, int64_t b) {
+  constexpr uint64_t kSign = uint64_t{1} << 63;
+  return (static_cast<uint64_t>(a) ^ kSign) <
+         (static_cast<uint64_t>(b) ^ kSign);
+}
+
+// f2i/d2i/f2l/d2l: NaN is 0, out of range saturates, else round to zero
+template <typename I>
+I FloatToIntegral(double d) {
+  constexpr double kLimit = std::is_same_v<I, int32_t> ? 0x1p31 : 0x1p63;
+  if (std::isnan(d)) return 0;
+  if (d >= kLimit) return std::numeric_limits<I>::max();
+  if (d < -kLimit) return std::numeric_limits<I>::min();
+  return static_cast<I>(std::trunc(d));
+}
+
+// fcmpl/dcmpl: NaN compares as less
+template <typename T>
+int32_t Compare3(T a, T b) {
+  if (a < b) return -1;
+  if (a > b) return 1;
+  if (a == b) return 0;
+  return -1;
+}
+
+// ----- Operands ------------------------------------------------------------
+
+uint64_t ToBits(const Value& v) {
+  switch (v.kind) {
+    case Value::Kind::kI32:
+      return static_cast<uint32_t>(v.data.i32);
+    case Value::Kind::kI64:
+      return static_cast<uint64_t>(v.data.i64);
+    case Value::Kind::kF32:
+      return std::bit_cast<uint32_t>(v.data.f32);
+    case Value::Kind::kF64:
+      return std::bit_cast<uint64_t>(v.data.f64);
+    case Value::Kind::kBool:
+      return v.data.b;
+    default:
+      return static_cast<uint32_t>(v.data.ref);
+  }
+}
+
+Value FromBits(Domain d, uint64_t bits) {
+  switch (d) {
+    case Domain::kI32:
+      return Value::MakeI32(static_cast<int32_t>(static_cast<uint32_t>(bits)));
+    case Domain::kI64:
+      return Value::MakeI64(static_cast<int64_t>(bits));
+    case Domain::kF32:
+      return Value::MakeF32(std::bit_cast<float>(static_cast<uint32_t>(bits)));
+    case Domain::kF64:
+      return Value::MakeF64(std::bit_cast<double>(bits));
+  }
+  return Value::MakeNull();
+}
+
+int Width(Domain d) {
+  return d == Domain::kI32 || d == Domain::kF32 ? 32 : 64;
+}
+
+std::vector<Value> UniqueByBits(Domain d, std::vector<uint64_t> bits) {
+  std::sort(bits.begin(), bits.end());
+  bits.erase(std::unique(bits.begin(), bits.end()), bits.end());
+  std::vector<Value> values;
+  values.reserve(bits.size());
+  for (uint64_t b : bits) values.push_back(FromBits(d, b));
+  return values;
+}
+
+// 0, +-2^k, +-(2^k - 1), +-(2^k + 1) for every k, MIN/MAX, alternating bit
+// patterns, and every shift count up to twice the width
+template <typename U>
+std::vector<uint64_t> IntegralGridBits() {
+  constexpr int kBits = std::numeric_limits<U>::digits;
+  std::vector<uint64_t> bits = {0, 10, 100, 1000};
+  for (uint64_t s = 0; s <= 2 * kBits + 2; ++s) bits.push_back(s);
+  for (int k = 0; k < kBits; ++k) {
+    U p = U{1} << k;
+    for (U v : {p, static_cast<U>(p - 1), static_cast<U>(p + 1)}) {
+      bits.push_back(v);
+      bits.push_back(static_cast<U>(0 - v));
+    }
+  }
+  bits.push_back(static_cast<U>(~U{0} / 3));      // 0x5555...
+  bits.push_back(static_cast<U>(~U{0} / 3 * 2));  // 0xAAAA...
+  for (uint64_t& b : bits) b = static_cast<U>(b);
+  return bits;
+}
+
+// Signed zeros, infinities, NaNs (quiet, signaling, negative, with
+// payload), subnormals, and the neighbours of powers of two that decide
+// rounding and int/long saturation
+template <typename T>
+std::vector<uint64_t> FloatGridBits() {
+  using Bits = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+  using L = std::numeric_limits<T>;
+  constexpr Bits kSign = Bits{1} << (sizeof(T) * 8 - 1);
+
+  std::vector<T> values = {
+      T(0),          L::infinity(), L::denorm_min(),
+      L::min(),      L::max(),      L::min() - L::denorm_min(),
+      L::epsilon(),  T(FLT_MAX),    T(FLT_MIN),
+      T(1 + 0x1p-24)};
+  const double anchors[] = {0.5,    1.0,    1.5,    2.5,    3.5,    1e10,
+                            0x1p23, 0x1p24, 0x1p31, 0x1p32, 0x1p52, 0x1p53,
+                            0x1p62, 0x1p63, 0x1p64};
+  for (double a : anchors) {
+    T x = static_cast<T>(a);
+    values.push_back(x);
+    values.push_back(std::nextafter(x, T(0)));
+    values.push_back(std::nextafter(x, L::infinity()));
+  }
+
+  std::vector<uint64_t> bits;
+  for (T v : values) {
+    bits.push_back(std::bit_cast<Bits>(v));
+    bits.push_back(std::bit_cast<Bits>(v) ^ kSign);
+  }
+  Bits qnan = std::bit_cast<Bits>(L::quiet_NaN());
+  Bits inf = std::bit_cast<Bits>(L::infinity());
+  for (Bits nan : {qnan, Bits(qnan | 0x1234), Bits(inf | 1), Bits(~kSign)}) {
+    bits.push_back(nan);
+    bits.push_back(nan ^ kSign);
+  }
+  return bits;
+}
+
+struct Grids {
+  std::vector<Value> by_domain[4];
+
+  Grids() {
+    std::vector<uint64_t> wide = IntegralGridBits<uint64_t>();
+    for (uint64_t b : IntegralGridBits<uint32_t>()) {
+      wide.push_back(b);  // Zero-extended
+      wide.push_back(static_cast<uint64_t>(
+          static_cast<int64_t>(static_cast<int32_t>(b))));  // Sign-extended
+    }
+    at(Domain::kI32) = UniqueByBits(Domain::kI32, IntegralGridBits<uint32_t>());
+    at(Domain::kI64) = UniqueByBits(Domain::kI64, std::move(wide));
+    at(Domain::kF32) = UniqueByBits(Domain::kF32, FloatGridBits<float>());
+    at(Domain::kF64) = UniqueByBits(Domain::kF64, FloatGridBits<double>());
+  }
+
+  std::vector<Value>& at(Domain d) { return by_domain[static_cast<int>(d)]; }
+  const std::vector<Value>& at(Domain d) const {
+    return by_domain[static_cast<int>(d)];
+  }
+};
+
+const Grids& GetGrids() {
+  static const Grids grids;
+  return grids;
+}
+
+// A quarter each: uniform bits, a grid value, a grid value a few units
+// (ulps for floats) away, and a value of random magnitude
+Value RandomOperand(Domain d, const std::vector<Value>& grid,
+                    SplitMix64& rng) {
+  uint64_t r = rng.Next();
+  uint64_t bits = rng.Next();
+  const Value& near = grid[(r >> 8) % grid.size()];
+  int shift = static_cast<int>((r >> 40) % Width(d));
+  bool negate = (r >> 47) & 1;
+  switch (r & 3) {
+    case 0:
+      break;
+    case 1:
+      return near;
+    case 2:
+      bits = ToBits(near) + ((r >> 48) % 17) - 8;
+      break;
+    default:
+      bits >>= shift;
+      if (d == Domain::kF32 || d == Domain::kF64) {
+        // Integral values and halves, around the conversion boundaries
+        double v = static_cast<double>(bits) + ((r >> 49) & 1 ? 0.5 : 0.0);
+        if (negate) v = -v;
+        return d == Domain::kF32 ? Value::MakeF32(static_cast<float>(v))
+                                 : Value::MakeF64(v);
+      }
+      if (negate) bits = 0 - bits;
+      break;
+  }
+  return FromBits(d, bits);
+}
+
+// ----- Checking -----------------------------------------------------------
+
+bool IsRawMove(ConformanceOp op) {
+  return op == ConformanceOp::kMoveI2F || op == ConformanceOp::kMoveL2D;
+}
+
+bool SameResult(ConformanceOp op, const Value& expected, const Value& actual) {
+  if (expected.kind != actual.kind) return false;
+  if (ToBits(expected) == ToBits(actual)) return true;
+  // Java does not pin NaN bits outside the raw moves
+  if (IsRawMove(op)) return false;
+  if (expected.is_f32()) {
+    return std::isnan(expected.data.f32) && std::isnan(actual.data.f32);
+  }
+  if (expected.is_f64()) {
+    return std::isnan(expected.data.f64) && std::isnan(actual.data.f64);
+  }
+  return false;
+}
+
+std::string Describe(const Value& v) {
+  if (!v.is_f32() && !v.is_f64()) return v.ToString();
+  char bits[32];
+  std::snprintf(bits, sizeof(bits), " (0x%llx)",
+                static_cast<unsigned long long>(ToBits(v)));
+  return v.ToString() + bits;
+}
+
+struct WorkItem {
+  ConformanceOp op;
+  bool grid;       // Grid rows [begin, end), else random samples
+  uint64_t begin;
+  uint64_t end;
+};
+
+struct WorkerResult {
+  uint64_t checks = 0;
+  uint64_t mismatches = 0;
+  // (work item, failure), in item order
+  std::vector<std::pair<size_t, ConformanceFailure>> failures;
+};
+
+class Checker {
+ public:
+  Checker(const ConformanceEngine& engine, const ConformanceOptions& options,
+          WorkerResult* result)
+      : engine_(engine), options_(options), result_(result) {}
+
+  void Run(size_t index, const WorkItem& item) {
+    item_ = index;
+    const OpInfo& info = Info(item.op);
+    const Grids& grids = GetGrids();
+    const std::vector<Value>& lhs = grids.at(info.lhs);
+    const std::vector<Value>& rhs = grids.at(info.rhs);
+    const Value none = Value::MakeNull();
+
+    if (item.grid) {
+      for (uint64_t i = item.begin; i < item.end; ++i) {
+        if (info.arity == 1) {
+          Check(item.op, lhs[i], none);
+          continue;
+        }
+        for (const Value& b : rhs) Check(item.op, lhs[i], b);
+      }
+      return;
+    }
+
+    SplitMix64 rng(options_.seed * 0x9E3779B97F4A7C15ull +
+                   (static_cast<uint64_t>(item.op) << 48) + item.begin);
+    for (uint64_t i = item.begin; i < item.end; ++i) {
+      Value a = RandomOperand(info.lhs, lhs, rng);
+      Value b = info.arity == 1 ? none : RandomOperand(info.rhs, rhs, rng);
+      Check(item.op, a, b);
+    }
+  }
+
+ private:
+  void Check(ConformanceOp op, const Value& a, const Value& b) {
+    ++result_->checks;
+    std::optional<Value> expected = Conformance::Reference(op, a, b);
+
+    size_t i = static_cast<size_t>(op);
+    std::optional<Value> actual;
+    std::string error;
+    try {
+      actual = Info(op).arity == 1 ? engine_.unary[i](a)
+                                   : engine_.binary[i](a, b);
+    } catch (const EvalException&) {
+      // Java's ArithmeticException
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+
+    bool same = error.empty() && expected.has_value() == actual.has_value() &&
+                (!expected || SameResult(op, *expected, *actual));
+    if (same) return;
+
+    ++result_->mismatches;
+    // A worker takes items in increasing order, so once it holds
+    // max_failures none of its later ones can make the report
+    if (result_->failures.size() >= options_.max_failures) return;
+    ConformanceFailure failure{op, a, b,
+                               expected ? Describe(*expected)
+                                        : "ArithmeticException",
+                               ""};
+    if (!error.empty()) {
+      failure.actual = "error: " + error;
+    } else {
+      failure.actual = actual ? Describe(*actual) : "ArithmeticException";
+    }
+    result_->failures.emplace_back(item_, std::move(failure));
+  }
+
+  const ConformanceEngine& engine_;
+  const ConformanceOptions& options_;
+  WorkerResult* result_;
+  size_t item_ = 0;
+};
+
+void Bind(ConformanceEngine* engine, ConformanceOp op,
+          ConformanceEngine::UnaryFn fn) {
+  engine->unary[static_cast<size_t>(op)] = fn;
+}
+
+void Bind(ConformanceEngine* engine, ConformanceOp op,
+          ConformanceEngine::BinaryFn fn) {
+  engine->binary[static_cast<size_t>(op)] = fn;
+}
+
+}  // namespace
+
+std::string_view Conformance::OpName(ConformanceOp op) {
+  return Info(op).name;
+}
+
+std::optional<ConformanceOp> Conformance::OpFromName(std::string_view name) {
+  for (size_t i = 0; i < kNumConformanceOps; ++i) {
+    if (kOps[i].name == name) return static_cast<ConformanceOp>(i);
+  }
+  return std::nullopt;
+}
+
+int Conformance::Arity(ConformanceOp op) { return Info(op).arity; }
+
+std::optional<Value> Conformance::Reference(ConformanceOp op, Value lhs,
+                                            Value rhs) {
+  using Op = ConformanceOp;
+  const Domain d = Info(op).lhs;
+  const int64_t a = d == Domain::kI32   ? lhs.data.i32
+                    : d == Domain::kI64 ? lhs.data.i64
+                                        : 0;
+  const int64_t b = Info(op).rhs == Domain::kI32   ? rhs.data.i32
+                    : Info(op).rhs == Domain::kI64 ? rhs.data.i64
+                                                   : 0;
+  const uint64_t ua = static_cast<uint64_t>(a);
+  const uint64_t ub = static_cast<uint64_t>(b);
+
+  switch (op) {
+    // int: exact in 64 bits, then truncated
+    case Op::kAddI:
+      return Value::MakeI32(TruncI32(a + b));
+    case Op::kSubI:
+      return Value::MakeI32(TruncI32(a - b));
+    case Op::kMulI:
+      return Value::MakeI32(TruncI32(a * b));
+    case Op::kDivI:
+      if (b == 0) return std::nullopt;
+      return Value::MakeI32(TruncI32(a / b));
+    case Op::kModI:
+      if (b == 0) return std::nullopt;
+      return Value::MakeI32(TruncI32(a % b));
+    case Op::kAndI:
+      return Value::MakeI32(TruncI32(a & b));
+    case Op::kOrI:
+      return Value::MakeI32(TruncI32(a | b));
+    case Op::kXorI:
+      return Value::MakeI32(TruncI32(a ^ b));
+    case Op::kLShiftI:
+      return Value::MakeI32(TruncI32(FromU64(ua << (b & 31))));
+    case Op::kRShiftI:
+      return Value::MakeI32(TruncI32(ShrL(a, b & 31)));
+    case Op::kURShiftI:
+      return Value::MakeI32(TruncI32((ua & 0xFFFFFFFFu) >> (b & 31)));
+    case Op::kCmpEqI:
+      return Value::MakeBool(a - b == 0);
+    case Op::kCmpNeI:
+      return Value::MakeBool(a - b != 0);
+    case Op::kCmpLtI:
+      return Value::MakeBool(a - b < 0);
+    case Op::kCmpLeI:
+      return Value::MakeBool(a - b <= 0);
+    case Op::kCmpGtI:
+      return Value::MakeBool(a - b > 0);
+    case Op::kCmpGeI:
+      return Value::MakeBool(a - b >= 0);
+    case Op::kAbsI:
+      return Value::MakeI32(TruncI32(a < 0 ? -a : a));
+
+    // long: modular on uint64_t, division on magnitudes
+    case Op::kAddL:
+      return Value::MakeI64(FromU64(ua + ub));
+    case Op::kSubL:
+      return Value::MakeI64(FromU64(ua - ub));
+    case Op::kMulL:
+      return Value::MakeI64(FromU64(ua * ub));
+    case Op::kDivL:
+      if (b == 0) return std::nullopt;
+      return Value::MakeI64(DivL(a, b));
+    case Op::kModL:
+      if (b == 0) return std::nullopt;
+      return Value::MakeI64(ModL(a, b));
+    case Op::kAndL:
+      return Value::MakeI64(FromU64(ua & ub));
+    case Op::kOrL:
+      return Value::MakeI64(FromU64(ua | ub));
+    case Op::kXorL:
+      return Value::MakeI64(FromU64(ua ^ ub));
+    case Op::kLShiftL:
+      return Value::MakeI64(FromU64(ua << (b & 63)));
+    case Op::kRShiftL:
+      return Value::MakeI64(ShrL(a, static_cast<int32_t>(b)));
+    case Op::kURShiftL:
+      return Value::MakeI64(FromU64(ua >> (b & 63)));
+    case Op::kCmpLtL:
+      return Value::MakeBool(LessL(a, b));
+    case Op::kCmpLeL:
+      return Value::MakeBool(!LessL(b, a));
+    case Op::kCmpGtL:
+      return Value::MakeBool(LessL(b, a));
+    case Op::kCmpGeL:
+      return Value::MakeBool(!LessL(a, b));
+    case Op::kAbsL:
+      return Value::MakeI64(FromU64(Magnitude(a)));
+
+    case Op::kCmpF3:
+      return Value::MakeI32(Compare3(lhs.data.f32, rhs.data.f32));
+    case Op::kCmpD3:
+      return Value::MakeI32(Compare3(lhs.data.f64, rhs.data.f64));
+
+    // Conversions; int/long to float rounds to nearest even
+    case Op::kConvI2L:
+      return Value::MakeI64(a);
+    case Op::kConvL2I:
+      return Value::MakeI32(TruncI32(a));
+    case Op::kConvI2F:
+    case Op::kConvL2F:
+      return Value::MakeF32(static_cast<float>(a));
+    case Op::kConvI2D:
+    case Op::kConvL2D:
+      return Value::MakeF64(static_cast<double>(a));
+    case Op::kConvF2I:
+      return Value::MakeI32(FloatToIntegral<int32_t>(lhs.data.f32));
+    case Op::kConvF2L:
+      return Value::MakeI64(FloatToIntegral<int64_t>(lhs.data.f32));
+    case Op::kConvD2I:
+      return Value::MakeI32(FloatToIntegral<int32_t>(lhs.data.f64));
+    case Op::kConvD2L:
+      return Value::MakeI64(FloatToIntegral<int64_t>(lhs.data.f64));
+    case Op::kConvF2D:
+      return Value::MakeF64(static_cast<double>(lhs.data.f32));
+    case Op::kConvD2F:
+      return Value::MakeF32(static_cast<float>(lhs.data.f64));
+    case Op::kMoveF2I:
+      return FromBits(Domain::kI32, ToBits(lhs));
+    case Op::kMoveI2F:
+      return FromBits(Domain::kF32, ToBits(lhs));
+    case Op::kMoveD2L:
+      return FromBits(Domain::kI64, ToBits(lhs));
+    case Op::kMoveL2D:
+      return FromBits(Domain::kF64, ToBits(lhs));
+  }
+  return std::nullopt;
+}
+
+ConformanceEngine Conformance::EvaluatorEngine() {
+  ConformanceEngine engine;
+  engine.name = "evaluator";
+#define SUN_CONFORMANCE_BIND(name, arity, lhs, rhs) \
+  Bind(&engine, ConformanceOp::k##name, &Evaluator::Eval##name);
+  SUN_CONFORMANCE_OPS(SUN_CONFORMANCE_BIND)
+#undef SUN_CONFORMANCE_BIND
+  return engine;
+}
+
+std::vector<ConformanceEngine> Conformance::Engines() {
+  return {EvaluatorEngine()};
+}
+
+ConformanceReport Conformance::Run(const ConformanceEngine& engine,
+                                   const ConformanceOptions& options) {
+  ConformanceReport report;
+  std::vector<ConformanceOp> ops = options.ops;
+  if (ops.empty()) {
+    for (size_t i = 0; i < kNumConformanceOps; ++i) {
+      ops.push_back(static_cast<ConformanceOp>(i));
+    }
+  }
+
+  // Work items: grid rows, then random sample blocks, op by op
+  const Grids& grids = GetGrids();
+  std::vector<WorkItem> items;
+  for (ConformanceOp op : ops) {
+    size_t i = static_cast<size_t>(op);
+    bool bound = Info(op).arity == 1 ? engine.unary[i] != nullptr
+                                     : engine.binary[i] != nullptr;
+    if (!bound) {
+      report.skipped.push_back(op);
+      continue;
+    }
+    if (options.grid) {
+      uint64_t rows = grids.at(Info(op).lhs).size();
+      uint64_t step = Info(op).arity == 1 ? rows : kGridRowsPerItem;
+      for (uint64_t r = 0; r < rows; r += step) {
+        items.push_back({op, true, r, std::min(rows, r + step)});
+      }
+    }
+    for (uint64_t s = 0; s < options.samples; s += kSamplesPerItem) {
+      items.push_back(
+          {op, false, s, std::min(options.samples, s + kSamplesPerItem)});
+    }
+  }
+
+  size_t num_threads = options.num_threads;
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min(num_threads, std::max<size_t>(items.size(), 1));
+
+  std::atomic<size_t> next{0};
+  std::mutex merge_mutex;
+  std::vector<std::pair<size_t, ConformanceFailure>> failures;
+  auto worker = [&]() {
+    WorkerResult local;
+    Checker checker(engine, options, &local);
+    for (size_t i = next++; i < items.size(); i = next++) {
+      checker.Run(i, items[i]);
+    }
+    std::lock_guard<std::mutex> lock(merge_mutex);
+    report.checks += local.checks;
+    report.mismatches += local.mismatches;
+    for (auto& f : local.failures) failures.push_back(std::move(f));
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) threads.emplace_back(worker);
+  worker();
+  for (std::thread& t : threads) t.join();
+
+  // Keep the first failures in work order, whatever the thread timing
+  std::stable_sort(
+      failures.begin(), failures.end(),
+      [](const auto& x, const auto& y) { return x.first < y.first; });
+  for (auto& f : failures) {
+    if (report.failures.size() == options.max_failures) break;
+    report.failures.push_back(std::move(f.second));
+  }
+  return report;
+}
+
+}  // namespace sun
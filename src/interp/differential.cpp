@@ -0,0 +1,435 @@
+#include "suntv/interp/differential.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "suntv/interp/interpreter.hpp"
+#include "suntv/util/random.hpp"
+
+namespace sun {
+
+namespace {
+
+bool SameValue(const Value& a, const Value& b) {
+  if (a.kind != b.kind) return false;
+  switch (a.kind) {
+    case Value::Kind::kI32:
+      return a.data.i32 == b.data.i32;
+    case Value::Kind::kI64:
+      return a.data.i64 == b.data.i64;
+    case Value::Kind::kBool:
+      return a.data.b == b.data.b;
+    case Value::Kind::kRef:
+      return a.data.ref == b.data.ref;
+    case Value::Kind::kNull:
+      return true;
+    case Value::Kind::kF32:
+      return std::bit_cast<uint32_t>(a.data.f32) ==
+             std::bit_cast<uint32_t>(b.data.f32);
+    case Value::Kind::kF64:
+      return std::bit_cast<uint64_t>(a.data.f64) ==
+             std::bit_cast<uint64_t>(b.data.f64);
+  }
+  return false;
+}
+
+// Java only tells exceptions apart by class: DivI and ModI both throw
+// ArithmeticException, so which of two failing divisions ran first is not
+// observable
+std::string JavaException(const std::string& message) {
+  if (message == "Division by zero" || message == "Modulo by zero") {
+    return "ArithmeticException";
+  }
+  if (message == "Negative array length") return "NegativeArraySizeException";
+  return message;
+}
+
+// Same graph, nodes created in reverse order with mirrored IDs
+std::unique_ptr<Graph> Renumbered(const Graph& g) {
+  auto copy = std::make_unique<Graph>();
+  NodeID max_id = 0;
+  for (const Node* n : g.nodes()) max_id = std::max(max_id, n->id());
+
+  std::unordered_map<const Node*, Node*> map;
+  for (auto it = g.nodes().rbegin(); it != g.nodes().rend(); ++it) {
+    map[*it] = copy->CloneNode(**it, max_id - (*it)->id());
+  }
+  for (const Node* n : g.nodes()) {
+    Node* c = map[n];
+    for (size_t i = 0; i < n->num_inputs(); ++i) {
+      c->AddInput(n->input(i) ? map[n->input(i)] : nullptr);
+    }
+  }
+  return copy;
+}
+
+// Boundary ints half the time, then small and full-range ones
+std::vector<std::vector<Value>> CaseInputs(SplitMix64& rng, int num_params,
+                                           int count) {
+  static constexpr int32_t kInteresting[] = {
+      0, 1, -1, 2, 7, 8, 31, 32, std::numeric_limits<int32_t>::min(),
+      std::numeric_limits<int32_t>::max()};
+  std::vector<std::vector<Value>> inputs(count);
+  for (std::vector<Value>& in : inputs) {
+    for (int p = 0; p < num_params; ++p) {
+      int32_t v;
+      if (rng.Chance(1, 2)) {
+        v = kInteresting[rng.Below(std::size(kInteresting))];
+      } else if (rng.Chance(1, 2)) {
+        v = static_cast<int32_t>(rng.Below(33)) - 16;
+      } else {
+        v = static_cast<int32_t>(rng.Next());
+      }
+      in.push_back(Value::MakeI32(v));
+    }
+  }
+  return inputs;
+}
+
+struct Mismatch {
+  size_t input = 0;
+  size_t engine = 0;  // Disagrees with engine 0
+  EngineResult a;
+  EngineResult b;
+};
+
+struct Tally {
+  uint64_t cases = 0;
+  uint64_t runs = 0;
+  uint64_t returns = 0;
+  uint64_t throws = 0;
+  uint64_t errors = 0;
+};
+
+std::optional<Mismatch> Compare(const std::vector<DiffEngine>& engines,
+                                const Graph& graph,
+                                const std::vector<std::vector<Value>>& inputs,
+                                Tally* tally) {
+  std::vector<std::vector<EngineResult>> results;
+  for (const DiffEngine& engine : engines) {
+    try {
+      results.push_back(engine.run(graph, inputs));
+    } catch (const std::exception& e) {
+      EngineResult error;
+      error.message = e.what();
+      results.emplace_back(inputs.size(), error);
+    }
+    results.back().resize(inputs.size());
+  }
+
+  if (tally) {
+    for (const EngineResult& r : results[0]) {
+      ++tally->runs;
+      switch (r.kind) {
+        case EngineResult::Kind::kReturn:
+          ++tally->returns;
+          break;
+        case EngineResult::Kind::kThrow:
+          ++tally->throws;
+          break;
+        case EngineResult::Kind::kError:
+          ++tally->errors;
+          break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    for (size_t e = 1; e < engines.size(); ++e) {
+      if (!results[0][i].Matches(results[e][i])) {
+        return Mismatch{i, e, results[0][i], results[e][i]};
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+DiffFailure MakeFailure(const std::vector<DiffEngine>& engines,
+                        uint64_t case_seed, const RandomProgram& program,
+                        std::vector<Value> inputs, const Mismatch& m) {
+  DiffFailure f;
+  f.case_seed = case_seed;
+  f.program = program;
+  f.inputs = std::move(inputs);
+  f.engine_a = engines[0].name;
+  f.engine_b = engines[m.engine].name;
+  f.result_a = m.a;
+  f.result_b = m.b;
+  return f;
+}
+
+std::optional<DiffFailure> RunCase(const std::vector<DiffEngine>& engines,
+                                   uint64_t case_seed,
+                                   const DiffOptions& options, Tally* tally) {
+  SplitMix64 rng(case_seed);
+  RandomProgram program = RandomProgram::Generate(rng.Next(), options.program);
+  std::vector<std::vector<Value>> inputs =
+      CaseInputs(rng, program.num_params, options.inputs_per_case);
+  std::unique_ptr<Graph> graph = program.Lower();
+  if (tally) ++tally->cases;
+
+  std::optional<Mismatch> m = Compare(engines, *graph, inputs, tally);
+  if (!m) return std::nullopt;
+  return MakeFailure(engines, case_seed, program, inputs[m->input], *m);
+}
+
+// Smaller magnitude first, then positive before negative
+bool Simpler(int32_t a, int32_t b) {
+  uint32_t ma = a < 0 ? 0u - static_cast<uint32_t>(a) : a;
+  uint32_t mb = b < 0 ? 0u - static_cast<uint32_t>(b) : b;
+  return ma < mb || (ma == mb && a > b);
+}
+
+// Greedy: take the first simpler input or program that still fails, and
+// start over from it, until nothing simpler fails or the budget runs out
+void Shrink(const std::vector<DiffEngine>& engines, const DiffOptions& options,
+            DiffFailure* failure) {
+  int steps = 0;
+  auto fails = [&](const RandomProgram& program,
+                   const std::vector<Value>& inputs) {
+    ++steps;
+    std::unique_ptr<Graph> graph = program.Lower();
+    std::optional<Mismatch> m = Compare(engines, *graph, {inputs}, nullptr);
+    if (!m) return false;
+    *failure = MakeFailure(engines, failure->case_seed, program, inputs, *m);
+    return true;
+  };
+
+  bool progress = true;
+  while (progress && steps < options.max_shrink_steps) {
+    progress = false;
+    for (size_t i = 0; i < failure->inputs.size() && !progress; ++i) {
+      int32_t v = failure->inputs[i].as_i32();
+      for (int32_t smaller : {0, 1, -1, v / 2}) {
+        if (!Simpler(smaller, v)) continue;
+        std::vector<Value> inputs = failure->inputs;
+        inputs[i] = Value::MakeI32(smaller);
+        if (fails(failure->program, inputs)) {
+          progress = true;
+          break;
+        }
+      }
+    }
+    if (progress) continue;
+    RandomProgram current = failure->program;
+    std::vector<Value> inputs = failure->inputs;
+    for (const RandomProgram& candidate : current.Shrinks()) {
+      if (steps >= options.max_shrink_steps) break;
+      if (fails(candidate, inputs)) {
+        progress = true;
+        break;
+      }
+    }
+  }
+  failure->shrink_steps = steps;
+}
+
+std::string Indent(const std::string& text) {
+  std::string out;
+  std::istringstream in(text);
+  for (std::string line; std::getline(in, line);) out += "    " + line + "\n";
+  return out;
+}
+
+}  // namespace
+
+EngineResult CaptureRun(Interpreter& interp, const std::vector<Value>& inputs,
+                        const ConcreteHeap* heap) {
+  EngineResult r;
+  try {
+    Outcome outcome =
+        heap ? interp.ExecuteWithHeap(inputs, *heap) : interp.Execute(inputs);
+    r.kind = outcome.kind == Outcome::Kind::kReturn
+                 ? EngineResult::Kind::kReturn
+                 : EngineResult::Kind::kThrow;
+    r.message = JavaException(outcome.exception_kind);
+    // Refs by canonical number, so that allocation order does not show
+    std::vector<Value> roots;
+    if (outcome.return_value) roots.push_back(*outcome.return_value);
+    roots.insert(roots.end(), inputs.begin(), inputs.end());
+    const std::map<Ref, Ref> number = outcome.heap.CanonicalNumbering(roots);
+    r.value = outcome.return_value;
+    if (r.value && r.value->is_ref()) {
+      auto it = number.find(r.value->as_ref());
+      if (it != number.end()) r.value = Value::MakeRef(it->second);
+    }
+    r.heap = outcome.heap.CanonicalDump(roots);
+  } catch (const EvalException& e) {
+    // Raised on a control path (e.g. an If on a division): still Java's
+    // exception, but the heap at that point is not observable
+    r.kind = EngineResult::Kind::kThrow;
+    r.message = JavaException(e.what());
+  } catch (const std::exception& e) {
+    r.kind = EngineResult::Kind::kError;
+    r.message = e.what();
+  }
+  return r;
+}
+
+bool EngineResult::Matches(const EngineResult& other) const {
+  if (kind != other.kind) return false;
+  switch (kind) {
+    case Kind::kReturn:
+      if (value.has_value() != other.value.has_value()) return false;
+      if (value && !SameValue(*value, *other.value)) return false;
+      return heap == other.heap;
+    case Kind::kThrow:
+      return message == other.message && heap == other.heap;
+    case Kind::kError:
+      return true;
+  }
+  return false;
+}
+
+std::string EngineResult::ToString() const {
+  switch (kind) {
+    case Kind::kReturn:
+      return "return " + (value ? value->ToString() : std::string("(none)"));
+    case Kind::kThrow:
+      return "throw " + message;
+    case Kind::kError:
+      return "error: " + message;
+  }
+  return "";
+}
+
+std::string DiffFailure::ToString() const {
+  std::ostringstream out;
+  out << "case seed " << case_seed << ": " << engine_a << " and " << engine_b
+      << " disagree\n";
+  out << "  inputs: (";
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    out << (i ? ", " : "") << inputs[i].ToString();
+  }
+  out << ")\n";
+  out << "  " << engine_a << ": " << result_a.ToString() << "\n";
+  out << "  " << engine_b << ": " << result_b.ToString() << "\n";
+  if (result_a.heap != result_b.heap) {
+    out << "  " << engine_a << " heap:\n" << Indent(result_a.heap);
+    out << "  " << engine_b << " heap:\n" << Indent(result_b.heap);
+  }
+  out << "  program";
+  if (shrink_steps) out << " (shrunk in " << shrink_steps << " steps)";
+  out << ":\n" << Indent(program.ToString());
+  return out.str();
+}
+
+std::vector<DiffEngine> DifferentialTester::Engines() {
+  std::vector<DiffEngine> engines;
+  engines.push_back(
+      {"interpreter", [](const Graph& g, const auto& inputs) {
+         std::vector<EngineResult> out;
+         for (const std::vector<Value>& in : inputs) {
+           Interpreter interp(g);
+           out.push_back(CaptureRun(interp, in));
+         }
+         return out;
+       }});
+  engines.push_back(
+      {"interpreter-reused", [](const Graph& g, const auto& inputs) {
+         std::vector<EngineResult> out;
+         Interpreter interp(g);
+         for (const std::vector<Value>& in : inputs) {
+           out.push_back(CaptureRun(interp, in));
+         }
+         return out;
+       }});
+  engines.push_back(
+      {"interpreter-renumbered", [](const Graph& g, const auto& inputs) {
+         std::unique_ptr<Graph> copy = Renumbered(g);
+         std::vector<EngineResult> out;
+         for (const std::vector<Value>& in : inputs) {
+           Interpreter interp(*copy);
+           out.push_back(CaptureRun(interp, in));
+         }
+         return out;
+       }});
+  return engines;
+}
+
+uint64_t DifferentialTester::CaseSeed(uint64_t seed, uint64_t index) {
+  return SplitMix64(seed ^ (index * 0xD1B54A32D192ED03ull)).Next();
+}
+
+std::optional<DiffFailure> DifferentialTester::CheckCase(
+    const std::vector<DiffEngine>& engines, uint64_t case_seed,
+    const DiffOptions& options) {
+  std::optional<DiffFailure> failure =
+      RunCase(engines, case_seed, options, nullptr);
+  if (failure && options.shrink) Shrink(engines, options, &*failure);
+  return failure;
+}
+
+DiffReport DifferentialTester::Run(const std::vector<DiffEngine>& engines,
+                                   const DiffOptions& options) {
+  DiffReport report;
+  if (engines.empty()) return report;
+
+  size_t num_threads = options.num_threads;
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  num_threads =
+      std::min<size_t>(num_threads, std::max<uint64_t>(options.cases, 1));
+
+  // Cases past the lowest failure found so far are skipped
+  std::atomic<uint64_t> next{0};
+  std::atomic<uint64_t> first_failure{std::numeric_limits<uint64_t>::max()};
+  std::mutex merge_mutex;
+  Tally total;
+  uint64_t failure_index = std::numeric_limits<uint64_t>::max();
+
+  auto worker = [&]() {
+    Tally tally;
+    std::optional<DiffFailure> failure;
+    uint64_t index = 0;
+    for (uint64_t i = next++; i < options.cases && i < first_failure;
+         i = next++) {
+      std::optional<DiffFailure> f =
+          RunCase(engines, CaseSeed(options.seed, i), options, &tally);
+      if (!f) continue;
+      failure = std::move(f);
+      index = i;
+      uint64_t seen = first_failure.load();
+      while (i < seen && !first_failure.compare_exchange_weak(seen, i)) {
+      }
+      break;
+    }
+    std::lock_guard<std::mutex> lock(merge_mutex);
+    total.cases += tally.cases;
+    total.runs += tally.runs;
+    total.returns += tally.returns;
+    total.throws += tally.throws;
+    total.errors += tally.errors;
+    if (failure && index < failure_index) {
+      failure_index = index;
+      report.failure = std::move(failure);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) threads.emplace_back(worker);
+  worker();
+  for (std::thread& t : threads) t.join();
+
+  report.cases = total.cases;
+  report.runs = total.runs;
+  report.returns = total.returns;
+  report.throws = total.throws;
+  report.errors = total.errors;
+  if (report.failure && options.shrink) {
+    Shrink(engines, options, &*report.failure);
+  }
+  return report;
+}
+
+}  // namespace sun
@@ -1,6 +1,8 @@
 #include "suntv/interp/evaluator.hpp"
 
-#include <cstdlib>
+#include <cmath>
+
+#include "suntv/interp/float_kernels.hpp"
 
 namespace sun {
 
@@ -9,17 +11,25 @@ static Value WidenI32ToI64(Value v) {
   return v;
 }
 
+// Java integer arithmetic wraps modulo 2^n. Going through the unsigned type
+// keeps that well defined in C++ (signed overflow is undefined behavior).
+static int32_t WrapI32(uint32_t v) { return static_cast<int32_t>(v); }
+static int64_t WrapI64(uint64_t v) { return static_cast<int64_t>(v); }
+
 // Arithmetic - Int32
 Value Evaluator::EvalAddI(Value a, Value b) {
-  return Value::MakeI32(a.as_i32() + b.as_i32());
+  return Value::MakeI32(WrapI32(static_cast<uint32_t>(a.as_i32()) +
+                                static_cast<uint32_t>(b.as_i32())));
 }
 
 Value Evaluator::EvalSubI(Value a, Value b) {
-  return Value::MakeI32(a.as_i32() - b.as_i32());
+  return Value::MakeI32(WrapI32(static_cast<uint32_t>(a.as_i32()) -
+                                static_cast<uint32_t>(b.as_i32())));
 }
 
 Value Evaluator::EvalMulI(Value a, Value b) {
-  return Value::MakeI32(a.as_i32() * b.as_i32());
+  return Value::MakeI32(WrapI32(static_cast<uint32_t>(a.as_i32()) *
+                                static_cast<uint32_t>(b.as_i32())));
 }
 
 Value Evaluator::EvalDivI(Value a, Value b) {
@@ -27,6 +37,8 @@ Value Evaluator::EvalDivI(Value a, Value b) {
   if (bv == 0) {
     throw EvalException("Division by zero");
   }
+  // MIN_VALUE / -1 overflows back to MIN_VALUE (and traps in hardware)
+  if (bv == -1) return Value::MakeI32(WrapI32(0u - a.as_i32()));
   return Value::MakeI32(a.as_i32() / bv);
 }
 
@@ -35,30 +47,36 @@ Value Evaluator::EvalModI(Value a, Value b) {
   if (bv == 0) {
     throw EvalException("Modulo by zero");
   }
+  if (bv == -1) return Value::MakeI32(0);
   return Value::MakeI32(a.as_i32() % bv);
 }
 
 Value Evaluator::EvalAbsI(Value a) {
-  return Value::MakeI32(std::abs(a.as_i32()));
+  // Math.abs(MIN_VALUE) is MIN_VALUE
+  int32_t v = a.as_i32();
+  return Value::MakeI32(v < 0 ? WrapI32(0u - v) : v);
 }
 
 // Arithmetic - Int64
 Value Evaluator::EvalAddL(Value a, Value b) {
   a = WidenI32ToI64(a);
   b = WidenI32ToI64(b);
-  return Value::MakeI64(a.as_i64() + b.as_i64());
+  return Value::MakeI64(WrapI64(static_cast<uint64_t>(a.as_i64()) +
+                                static_cast<uint64_t>(b.as_i64())));
 }
 
 Value Evaluator::EvalSubL(Value a, Value b) {
   a = WidenI32ToI64(a);
   b = WidenI32ToI64(b);
-  return Value::MakeI64(a.as_i64() - b.as_i64());
+  return Value::MakeI64(WrapI64(static_cast<uint64_t>(a.as_i64()) -
+                                static_cast<uint64_t>(b.as_i64())));
 }
 
 Value Evaluator::EvalMulL(Value a, Value b) {
   a = WidenI32ToI64(a);
   b = WidenI32ToI64(b);
-  return Value::MakeI64(a.as_i64() * b.as_i64());
+  return Value::MakeI64(WrapI64(static_cast<uint64_t>(a.as_i64()) *
+                                static_cast<uint64_t>(b.as_i64())));
 }
 
 Value Evaluator::EvalDivL(Value a, Value b) {
@@ -68,6 +86,7 @@ Value Evaluator::EvalDivL(Value a, Value b) {
   if (bv == 0) {
     throw EvalException("Division by zero");
   }
+  if (bv == -1) return Value::MakeI64(WrapI64(0ull - a.as_i64()));
   return Value::MakeI64(a.as_i64() / bv);
 }
 
@@ -78,12 +97,88 @@ Value Evaluator::EvalModL(Value a, Value b) {
   if (bv == 0) {
     throw EvalException("Modulo by zero");
   }
+  if (bv == -1) return Value::MakeI64(0);
   return Value::MakeI64(a.as_i64() % bv);
 }
 
 Value Evaluator::EvalAbsL(Value a) {
   a = WidenI32ToI64(a);
-  return Value::MakeI64(std::llabs(a.as_i64()));
+  int64_t v = a.as_i64();
+  return Value::MakeI64(v < 0 ? WrapI64(0ull - v) : v);
+}
+
+// Arithmetic - Float
+Value Evaluator::EvalAddF(Value a, Value b) {
+  return Value::MakeF32(a.as_f32() + b.as_f32());
+}
+
+Value Evaluator::EvalSubF(Value a, Value b) {
+  return Value::MakeF32(a.as_f32() - b.as_f32());
+}
+
+Value Evaluator::EvalMulF(Value a, Value b) {
+  return Value::MakeF32(a.as_f32() * b.as_f32());
+}
+
+Value Evaluator::EvalDivF(Value a, Value b) {
+  return Value::MakeF32(a.as_f32() / b.as_f32());
+}
+
+Value Evaluator::EvalModF(Value a, Value b) {
+  return Value::MakeF32(FloatKernels::ModF(a.as_f32(), b.as_f32()));
+}
+
+Value Evaluator::EvalNegF(Value a) { return Value::MakeF32(-a.as_f32()); }
+
+Value Evaluator::EvalAbsF(Value a) {
+  return Value::MakeF32(std::fabs(a.as_f32()));
+}
+
+Value Evaluator::EvalMinF(Value a, Value b) {
+  return Value::MakeF32(FloatKernels::Min(a.as_f32(), b.as_f32()));
+}
+
+Value Evaluator::EvalMaxF(Value a, Value b) {
+  return Value::MakeF32(FloatKernels::Max(a.as_f32(), b.as_f32()));
+}
+
+// Arithmetic - Double
+Value Evaluator::EvalAddD(Value a, Value b) {
+  return Value::MakeF64(a.as_f64() + b.as_f64());
+}
+
+Value Evaluator::EvalSubD(Value a, Value b) {
+  return Value::MakeF64(a.as_f64() - b.as_f64());
+}
+
+Value Evaluator::EvalMulD(Value a, Value b) {
+  return Value::MakeF64(a.as_f64() * b.as_f64());
+}
+
+Value Evaluator::EvalDivD(Value a, Value b) {
+  return Value::MakeF64(a.as_f64() / b.as_f64());
+}
+
+Value Evaluator::EvalModD(Value a, Value b) {
+  return Value::MakeF64(FloatKernels::ModD(a.as_f64(), b.as_f64()));
+}
+
+Value Evaluator::EvalNegD(Value a) { return Value::MakeF64(-a.as_f64()); }
+
+Value Evaluator::EvalAbsD(Value a) {
+  return Value::MakeF64(std::fabs(a.as_f64()));
+}
+
+Value Evaluator::EvalSqrtD(Value a) {
+  return Value::MakeF64(std::sqrt(a.as_f64()));
+}
+
+Value Evaluator::EvalMinD(Value a, Value b) {
+  return Value::MakeF64(FloatKernels::Min(a.as_f64(), b.as_f64()));
+}
+
+Value Evaluator::EvalMaxD(Value a, Value b) {
+  return Value::MakeF64(FloatKernels::Max(a.as_f64(), b.as_f64()));
 }
 
 // Bitwise - Int32
@@ -209,6 +304,15 @@ Value Evaluator::EvalCmpNeP(Value a, Value b) {
   return Value::MakeBool(a.as_ref() != b.as_ref());
 }
 
+// Comparison - Float
+Value Evaluator::EvalCmpF3(Value a, Value b) {
+  return Value::MakeI32(FloatKernels::CmpF3(a.as_f32(), b.as_f32()));
+}
+
+Value Evaluator::EvalCmpD3(Value a, Value b) {
+  return Value::MakeI32(FloatKernels::CmpD3(a.as_f64(), b.as_f64()));
+}
+
 // Conversions
 Value Evaluator::EvalConvI2L(Value a) {
   return Value::MakeI64(static_cast<int64_t>(a.as_i32()));
@@ -219,6 +323,65 @@ Value Evaluator::EvalConvL2I(Value a) {
   return Value::MakeI32(static_cast<int32_t>(a.as_i64()));
 }
 
+Value Evaluator::EvalConvI2F(Value a) {
+  return Value::MakeF32(static_cast<float>(a.as_i32()));
+}
+
+Value Evaluator::EvalConvI2D(Value a) {
+  return Value::MakeF64(static_cast<double>(a.as_i32()));
+}
+
+Value Evaluator::EvalConvL2F(Value a) {
+  a = WidenI32ToI64(a);
+  return Value::MakeF32(static_cast<float>(a.as_i64()));
+}
+
+Value Evaluator::EvalConvL2D(Value a) {
+  a = WidenI32ToI64(a);
+  return Value::MakeF64(static_cast<double>(a.as_i64()));
+}
+
+Value Evaluator::EvalConvF2I(Value a) {
+  return Value::MakeI32(FloatKernels::F2I(a.as_f32()));
+}
+
+Value Evaluator::EvalConvF2L(Value a) {
+  return Value::MakeI64(FloatKernels::F2L(a.as_f32()));
+}
+
+Value Evaluator::EvalConvD2I(Value a) {
+  return Value::MakeI32(FloatKernels::D2I(a.as_f64()));
+}
+
+Value Evaluator::EvalConvD2L(Value a) {
+  return Value::MakeI64(FloatKernels::D2L(a.as_f64()));
+}
+
+Value Evaluator::EvalConvF2D(Value a) {
+  return Value::MakeF64(static_cast<double>(a.as_f32()));
+}
+
+Value Evaluator::EvalConvD2F(Value a) {
+  return Value::MakeF32(static_cast<float>(a.as_f64()));
+}
+
+Value Evaluator::EvalMoveF2I(Value a) {
+  return Value::MakeI32(FloatKernels::MoveF2I(a.as_f32()));
+}
+
+Value Evaluator::EvalMoveI2F(Value a) {
+  return Value::MakeF32(FloatKernels::MoveI2F(a.as_i32()));
+}
+
+Value Evaluator::EvalMoveD2L(Value a) {
+  return Value::MakeI64(FloatKernels::MoveD2L(a.as_f64()));
+}
+
+Value Evaluator::EvalMoveL2D(Value a) {
+  a = WidenI32ToI64(a);
+  return Value::MakeF64(FloatKernels::MoveL2D(a.as_i64()));
+}
+
 // Conditional move
 Value Evaluator::EvalCMoveI(Value cond, Value true_val, Value false_val) {
   return cond.as_bool() ? true_val : false_val;
@@ -232,4 +395,12 @@ Value Evaluator::EvalCMoveP(Value cond, Value true_val, Value false_val) {
   return cond.as_bool() ? true_val : false_val;
 }
 
+Value Evaluator::EvalCMoveF(Value cond, Value true_val, Value false_val) {
+  return cond.as_bool() ? true_val : false_val;
+}
+
+Value Evaluator::EvalCMoveD(Value cond, Value true_val, Value false_val) {
+  return cond.as_bool() ? true_val : false_val;
+}
+
 }  // namespace sun
@@ -0,0 +1,93 @@
+#include "suntv/interp/float_kernels.hpp"
+
+#include <stdexcept>
+
+namespace sun {
+
+namespace {
+
+void CheckSizes(size_t a, size_t b, size_t out) {
+  if (a != out || b != out) {
+    throw std::invalid_argument("FloatKernels: span length mismatch");
+  }
+}
+
+// Loops are kept free of calls and early exits so they vectorize
+template <typename T, typename R, typename Op>
+void Binary(std::span<const T> a, std::span<const T> b, std::span<R> out,
+            Op op) {
+  CheckSizes(a.size(), b.size(), out.size());
+  const T* pa = a.data();
+  const T* pb = b.data();
+  R* po = out.data();
+  for (size_t i = 0, n = out.size(); i < n; ++i) po[i] = op(pa[i], pb[i]);
+}
+
+template <typename T, typename R, typename Op>
+void Unary(std::span<const T> in, std::span<R> out, Op op) {
+  CheckSizes(in.size(), in.size(), out.size());
+  const T* pi = in.data();
+  R* po = out.data();
+  for (size_t i = 0, n = out.size(); i < n; ++i) po[i] = op(pi[i]);
+}
+
+}  // namespace
+
+void FloatKernels::AddF(std::span<const float> a, std::span<const float> b,
+                        std::span<float> out) {
+  Binary(a, b, out, [](float x, float y) { return x + y; });
+}
+
+void FloatKernels::SubF(std::span<const float> a, std::span<const float> b,
+                        std::span<float> out) {
+  Binary(a, b, out, [](float x, float y) { return x - y; });
+}
+
+void FloatKernels::MulF(std::span<const float> a, std::span<const float> b,
+                        std::span<float> out) {
+  Binary(a, b, out, [](float x, float y) { return x * y; });
+}
+
+void FloatKernels::DivF(std::span<const float> a, std::span<const float> b,
+                        std::span<float> out) {
+  Binary(a, b, out, [](float x, float y) { return x / y; });
+}
+
+void FloatKernels::AddD(std::span<const double> a, std::span<const double> b,
+                        std::span<double> out) {
+  Binary(a, b, out, [](double x, double y) { return x + y; });
+}
+
+void FloatKernels::SubD(std::span<const double> a, std::span<const double> b,
+                        std::span<double> out) {
+  Binary(a, b, out, [](double x, double y) { return x - y; });
+}
+
+void FloatKernels::MulD(std::span<const double> a, std::span<const double> b,
+                        std::span<double> out) {
+  Binary(a, b, out, [](double x, double y) { return x * y; });
+}
+
+void FloatKernels::DivD(std::span<const double> a, std::span<const double> b,
+                        std::span<double> out) {
+  Binary(a, b, out, [](double x, double y) { return x / y; });
+}
+
+void FloatKernels::CmpD3(std::span<const double> a, std::span<const double> b,
+                         std::span<int32_t> out) {
+  Binary(a, b, out, [](double x, double y) { return CmpD3(x, y); });
+}
+
+void FloatKernels::D2I(std::span<const double> in, std::span<int32_t> out) {
+  Unary(in, out, [](double x) { return D2I(x); });
+}
+
+void FloatKernels::D2L(std::span<const double> in, std::span<int64_t> out) {
+  Unary(in, out, [](double x) { return D2L(x); });
+}
+
+void FloatKernels::F2I(std::span<const float> in, std::span<int32_t> out) {
+  Unary(in, out, [](float x) { return F2I(x); });
+}
+
+}  // namespace sun
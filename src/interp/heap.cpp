@@ -1,23 +1,80 @@
 #include "suntv/interp/heap.hpp"
 
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 
+#include "suntv/util/memory_usage.hpp"
+
 namespace sun {
 
+void ConcreteHeap::Reserve(size_t bytes) {
+  if (limit_ != 0 && bytes_ + bytes > limit_) {
+    throw MemoryLimitExceeded("Heap limit of " + std::to_string(limit_) +
+                              " bytes exceeded (" + std::to_string(bytes_) +
+                              " in use, " + std::to_string(bytes) +
+                              " requested)");
+  }
+  bytes_ += bytes;
+}
+
+size_t ConcreteHeap::FieldBytes(const FieldID& field) const {
+  return memory::TreeNodeBytes<decltype(fields_)>() +
+         memory::StringBytes(field);
+}
+
+size_t ConcreteHeap::ArrayBytes(int32_t length, Value::Kind elem) const {
+  size_t bytes = memory::TreeNodeBytes<decltype(array_lengths_)>() +
+                 memory::TreeNodeBytes<decltype(array_kinds_)>();
+  switch (elem) {
+    case Value::Kind::kF32:
+      return bytes + memory::TreeNodeBytes<decltype(float_arrays_)>() +
+             length * sizeof(float);
+    case Value::Kind::kF64:
+      return bytes + memory::TreeNodeBytes<decltype(double_arrays_)>() +
+             length * sizeof(double);
+    default:
+      return bytes + memory::TreeNodeBytes<decltype(arrays_)>() +
+             length * sizeof(Value);
+  }
+}
+
 Ref ConcreteHeap::AllocateObject() {
   Ref ref = next_ref_++;
   // Objects have no default initialization in this model
   return ref;
 }
 
-Ref ConcreteHeap::AllocateArray(int32_t length) {
+Ref ConcreteHeap::AllocateArray(int32_t length, Value::Kind elem) {
   if (length < 0) {
     throw std::runtime_error("Negative array length");
   }
+  Reserve(ArrayBytes(length, elem));
   Ref ref = next_ref_++;
-  arrays_[ref] = std::vector<Value>(length, Value::MakeI32(0));  // Default init
+  // Default init; +0.0 for float arrays
+  switch (elem) {
+    case Value::Kind::kF32:
+      float_arrays_[ref] = std::vector<float>(length, 0.0f);
+      break;
+    case Value::Kind::kF64:
+      double_arrays_[ref] = std::vector<double>(length, 0.0);
+      break;
+    case Value::Kind::kI64:
+      arrays_[ref] = std::vector<Value>(length, Value::MakeI64(0));
+      break;
+    case Value::Kind::kRef:
+    case Value::Kind::kNull:
+      arrays_[ref] = std::vector<Value>(length, Value::MakeNull());
+      break;
+    case Value::Kind::kBool:
+      arrays_[ref] = std::vector<Value>(length, Value::MakeBool(false));
+      break;
+    default:
+      arrays_[ref] = std::vector<Value>(length, Value::MakeI32(0));
+      break;
+  }
   array_lengths_[ref] = length;
+  array_kinds_[ref] = elem;
   return ref;
 }
 
@@ -33,29 +90,49 @@ Value ConcreteHeap::ReadField(Ref obj, const FieldID& field) const {
 
 void ConcreteHeap::WriteField(Ref obj, const FieldID& field, Value val) {
   auto key = std::make_pair(obj, field);
-  fields_[key] = val;
+  auto it = fields_.lower_bound(key);
+  if (it != fields_.end() && it->first == key) {
+    it->second = val;
+    return;
+  }
+  Reserve(FieldBytes(field));
+  fields_.emplace_hint(it, std::move(key), val);
 }
 
 Value ConcreteHeap::ReadArray(Ref arr, int32_t index) const {
-  auto it = arrays_.find(arr);
-  if (it == arrays_.end()) {
-    throw std::runtime_error("Invalid array reference");
-  }
-  if (index < 0 || index >= static_cast<int32_t>(it->second.size())) {
+  if (index < 0 || index >= ArrayLength(arr)) {
     throw std::runtime_error("Array index out of bounds");
   }
-  return it->second[index];
+  if (auto f = float_arrays_.find(arr); f != float_arrays_.end()) {
+    return Value::MakeF32(f->second[index]);
+  }
+  if (auto d = double_arrays_.find(arr); d != double_arrays_.end()) {
+    return Value::MakeF64(d->second[index]);
+  }
+  return arrays_.at(arr)[index];
 }
 
 void ConcreteHeap::WriteArray(Ref arr, int32_t index, Value val) {
-  auto it = arrays_.find(arr);
-  if (it == arrays_.end()) {
-    throw std::runtime_error("Invalid array reference");
-  }
-  if (index < 0 || index >= static_cast<int32_t>(it->second.size())) {
+  if (index < 0 || index >= ArrayLength(arr)) {
     throw std::runtime_error("Array index out of bounds");
   }
-  it->second[index] = val;
+  if (auto f = float_arrays_.find(arr); f != float_arrays_.end()) {
+    if (!val.is_f32()) {
+      throw std::runtime_error("Array store of " + val.ToString() +
+                               " into float array");
+    }
+    f->second[index] = val.as_f32();
+    return;
+  }
+  if (auto d = double_arrays_.find(arr); d != double_arrays_.end()) {
+    if (!val.is_f64()) {
+      throw std::runtime_error("Array store of " + val.ToString() +
+                               " into double array");
+    }
+    d->second[index] = val.as_f64();
+    return;
+  }
+  arrays_.at(arr)[index] = val;
 }
 
 int32_t ConcreteHeap::ArrayLength(Ref arr) const {
@@ -66,14 +143,53 @@ int32_t ConcreteHeap::ArrayLength(Ref arr) const {
   return it->second;
 }
 
-std::vector<Value> ConcreteHeap::GetArrayContents(Ref arr) const {
-  auto it = arrays_.find(arr);
-  if (it == arrays_.end()) {
+Value::Kind ConcreteHeap::ArrayElementKind(Ref arr) const {
+  auto it = array_kinds_.find(arr);
+  if (it == array_kinds_.end()) {
     throw std::runtime_error("Invalid array reference");
   }
   return it->second;
 }
 
+std::span<float> ConcreteHeap::FloatArrayData(Ref arr) {
+  auto it = float_arrays_.find(arr);
+  if (it == float_arrays_.end()) {
+    throw std::runtime_error("Not a float array");
+  }
+  return it->second;
+}
+
+std::span<double> ConcreteHeap::DoubleArrayData(Ref arr) {
+  auto it = double_arrays_.find(arr);
+  if (it == double_arrays_.end()) {
+    throw std::runtime_error("Not a double array");
+  }
+  return it->second;
+}
+
+std::vector<Value> ConcreteHeap::GetArrayContents(Ref arr) const {
+  std::vector<Value> contents;
+  int32_t length = ArrayLength(arr);
+  contents.reserve(length);
+  for (int32_t i = 0; i < length; ++i) {
+    contents.push_back(ReadArray(arr, i));
+  }
+  return contents;
+}
+
+HeapMemory ConcreteHeap::MemoryUsage() const {
+  HeapMemory m;
+  m.arrays = array_lengths_.size();
+  m.objects = static_cast<size_t>(next_ref_ - 1) - m.arrays;
+  for (const auto& [key, val] : fields_) {
+    m.field_bytes += FieldBytes(key.second);
+  }
+  for (const auto& [ref, length] : array_lengths_) {
+    m.array_bytes += ArrayBytes(length, array_kinds_.at(ref));
+  }
+  return m;
+}
+
 std::string ConcreteHeap::Dump() const {
   std::ostringstream oss;
   oss << "=== Heap Dump ===" << std::endl;
@@ -87,15 +203,15 @@ std::string ConcreteHeap::Dump() const {
     }
   }
 
-  if (!arrays_.empty()) {
+  if (!array_lengths_.empty()) {
     oss << "Arrays:" << std::endl;
-    for (const auto& [ref, arr] : arrays_) {
-      oss << "  ref:" << ref << "[" << array_lengths_.at(ref) << "]";
-      if (!arr.empty()) {
+    for (const auto& [ref, length] : array_lengths_) {
+      oss << "  ref:" << ref << "[" << length << "]";
+      if (length > 0) {
         oss << " = {";
-        for (size_t i = 0; i < arr.size(); ++i) {
+        for (int32_t i = 0; i < length; ++i) {
           if (i > 0) oss << ", ";
-          oss << arr[i].ToString();
+          oss << ReadArray(ref, i).ToString();
         }
         oss << "}";
       }
@@ -107,4 +223,93 @@ std::string ConcreteHeap::Dump() const {
   return oss.str();
 }
 
+std::vector<Ref> ConcreteHeap::Successors(Ref ref) const {
+  std::vector<Ref> out;
+  for (auto it = fields_.lower_bound({ref, FieldID()});
+       it != fields_.end() && it->first.first == ref; ++it) {
+    if (it->second.is_ref()) out.push_back(it->second.as_ref());
+  }
+  if (auto it = arrays_.find(ref); it != arrays_.end()) {
+    for (const Value& v : it->second) {
+      if (v.is_ref()) out.push_back(v.as_ref());
+    }
+  }
+  return out;
+}
+
+std::string ConcreteHeap::Contents(Ref ref,
+                                   const std::map<Ref, Ref>& number) const {
+  auto show = [&](const Value& v) {
+    if (!v.is_ref()) return v.ToString();
+    auto it = number.find(v.as_ref());
+    return it == number.end() ? std::string("?")
+                              : "@" + std::to_string(it->second);
+  };
+  if (auto it = array_lengths_.find(ref); it != array_lengths_.end()) {
+    std::string entry = "array[" + std::to_string(it->second) + "] = {";
+    for (int32_t i = 0; i < it->second; ++i) {
+      entry += (i > 0 ? ", " : "") + show(ReadArray(ref, i));
+    }
+    return entry + "}";
+  }
+  std::string entry = "object {";
+  for (auto it = fields_.lower_bound({ref, FieldID()});
+       it != fields_.end() && it->first.first == ref; ++it) {
+    entry += " ." + it->first.second + " = " + show(it->second);
+  }
+  return entry + " }";
+}
+
+std::map<Ref, Ref> ConcreteHeap::CanonicalNumbering(
+    std::span<const Value> roots) const {
+  std::map<Ref, Ref> number;
+  std::vector<Ref> queue;
+  auto reach = [&](Ref from) {
+    if (!number.emplace(from, static_cast<Ref>(number.size() + 1)).second) {
+      return;
+    }
+    queue.push_back(from);
+    for (size_t i = queue.size() - 1; i < queue.size(); ++i) {
+      for (Ref next : Successors(queue[i])) {
+        if (number.emplace(next, static_cast<Ref>(number.size() + 1))
+                .second) {
+          queue.push_back(next);
+        }
+      }
+    }
+  };
+  for (const Value& root : roots) {
+    if (root.is_ref()) reach(root.as_ref());
+  }
+
+  // Unreached objects and arrays: no root tells them apart, so order them
+  // by what they hold
+  std::vector<std::pair<std::string, Ref>> rest;
+  for (const auto& [key, val] : fields_) {
+    if (!number.count(key.first) &&
+        (rest.empty() || rest.back().second != key.first)) {
+      rest.emplace_back(Contents(key.first, number), key.first);
+    }
+  }
+  for (const auto& [ref, length] : array_lengths_) {
+    if (!number.count(ref)) rest.emplace_back(Contents(ref, number), ref);
+  }
+  std::sort(rest.begin(), rest.end());
+  for (const auto& [contents, ref] : rest) reach(ref);
+  return number;
+}
+
+std::string ConcreteHeap::CanonicalDump(std::span<const Value> roots) const {
+  const std::map<Ref, Ref> number = CanonicalNumbering(roots);
+  std::vector<Ref> order(number.size());
+  for (const auto& [ref, n] : number) order[n - 1] = ref;
+
+  std::ostringstream oss;
+  oss << "allocated " << next_ref_ - 1 << std::endl;
+  for (size_t i = 0; i < order.size(); ++i) {
+    oss << "@" << i + 1 << " " << Contents(order[i], number) << std::endl;
+  }
+  return oss.str();
+}
+
 }  // namespace sun
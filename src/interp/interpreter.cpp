@@ -1,15 +1,23 @@
 #include "suntv/interp/interpreter.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <queue>
 #include <set>
+#include <string_view>
+#include <utility>
 
+#include "suntv/ir/constant_pool.hpp"
 #include "suntv/ir/graph.hpp"
 #include "suntv/ir/node.hpp"
 #include "suntv/ir/opcode.hpp"
+#include "suntv/ir/schedule.hpp"
+#include "suntv/ir/verifier.hpp"
 #include "suntv/util/logging.hpp"
+#include "suntv/util/memory_usage.hpp"
 
 namespace sun {
 
@@ -23,8 +31,11 @@ static bool IsNonDataTypeString(const std::string& type) {
 static bool IsDataTypeString(const std::string& type) {
   // Heuristic for scalar data values used in tests/fixtures:
   // int:, long:, ptr:, etc. have trailing ':'; exclude known non-data kinds.
+  // Non-constant floats are the bare "float"/"double" (constants are
+  // "ftcon:..."/"dblcon:...").
   if (type.empty()) return false;
   if (IsNonDataTypeString(type)) return false;
+  if (type == "float" || type == "double") return true;
   return type.back() == ':';
 }
 
@@ -45,88 +56,95 @@ static bool IsDataPhiNode(const Node* n) {
   return IsDataTypeString(type);
 }
 
+// Stores the first value inputs of n (see Node::value_inputs) in `out`
+// without building a vector. Returns how many were stored, at most `max`.
+static size_t GetValueInputs(const Node* n, const Node** out, size_t max) {
+  size_t count = 0;
+  for (size_t i = n->value_inputs_begin(); i < n->num_inputs() && count < max;
+       ++i) {
+    if (const Node* in = n->input(i)) out[count++] = in;
+  }
+  return count;
+}
+
+// First value input of n, or null if it has none; for a Phi its first value
+static const Node* FirstValueInput(const Node* n) {
+  const Node* in = nullptr;
+  GetValueInputs(n, &in, 1);
+  return in;
+}
+
 void Interpreter::UpdateRegionPhis(const Node* region, bool is_back_edge) {
-  if (!region || region->opcode() != Opcode::kRegion) {
+  if (!region || !IsRegion(region->opcode())) {
     return;
   }
+  static const std::vector<const Node*> kNoPhis;
+  auto it_phis = region_phis_.find(region);
+  const std::vector<const Node*>& phis =
+      it_phis != region_phis_.end() ? it_phis->second : kNoPhis;
 
   auto prune_cache_keep_seeds = [&]() {
     // After (re)seeding Phis, cached derived computations can become stale once
     // Phi values change. Keep only constants/parameters and Phis.
-    auto it = value_cache_.begin();
-    while (it != value_cache_.end()) {
-      const Opcode vop = it->first->opcode();
+    for (const Node* n : graph_.nodes()) {
+      const Opcode vop = n->opcode();
       const bool keep =
           (vop == Opcode::kConI || vop == Opcode::kConL ||
-           vop == Opcode::kConP || vop == Opcode::kParm || vop == Opcode::kPhi);
-      if (keep) {
-        ++it;
-      } else {
-        it = value_cache_.erase(it);
-      }
+           vop == Opcode::kConP || vop == Opcode::kConF ||
+           vop == Opcode::kConD || vop == Opcode::kParm || vop == Opcode::kPhi);
+      if (!keep) value_cache_.erase(n);
     }
   };
 
   // Snapshot old Phi values (from previous iteration) so that back-edge updates
   // don't recursively depend on the new values being computed.
   if (is_back_edge) {
-    phi_old_values_.clear();
+    phi_old_values_.Clear();
     in_phi_update_ = true;
     updating_region_ = region;
     updating_phi_ = nullptr;
-    for (Node* n : graph_.nodes()) {
-      if (n->opcode() != Opcode::kPhi) continue;
-      if (n->region_input() != region) continue;
-      if (!IsDataPhiNode(n)) continue;
-      auto it = value_cache_.find(n);
-      if (it != value_cache_.end()) {
-        phi_old_values_[n] = it->second;
+    for (const Node* n : phis) {
+      if (const Value* v = value_cache_.find(n)) {
+        phi_old_values_[n] = *v;
       }
     }
   }
 
   // For back-edges, clear cached computed values so future evaluation uses the
-  // updated Phi seeds. We keep constants/parameters.
+  // updated Phi seeds. We keep constants/parameters, and Phis of other
+  // Regions: those are only read where their Region dominates, which
+  // refreshes them first (e.g. an inner loop's final values feeding the
+  // outer loop's back edge).
   if (is_back_edge) {
-    auto it = value_cache_.begin();
-    while (it != value_cache_.end()) {
-      Opcode vop = it->first->opcode();
-      if (vop == Opcode::kConI || vop == Opcode::kConL ||
-          vop == Opcode::kConP || vop == Opcode::kParm) {
-        ++it;
-      } else {
-        it = value_cache_.erase(it);
+    for (const Node* n : graph_.nodes()) {
+      Opcode vop = n->opcode();
+      if (!(vop == Opcode::kConI || vop == Opcode::kConL ||
+            vop == Opcode::kConP || vop == Opcode::kConF ||
+            vop == Opcode::kConD || vop == Opcode::kParm ||
+            (vop == Opcode::kPhi && n->region_input() != region))) {
+        value_cache_.erase(n);
       }
     }
   }
 
-  // Collect data Phi nodes for this Region.
-  std::vector<const Node*> phis;
-  for (Node* n : graph_.nodes()) {
-    if (n->opcode() != Opcode::kPhi) continue;
-    if (n->region_input() != region) continue;
-    if (!IsDataPhiNode(n)) continue;
-    phis.push_back(n);
-  }
-
   // Recompute Phi values without letting intermediate cached computations leak
   // out of the update.
-  std::map<const Node*, Value> new_phi_values;
-  Logger::Info("  UpdateRegionPhis: evaluating " + std::to_string(phis.size()) +
-               " Phis");
+  const size_t base = pending_phi_values_.size();
+  Logger::Info("  UpdateRegionPhis: evaluating ", phis.size(), " Phis");
   for (const Node* phi : phis) {
     updating_phi_ = phi;
-    Logger::Info("    Evaluating Phi node " + std::to_string(phi->id()));
-    new_phi_values[phi] = EvalPhi(phi);
-    Logger::Info("    Phi node " + std::to_string(phi->id()) + " evaluated");
+    Logger::Info("    Evaluating Phi node ", phi->id());
+    pending_phi_values_.push_back(EvalPhi(phi));
+    Logger::Info("    Phi node ", phi->id(), " evaluated");
   }
   updating_phi_ = nullptr;
   Logger::Info("  UpdateRegionPhis: all Phis evaluated");
 
   // Install new Phi seeds.
-  for (const auto& [phi, v] : new_phi_values) {
-    value_cache_[phi] = v;
+  for (size_t i = 0; i < phis.size(); ++i) {
+    value_cache_[phis[i]] = pending_phi_values_[base + i];
   }
+  pending_phi_values_.resize(base);
 
   // Ensure no stale derived values remain cached.
   prune_cache_keep_seeds();
@@ -134,9 +152,36 @@ void Interpreter::UpdateRegionPhis(const Node* region, bool is_back_edge) {
   if (is_back_edge) {
     in_phi_update_ = false;
     updating_region_ = nullptr;
-    phi_old_values_.clear();
-    phi_update_active_.clear();
+    phi_old_values_.Clear();
+    phi_update_active_.Clear();
+  }
+}
+
+static bool PropIsTrue(const Node* n, const std::string& key) {
+  if (!n || !n->has_prop(key)) return false;
+  const Property p = n->prop(key);
+  if (std::holds_alternative<bool>(p)) return std::get<bool>(p);
+  if (std::holds_alternative<int32_t>(p)) return std::get<int32_t>(p) != 0;
+  if (std::holds_alternative<int64_t>(p)) return std::get<int64_t>(p) != 0;
+  if (std::holds_alternative<std::string>(p)) {
+    const std::string& s = std::get<std::string>(p);
+    return s == "true" || s == "True" || s == "1";
+  }
+  return false;
+}
+
+static std::optional<int64_t> PropAsI64(const Node* n, const std::string& key) {
+  if (!n || !n->has_prop(key)) return std::nullopt;
+  const Property p = n->prop(key);
+  if (std::holds_alternative<int32_t>(p)) return std::get<int32_t>(p);
+  if (std::holds_alternative<int64_t>(p)) return std::get<int64_t>(p);
+  if (std::holds_alternative<std::string>(p)) {
+    const std::string& s = std::get<std::string>(p);
+    char* end = nullptr;
+    long long v = std::strtoll(s.c_str(), &end, 10);
+    if (end != s.c_str() && *end == '\0') return static_cast<int64_t>(v);
   }
+  return std::nullopt;
 }
 
 // Helper functions to categorize opcodes
@@ -148,6 +193,56 @@ static bool IsArithmetic(Opcode op) {
          op == Opcode::kConvI2L || op == Opcode::kConvL2I;
 }
 
+static bool IsFloatArithmetic(Opcode op) {
+  switch (op) {
+    case Opcode::kAddF:
+    case Opcode::kSubF:
+    case Opcode::kMulF:
+    case Opcode::kDivF:
+    case Opcode::kModF:
+    case Opcode::kMinF:
+    case Opcode::kMaxF:
+    case Opcode::kAddD:
+    case Opcode::kSubD:
+    case Opcode::kMulD:
+    case Opcode::kDivD:
+    case Opcode::kModD:
+    case Opcode::kMinD:
+    case Opcode::kMaxD:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Single-operand float operations, including conversions to and from float
+static bool IsFloatUnary(Opcode op) {
+  switch (op) {
+    case Opcode::kNegF:
+    case Opcode::kAbsF:
+    case Opcode::kNegD:
+    case Opcode::kAbsD:
+    case Opcode::kSqrtD:
+    case Opcode::kConvI2F:
+    case Opcode::kConvI2D:
+    case Opcode::kConvL2F:
+    case Opcode::kConvL2D:
+    case Opcode::kConvF2I:
+    case Opcode::kConvF2L:
+    case Opcode::kConvD2I:
+    case Opcode::kConvD2L:
+    case Opcode::kConvF2D:
+    case Opcode::kConvD2F:
+    case Opcode::kMoveF2I:
+    case Opcode::kMoveI2F:
+    case Opcode::kMoveD2L:
+    case Opcode::kMoveL2D:
+      return true;
+    default:
+      return false;
+  }
+}
+
 static bool IsBitwise(Opcode op) {
   return op == Opcode::kAndI || op == Opcode::kOrI || op == Opcode::kXorI ||
          op == Opcode::kLShiftI || op == Opcode::kRShiftI ||
@@ -158,10 +253,34 @@ static bool IsBitwise(Opcode op) {
 
 static bool IsComparison(Opcode op) {
   return op == Opcode::kCmpI || op == Opcode::kCmpL || op == Opcode::kCmpP ||
-         op == Opcode::kCmpU || op == Opcode::kCmpUL;
+         op == Opcode::kCmpU || op == Opcode::kCmpUL || op == Opcode::kCmpF ||
+         op == Opcode::kCmpD || op == Opcode::kCmpF3 || op == Opcode::kCmpD3;
 }
 
-Interpreter::Interpreter(const Graph& g) : graph_(g) {}
+// Users of a control node that control can flow to
+static bool IsControlCandidate(const Node* s) {
+  if (!s) return false;
+  const Opcode op = s->opcode();
+  if (IsRegion(op) || IsLoopEnd(op) || op == Opcode::kIf ||
+      op == Opcode::kIfTrue ||
+      op == Opcode::kIfFalse || op == Opcode::kGoto ||
+      op == Opcode::kReturn || op == Opcode::kHalt ||
+      op == Opcode::kSafePoint || op == Opcode::kParsePredicate ||
+      op == Opcode::kCallStaticJava || op == Opcode::kProj ||
+      op == Opcode::kRangeCheck) {
+    return true;
+  }
+  if (op == Opcode::kParm && s->has_prop("type")) {
+    const Property p = s->prop("type");
+    if (std::holds_alternative<std::string>(p)) {
+      return std::get<std::string>(p) == "control";
+    }
+  }
+  return false;
+}
+
+Interpreter::Interpreter(const Graph& g, MethodRegistry* registry)
+    : graph_(g), registry_(registry) {}
 
 void Interpreter::BuildControlSuccessors() {
   control_successors_.clear();
@@ -176,13 +295,13 @@ void Interpreter::BuildControlSuccessors() {
         (op == Opcode::kIf || op == Opcode::kIfTrue || op == Opcode::kIfFalse ||
          op == Opcode::kGoto || op == Opcode::kReturn || op == Opcode::kHalt ||
          op == Opcode::kSafePoint || op == Opcode::kParsePredicate ||
-         op == Opcode::kCallStaticJava || op == Opcode::kRegion ||
+         op == Opcode::kCallStaticJava || IsRegion(op) || IsLoopEnd(op) ||
          op == Opcode::kProj || op == Opcode::kParm ||
          op == Opcode::kRangeCheck);
     if (!is_control_like) continue;
 
-    // Region control predecessors can be at any index.
-    if (op == Opcode::kRegion) {
+    // Region (and loop head) control predecessors can be at any index.
+    if (IsRegion(op)) {
       for (size_t i = 0; i < n->num_inputs(); ++i) {
         const Node* pred = n->input(i);
         if (!pred) continue;
@@ -209,39 +328,156 @@ void Interpreter::BuildControlSuccessors() {
   }
 }
 
+void Interpreter::BuildCountedLoops() {
+  counted_loops_.clear();
+
+  std::vector<CountedLoopInfo> loops = FindCountedLoops(graph_);
+  if (loops.empty()) return;
+
+  // Data uses of every node, for the per-trip invalidation sets
+  std::map<const Node*, std::vector<const Node*>> uses;
+  for (Node* n : graph_.nodes()) {
+    if (!n) continue;
+    for (size_t i = 0; i < n->num_inputs(); ++i) {
+      if (n->input(i)) uses[n->input(i)].push_back(n);
+    }
+  }
+
+  for (CountedLoopInfo& info : loops) {
+    if (!info.straight_line()) continue;
+
+    CountedLoopPlan plan;
+    bool eligible = true;
+    for (const Node* phi : info.phis) {
+      // Memory Phis mean the body has effects we must sequence by stepping
+      if (!IsDataPhiNode(phi) || phi->num_inputs() < 3 || !phi->input(2)) {
+        eligible = false;
+        break;
+      }
+      plan.phis.push_back(phi);
+      plan.next.push_back(phi->input(2));
+    }
+    if (!eligible) continue;
+
+    // Everything computed from the Phis without crossing another merge or a
+    // control node changes from one trip to the next.
+    std::set<const Node*> seen(plan.phis.begin(), plan.phis.end());
+    std::vector<const Node*> work(plan.phis.begin(), plan.phis.end());
+    while (!work.empty()) {
+      const Node* n = work.back();
+      work.pop_back();
+      auto it = uses.find(n);
+      if (it == uses.end()) continue;
+      for (const Node* u : it->second) {
+        const Opcode op = u->opcode();
+        if (op == Opcode::kPhi || IsControl(op) || !seen.insert(u).second) {
+          continue;
+        }
+        plan.variant.push_back(u);
+        work.push_back(u);
+      }
+    }
+
+    plan.info = std::move(info);
+    const Node* head = plan.info.head;
+    counted_loops_.emplace(head, std::move(plan));
+  }
+}
+
+const Node* Interpreter::RunCountedLoop(const CountedLoopPlan& loop) {
+  const Node* head = loop.info.head;
+  Logger::Info("  Counted loop ", head->id(), " (stride ", loop.info.stride,
+               ")");
+
+  // Seed the Phis from the entry edge recorded by FindControlSuccessor
+  UpdateRegionPhis(head, /*is_back_edge=*/false);
+
+  const size_t base = pending_phi_values_.size();
+  pending_phi_values_.resize(base + loop.phis.size());
+  for (int64_t trip = 0;; ++trip) {
+    if (trip >= kMaxCountedLoopTrips) {
+      throw std::runtime_error("Counted loop exceeded maximum trips (" +
+                               std::to_string(kMaxCountedLoopTrips) + ")");
+    }
+
+    Value cond = EvalNode(loop.info.test);
+    bool stay = false;
+    if (cond.is_bool()) {
+      stay = cond.as_bool();
+    } else if (cond.is_i32()) {
+      stay = cond.as_i32() != 0;
+    } else {
+      throw std::runtime_error("Loop end condition must be boolean or int");
+    }
+    if (!stay) {
+      Logger::Info("  Counted loop ", head->id(), " exits after ", trip,
+                   " back edge(s)");
+      pending_phi_values_.resize(base);
+      return loop.info.exit;
+    }
+
+    // Back edge: all next values are read from this trip's state before any
+    // Phi is overwritten.
+    for (size_t i = 0; i < loop.phis.size(); ++i) {
+      pending_phi_values_[base + i] = EvalNode(loop.next[i]);
+    }
+    for (const Node* n : loop.variant) {
+      value_cache_.erase(n);
+    }
+    for (size_t i = 0; i < loop.phis.size(); ++i) {
+      value_cache_[loop.phis[i]] = pending_phi_values_[base + i];
+    }
+    region_predecessor_[head] = loop.info.back_control;
+  }
+}
+
 Outcome Interpreter::Execute(const std::vector<Value>& inputs) {
   return ExecuteWithHeap(inputs, ConcreteHeap());
 }
 
 Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
                                      const ConcreteHeap& initial_heap) {
-  Logger::Info("ExecuteWithHeap: starting");
-  value_cache_.clear();
-  region_predecessor_.clear();
-  loop_iterations_.clear();
   heap_ = initial_heap;  // Use provided heap instead of resetting
-  eval_active_.clear();
-  phi_eval_stack_.clear();
-  phi_update_active_.clear();
-  phi_old_values_.clear();
-  memory_chain_visited_.clear();
-  in_phi_update_ = false;
-  updating_region_ = nullptr;
-  updating_phi_ = nullptr;
+  if (heap_limit_ != 0) heap_.set_limit(heap_limit_);
+  Outcome outcome = Run(inputs);
+  outcome.heap = heap_;
+  return outcome;
+}
 
-  Logger::Info("ExecuteWithHeap: calling BuildControlSuccessors");
-  BuildControlSuccessors();
-  Logger::Info("ExecuteWithHeap: BuildControlSuccessors done");
+InterpreterMemory Interpreter::MemoryUsage() const {
+  InterpreterMemory m;
+  m.prepared = memory::TreeBytes(call_targets_) +
+               memory::TreeBytes(control_successors_) +
+               memory::TreeBytes(counted_loops_) +
+               scheduled_successors_.bytes();
+  for (const auto& [ctrl, succs] : control_successors_) {
+    m.prepared += memory::VectorBytes(succs);
+  }
+  for (const auto& [head, loop] : counted_loops_) {
+    m.prepared += memory::VectorBytes(loop.info.phis) +
+                  memory::VectorBytes(loop.phis) +
+                  memory::VectorBytes(loop.next) +
+                  memory::VectorBytes(loop.variant);
+  }
+  m.prepared += memory::VectorBytes(params_) + memory::TreeBytes(region_phis_);
+  for (const auto& [region, phis] : region_phis_) {
+    m.prepared += memory::VectorBytes(phis);
+  }
+  m.run = value_cache_.bytes() + eval_active_.bytes() +
+          region_predecessor_.bytes() + loop_iterations_.bytes() +
+          phi_old_values_.bytes() + phi_update_active_.bytes() +
+          phi_eval_stack_.bytes() + memory_chain_visited_.bytes() +
+          memory::VectorBytes(pending_phi_values_);
+  m.heap = heap_.MemoryUsage();
+  m.self = sizeof(Interpreter);
+  return m;
+}
 
-  // Cache parameter values first
-  // Get all parameter nodes and filter to data parameters only
-  Logger::Info("ExecuteWithHeap: getting parameter nodes");
-  std::vector<Node*> all_params = graph_.GetParameterNodes();
-  Logger::Info("ExecuteWithHeap: got " + std::to_string(all_params.size()) +
-               " parameter nodes");
-  std::vector<Node*> params;
-
-  for (Node* p : all_params) {
+void Interpreter::BuildParamsAndPhis() {
+  params_.clear();
+  region_phis_.clear();
+
+  for (Node* p : graph_.GetParameterNodes()) {
     // Only include data parameters (skip control, memory, I/O, etc.)
     // Data parameters have types like "int:", "long:", etc.
     if (p->has_prop("type")) {
@@ -251,16 +487,17 @@ Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
           type == "rawptr:" || type == "abIO") {
         continue;
       }
-      // Only include types that end with ':' (int:, long:, etc.)
-      if (type.empty() || type.back() != ':') {
+      // Only include types that end with ':' (int:, long:, etc.) and floats;
+      // this skips the "half" slot after a long/double parameter
+      if (!IsDataTypeString(type)) {
         continue;
       }
     }
-    params.push_back(p);
+    params_.push_back(p);
   }
 
   // Sort parameters by their index
-  std::sort(params.begin(), params.end(), [](Node* a, Node* b) {
+  std::sort(params_.begin(), params_.end(), [](const Node* a, const Node* b) {
     // Try to get index from property first
     if (a->has_prop("index") && b->has_prop("index")) {
       return std::get<int32_t>(a->prop("index")) <
@@ -268,7 +505,7 @@ Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
     }
 
     // Try to extract from dump_spec (e.g., "Parm0: int")
-    auto get_index = [](Node* n) -> int32_t {
+    auto get_index = [](const Node* n) -> int32_t {
       if (n->has_prop("dump_spec")) {
         std::string spec = std::get<std::string>(n->prop("dump_spec"));
         size_t parm_pos = spec.find("Parm");
@@ -291,11 +528,61 @@ Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
     return get_index(a) < get_index(b);
   });
 
-  for (Node* parm_node : params) {
-    Value parm_val = EvalParm(parm_node, inputs);
-    value_cache_[parm_node] = parm_val;
+  for (Node* n : graph_.nodes()) {
+    if (!IsDataPhiNode(n) || !n->region_input()) continue;
+    region_phis_[n->region_input()].push_back(n);
   }
-  Logger::Info("ExecuteWithHeap: parameter caching done");
+}
+
+void Interpreter::Prepare() {
+  Logger::Info("ExecuteWithHeap: calling BuildControlSuccessors");
+  BuildControlSuccessors();
+  BuildCountedLoops();
+  BuildParamsAndPhis();
+  BuildScheduledSuccessors();
+  call_targets_.clear();
+  verified_ = VerifyGraph(graph_).empty();
+
+  // Size the per-run tables once, so runs only ever write into them
+  const size_t num_nodes = graph_.nodes().size();
+  value_cache_.Reserve(num_nodes);
+  eval_active_.Reserve(num_nodes);
+  region_predecessor_.Reserve(num_nodes);
+  loop_iterations_.Reserve(num_nodes);
+  phi_old_values_.Reserve(num_nodes);
+  phi_update_active_.Reserve(num_nodes);
+  phi_eval_stack_.Reserve(num_nodes);
+  memory_chain_visited_.Reserve(num_nodes);
+  prepared_ = true;
+  Logger::Info("ExecuteWithHeap: BuildControlSuccessors done");
+}
+
+void Interpreter::ResetRunState() {
+  value_cache_.Clear();
+  region_predecessor_.Clear();
+  loop_iterations_.Clear();
+  eval_active_.Clear();
+  phi_eval_stack_.Clear();
+  phi_update_active_.Clear();
+  phi_old_values_.Clear();
+  memory_chain_visited_.Clear();
+  pending_phi_values_.clear();
+  in_phi_update_ = false;
+  updating_region_ = nullptr;
+  updating_phi_ = nullptr;
+}
+
+Outcome Interpreter::Run(const std::vector<Value>& inputs) {
+  Logger::Info("ExecuteWithHeap: starting");
+  // Nested frames are reused across calls; prepare them once
+  if (!prepared_) Prepare();
+  ResetRunState();
+
+  // Cache parameter values first
+  for (const Node* parm_node : params_) {
+    value_cache_[parm_node] = EvalParm(parm_node, inputs);
+  }
+  Logger::Info("ExecuteWithHeap: cached ", params_.size(), " parameters");
 
   // Start control flow traversal from Start node
   Node* start = graph_.start();
@@ -314,8 +601,8 @@ Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
                                std::to_string(kMaxControlSteps) + ")");
     }
     if (step_count % 100 == 0) {
-      Logger::Debug("Control flow step " + std::to_string(step_count) +
-                    ": node " + std::to_string(current_control->id()));
+      Logger::Debug("Control flow step ", step_count, ": node ",
+                    current_control->id());
     }
     current_control = StepControl(current_control);
     if (!current_control) {
@@ -327,6 +614,13 @@ Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
     throw std::runtime_error("Control flow terminated without reaching Return");
   }
 
+  // Stores on the final memory state (TypeFunc::Memory) are part of the
+  // result, even when nothing loads them back
+  if (current_control->num_inputs() > 2) {
+    memory_chain_visited_.Clear();
+    ProcessMemoryChain(current_control->input(2));
+  }
+
   // Evaluate the return value (if any)
   Outcome outcome;
   outcome.kind = Outcome::Kind::kReturn;
@@ -336,10 +630,13 @@ Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
   // input[1..n-1] = various (memory, frame pointer, etc.)
   // Last input = return value (if method returns non-void)
   // Find the return value: it's typically the last input that's not a Parm
+  // (or the memory state of a void method)
   Node* value_node = nullptr;
   for (int i = current_control->num_inputs() - 1; i >= 1; --i) {
     Node* inp = current_control->input(i);
-    if (inp && inp->opcode() != Opcode::kParm) {
+    if (inp && inp->opcode() != Opcode::kParm && !IsControl(inp->opcode()) &&
+        inp->opcode() != Opcode::kMergeMem &&
+        inp->schema() != NodeSchema::kS4_Store) {
       value_node = inp;
       break;
     }
@@ -356,7 +653,6 @@ Outcome Interpreter::ExecuteWithHeap(const std::vector<Value>& inputs,
     }
   }
 
-  outcome.heap = heap_;
   return outcome;
 }
 
@@ -364,10 +660,10 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
   if (!ctrl) {
     throw std::runtime_error("StepControl called with null control node");
   }
+  LogContext::Node log_node(ctrl->id());
 
   Opcode op = ctrl->opcode();
-  Logger::Info("StepControl: node " + std::to_string(ctrl->id()) + " (" +
-               OpcodeToString(op) + ")");
+  Logger::Info("StepControl: node ", ctrl->id(), " (", OpcodeName(op), ")");
 
   switch (op) {
     case Opcode::kStart:
@@ -377,22 +673,43 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
     case Opcode::kParm:       // Parm nodes act as control projections in C2
     case Opcode::kSafePoint:  // SafePoint is a control pass-through
     case Opcode::kProj:       // Proj can also be a control projection in C2
-    case Opcode::kCallStaticJava:  // Often uncommon_trap; assume no deopt
       // Simple pass-through: find successor
       return FindControlSuccessor(ctrl);
 
+    case Opcode::kCallStaticJava: {
+      // Often uncommon_trap; assume no deopt and pass through
+      if (!ResolveCall(ctrl)) return FindControlSuccessor(ctrl);
+      // A registered call runs now, in control order; its result Proj
+      // reads the cached value
+      EvalNode(ctrl);
+      // Continue at the control projection (#0), not the memory or result
+      auto succ = control_successors_.find(ctrl);
+      if (succ != control_successors_.end()) {
+        for (const Node* s : succ->second) {
+          if (s->opcode() == Opcode::kProj && PropAsI64(s, "con") == 0) {
+            return s;
+          }
+        }
+      }
+      return FindControlSuccessor(ctrl);
+    }
+
     case Opcode::kIf:
-    case Opcode::kParsePredicate: {
-      // If and ParsePredicate: evaluate condition and choose branch
+    case Opcode::kParsePredicate:
+    case Opcode::kCountedLoopEnd:
+    case Opcode::kLongCountedLoopEnd:
+    case Opcode::kOuterStripMinedLoopEnd: {
+      // If, ParsePredicate and loop ends: evaluate condition and choose
+      // branch (IfTrue continues a loop, IfFalse exits it)
       // Use schema-aware accessor to get value inputs
-      auto value_inputs = ctrl->value_inputs();
-      if (value_inputs.empty()) {
+      const Node* cond_node = FirstValueInput(ctrl);
+      if (!cond_node) {
         throw std::runtime_error(std::string(OpcodeToString(ctrl->opcode())) +
                                  " node needs condition value input");
       }
 
       // Evaluate condition (this may recursively evaluate data subgraph)
-      Value cond = EvalNode(value_inputs[0]);
+      Value cond = EvalNode(cond_node);
 
       bool branch_taken = false;
       if (cond.is_bool()) {
@@ -404,8 +721,8 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
         throw std::runtime_error("If condition must be boolean or int");
       }
 
-      Logger::Trace("  If condition evaluated to: " +
-                    std::string(branch_taken ? "true" : "false"));
+      Logger::Trace("  If condition evaluated to: ",
+                    branch_taken ? "true" : "false");
 
       // Find the corresponding IfTrue or IfFalse successor (use precomputed
       // adjacency to avoid scanning and to match our traversal).
@@ -431,20 +748,16 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
       // Outputs: IfTrue (bounds OK), IfFalse (out of bounds)
       // Similar to If node, but specifically for array bounds checking
 
-      Logger::Info("StepControl: handling RangeCheck node " +
-                   std::to_string(ctrl->id()));
+      Logger::Info("StepControl: handling RangeCheck node ", ctrl->id());
 
-      auto value_inputs = ctrl->value_inputs();
-      Logger::Info("  Got " + std::to_string(value_inputs.size()) +
-                   " value inputs");
-      if (value_inputs.empty()) {
+      const Node* cond_node = FirstValueInput(ctrl);
+      if (!cond_node) {
         throw std::runtime_error("RangeCheck node needs Bool condition input");
       }
 
       // Evaluate the condition (Bool node that computes the bounds check)
-      Logger::Info("  About to evaluate Bool condition node " +
-                   std::to_string(value_inputs[0]->id()));
-      Value cond = EvalNode(value_inputs[0]);
+      Logger::Info("  About to evaluate Bool condition node ", cond_node->id());
+      Value cond = EvalNode(cond_node);
       Logger::Info("  Condition evaluated");
 
       bool bounds_ok = false;
@@ -457,23 +770,19 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
         throw std::runtime_error("RangeCheck condition must be boolean or int");
       }
 
-      Logger::Info("  Bounds check result: " +
-                   std::string(bounds_ok ? "OK" : "FAIL"));
-      Logger::Trace(
-          "  RangeCheck condition evaluated to: " +
-          std::string(bounds_ok ? "true (OK)" : "false (OUT_OF_BOUNDS)"));
+      Logger::Info("  Bounds check result: ", bounds_ok ? "OK" : "FAIL");
+      Logger::Trace("  RangeCheck condition evaluated to: ",
+                    bounds_ok ? "true (OK)" : "false (OUT_OF_BOUNDS)");
 
       // Find IfTrue or IfFalse successor based on bounds check result
       Logger::Info("  Looking for successors");
       auto it_succs = control_successors_.find(ctrl);
       if (it_succs != control_successors_.end()) {
-        Logger::Info("  Found " + std::to_string(it_succs->second.size()) +
-                     " successors");
+        Logger::Info("  Found ", it_succs->second.size(), " successors");
         for (const Node* s : it_succs->second) {
           if (!s) continue;
-          Logger::Info("    Checking successor node " +
-                       std::to_string(s->id()) + " (" +
-                       OpcodeToString(s->opcode()) + ")");
+          Logger::Info("    Checking successor node ", s->id(), " (",
+                       OpcodeName(s->opcode()), ")");
           if (bounds_ok && s->opcode() == Opcode::kIfTrue) {
             Logger::Info("    Taking IfTrue branch");
             return s;
@@ -489,24 +798,27 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
           "RangeCheck node has no IfTrue/IfFalse successors");
     }
 
+    case Opcode::kLoop:
+    case Opcode::kCountedLoop:
+    case Opcode::kLongCountedLoop:
+    case Opcode::kOuterStripMinedLoop: {
+      auto it_loop = counted_loops_.find(ctrl);
+      if (it_loop != counted_loops_.end()) {
+        return RunCountedLoop(it_loop->second);
+      }
+      // Other loop heads step like any Region
+      [[fallthrough]];
+    }
+
     case Opcode::kRegion: {
       // Control merge point
       // We cannot reliably identify loop headers structurally from a raw C2 IGV
       // dump without CFG analysis. Instead, treat any Region that is revisited
       // during execution as part of a loop and update its data Phis on
       // subsequent visits.
-      bool has_data_phi = false;
-      for (Node* n : graph_.nodes()) {
-        if (!IsDataPhiNode(n)) continue;
-        if (n->region_input() == ctrl) {
-          has_data_phi = true;
-          break;
-        }
-      }
-
-      if (has_data_phi) {
-        auto it = loop_iterations_.find(ctrl);
-        if (it == loop_iterations_.end()) {
+      if (region_phis_.count(ctrl) > 0) {
+        int* iterations = loop_iterations_.find(ctrl);
+        if (!iterations) {
           // First time we enter this Region: seed Phi caches for the entry
           // predecessor.
           Logger::Info("  Region first visit, seeding Phis");
@@ -514,14 +826,13 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
           UpdateRegionPhis(ctrl, /*is_back_edge=*/false);
           Logger::Info("  Region Phi seeding complete");
         } else {
-          const int iter_count = it->second;
-          Logger::Info("  Region revisit, iteration " +
-                       std::to_string(iter_count));
+          const int iter_count = *iterations;
+          Logger::Info("  Region revisit, iteration ", iter_count);
           if (iter_count >= kMaxLoopIterations) {
             throw std::runtime_error("Loop exceeded maximum iterations (" +
                                      std::to_string(kMaxLoopIterations) + ")");
           }
-          it->second = iter_count + 1;
+          *iterations = iter_count + 1;
           Logger::Info("  Updating Region Phis for back-edge");
           UpdateRegionPhis(ctrl, /*is_back_edge=*/true);
           Logger::Info("  Region Phi update complete");
@@ -547,31 +858,51 @@ const Node* Interpreter::StepControl(const Node* ctrl) {
   }
 }
 
-static bool PropIsTrue(const Node* n, const std::string& key) {
-  if (!n || !n->has_prop(key)) return false;
-  const Property p = n->prop(key);
-  if (std::holds_alternative<bool>(p)) return std::get<bool>(p);
-  if (std::holds_alternative<int32_t>(p)) return std::get<int32_t>(p) != 0;
-  if (std::holds_alternative<int64_t>(p)) return std::get<int64_t>(p) != 0;
-  if (std::holds_alternative<std::string>(p)) {
-    const std::string& s = std::get<std::string>(p);
-    return s == "true" || s == "True" || s == "1";
-  }
-  return false;
-}
-
-static std::optional<int64_t> PropAsI64(const Node* n, const std::string& key) {
-  if (!n || !n->has_prop(key)) return std::nullopt;
-  const Property p = n->prop(key);
-  if (std::holds_alternative<int32_t>(p)) return std::get<int32_t>(p);
-  if (std::holds_alternative<int64_t>(p)) return std::get<int64_t>(p);
-  if (std::holds_alternative<std::string>(p)) {
-    const std::string& s = std::get<std::string>(p);
-    char* end = nullptr;
-    long long v = std::strtoll(s.c_str(), &end, 10);
-    if (end != s.c_str() && *end == '\0') return static_cast<int64_t>(v);
+void Interpreter::BuildScheduledSuccessors() {
+  scheduled_successors_.Clear();
+  const Schedule* schedule = graph_.schedule();
+  if (!schedule) return;
+  scheduled_successors_.Reserve(graph_.nodes().size());
+
+  // Control stays in a block until its end, then enters a successor block.
+  // Of the users that continue that way, take the first in schedule order:
+  // the next one in the block, else the head of the first successor block.
+  // Projections without control users of their own (memory, I/O) are not
+  // where control goes.
+  for (const auto& [ctrl, succs] : control_successors_) {
+    const uint32_t block = schedule->block_of(ctrl);
+    if (block == Schedule::kNoBlock) continue;
+    const std::vector<uint32_t>& next_blocks =
+        schedule->block(block).successors;
+
+    const Node* chosen = nullptr;
+    size_t chosen_rank = SIZE_MAX;
+    for (const Node* s : succs) {
+      if (!IsControlCandidate(s)) continue;
+      const Opcode op = s->opcode();
+      if ((op == Opcode::kProj || op == Opcode::kParm) &&
+          control_successors_.count(s) == 0) {
+        continue;
+      }
+      const uint32_t s_block = schedule->block_of(s);
+      size_t rank = SIZE_MAX;
+      if (s_block == block) {
+        if (schedule->position_of(s) > schedule->position_of(ctrl)) {
+          rank = schedule->position_of(s);
+        }
+      } else {
+        auto it = std::find(next_blocks.begin(), next_blocks.end(), s_block);
+        if (s_block != Schedule::kNoBlock && it != next_blocks.end()) {
+          rank = (size_t{1} << 32) + (it - next_blocks.begin());
+        }
+      }
+      if (rank < chosen_rank) {
+        chosen = s;
+        chosen_rank = rank;
+      }
+    }
+    if (chosen) scheduled_successors_[ctrl] = chosen;
   }
-  return std::nullopt;
 }
 
 const Node* Interpreter::FindControlSuccessor(const Node* ctrl) {
@@ -579,51 +910,32 @@ const Node* Interpreter::FindControlSuccessor(const Node* ctrl) {
 
   auto it = control_successors_.find(ctrl);
   if (it == control_successors_.end()) {
-    Logger::Warn("FindControlSuccessor: node " + std::to_string(ctrl->id()) +
-                 " (" + OpcodeToString(ctrl->opcode()) + ") has no successors");
+    Logger::Warn("FindControlSuccessor: node ", ctrl->id(), " (",
+                 OpcodeName(ctrl->opcode()), ") has no successors");
     return nullptr;
   }
 
   const auto& succs = it->second;
 
-  auto is_candidate = [](const Node* s) -> bool {
-    if (!s) return false;
-    const Opcode op = s->opcode();
-    if (op == Opcode::kRegion || op == Opcode::kIf || op == Opcode::kIfTrue ||
-        op == Opcode::kIfFalse || op == Opcode::kGoto ||
-        op == Opcode::kReturn || op == Opcode::kHalt ||
-        op == Opcode::kSafePoint || op == Opcode::kParsePredicate ||
-        op == Opcode::kCallStaticJava || op == Opcode::kProj ||
-        op == Opcode::kRangeCheck) {
-      return true;
-    }
-    if (op == Opcode::kParm && s->has_prop("type")) {
-      const Property p = s->prop("type");
-      if (std::holds_alternative<std::string>(p)) {
-        return std::get<std::string>(p) == "control";
-      }
-    }
-    return false;
-  };
-
-  std::vector<const Node*> candidates;
-  candidates.reserve(succs.size());
+  size_t num_candidates = 0;
+  const Node* first_candidate = nullptr;
   for (const Node* s : succs) {
-    if (is_candidate(s)) candidates.push_back(s);
+    if (!IsControlCandidate(s)) continue;
+    if (num_candidates++ == 0) first_candidate = s;
   }
-  if (candidates.empty()) {
-    Logger::Warn("FindControlSuccessor: node " + std::to_string(ctrl->id()) +
-                 " has " + std::to_string(succs.size()) +
-                 " successors but none are control candidates");
+  if (num_candidates == 0) {
+    Logger::Warn("FindControlSuccessor: node ", ctrl->id(), " has ",
+                 succs.size(), " successors but none are control candidates");
     for (const Node* s : succs) {
-      Logger::Warn("  - successor node " + std::to_string(s->id()) + " (" +
-                   OpcodeToString(s->opcode()) + ")");
+      Logger::Warn("  - successor node ", s->id(), " (",
+                   OpcodeName(s->opcode()), ")");
     }
     return nullptr;
   }
-  if (candidates.size() == 1) {
-    const Node* chosen = candidates.front();
-    if (chosen->opcode() == Opcode::kRegion) {
+  const Node* const* scheduled = scheduled_successors_.find(ctrl);
+  if (num_candidates == 1 || scheduled) {
+    const Node* chosen = scheduled ? *scheduled : first_candidate;
+    if (IsRegion(chosen->opcode())) {
       region_predecessor_[chosen] = ctrl;
     }
     return chosen;
@@ -641,6 +953,9 @@ const Node* Interpreter::FindControlSuccessor(const Node* ctrl) {
       case Opcode::kIf:
       case Opcode::kParsePredicate:
       case Opcode::kRangeCheck:
+      case Opcode::kCountedLoopEnd:
+      case Opcode::kLongCountedLoopEnd:
+      case Opcode::kOuterStripMinedLoopEnd:
         return 2;
       case Opcode::kIfTrue:
       case Opcode::kIfFalse:
@@ -648,6 +963,10 @@ const Node* Interpreter::FindControlSuccessor(const Node* ctrl) {
       case Opcode::kGoto:
         return 4;
       case Opcode::kRegion:
+      case Opcode::kLoop:
+      case Opcode::kCountedLoop:
+      case Opcode::kLongCountedLoop:
+      case Opcode::kOuterStripMinedLoop:
         return 5;
       case Opcode::kSafePoint:
       case Opcode::kCallStaticJava:
@@ -692,11 +1011,13 @@ const Node* Interpreter::FindControlSuccessor(const Node* ctrl) {
         idx_delta, s->id());
   };
 
-  const Node* chosen = *std::min_element(
-      candidates.begin(), candidates.end(),
-      [&](const Node* a, const Node* b) { return score(a) < score(b); });
+  // The first candidate with the smallest score
+  const Node* chosen = first_candidate;
+  for (const Node* s : succs) {
+    if (IsControlCandidate(s) && score(s) < score(chosen)) chosen = s;
+  }
 
-  if (chosen && chosen->opcode() == Opcode::kRegion) {
+  if (chosen && IsRegion(chosen->opcode())) {
     // CRITICAL: record predecessor only for the chosen Region successor.
     region_predecessor_[chosen] = ctrl;
   }
@@ -704,9 +1025,12 @@ const Node* Interpreter::FindControlSuccessor(const Node* ctrl) {
 }
 
 bool Interpreter::IsLoopHeader(const Node* region) const {
-  if (!region || region->opcode() != Opcode::kRegion) {
+  if (!region || !IsRegion(region->opcode())) {
     return false;
   }
+  if (IsLoopHead(region->opcode())) {
+    return true;
+  }
 
   // HotSpot C2 uses cyclic Phis for loop headers (induction variables).
   // This is a robust discriminator for our prototype: non-loop merge Regions
@@ -727,7 +1051,7 @@ const Node* Interpreter::SelectPhiInputNode(const Node* phi,
                                             bool allow_self) const {
   if (!phi || phi->opcode() != Opcode::kPhi) return nullptr;
   const Node* region = phi->region_input();
-  if (!region || region->opcode() != Opcode::kRegion) return nullptr;
+  if (!region || !IsRegion(region->opcode())) return nullptr;
   if (!active_pred) return nullptr;
 
   // Find the Region predecessor index i such that Region input[i] ==
@@ -748,18 +1072,19 @@ const Node* Interpreter::SelectPhiInputNode(const Node* phi,
   // - often Phi input[0] is Region, and value for pred i is at input[i+1]
   // - sometimes Phi has the same arity as Region and uses input[i] for i>=1
   // - dumps can have holes (nullptr) at some indices
-  std::vector<size_t> candidates;
+  size_t candidates[3];
+  size_t num_candidates = 0;
   const size_t phi_n = phi->num_inputs();
   const size_t region_n = region->num_inputs();
   if (phi_n == region_n + 1) {
-    candidates.push_back(pred_index + 1);
+    candidates[num_candidates++] = pred_index + 1;
   }
   if (phi_n == region_n) {
-    candidates.push_back((pred_index == 0) ? 1 : pred_index);
+    candidates[num_candidates++] = (pred_index == 0) ? 1 : pred_index;
   }
   // Always try these two fallbacks as well (in case arities don't match).
-  candidates.push_back(pred_index + 1);
-  candidates.push_back(pred_index);
+  candidates[num_candidates++] = pred_index + 1;
+  candidates[num_candidates++] = pred_index;
 
   auto accept = [&](const Node* v) -> bool {
     if (!v) return false;
@@ -767,7 +1092,8 @@ const Node* Interpreter::SelectPhiInputNode(const Node* phi,
     return true;
   };
 
-  for (size_t idx : candidates) {
+  for (size_t c = 0; c < num_candidates; ++c) {
+    const size_t idx = candidates[c];
     if (idx >= phi->num_inputs()) continue;
     const Node* v = phi->input(idx);
     if (accept(v)) return v;
@@ -799,23 +1125,23 @@ Value Interpreter::EvalNode(const Node* n) {
   // Check cache FIRST, before any cycle detection or guards
   // This allows cached values to be returned immediately without re-entering
   // evaluation
-  auto it = value_cache_.find(n);
-  if (it != value_cache_.end()) {
-    return it->second;
+  if (const Value* cached = value_cache_.find(n)) {
+    return *cached;
   }
 
+  LogContext::Node log_node(n->id());
+
   // General cycle detection: loops in SoN value graphs should only be via Phi
   // with well-defined predecessor selection. If we see a cycle here, our
   // traversal/predecessor tracking is broken; fail fast instead of segfaulting.
   // EXCEPTION: Phi nodes can legitimately reference themselves through complex
   // dependency chains. If a Phi is already being evaluated, check if it's
   // cached from a previous Region update and return that value.
-  if (eval_active_.count(n) > 0) {
+  if (eval_active_.contains(n)) {
     if (n->opcode() == Opcode::kPhi) {
       // Phi node cycle - check if we have a cached value from UpdateRegionPhis
-      auto cached_it = value_cache_.find(n);
-      if (cached_it != value_cache_.end()) {
-        return cached_it->second;
+      if (const Value* cached = value_cache_.find(n)) {
+        return *cached;
       }
     }
     throw std::runtime_error(
@@ -825,9 +1151,14 @@ Value Interpreter::EvalNode(const Node* n) {
   struct EvalActiveGuard {
     Interpreter* interp;
     const Node* node;
-    ~EvalActiveGuard() { interp->eval_active_.erase(node); }
+    ~EvalActiveGuard() {
+      if (node) interp->eval_active_.erase(node);
+    }
   } active_guard{this, n};
-  eval_active_.insert(n);
+#ifdef NDEBUG
+  if (verified_ && !MayCloseValueCycle(n)) active_guard.node = nullptr;
+#endif
+  if (active_guard.node) eval_active_.insert(n);
 
   struct EvalDepthGuard {
     Interpreter* interp;
@@ -855,13 +1186,12 @@ Value Interpreter::EvalNode(const Node* n) {
   // This gives simultaneous-update semantics for mutually dependent Phis.
   if (in_phi_update_ && updating_region_ != nullptr &&
       n->opcode() == Opcode::kPhi && n->region_input() == updating_region_) {
-    auto it_old = phi_old_values_.find(n);
-    if (it_old != phi_old_values_.end()) {
+    if (const Value* old = phi_old_values_.find(n)) {
       if (n != updating_phi_) {
-        return it_old->second;
+        return *old;
       }
-      if (phi_update_active_.count(n) > 0) {
-        return it_old->second;
+      if (phi_update_active_.contains(n)) {
+        return *old;
       }
     }
   }
@@ -870,7 +1200,8 @@ Value Interpreter::EvalNode(const Node* n) {
   Opcode op = n->opcode();
 
   // Dispatch based on opcode
-  if (op == Opcode::kConI || op == Opcode::kConL || op == Opcode::kConP) {
+  if (op == Opcode::kConI || op == Opcode::kConL || op == Opcode::kConP ||
+      op == Opcode::kConF || op == Opcode::kConD) {
     result = EvalConst(n);
   } else if (op == Opcode::kParm) {
     // Parm nodes should have been cached during Execute()
@@ -893,7 +1224,8 @@ Value Interpreter::EvalNode(const Node* n) {
     }
     result = EvalNode(input_node);
   } else if (op == Opcode::kCMoveI || op == Opcode::kCMoveL ||
-             op == Opcode::kCMoveP) {
+             op == Opcode::kCMoveP || op == Opcode::kCMoveF ||
+             op == Opcode::kCMoveD) {
     result = EvalCMove(n);
   } else if (op == Opcode::kPhi) {
     // Memory/control Phis exist in real C2 graphs and can be cyclic (self).
@@ -904,13 +1236,23 @@ Value Interpreter::EvalNode(const Node* n) {
       result = EvalPhi(n);
     }
   } else if (op == Opcode::kSafePoint || op == Opcode::kOpaque1 ||
+             op == Opcode::kOpaqueLoopInit ||
+             op == Opcode::kOpaqueLoopStride ||
+             op == Opcode::kOpaqueZeroTripGuard ||
              op == Opcode::kParsePredicate) {
     result = EvalNoOp(n);
   } else if (op == Opcode::kProj) {
     // Proj projects one output from a multi-output node. For this concrete
     // interpreter prototype, treat it as a pass-through of its first value
-    // input (similar to Opaque1/SafePoint behavior).
-    result = EvalNoOp(n);
+    // input (similar to Opaque1/SafePoint behavior). The result (#5,
+    // TypeFunc::Parms) of a registered call is the call's value.
+    const Node* src = n->num_inputs() > 0 ? n->input(0) : nullptr;
+    if (src && src->opcode() == Opcode::kCallStaticJava &&
+        PropAsI64(n, "con") == 5 && ResolveCall(src)) {
+      result = EvalNode(src);
+    } else {
+      result = EvalNoOp(n);
+    }
   } else if (op == Opcode::kThreadLocal) {
     result = EvalThreadLocal(n);
   } else if (op == Opcode::kCallStaticJava) {
@@ -1020,9 +1362,11 @@ Value Interpreter::EvalNode(const Node* n) {
   } else if (op == Opcode::kLoadB || op == Opcode::kLoadUB ||
              op == Opcode::kLoadS || op == Opcode::kLoadUS ||
              op == Opcode::kLoadI || op == Opcode::kLoadL ||
+             op == Opcode::kLoadF || op == Opcode::kLoadD ||
              op == Opcode::kLoadP || op == Opcode::kLoadN) {
     result = EvalLoad(n);
-  } else if (IsArithmetic(op) || IsBitwise(op)) {
+  } else if (IsArithmetic(op) || IsBitwise(op) || IsFloatArithmetic(op) ||
+             IsFloatUnary(op)) {
     result = EvalArithOp(n);
   } else if (IsComparison(op)) {
     result = EvalCmpOp(n);
@@ -1039,21 +1383,34 @@ Value Interpreter::EvalNode(const Node* n) {
 Value Interpreter::EvalConst(const Node* n) {
   Opcode op = n->opcode();
 
+  // Payload already decoded and pooled by the parser
+  if (const Constant* c = n->constant()) {
+    switch (c->op) {
+      case Opcode::kConI:
+        return Value::MakeI32(static_cast<int32_t>(c->value));
+      case Opcode::kConL:
+        return Value::MakeI64(c->value);
+      case Opcode::kConF:
+        return Value::MakeF32(
+            std::bit_cast<float>(static_cast<uint32_t>(c->value)));
+      case Opcode::kConD:
+        return Value::MakeF64(std::bit_cast<double>(c->value));
+      default:
+        return Value::MakeNull();
+    }
+  }
+
   if (op == Opcode::kConI) {
     // Try 'value' property first (manually constructed graphs)
     if (n->has_prop("value")) {
       int32_t val = std::get<int32_t>(n->prop("value"));
       return Value::MakeI32(val);
     }
-    // C2 graphs encode value in dump_spec: " #int:42" or " #int:-5"
+    // C2 graphs encode value in dump_spec: " #int:42" or " #int:max-1"
     if (n->has_prop("dump_spec")) {
-      std::string spec = std::get<std::string>(n->prop("dump_spec"));
-      // Format: " #int:<value>"
-      size_t colon = spec.find(':');
-      if (colon != std::string::npos) {
-        std::string val_str = spec.substr(colon + 1);
-        int32_t val = std::stoi(val_str);
-        return Value::MakeI32(val);
+      std::string_view spec = n->interned_prop("dump_spec").view();
+      if (auto val = ConstantPool::DecodeDumpSpec(op, spec)) {
+        return Value::MakeI32(static_cast<int32_t>(*val));
       }
     }
     throw std::runtime_error(
@@ -1064,15 +1421,11 @@ Value Interpreter::EvalConst(const Node* n) {
       int64_t val = std::get<int64_t>(n->prop("value"));
       return Value::MakeI64(val);
     }
-    // C2 graphs encode value in dump_spec: " #long:42" or " #long:-5"
+    // C2 graphs encode value in dump_spec: " #long:42" or " #long:minint"
     if (n->has_prop("dump_spec")) {
-      std::string spec = std::get<std::string>(n->prop("dump_spec"));
-      // Format: " #long:<value>"
-      size_t colon = spec.find(':');
-      if (colon != std::string::npos) {
-        std::string val_str = spec.substr(colon + 1);
-        int64_t val = std::stoll(val_str);
-        return Value::MakeI64(val);
+      std::string_view spec = n->interned_prop("dump_spec").view();
+      if (auto val = ConstantPool::DecodeDumpSpec(op, spec)) {
+        return Value::MakeI64(*val);
       }
     }
     throw std::runtime_error(
@@ -1080,6 +1433,30 @@ Value Interpreter::EvalConst(const Node* n) {
   } else if (op == Opcode::kConP) {
     // Null pointer constant
     return Value::MakeNull();
+  } else if (op == Opcode::kConF || op == Opcode::kConD) {
+    // Manually constructed graphs give the IEEE bits as 'value' (int32 for
+    // ConF, int64 for ConD); C2 graphs use " #ftcon:1.500000"
+    std::optional<int64_t> bits;
+    if (n->has_prop("value")) {
+      Property p = n->prop("value");
+      if (std::holds_alternative<int32_t>(p)) {
+        bits = static_cast<uint32_t>(std::get<int32_t>(p));
+      } else if (std::holds_alternative<int64_t>(p)) {
+        bits = std::get<int64_t>(p);
+      }
+    } else if (n->has_prop("dump_spec")) {
+      std::string_view spec = n->interned_prop("dump_spec").view();
+      bits = ConstantPool::DecodeDumpSpec(op, spec);
+    }
+    if (!bits) {
+      throw std::runtime_error(OpcodeToString(op) +
+                               " node missing 'value' or parseable "
+                               "'dump_spec' property");
+    }
+    if (op == Opcode::kConF) {
+      return Value::MakeF32(std::bit_cast<float>(static_cast<uint32_t>(*bits)));
+    }
+    return Value::MakeF64(std::bit_cast<double>(*bits));
   }
 
   throw std::runtime_error("Unknown constant opcode");
@@ -1124,10 +1501,9 @@ Value Interpreter::EvalParm(const Node* n, const std::vector<Value>& inputs) {
             // For array/object parameters that weren't provided,
             // return a null reference - this allows testing compilation
             // even without proper input setup
-            Logger::Warn(
-                "Parm index " + std::to_string(index) +
-                " out of range (inputs size: " + std::to_string(inputs.size()) +
-                "), returning null reference");
+            Logger::Warn("Parm index ", index,
+                         " out of range (inputs size: ", inputs.size(),
+                         "), returning null reference");
             return Value::MakeNull();
           }
           return inputs[index];
@@ -1161,9 +1537,9 @@ Value Interpreter::EvalArithOp(const Node* n) {
     return v;
   };
 
-  // Handle unary operations (AbsI, AbsL, conversions)
+  // Handle unary operations (AbsI, AbsL, conversions, float unaries)
   if (op == Opcode::kAbsI || op == Opcode::kAbsL || op == Opcode::kConvI2L ||
-      op == Opcode::kConvL2I) {
+      op == Opcode::kConvL2I || IsFloatUnary(op)) {
     // C2 format check: if input[0] is null, try input[1]
     const Node* operand = nullptr;
     if (n->num_inputs() >= 2 && n->input(0) == nullptr) {
@@ -1185,14 +1561,52 @@ Value Interpreter::EvalArithOp(const Node* n) {
         return Evaluator::EvalConvI2L(a);
       case Opcode::kConvL2I:
         return Evaluator::EvalConvL2I(a);
+      case Opcode::kNegF:
+        return Evaluator::EvalNegF(a);
+      case Opcode::kAbsF:
+        return Evaluator::EvalAbsF(a);
+      case Opcode::kNegD:
+        return Evaluator::EvalNegD(a);
+      case Opcode::kAbsD:
+        return Evaluator::EvalAbsD(a);
+      case Opcode::kSqrtD:
+        return Evaluator::EvalSqrtD(a);
+      case Opcode::kConvI2F:
+        return Evaluator::EvalConvI2F(a);
+      case Opcode::kConvI2D:
+        return Evaluator::EvalConvI2D(a);
+      case Opcode::kConvL2F:
+        return Evaluator::EvalConvL2F(a);
+      case Opcode::kConvL2D:
+        return Evaluator::EvalConvL2D(a);
+      case Opcode::kConvF2I:
+        return Evaluator::EvalConvF2I(a);
+      case Opcode::kConvF2L:
+        return Evaluator::EvalConvF2L(a);
+      case Opcode::kConvD2I:
+        return Evaluator::EvalConvD2I(a);
+      case Opcode::kConvD2L:
+        return Evaluator::EvalConvD2L(a);
+      case Opcode::kConvF2D:
+        return Evaluator::EvalConvF2D(a);
+      case Opcode::kConvD2F:
+        return Evaluator::EvalConvD2F(a);
+      case Opcode::kMoveF2I:
+        return Evaluator::EvalMoveF2I(a);
+      case Opcode::kMoveI2F:
+        return Evaluator::EvalMoveI2F(a);
+      case Opcode::kMoveD2L:
+        return Evaluator::EvalMoveD2L(a);
+      case Opcode::kMoveL2D:
+        return Evaluator::EvalMoveL2D(a);
       default:
         throw std::runtime_error("Unsupported unary opcode");
     }
   }
 
   // Binary operations - use schema-aware accessor
-  auto value_inputs = n->value_inputs();
-  if (value_inputs.size() < 2) {
+  const Node* value_inputs[2];
+  if (GetValueInputs(n, value_inputs, 2) < 2) {
     throw std::runtime_error("Binary op needs at least 2 value inputs");
   }
 
@@ -1264,6 +1678,38 @@ Value Interpreter::EvalArithOp(const Node* n) {
     case Opcode::kURShiftL:
       return Evaluator::EvalURShiftL(a, b);
 
+    // Float arithmetic
+    case Opcode::kAddF:
+      return Evaluator::EvalAddF(a, b);
+    case Opcode::kSubF:
+      return Evaluator::EvalSubF(a, b);
+    case Opcode::kMulF:
+      return Evaluator::EvalMulF(a, b);
+    case Opcode::kDivF:
+      return Evaluator::EvalDivF(a, b);
+    case Opcode::kModF:
+      return Evaluator::EvalModF(a, b);
+    case Opcode::kMinF:
+      return Evaluator::EvalMinF(a, b);
+    case Opcode::kMaxF:
+      return Evaluator::EvalMaxF(a, b);
+
+    // Double arithmetic
+    case Opcode::kAddD:
+      return Evaluator::EvalAddD(a, b);
+    case Opcode::kSubD:
+      return Evaluator::EvalSubD(a, b);
+    case Opcode::kMulD:
+      return Evaluator::EvalMulD(a, b);
+    case Opcode::kDivD:
+      return Evaluator::EvalDivD(a, b);
+    case Opcode::kModD:
+      return Evaluator::EvalModD(a, b);
+    case Opcode::kMinD:
+      return Evaluator::EvalMinD(a, b);
+    case Opcode::kMaxD:
+      return Evaluator::EvalMaxD(a, b);
+
     default:
       throw std::runtime_error("Unsupported arithmetic opcode");
   }
@@ -1272,9 +1718,8 @@ Value Interpreter::EvalArithOp(const Node* n) {
 Value Interpreter::EvalCmpOp(const Node* n) {
   // Comparison operations: CmpI, CmpL, CmpP
   // Use schema-aware accessor to get value inputs
-  auto value_inputs = n->value_inputs();
-
-  if (value_inputs.size() < 2) {
+  const Node* value_inputs[2];
+  if (GetValueInputs(n, value_inputs, 2) < 2) {
     throw std::runtime_error("Comparison op needs at least 2 value inputs");
   }
 
@@ -1283,8 +1728,17 @@ Value Interpreter::EvalCmpOp(const Node* n) {
 
   Opcode op = n->opcode();
 
-  // CmpI/CmpL/CmpP return tri-state: -1 (less), 0 (equal), 1 (greater)
+  // CmpI/CmpL/CmpP return tri-state: -1 (less), 0 (equal), 1 (greater).
+  // Float compares report unordered (NaN) as less, so a Bool over CmpF/CmpD
+  // is false for eq/gt/ge and true for ne/lt/le; C2 orders the operands so
+  // that this gives Java's result.
   switch (op) {
+    case Opcode::kCmpF:
+    case Opcode::kCmpF3:
+      return Evaluator::EvalCmpF3(a, b);
+    case Opcode::kCmpD:
+    case Opcode::kCmpD3:
+      return Evaluator::EvalCmpD3(a, b);
     case Opcode::kCmpI: {
       int32_t av = a.as_i32();
       int32_t bv = b.as_i32();
@@ -1355,16 +1809,16 @@ Value Interpreter::EvalCmpOp(const Node* n) {
 }
 
 Value Interpreter::EvalPhi(const Node* n) {
-  Logger::Info("      EvalPhi: Phi node " + std::to_string(n->id()));
+  Logger::Info("      EvalPhi: Phi node ", n->id());
   // Outside of explicit back-edge update mode, Phi cycles are a bug in our
   // predecessor tracking / input selection and should be reported, not crash.
   const bool in_update_for_this_region = in_phi_update_ &&
                                          updating_region_ != nullptr &&
                                          n->region_input() == updating_region_;
-  Logger::Info("        in_update_for_this_region=" +
-               std::string(in_update_for_this_region ? "true" : "false"));
+  Logger::Info("        in_update_for_this_region=",
+               in_update_for_this_region ? "true" : "false");
   if (!in_update_for_this_region) {
-    if (phi_eval_stack_.count(n) > 0) {
+    if (phi_eval_stack_.contains(n)) {
       throw std::runtime_error("Cyclic Phi evaluation detected (phi=" +
                                std::to_string(n->id()) + ")");
     }
@@ -1386,10 +1840,9 @@ Value Interpreter::EvalPhi(const Node* n) {
   // - recursive self-references while computing a Phi should also read as old
   if (in_phi_update_ && updating_region_ != nullptr &&
       n->region_input() == updating_region_) {
-    auto it_old = phi_old_values_.find(n);
-    if (it_old != phi_old_values_.end()) {
-      if (n != updating_phi_ || phi_update_active_.count(n) > 0) {
-        return it_old->second;
+    if (const Value* old = phi_old_values_.find(n)) {
+      if (n != updating_phi_ || phi_update_active_.contains(n)) {
+        return *old;
       }
     }
   }
@@ -1397,36 +1850,34 @@ Value Interpreter::EvalPhi(const Node* n) {
   // Phi selects value based on which control predecessor was taken
   // Use schema-aware accessors
   Node* region = n->region_input();
-  if (!region || region->opcode() != Opcode::kRegion) {
+  if (!region || !IsRegion(region->opcode())) {
     // Simplified case: no region, just take first value
-    auto values = n->phi_values();
-    if (values.empty()) {
+    const Node* first = FirstValueInput(n);
+    if (!first) {
       throw std::runtime_error("Phi node has no value inputs");
     }
-    return EvalNode(values[0]);
+    return EvalNode(first);
   }
 
   // Determine which control predecessor was taken
-  auto it = region_predecessor_.find(region);
-  if (it == region_predecessor_.end()) {
+  const Node* const* pred = region_predecessor_.find(region);
+  if (!pred) {
     // No predecessor recorded - this shouldn't happen in proper execution
     // Fall back to first value
-    Logger::Warn("Phi node " + std::to_string(n->id()) +
-                 ": no predecessor recorded for Region " +
-                 std::to_string(region->id()) + ", using first value");
-    auto values = n->phi_values();
-    if (values.empty()) {
+    Logger::Warn("Phi node ", n->id(), ": no predecessor recorded for Region ",
+                 region->id(), ", using first value");
+    const Node* first = FirstValueInput(n);
+    if (!first) {
       throw std::runtime_error("Phi node has no value inputs");
     }
-    return EvalNode(values[0]);
+    return EvalNode(first);
   }
 
-  const Node* active_pred = it->second;
-  Logger::Trace("EvalPhi: Phi " + std::to_string(n->id()) + " in Region " +
-                std::to_string(region->id()) +
-                " active predecessor = " + std::to_string(active_pred->id()) +
-                " (region_inputs=" + std::to_string(region->num_inputs()) +
-                ", phi_inputs=" + std::to_string(n->num_inputs()) + ")");
+  const Node* active_pred = *pred;
+  Logger::Trace("EvalPhi: Phi ", n->id(), " in Region ", region->id(),
+                " active predecessor = ", active_pred->id(),
+                " (region_inputs=", region->num_inputs(),
+                ", phi_inputs=", n->num_inputs(), ")");
 
   // IMPORTANT: Phi inputs are positionally aligned with Region inputs.
   // Region:   input[i]   is the i-th control predecessor.
@@ -1438,12 +1889,12 @@ Value Interpreter::EvalPhi(const Node* n) {
   // recursion).
   const bool allow_self = in_phi_update_ && updating_region_ != nullptr &&
                           n->region_input() == updating_region_;
-  Logger::Info("        Selecting Phi input, allow_self=" +
-               std::string(allow_self ? "true" : "false"));
+  Logger::Info("        Selecting Phi input, allow_self=",
+               allow_self ? "true" : "false");
   const Node* selected =
       SelectPhiInputNode(n, active_pred, /*allow_self=*/allow_self);
-  Logger::Info("        Selected node " +
-               (selected ? std::to_string(selected->id()) : "NULL"));
+  Logger::Info("        Selected node ",
+               selected ? std::to_string(selected->id()) : "NULL");
   if (selected == nullptr) {
     throw std::runtime_error(
         "Phi node: could not select input (phi=" + std::to_string(n->id()) +
@@ -1472,9 +1923,8 @@ Value Interpreter::EvalPhi(const Node* n) {
     phi_update_active_.insert(n);
   }
 
-  Logger::Info("        About to EvalNode on selected=" +
-               std::to_string(selected->id()) + " (" +
-               OpcodeToString(selected->opcode()) + ")");
+  Logger::Info("        About to EvalNode on selected=", selected->id(), " (",
+               OpcodeName(selected->opcode()), ")");
   Value result = EvalNode(selected);
   Logger::Info("        EvalNode complete");
   return result;
@@ -1483,15 +1933,9 @@ Value Interpreter::EvalPhi(const Node* n) {
 Value Interpreter::EvalBool(const Node* n) {
   // Bool node converts comparison result to boolean
   // Use schema-aware accessor
-  auto value_inputs = n->value_inputs();
-
-  if (value_inputs.empty()) {
-    throw std::runtime_error("Bool node needs comparison value input");
-  }
-
-  Node* cmp_node = value_inputs[0];
+  const Node* cmp_node = FirstValueInput(n);
   if (!cmp_node) {
-    throw std::runtime_error("Bool node comparison input is null");
+    throw std::runtime_error("Bool node needs comparison value input");
   }
 
   Value cmp_result = EvalNode(cmp_node);
@@ -1507,20 +1951,20 @@ Value Interpreter::EvalBool(const Node* n) {
     mask = std::get<int32_t>(n->prop("mask"));
   } else if (n->has_prop("dump_spec")) {
     // Parse dump_spec for condition (e.g., "[le]")
-    std::string spec = std::get<std::string>(n->prop("dump_spec"));
+    std::string_view spec = n->interned_prop("dump_spec").view();
     // Map dump_spec to mask
     // le = LT|EQ = 1|2 = 3, gt = 4, ge = GT|EQ = 4|2 = 6, etc.
-    if (spec.find("le") != std::string::npos) {
+    if (spec.find("le") != std::string_view::npos) {
       mask = 3;  // LT | EQ
-    } else if (spec.find("lt") != std::string::npos) {
+    } else if (spec.find("lt") != std::string_view::npos) {
       mask = 1;  // LT
-    } else if (spec.find("ge") != std::string::npos) {
+    } else if (spec.find("ge") != std::string_view::npos) {
       mask = 6;  // GT | EQ
-    } else if (spec.find("gt") != std::string::npos) {
+    } else if (spec.find("gt") != std::string_view::npos) {
       mask = 4;  // GT
-    } else if (spec.find("eq") != std::string::npos) {
+    } else if (spec.find("eq") != std::string_view::npos) {
       mask = 2;  // EQ
-    } else if (spec.find("ne") != std::string::npos) {
+    } else if (spec.find("ne") != std::string_view::npos) {
       mask = 5;  // LT | GT
     }
   }
@@ -1545,8 +1989,8 @@ Value Interpreter::EvalBool(const Node* n) {
 Value Interpreter::EvalCMove(const Node* n) {
   // CMoveI/L/P: conditional move
   // Use schema-aware accessor
-  auto value_inputs = n->value_inputs();
-  if (value_inputs.size() < 3) {
+  const Node* value_inputs[3];
+  if (GetValueInputs(n, value_inputs, 3) < 3) {
     throw std::runtime_error("CMove needs 3 value inputs");
   }
 
@@ -1565,12 +2009,12 @@ Value Interpreter::EvalCMove(const Node* n) {
 Value Interpreter::EvalConv2B(const Node* n) {
   // Conv2B: Convert any value to boolean (0 -> 0, non-zero -> 1)
   // Use schema-aware accessor
-  auto value_inputs = n->value_inputs();
-  if (value_inputs.empty()) {
+  const Node* input_node = FirstValueInput(n);
+  if (!input_node) {
     throw std::runtime_error("Conv2B needs value input");
   }
 
-  Value input = EvalNode(value_inputs[0]);
+  Value input = EvalNode(input_node);
 
   // Convert to boolean: 0 -> 0, non-zero -> 1
   if (input.is_i32()) {
@@ -1590,11 +2034,10 @@ Value Interpreter::EvalConv2B(const Node* n) {
 
 Value Interpreter::EvalNoOp(const Node* n) {
   // Opaque1: optimization marker, pass through value
-  // Use value_inputs() which respects schema and skips non-value inputs
-  auto vals = n->value_inputs();
-  if (!vals.empty()) {
+  // Use the value inputs, which respect schema and skip non-value inputs
+  if (const Node* first = FirstValueInput(n)) {
     // Pass through the first value input
-    return EvalNode(vals[0]);
+    return EvalNode(first);
   }
   // If no value inputs, return a dummy value (shouldn't happen in practice)
   return Value::MakeI32(0);
@@ -1607,6 +2050,23 @@ Value Interpreter::EvalThreadLocal(const Node* /*n*/) {
   return Value::MakeNull();
 }
 
+MethodRegistry::Method* Interpreter::ResolveCall(const Node* call) {
+  if (!registry_) return nullptr;
+  auto it = call_targets_.find(call);
+  if (it != call_targets_.end()) return it->second;
+
+  MethodRegistry::Method* target = nullptr;
+  if (call->has_prop("dump_spec")) {
+    const Property p = call->prop("dump_spec");
+    if (std::holds_alternative<std::string>(p)) {
+      auto sig = MethodSignature::Parse(std::get<std::string>(p));
+      if (sig) target = registry_->Find(*sig);
+    }
+  }
+  call_targets_[call] = target;
+  return target;
+}
+
 Value Interpreter::EvalCallStaticJava(const Node* n) {
   // CallStaticJava: static method call
   // Most of these in C2 graphs are uncommon_trap (deopt guards)
@@ -1619,9 +2079,74 @@ Value Interpreter::EvalCallStaticJava(const Node* n) {
     }
   }
 
-  // Real method call - not supported in prototype
-  throw std::runtime_error(
-      "CallStaticJava: real method calls not supported in prototype");
+  MethodRegistry::Method* target = ResolveCall(n);
+  if (!target) {
+    throw std::runtime_error(
+        "CallStaticJava: no registered target for node " +
+        std::to_string(n->id()));
+  }
+  auto sig =
+      MethodSignature::Parse(std::get<std::string>(n->prop("dump_spec")));
+  if (!sig->has_params) {
+    throw std::runtime_error("CallStaticJava: argument list of " +
+                             sig->ShortKey() + " is missing from dump_spec");
+  }
+
+  // Arguments start at TypeFunc::Parms (after control, I/O, memory, frame
+  // pointer and return address); a long/double takes a second "half" slot.
+  // Callee graphs number their Parms by slot, natives only see arguments.
+  constexpr size_t kParms = 5;
+  std::vector<Value> slots;
+  std::vector<Value> args;
+  for (size_t i = 0; i < sig->params.size(); ++i) {
+    if (sig->params[i] == "half") {
+      slots.push_back(Value::MakeNull());
+      continue;
+    }
+    if (kParms + i >= n->num_inputs() || !n->input(kParms + i)) {
+      throw std::runtime_error("CallStaticJava: missing argument " +
+                               std::to_string(i) + " of " + sig->Key());
+    }
+    args.push_back(EvalNode(n->input(kParms + i)));
+    slots.push_back(args.back());
+  }
+
+  // Stores on the incoming memory state must land before the callee runs
+  if (n->num_inputs() > 2) {
+    memory_chain_visited_.Clear();
+    ProcessMemoryChain(n->input(2));
+  }
+
+  if (target->native) {
+    return target->native(args, heap_);
+  }
+
+  if (call_depth_ >= kMaxCallDepth) {
+    throw std::runtime_error("CallStaticJava: call depth exceeded (" +
+                             std::to_string(kMaxCallDepth) + ") at " +
+                             sig->Key());
+  }
+
+  // Nested frame: the callee runs on this frame's heap, swapped in and
+  // back out so no objects are copied
+  Interpreter& frame = registry_->AcquireFrame(*target);
+  frame.call_depth_ = call_depth_ + 1;
+  std::swap(frame.heap_, heap_);
+  Outcome outcome;
+  try {
+    outcome = frame.Run(slots);
+  } catch (...) {
+    std::swap(frame.heap_, heap_);
+    registry_->ReleaseFrame(*target);
+    throw;
+  }
+  std::swap(frame.heap_, heap_);
+  registry_->ReleaseFrame(*target);
+
+  if (outcome.kind == Outcome::Kind::kThrow) {
+    throw EvalException(outcome.exception_kind);
+  }
+  return outcome.return_value.value_or(Value::MakeNull());
 }
 
 Value Interpreter::EvalHalt(const Node* /*n*/) {
@@ -1653,7 +2178,26 @@ Value Interpreter::EvalAllocateArray(const Node* n) {
     throw EvalException("Negative array length");
   }
 
-  Ref arr_ref = heap_.AllocateArray(length);
+  // float[]/double[] get typed storage; the element type comes from an
+  // explicit 'elem' property or the array klass in dump_spec
+  Value::Kind elem = Value::Kind::kI32;
+  std::string elem_type;
+  if (n->has_prop("elem")) {
+    elem_type = std::get<std::string>(n->prop("elem"));
+  } else if (n->has_prop("dump_spec")) {
+    std::string spec = std::get<std::string>(n->prop("dump_spec"));
+    if (spec.find("float[") != std::string::npos) elem_type = "float";
+    if (spec.find("double[") != std::string::npos) elem_type = "double";
+  }
+  if (elem_type == "float") {
+    elem = Value::Kind::kF32;
+  } else if (elem_type == "double") {
+    elem = Value::Kind::kF64;
+  } else if (elem_type == "long") {
+    elem = Value::Kind::kI64;
+  }
+
+  Ref arr_ref = heap_.AllocateArray(length, elem);
   return Value::MakeRef(arr_ref);
 }
 
@@ -1665,7 +2209,7 @@ Value Interpreter::EvalLoad(const Node* n) {
   }
 
   // Clear memory chain visited set before processing this load's memory chain
-  memory_chain_visited_.clear();
+  memory_chain_visited_.Clear();
 
   // Process memory chain (execute any Store nodes in the chain)
   Node* mem = n->input(1);
@@ -1800,10 +2344,9 @@ void Interpreter::ProcessMemoryChain(const Node* mem) {
   if (!mem) return;
 
   // Cycle detection: memory chains can have cycles through memory Phis
-  if (memory_chain_visited_.count(mem) > 0) {
+  if (!memory_chain_visited_.insert(mem)) {
     return;  // Already processed this node in this chain walk
   }
-  memory_chain_visited_.insert(mem);
 
   Opcode op = mem->opcode();
 
@@ -1813,16 +2356,18 @@ void Interpreter::ProcessMemoryChain(const Node* mem) {
     return;
   }
 
+  // Recursively process memory input (follow the memory chain backwards),
+  // so older stores land before this one
+  if (mem->num_inputs() >= 2) {
+    ProcessMemoryChain(mem->input(1));
+  }
+
   // If this is a Store, execute it
   if (op == Opcode::kStoreB || op == Opcode::kStoreC || op == Opcode::kStoreI ||
-      op == Opcode::kStoreL || op == Opcode::kStoreP || op == Opcode::kStoreN) {
+      op == Opcode::kStoreL || op == Opcode::kStoreF || op == Opcode::kStoreD ||
+      op == Opcode::kStoreP || op == Opcode::kStoreN) {
     EvalStore(mem);
   }
-
-  // Recursively process memory input (follow the memory chain backwards)
-  if (mem->num_inputs() >= 2) {
-    ProcessMemoryChain(mem->input(1));
-  }
 }
 
 void Interpreter::EvalStore(const Node* n) {
@@ -0,0 +1,149 @@
+#include "suntv/interp/method_registry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "suntv/interp/float_kernels.hpp"
+#include "suntv/interp/interpreter.hpp"
+
+namespace sun {
+
+MethodRegistry::MethodRegistry() = default;
+MethodRegistry::~MethodRegistry() = default;
+
+void MethodRegistry::AddGraph(std::string_view method, const Graph& callee) {
+  Method& m = methods_[MethodSignature::NormalizeKey(method)];
+  if (m.active > 0) {
+    throw std::runtime_error("MethodRegistry: " + std::string(method) +
+                             " is executing");
+  }
+  for (size_t bytes : m.frame_bytes) frame_cache_bytes_ -= bytes;
+  m = Method();
+  m.graph = &callee;
+}
+
+void MethodRegistry::AddNative(std::string_view method, NativeMethod stub) {
+  if (!stub) {
+    throw std::invalid_argument("MethodRegistry: empty native stub for " +
+                                std::string(method));
+  }
+  Method& m = methods_[MethodSignature::NormalizeKey(method)];
+  if (m.active > 0) {
+    throw std::runtime_error("MethodRegistry: " + std::string(method) +
+                             " is executing");
+  }
+  for (size_t bytes : m.frame_bytes) frame_cache_bytes_ -= bytes;
+  m = Method();
+  m.native = std::move(stub);
+}
+
+void MethodRegistry::AddJavaLangMath() {
+  using Args = std::span<const Value>;
+  const std::string math = "java.lang.Math::";
+
+  AddNative(math + "max(int,int)", [](Args a, ConcreteHeap&) {
+    return Value::MakeI32(std::max(a[0].as_i32(), a[1].as_i32()));
+  });
+  AddNative(math + "min(int,int)", [](Args a, ConcreteHeap&) {
+    return Value::MakeI32(std::min(a[0].as_i32(), a[1].as_i32()));
+  });
+  AddNative(math + "max(long,long)", [](Args a, ConcreteHeap&) {
+    return Value::MakeI64(std::max(a[0].as_i64(), a[1].as_i64()));
+  });
+  AddNative(math + "min(long,long)", [](Args a, ConcreteHeap&) {
+    return Value::MakeI64(std::min(a[0].as_i64(), a[1].as_i64()));
+  });
+  AddNative(math + "max(float,float)", [](Args a, ConcreteHeap&) {
+    return Value::MakeF32(FloatKernels::Max(a[0].as_f32(), a[1].as_f32()));
+  });
+  AddNative(math + "min(float,float)", [](Args a, ConcreteHeap&) {
+    return Value::MakeF32(FloatKernels::Min(a[0].as_f32(), a[1].as_f32()));
+  });
+  AddNative(math + "max(double,double)", [](Args a, ConcreteHeap&) {
+    return Value::MakeF64(FloatKernels::Max(a[0].as_f64(), a[1].as_f64()));
+  });
+  AddNative(math + "min(double,double)", [](Args a, ConcreteHeap&) {
+    return Value::MakeF64(FloatKernels::Min(a[0].as_f64(), a[1].as_f64()));
+  });
+
+  // abs(MIN_VALUE) stays MIN_VALUE; negate in unsigned to wrap
+  AddNative(math + "abs(int)", [](Args a, ConcreteHeap&) {
+    const int32_t x = a[0].as_i32();
+    const uint32_t neg = 0u - static_cast<uint32_t>(x);
+    return Value::MakeI32(x < 0 ? static_cast<int32_t>(neg) : x);
+  });
+  AddNative(math + "abs(long)", [](Args a, ConcreteHeap&) {
+    const int64_t x = a[0].as_i64();
+    const uint64_t neg = 0u - static_cast<uint64_t>(x);
+    return Value::MakeI64(x < 0 ? static_cast<int64_t>(neg) : x);
+  });
+  AddNative(math + "abs(float)", [](Args a, ConcreteHeap&) {
+    return Value::MakeF32(std::fabs(a[0].as_f32()));
+  });
+  AddNative(math + "abs(double)", [](Args a, ConcreteHeap&) {
+    return Value::MakeF64(std::fabs(a[0].as_f64()));
+  });
+  AddNative(math + "sqrt(double)", [](Args a, ConcreteHeap&) {
+    return Value::MakeF64(std::sqrt(a[0].as_f64()));
+  });
+}
+
+MethodRegistry::Method* MethodRegistry::Find(const MethodSignature& sig) {
+  if (sig.has_params) {
+    auto it = methods_.find(sig.Key());
+    if (it != methods_.end()) return &it->second;
+  }
+  auto it = methods_.find(MethodSignature::NormalizeKey(sig.ShortKey()));
+  return it == methods_.end() ? nullptr : &it->second;
+}
+
+Interpreter& MethodRegistry::AcquireFrame(Method& method) {
+  if (!method.graph) {
+    throw std::logic_error("MethodRegistry: frame for a native method");
+  }
+  method.last_used = ++tick_;
+  if (method.active == method.frames.size()) {
+    method.frames.push_back(
+        std::make_unique<Interpreter>(*method.graph, this));
+    method.frame_bytes.push_back(0);
+  }
+  frame_cache_bytes_ -= std::exchange(method.frame_bytes[method.active], 0);
+  return *method.frames[method.active++];
+}
+
+void MethodRegistry::ReleaseFrame(Method& method) {
+  if (method.active == 0) {
+    throw std::logic_error("MethodRegistry: release without acquire");
+  }
+  --method.active;
+  size_t bytes = method.frames[method.active]->MemoryUsage().total();
+  method.frame_bytes[method.active] = bytes;
+  frame_cache_bytes_ += bytes;
+  if (frame_cache_limit_ != 0 && frame_cache_bytes_ > frame_cache_limit_) {
+    EvictFrames();
+  }
+}
+
+void MethodRegistry::EvictFrames() {
+  std::vector<Method*> by_age;
+  for (auto& [name, method] : methods_) {
+    if (method.frames.size() > method.active) by_age.push_back(&method);
+  }
+  std::sort(by_age.begin(), by_age.end(), [](Method* a, Method* b) {
+    return a->last_used < b->last_used;
+  });
+  for (Method* method : by_age) {
+    while (method->frames.size() > method->active &&
+           frame_cache_bytes_ > frame_cache_limit_) {
+      frame_cache_bytes_ -= method->frame_bytes.back();
+      method->frames.pop_back();
+      method->frame_bytes.pop_back();
+      ++evictions_;
+    }
+  }
+}
+
+}  // namespace sun
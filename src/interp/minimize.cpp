@@ -0,0 +1,318 @@
+#include "suntv/interp/minimize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "suntv/interp/interpreter.hpp"
+
+namespace sun {
+
+namespace {
+
+struct ArrayPrefix {
+  const char* text;
+  Value::Kind kind;
+};
+
+// Int arrays have no prefix: "[1,2]"
+constexpr ArrayPrefix kArrayPrefixes[] = {
+    {"long", Value::Kind::kI64},
+    {"float", Value::Kind::kF32},
+    {"double", Value::Kind::kF64},
+};
+
+const char* ArrayPrefixOf(Value::Kind kind) {
+  for (const ArrayPrefix& p : kArrayPrefixes) {
+    if (p.kind == kind) return p.text;
+  }
+  return "";
+}
+
+// An element as the array's kind; ints widen as Java's literals would
+Value Element(const std::string& text, Value::Kind kind) {
+  Value v = Value::Parse(text);
+  if (v.kind == kind) return v;
+  if (kind == Value::Kind::kI64 && v.is_i32()) {
+    return Value::MakeI64(v.as_i32());
+  }
+  if (kind == Value::Kind::kF32 && (v.is_i32() || v.is_f64())) {
+    return Value::MakeF32(v.is_i32() ? static_cast<float>(v.as_i32())
+                                     : static_cast<float>(v.as_f64()));
+  }
+  if (kind == Value::Kind::kF64 && (v.is_i32() || v.is_f32())) {
+    return Value::MakeF64(v.is_i32() ? static_cast<double>(v.as_i32())
+                                     : static_cast<double>(v.as_f32()));
+  }
+  throw std::invalid_argument("'" + text + "' is not a " +
+                              (kind == Value::Kind::kI32
+                                   ? std::string("int")
+                                   : std::string(ArrayPrefixOf(kind))));
+}
+
+WitnessArg ParseArg(const std::string& token) {
+  WitnessArg arg;
+  const size_t open = token.find('[');
+  if (open == std::string::npos) {
+    arg.value = Value::Parse(token);
+    return arg;
+  }
+  const std::string prefix = token.substr(0, open);
+  arg.array = Value::Kind::kI32;
+  if (!prefix.empty()) {
+    arg.array.reset();
+    for (const ArrayPrefix& p : kArrayPrefixes) {
+      if (prefix == p.text) arg.array = p.kind;
+    }
+    if (!arg.array) {
+      throw std::invalid_argument("unknown array type '" + prefix + "'");
+    }
+  }
+  if (token.back() != ']') throw std::invalid_argument("unterminated array");
+  const std::string body = token.substr(open + 1, token.size() - open - 2);
+  if (body.empty()) return arg;
+  std::stringstream in(body);
+  std::string element;
+  while (std::getline(in, element, ',')) {
+    arg.elements.push_back(Element(element, *arg.array));
+  }
+  if (body.back() == ',') throw std::invalid_argument("trailing ','");
+  return arg;
+}
+
+// Smaller values to try in place of v, nearest 0 first
+std::vector<Value> TowardsZero(const Value& v) {
+  std::vector<Value> out;
+  auto add = [&](Value c) {
+    if (c.Literal() == v.Literal()) return;
+    for (const Value& o : out) {
+      if (o.Literal() == c.Literal()) return;
+    }
+    out.push_back(c);
+  };
+  switch (v.kind) {
+    case Value::Kind::kI32: {
+      const int32_t x = v.as_i32();
+      if (x == 0) break;
+      add(Value::MakeI32(0));
+      add(Value::MakeI32(x < 0 ? -1 : 1));
+      add(Value::MakeI32(x / 2));
+      add(Value::MakeI32(x > 0 ? x - 1 : x + 1));
+      break;
+    }
+    case Value::Kind::kI64: {
+      const int64_t x = v.as_i64();
+      if (x == 0) break;
+      add(Value::MakeI64(0));
+      add(Value::MakeI64(x < 0 ? -1 : 1));
+      add(Value::MakeI64(x / 2));
+      add(Value::MakeI64(x > 0 ? x - 1 : x + 1));
+      break;
+    }
+    case Value::Kind::kF32: {
+      const float x = v.as_f32();
+      add(Value::MakeF32(0.0f));
+      if (std::isfinite(x) && std::fabs(x) > 1) {
+        add(Value::MakeF32(std::copysign(1.0f, x)));
+        add(Value::MakeF32(std::trunc(x)));
+        add(Value::MakeF32(x / 2));
+      }
+      break;
+    }
+    case Value::Kind::kF64: {
+      const double x = v.as_f64();
+      add(Value::MakeF64(0.0));
+      if (std::isfinite(x) && std::fabs(x) > 1) {
+        add(Value::MakeF64(std::copysign(1.0, x)));
+        add(Value::MakeF64(std::trunc(x)));
+        add(Value::MakeF64(x / 2));
+      }
+      break;
+    }
+    case Value::Kind::kBool:
+    case Value::Kind::kRef:
+    case Value::Kind::kNull:
+      break;
+  }
+  return out;
+}
+
+bool Disagree(const EngineResult& a, const EngineResult& b) {
+  return a.kind != EngineResult::Kind::kError &&
+         b.kind != EngineResult::Kind::kError && !a.Matches(b);
+}
+
+class Minimizer {
+ public:
+  Minimizer(const Graph& before, const Graph& after,
+            const MinimizeOptions& options)
+      : options_(options), before_(before), after_(after) {}
+
+  std::optional<MinimizeResult> Run(const Witness& start) {
+    result_.witness = start;
+    if (!Try(start)) return std::nullopt;
+    while (result_.runs < options_.max_runs && Step()) ++result_.steps;
+    return std::move(result_);
+  }
+
+ private:
+  // One pass over the candidates of the current witness; true once one
+  // still disagrees and has become the current witness
+  bool Step() {
+    const Witness w = result_.witness;
+    for (size_t i = 0; i < w.args.size(); ++i) {
+      const WitnessArg& arg = w.args[i];
+      if (!arg.array) {
+        for (const Value& v : TowardsZero(arg.value)) {
+          Witness c = w;
+          c.args[i].value = v;
+          if (Try(c)) return true;
+        }
+        continue;
+      }
+
+      Witness c = w;
+      c.args[i] = WitnessArg{Value::MakeNull(), std::nullopt, {}};
+      if (Try(c)) return true;
+
+      // Cut chunks of halving size, whole array first
+      const size_t n = arg.elements.size();
+      for (size_t chunk = n; chunk >= 1; chunk /= 2) {
+        for (size_t from = 0; from < n; from += chunk) {
+          c = w;
+          std::vector<Value>& e = c.args[i].elements;
+          e.erase(e.begin() + from, e.begin() + std::min(n, from + chunk));
+          if (Try(c)) return true;
+        }
+      }
+
+      for (size_t j = 0; j < n; ++j) {
+        for (const Value& v : TowardsZero(arg.elements[j])) {
+          c = w;
+          c.args[i].elements[j] = v;
+          if (Try(c)) return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Run both graphs; keep the candidate if they still disagree
+  bool Try(const Witness& candidate) {
+    if (result_.runs >= options_.max_runs) return false;
+    ++result_.runs;
+    EngineResult a;
+    EngineResult b;
+    try {
+      ConcreteHeap heap;
+      std::vector<Value> inputs = candidate.Materialize(heap);
+      a = CaptureRun(before_, inputs, &heap);
+      b = CaptureRun(after_, inputs, &heap);
+    } catch (const std::exception&) {
+      return false;
+    }
+    if (!Disagree(a, b)) return false;
+    result_.witness = candidate;
+    result_.before = std::move(a);
+    result_.after = std::move(b);
+    return true;
+  }
+
+  const MinimizeOptions& options_;
+  Interpreter before_;
+  Interpreter after_;
+  MinimizeResult result_;
+};
+
+}  // namespace
+
+Witness Witness::Parse(const std::vector<std::string>& tokens) {
+  Witness w;
+  for (const std::string& token : tokens) {
+    try {
+      w.args.push_back(ParseArg(token));
+    } catch (const std::invalid_argument& e) {
+      throw std::invalid_argument("bad argument '" + token +
+                                  "': " + e.what());
+    } catch (const std::out_of_range&) {
+      throw std::invalid_argument("bad argument '" + token +
+                                  "': out of range");
+    }
+  }
+  return w;
+}
+
+Witness Witness::FromValues(const std::vector<Value>& values) {
+  Witness w;
+  for (const Value& v : values) w.args.push_back(WitnessArg{v, {}, {}});
+  return w;
+}
+
+Witness Witness::Load(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("cannot read '" + path + "'");
+  std::vector<std::string> tokens;
+  std::string line;
+  while (std::getline(in, line)) {
+    const size_t first = line.find_first_not_of(" \t");
+    if (first == std::string::npos || line[first] == '#') continue;
+    std::stringstream words(line);
+    std::string token;
+    while (words >> token) tokens.push_back(token);
+  }
+  return Parse(tokens);
+}
+
+std::string Witness::ToString() const {
+  std::string out;
+  for (const WitnessArg& arg : args) {
+    if (!out.empty()) out += " ";
+    if (!arg.array) {
+      out += arg.value.Literal();
+      continue;
+    }
+    out += ArrayPrefixOf(*arg.array);
+    out += "[";
+    for (size_t i = 0; i < arg.elements.size(); ++i) {
+      if (i > 0) out += ",";
+      out += arg.elements[i].Literal();
+    }
+    out += "]";
+  }
+  return out;
+}
+
+std::vector<Value> Witness::Materialize(ConcreteHeap& heap) const {
+  std::vector<Value> inputs;
+  for (const WitnessArg& arg : args) {
+    if (!arg.array) {
+      inputs.push_back(arg.value);
+      continue;
+    }
+    const Ref ref = heap.AllocateArray(
+        static_cast<int32_t>(arg.elements.size()), *arg.array);
+    for (size_t i = 0; i < arg.elements.size(); ++i) {
+      heap.WriteArray(ref, static_cast<int32_t>(i), arg.elements[i]);
+    }
+    inputs.push_back(Value::MakeRef(ref));
+  }
+  return inputs;
+}
+
+std::optional<MinimizeResult> MinimizeWitness(const Graph& before,
+                                              const Graph& after,
+                                              const Witness& start,
+                                              const MinimizeOptions& options) {
+  return Minimizer(before, after, options).Run(start);
+}
+
+std::string WitnessFile(const Witness& witness,
+                        const std::vector<std::string>& comments) {
+  std::string out;
+  for (const std::string& c : comments) out += "# " + c + "\n";
+  return out + witness.ToString() + "\n";
+}
+
+}  // namespace sun
@@ -0,0 +1,122 @@
+#include "suntv/interp/phase_pipeline.hpp"
+
+#include <utility>
+
+#include "suntv/ir/mach_lowering.hpp"
+
+namespace sun {
+
+namespace {
+
+DiffEngine ReusedInterpreter() {
+  for (DiffEngine& engine : DifferentialTester::Engines()) {
+    if (engine.name == "interpreter-reused") return engine;
+  }
+  return DifferentialTester::Engines().front();
+}
+
+}  // namespace
+
+const char* PhasePairVerdictName(PhasePair::Verdict verdict) {
+  switch (verdict) {
+    case PhasePair::Verdict::kIdentical:
+      return "identical";
+    case PhasePair::Verdict::kProven:
+      return "proven";
+    case PhasePair::Verdict::kAgree:
+      return "agree";
+    case PhasePair::Verdict::kDiffer:
+      return "differ";
+    case PhasePair::Verdict::kUnknown:
+      return "unknown";
+  }
+  return "?";
+}
+
+PhasePipeline::PhasePipeline(std::vector<std::vector<Value>> inputs,
+                             DiffEngine engine)
+    : inputs_(std::move(inputs)), engine_(std::move(engine)) {}
+
+PhasePipeline::PhasePipeline(std::vector<std::vector<Value>> inputs)
+    : PhasePipeline(std::move(inputs), ReusedInterpreter()) {}
+
+const Graph* PhasePipeline::Runnable(PhaseState& state) {
+  if (!IsMachGraph(*state.graph)) return state.graph;
+  if (!state.lowered && state.error.empty()) {
+    try {
+      std::vector<const Graph*> before(history_.begin(),
+                                       history_.begin() + state.index);
+      state.lowered = LowerMachGraph(*state.graph, before);
+    } catch (const std::exception& e) {
+      state.error = e.what();
+      if (state.error.empty()) state.error = "cannot be lowered";
+    }
+  }
+  return state.lowered.get();
+}
+
+const std::vector<EngineResult>& PhasePipeline::Signature(PhaseState& state) {
+  if (state.signature) return *state.signature;
+  EngineResult error;
+  error.kind = EngineResult::Kind::kError;
+  try {
+    if (const Graph* graph = Runnable(state)) {
+      ++executions_;
+      state.signature = engine_.run(*graph, inputs_);
+      return *state.signature;
+    }
+    error.message = state.error;
+  } catch (const std::exception& e) {
+    error.message = e.what();
+  }
+  state.signature.emplace(inputs_.size(), error);
+  return *state.signature;
+}
+
+std::optional<PhasePair> PhasePipeline::Add(const Graph& phase) {
+  auto state = std::make_unique<PhaseState>(
+      PhaseState{history_.size(), &phase, StructuralHashes(phase), {}, {},
+                 {}});
+  history_.push_back(&phase);
+  std::unique_ptr<PhaseState> prev = std::exchange(last_, std::move(state));
+  if (!prev) return std::nullopt;
+  PhaseState& cur = *last_;
+
+  PhasePair pair;
+  pair.before = prev->index;
+  pair.after = cur.index;
+  pair.changed_nodes = cur.hashes.CountChanged(prev->hashes);
+  if (cur.hashes.graph() == prev->hashes.graph()) {
+    pair.verdict = PhasePair::Verdict::kIdentical;
+    cur.signature = std::move(prev->signature);
+    return pair;
+  }
+  if (proof_limits_) {
+    const Graph* a = Runnable(*prev);
+    const Graph* b = Runnable(cur);
+    if (a && b && ProveEquivalent(*a, *b, *proof_limits_).proven) {
+      pair.verdict = PhasePair::Verdict::kProven;
+      cur.signature = std::move(prev->signature);
+      return pair;
+    }
+  }
+
+  const std::vector<EngineResult>& a = Signature(*prev);
+  const std::vector<EngineResult>& b = Signature(cur);
+  pair.verdict = PhasePair::Verdict::kAgree;
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (a[i].kind == EngineResult::Kind::kError ||
+        b[i].kind == EngineResult::Kind::kError) {
+      pair.verdict = PhasePair::Verdict::kUnknown;
+    } else if (!a[i].Matches(b[i])) {
+      pair.verdict = PhasePair::Verdict::kDiffer;
+      pair.input = i;
+      pair.before_result = a[i];
+      pair.after_result = b[i];
+      break;
+    }
+  }
+  return pair;
+}
+
+}  // namespace sun
@@ -1,5 +1,8 @@
 #include "suntv/interp/value.hpp"
 
+#include <cmath>
+#include <cstdio>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 
@@ -40,6 +43,81 @@ Value Value::MakeNull() {
   return val;
 }
 
+Value Value::MakeF32(float v) {
+  Value val;
+  val.kind = Kind::kF32;
+  val.data.f32 = v;
+  return val;
+}
+
+Value Value::MakeF64(double v) {
+  Value val;
+  val.kind = Kind::kF64;
+  val.data.f64 = v;
+  return val;
+}
+
+Value Value::Parse(const std::string& text) {
+  size_t end = 0;
+  if (text == "null") return MakeNull();
+  if (!text.empty() && (text.back() == 'L' || text.back() == 'l')) {
+    int64_t val64 = std::stoll(text, &end);
+    if (end + 1 == text.size()) return MakeI64(val64);
+    throw std::invalid_argument("trailing characters");
+  }
+  const bool is_float =
+      !text.empty() && (text.back() == 'f' || text.back() == 'F');
+  const bool is_double = text.find_first_of(".eE") != std::string::npos ||
+                         text.find("NaN") != std::string::npos ||
+                         text.find("Infinity") != std::string::npos;
+  if (is_float) {
+    float f = std::stof(text, &end);
+    if (end + 1 == text.size()) return MakeF32(f);
+  } else if (is_double) {
+    double d = std::stod(text, &end);
+    if (end == text.size()) return MakeF64(d);
+  } else {
+    try {
+      // Try int32 first
+      int32_t val32 = std::stoi(text, &end);
+      if (end == text.size()) return MakeI32(val32);
+    } catch (const std::out_of_range&) {
+      // If out of range for int32, try int64
+      int64_t val64 = std::stoll(text, &end);
+      if (end == text.size()) return MakeI64(val64);
+    }
+  }
+  throw std::invalid_argument("trailing characters");
+}
+
+std::string Value::Literal() const {
+  auto real = [](double v, int digits) -> std::string {
+    if (std::isnan(v)) return "NaN";
+    if (std::isinf(v)) return v < 0 ? "-Infinity" : "Infinity";
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*g", digits, v);
+    std::string s = buf;
+    if (s.find_first_of(".e") == std::string::npos) s += ".0";
+    return s;
+  };
+  switch (kind) {
+    case Kind::kI32:
+      return std::to_string(data.i32);
+    case Kind::kI64:
+      return std::to_string(data.i64) + "L";
+    case Kind::kF32:
+      return real(data.f32, 9) + "f";
+    case Kind::kF64:
+      return real(data.f64, 17);
+    case Kind::kNull:
+      return "null";
+    case Kind::kBool:
+    case Kind::kRef:
+      break;
+  }
+  throw std::invalid_argument("no literal for " + ToString());
+}
+
 int32_t Value::as_i32() const {
   if (kind != Kind::kI32) {
     throw std::runtime_error("Value is not i32");
@@ -68,6 +146,34 @@ Ref Value::as_ref() const {
   return data.ref;
 }
 
+float Value::as_f32() const {
+  if (kind != Kind::kF32) {
+    throw std::runtime_error("Value is not f32");
+  }
+  return data.f32;
+}
+
+double Value::as_f64() const {
+  if (kind != Kind::kF64) {
+    throw std::runtime_error("Value is not f64");
+  }
+  return data.f64;
+}
+
+// Java spelling for the non-finite values; finite values get enough digits
+// to round-trip
+template <typename T>
+static void PrintFloat(std::ostringstream& oss, T v) {
+  if (std::isnan(v)) {
+    oss << "NaN";
+  } else if (std::isinf(v)) {
+    oss << (v < 0 ? "-Infinity" : "Infinity");
+  } else {
+    oss.precision(std::numeric_limits<T>::max_digits10);
+    oss << v;
+  }
+}
+
 std::string Value::ToString() const {
   std::ostringstream oss;
   switch (kind) {
@@ -86,6 +192,14 @@ std::string Value::ToString() const {
     case Kind::kNull:
       oss << "null";
       break;
+    case Kind::kF32:
+      oss << "f32:";
+      PrintFloat(oss, data.f32);
+      break;
+    case Kind::kF64:
+      oss << "f64:";
+      PrintFloat(oss, data.f64);
+      break;
   }
   return oss.str();
 }
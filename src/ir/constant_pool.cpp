@@ -0,0 +1,164 @@
+#include "suntv/ir/constant_pool.hpp"
+
+#include <bit>
+#include <charconv>
+#include <limits>
+
+namespace sun {
+
+ConstantPool::ConstantPool(Arena& arena) : arena_(arena), table_(&arena) {}
+
+const Constant* ConstantPool::Intern(Opcode op, int64_t value) {
+  Key key{op, value};
+  auto it = table_.find(key);
+  if (it != table_.end()) {
+    return it->second;
+  }
+  const Constant* c =
+      arena_.New<Constant>(Constant{op, value, static_cast<uint32_t>(size_)});
+  ++size_;
+  table_.emplace(key, c);
+  return c;
+}
+
+const Constant* ConstantPool::InternDumpSpec(Opcode op,
+                                             std::string_view spec) {
+  std::optional<int64_t> value = DecodeDumpSpec(op, spec);
+  if (!value) {
+    return nullptr;
+  }
+  return Intern(op, *value);
+}
+
+namespace {
+
+// Parse C2's "%f" spelling of a float constant ("nan" and "inf" included)
+// or Java's "NaN"/"Infinity". Parsing directly as T avoids double rounding.
+template <typename T>
+std::optional<T> ParseFloat(std::string_view text) {
+  bool negative = !text.empty() && text.front() == '-';
+  if (negative) text.remove_prefix(1);
+
+  T value = 0;
+  if (text.substr(0, 3) == "NaN") {
+    value = std::numeric_limits<T>::quiet_NaN();
+    text.remove_prefix(3);
+  } else if (text.substr(0, 8) == "Infinity") {
+    value = std::numeric_limits<T>::infinity();
+    text.remove_prefix(8);
+  } else {
+    auto [end, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end == text.data()) {
+      return std::nullopt;
+    }
+    text.remove_prefix(end - text.data());
+  }
+  if (!text.empty() && text.front() != ' ') {
+    return std::nullopt;
+  }
+  return negative ? -value : value;
+}
+
+// Format: " #ftcon:1.500000" / " #dblcon:-Infinity" (older dumps spell the
+// type "float"/"double")
+std::optional<int64_t> DecodeFloatSpec(Opcode op, std::string_view spec) {
+  size_t colon = spec.find(':');
+  if (colon == std::string_view::npos) {
+    return std::nullopt;
+  }
+  std::string_view text = spec.substr(colon + 1);
+  while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+    text.remove_prefix(1);
+  }
+  if (op == Opcode::kConF) {
+    std::optional<float> f = ParseFloat<float>(text);
+    if (!f) return std::nullopt;
+    return std::bit_cast<uint32_t>(*f);
+  }
+  std::optional<double> d = ParseFloat<double>(text);
+  if (!d) return std::nullopt;
+  return std::bit_cast<int64_t>(*d);
+}
+
+}  // namespace
+
+std::optional<int64_t> ConstantPool::DecodeDumpSpec(Opcode op,
+                                                    std::string_view spec) {
+  if (op == Opcode::kConP) {
+    // Only the null constant has a meaningful concrete value.
+    if (spec.find("null") != std::string_view::npos) return 0;
+    return std::nullopt;
+  }
+  if (op == Opcode::kConF || op == Opcode::kConD) {
+    return DecodeFloatSpec(op, spec);
+  }
+  if (op != Opcode::kConI && op != Opcode::kConL) {
+    return std::nullopt;
+  }
+
+  // Format: " #int:<value>" / " #long:<value>"
+  size_t colon = spec.find(':');
+  if (colon == std::string_view::npos) {
+    return std::nullopt;
+  }
+  std::string_view digits = spec.substr(colon + 1);
+  while (!digits.empty() && (digits.front() == ' ' || digits.front() == '\t')) {
+    digits.remove_prefix(1);
+  }
+
+  // C2 prints values near the type bounds symbolically: "max", "min+3",
+  // and for longs also "maxint-15" / "minint" (the int32 bounds).
+  int64_t base = 0;
+  bool symbolic = false;
+  const bool is_int = op == Opcode::kConI;
+  struct Bound {
+    std::string_view name;
+    int64_t value;
+  };
+  const Bound bounds[] = {
+      {"minint", INT32_MIN},
+      {"maxint", INT32_MAX},
+      {"min", is_int ? int64_t{INT32_MIN} : INT64_MIN},
+      {"max", is_int ? int64_t{INT32_MAX} : INT64_MAX},
+  };
+  for (const Bound& b : bounds) {
+    if (digits.substr(0, b.name.size()) == b.name) {
+      base = b.value;
+      symbolic = true;
+      digits.remove_prefix(b.name.size());
+      break;
+    }
+  }
+
+  int64_t value = 0;
+  if (symbolic) {
+    if (digits.empty() || digits.front() == ' ') {
+      return base;
+    }
+    if (digits.front() != '+' && digits.front() != '-') {
+      return std::nullopt;
+    }
+    bool negative = digits.front() == '-';
+    digits.remove_prefix(1);
+    int64_t offset = 0;
+    auto [end, ec] =
+        std::from_chars(digits.data(), digits.data() + digits.size(), offset);
+    if (ec != std::errc() || end == digits.data()) {
+      return std::nullopt;
+    }
+    value = negative ? base - offset : base + offset;
+  } else {
+    auto [end, ec] =
+        std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (ec != std::errc() || end == digits.data()) {
+      return std::nullopt;
+    }
+  }
+  if (op == Opcode::kConI && (value < INT32_MIN || value > INT32_MAX)) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+}  // namespace sun
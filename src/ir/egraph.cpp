@@ -0,0 +1,1098 @@
+#include "suntv/ir/egraph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+#include "suntv/ir/constant_pool.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/node.hpp"
+
+namespace sun {
+
+namespace {
+
+// Placeholder leaves: a null input, and a node's input to itself
+constexpr int64_t kHole = -1;
+constexpr int64_t kSelf = -2;
+
+bool IsLoadOp(Opcode op) { return OpcodeName(op).starts_with("Load"); }
+bool IsStoreOp(Opcode op) { return OpcodeName(op).starts_with("Store"); }
+
+bool IsConstantOp(Opcode op) {
+  switch (op) {
+    case Opcode::kConI:
+    case Opcode::kConL:
+    case Opcode::kConP:
+    case Opcode::kConF:
+    case Opcode::kConD:
+      return true;
+    default:
+      return false;
+  }
+}
+
+int64_t WrapI(int64_t v) {
+  return static_cast<int32_t>(static_cast<uint32_t>(v));
+}
+
+}  // namespace
+
+// ========== ENode ==========
+
+size_t ENodeHash::operator()(const ENode& n) const {
+  uint64_t h = static_cast<uint64_t>(n.op) * 0x9E3779B97F4A7C15ull;
+  h ^= static_cast<uint64_t>(n.payload) + 0x7F4A7C15ull + (h << 6) + (h >> 2);
+  h ^= n.symbol + 0x9E3779B9ull + (h << 6) + (h >> 2);
+  for (EClassId c : n.children) {
+    h ^= c + 0x9E3779B9ull + (h << 6) + (h >> 2);
+  }
+  return static_cast<size_t>(h);
+}
+
+// ========== EGraph ==========
+
+EGraph::EGraph() = default;
+EGraph::~EGraph() = default;
+
+uint32_t EGraph::Intern(const std::string& text) {
+  auto [it, fresh] =
+      symbols_.emplace(text, static_cast<uint32_t>(symbols_.size() + 1));
+  return it->second;
+}
+
+EClassId EGraph::Find(EClassId id) const {
+  while (parent_[id] != id) {
+    parent_[id] = parent_[parent_[id]];
+    id = parent_[id];
+  }
+  return id;
+}
+
+ENode EGraph::Canonical(ENode n) const {
+  for (EClassId& c : n.children) c = Find(c);
+  return n;
+}
+
+std::optional<EGraph::Constant> EGraph::constant(EClassId id) const {
+  return classes_[Find(id)].constant;
+}
+
+const std::vector<ENode>& EGraph::nodes(EClassId id) const {
+  return classes_[Find(id)].nodes;
+}
+
+std::vector<EClassId> EGraph::classes() const {
+  std::vector<EClassId> out;
+  out.reserve(num_classes_);
+  for (EClassId id = 0; id < parent_.size(); ++id) {
+    if (parent_[id] == id) out.push_back(id);
+  }
+  return out;
+}
+
+// Constant value of n from the constants known for its children
+std::optional<EGraph::Constant> EGraph::Fold(const ENode& n) const {
+  if (IsConstantOp(n.op)) {
+    if (n.symbol != 0) return std::nullopt;  // Value not known
+    return Constant{n.op, n.payload};
+  }
+
+  auto arg = [&](size_t i, Opcode op) -> std::optional<int64_t> {
+    if (i >= n.children.size()) return std::nullopt;
+    const std::optional<Constant>& c = classes_[Find(n.children[i])].constant;
+    if (!c || c->op != op) return std::nullopt;
+    return c->value;
+  };
+  auto int_result = [](int64_t v) { return Constant{Opcode::kConI, WrapI(v)}; };
+  auto long_result = [](uint64_t v) {
+    return Constant{Opcode::kConL, static_cast<int64_t>(v)};
+  };
+
+  switch (n.op) {
+    case Opcode::kCastII:
+      if (auto a = arg(0, Opcode::kConI)) return int_result(*a);
+      return std::nullopt;
+    case Opcode::kCastLL:
+      if (auto a = arg(0, Opcode::kConL)) return long_result(*a);
+      return std::nullopt;
+    case Opcode::kConvI2L:
+      if (auto a = arg(0, Opcode::kConI)) return long_result(*a);
+      return std::nullopt;
+    case Opcode::kConvL2I:
+      if (auto a = arg(0, Opcode::kConL)) return int_result(*a);
+      return std::nullopt;
+    case Opcode::kAbsI:
+      if (auto a = arg(0, Opcode::kConI)) {
+        return int_result(*a < 0 ? -static_cast<uint64_t>(*a) : *a);
+      }
+      return std::nullopt;
+    case Opcode::kAbsL:
+      if (auto a = arg(0, Opcode::kConL)) {
+        return long_result(*a < 0 ? -static_cast<uint64_t>(*a) : *a);
+      }
+      return std::nullopt;
+    default:
+      break;
+  }
+
+  if (n.children.size() != 2) return std::nullopt;
+  if (auto a = arg(0, Opcode::kConI)) {
+    auto b = arg(1, Opcode::kConI);
+    if (!b) return std::nullopt;
+    const uint32_t x = static_cast<uint32_t>(*a);
+    const uint32_t y = static_cast<uint32_t>(*b);
+    switch (n.op) {
+      case Opcode::kAddI: return int_result(x + y);
+      case Opcode::kSubI: return int_result(x - y);
+      case Opcode::kMulI: return int_result(x * y);
+      case Opcode::kAndI: return int_result(x & y);
+      case Opcode::kOrI: return int_result(x | y);
+      case Opcode::kXorI: return int_result(x ^ y);
+      case Opcode::kLShiftI: return int_result(x << (y & 31));
+      case Opcode::kRShiftI:
+        return int_result(static_cast<int32_t>(x) >> (y & 31));
+      case Opcode::kURShiftI: return int_result(x >> (y & 31));
+      case Opcode::kDivI:
+      case Opcode::kModI: {
+        // Division by zero throws, so only a nonzero divisor folds
+        if (y == 0) return std::nullopt;
+        const int32_t p = static_cast<int32_t>(x);
+        const int32_t q = static_cast<int32_t>(y);
+        if (q == -1) return int_result(n.op == Opcode::kDivI ? 0u - x : 0);
+        return int_result(n.op == Opcode::kDivI ? p / q : p % q);
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+  auto a = arg(0, Opcode::kConL);
+  if (!a) return std::nullopt;
+  const uint64_t x = static_cast<uint64_t>(*a);
+  if (n.op == Opcode::kLShiftL || n.op == Opcode::kRShiftL ||
+      n.op == Opcode::kURShiftL) {
+    auto s = arg(1, Opcode::kConI);
+    if (!s) return std::nullopt;
+    const int shift = static_cast<int>(*s & 63);
+    if (n.op == Opcode::kLShiftL) return long_result(x << shift);
+    if (n.op == Opcode::kURShiftL) return long_result(x >> shift);
+    return long_result(static_cast<uint64_t>(*a >> shift));
+  }
+  auto b = arg(1, Opcode::kConL);
+  if (!b) return std::nullopt;
+  const uint64_t y = static_cast<uint64_t>(*b);
+  switch (n.op) {
+    case Opcode::kAddL: return long_result(x + y);
+    case Opcode::kSubL: return long_result(x - y);
+    case Opcode::kMulL: return long_result(x * y);
+    case Opcode::kAndL: return long_result(x & y);
+    case Opcode::kOrL: return long_result(x | y);
+    case Opcode::kXorL: return long_result(x ^ y);
+    case Opcode::kDivL:
+    case Opcode::kModL: {
+      if (y == 0) return std::nullopt;
+      if (*b == -1) return long_result(n.op == Opcode::kDivL ? 0 - x : 0);
+      return long_result(static_cast<uint64_t>(n.op == Opcode::kDivL
+                                                   ? *a / *b
+                                                   : *a % *b));
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+EClassId EGraph::Add(ENode n) {
+  n = Canonical(std::move(n));
+  if (auto it = memo_.find(n); it != memo_.end()) return Find(it->second);
+
+  const EClassId id = static_cast<EClassId>(classes_.size());
+  parent_.push_back(id);
+  const std::optional<Constant> folded = Fold(n);
+  classes_.push_back(
+      EClass{{n}, {}, IsConstantOp(n.op) ? folded : std::nullopt});
+  ++num_classes_;
+  std::vector<EClassId> children = n.children;
+  std::sort(children.begin(), children.end());
+  children.erase(std::unique(children.begin(), children.end()), children.end());
+  for (EClassId c : children) classes_[c].parents.emplace_back(n, id);
+  memo_.emplace(std::move(n), id);
+
+  // A folded operation is its constant
+  if (folded && !IsConstantOp(classes_[id].nodes[0].op)) {
+    Merge(id, AddConstant(folded->op, folded->value));
+  }
+  return Find(id);
+}
+
+EClassId EGraph::AddConstant(Opcode op, int64_t value) {
+  ENode n;
+  n.op = op;
+  n.payload = op == Opcode::kConI ? WrapI(value) : value;
+  return Add(std::move(n));
+}
+
+bool EGraph::Merge(EClassId a, EClassId b) {
+  a = Find(a);
+  b = Find(b);
+  if (a == b) return false;
+  if (classes_[a].parents.size() < classes_[b].parents.size()) std::swap(a, b);
+  parent_[b] = a;
+  --num_classes_;
+
+  EClass& into = classes_[a];
+  EClass& from = classes_[b];
+  into.nodes.insert(into.nodes.end(), from.nodes.begin(), from.nodes.end());
+  into.parents.insert(into.parents.end(), from.parents.begin(),
+                      from.parents.end());
+  if (!into.constant) into.constant = from.constant;
+  from.nodes.clear();
+  from.nodes.shrink_to_fit();
+  from.parents.clear();
+  from.parents.shrink_to_fit();
+  pending_.push_back(a);
+  return true;
+}
+
+void EGraph::Repair(EClassId id) {
+  std::vector<std::pair<ENode, EClassId>> parents =
+      std::move(classes_[id].parents);
+  classes_[id].parents.clear();
+  for (const auto& [n, c] : parents) memo_.erase(n);
+
+  // Parents that became equal operators over equal children are congruent
+  std::unordered_map<ENode, EClassId, ENodeHash> seen;
+  for (auto& [n, c] : parents) {
+    ENode canon = Canonical(n);
+    if (auto it = seen.find(canon); it != seen.end()) {
+      Merge(it->second, c);
+      it->second = Find(c);
+    } else {
+      seen.emplace(canon, Find(c));
+    }
+    if (auto [it, fresh] = memo_.emplace(canon, Find(c)); !fresh) {
+      Merge(it->second, c);
+      it->second = Find(c);
+    }
+    // The merge may have made the parent's children constants
+    if (!classes_[Find(c)].constant) {
+      if (std::optional<Constant> folded = Fold(canon)) {
+        Merge(c, AddConstant(folded->op, folded->value));
+      }
+    }
+  }
+  std::vector<std::pair<ENode, EClassId>>& into = classes_[Find(id)].parents;
+  for (auto& [n, c] : seen) into.emplace_back(n, Find(c));
+}
+
+void EGraph::Rebuild() {
+  std::vector<EClassId> touched;
+  while (!pending_.empty()) {
+    std::vector<EClassId> todo;
+    todo.swap(pending_);
+    for (EClassId& id : todo) id = Find(id);
+    std::sort(todo.begin(), todo.end());
+    todo.erase(std::unique(todo.begin(), todo.end()), todo.end());
+    for (EClassId id : todo) Repair(Find(id));
+    touched.insert(touched.end(), todo.begin(), todo.end());
+  }
+
+  // Canonical, duplicate-free node lists for matching
+  for (EClassId& id : touched) id = Find(id);
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+  for (EClassId id : touched) {
+    std::vector<ENode>& nodes = classes_[id].nodes;
+    std::unordered_set<ENode, ENodeHash> unique;
+    std::vector<ENode> kept;
+    for (ENode& n : nodes) {
+      ENode canon = Canonical(std::move(n));
+      if (unique.insert(canon).second) kept.push_back(std::move(canon));
+    }
+    nodes = std::move(kept);
+  }
+}
+
+// ========== Rewrite ==========
+
+struct Rewrite::Pattern {
+  enum class Kind { kVar, kConstant, kNode };
+
+  Kind kind = Kind::kNode;
+  Opcode op = Opcode::kUnknown;
+  int64_t payload = 0;  // kNode: exact payload; kConstant: value
+  size_t var = 0;
+  std::vector<Pattern> children;
+};
+
+namespace {
+
+class PatternParser {
+ public:
+  PatternParser(std::string_view text, std::vector<std::string>& vars,
+                bool bind)
+      : text_(text), vars_(vars), bind_(bind) {}
+
+  Rewrite::Pattern Parse() {
+    Rewrite::Pattern p = Term();
+    Skip();
+    if (pos_ != text_.size()) Fail("trailing text");
+    return p;
+  }
+
+ private:
+  using Pattern = Rewrite::Pattern;
+
+  Pattern Term() {
+    Skip();
+    if (pos_ < text_.size() && text_[pos_] == '?') {
+      ++pos_;
+      const std::string name(Atom());
+      Pattern p;
+      p.kind = Pattern::Kind::kVar;
+      auto it = std::find(vars_.begin(), vars_.end(), name);
+      if (it == vars_.end()) {
+        if (!bind_) Fail("unbound variable ?" + name);
+        vars_.push_back(name);
+        it = vars_.end() - 1;
+      }
+      p.var = static_cast<size_t>(it - vars_.begin());
+      return p;
+    }
+    if (pos_ >= text_.size() || text_[pos_] != '(') Fail("expected '('");
+    ++pos_;
+    Skip();
+    std::string_view head = Atom();
+    Pattern p;
+    const size_t colon = head.find(':');
+    p.op = StringToOpcode(head.substr(0, colon));
+    if (p.op == Opcode::kUnknown) Fail("unknown opcode");
+    if (colon != std::string_view::npos) {
+      p.payload = Number(head.substr(colon + 1));
+    }
+    Skip();
+    if (IsConstantOp(p.op)) {
+      p.kind = Pattern::Kind::kConstant;
+      p.payload = Number(Atom());
+    } else {
+      while (Skip(), pos_ < text_.size() && text_[pos_] != ')') {
+        p.children.push_back(Term());
+      }
+    }
+    Skip();
+    if (pos_ >= text_.size() || text_[pos_] != ')') Fail("expected ')'");
+    ++pos_;
+    return p;
+  }
+
+  std::string_view Atom() {
+    const size_t begin = pos_;
+    while (pos_ < text_.size() && text_[pos_] != ' ' && text_[pos_] != '(' &&
+           text_[pos_] != ')') {
+      ++pos_;
+    }
+    if (pos_ == begin) Fail("expected a name");
+    return text_.substr(begin, pos_ - begin);
+  }
+
+  int64_t Number(std::string_view s) {
+    try {
+      size_t end = 0;
+      const int64_t v = std::stoll(std::string(s), &end);
+      if (end == s.size()) return v;
+    } catch (const std::exception&) {
+    }
+    Fail("expected a number");
+  }
+
+  void Skip() {
+    while (pos_ < text_.size() && text_[pos_] == ' ') ++pos_;
+  }
+
+  [[noreturn]] void Fail(const std::string& what) {
+    throw std::invalid_argument("pattern '" + std::string(text_) + "': " +
+                                what + " at " + std::to_string(pos_));
+  }
+
+  std::string_view text_;
+  std::vector<std::string>& vars_;
+  bool bind_;
+  size_t pos_ = 0;
+};
+
+constexpr EClassId kUnbound = UINT32_MAX;
+
+void MatchInto(const EGraph& g, const Rewrite::Pattern& p, EClassId id,
+               const Rewrite::Bindings& b,
+               std::vector<Rewrite::Bindings>& out) {
+  using Kind = Rewrite::Pattern::Kind;
+  id = g.Find(id);
+  switch (p.kind) {
+    case Kind::kVar:
+      if (b[p.var] == kUnbound) {
+        out.push_back(b);
+        out.back()[p.var] = id;
+      } else if (g.Find(b[p.var]) == id) {
+        out.push_back(b);
+      }
+      return;
+    case Kind::kConstant: {
+      const std::optional<EGraph::Constant> c = g.constant(id);
+      if (c && c->op == p.op && c->value == p.payload) out.push_back(b);
+      return;
+    }
+    case Kind::kNode:
+      break;
+  }
+  for (const ENode& n : g.nodes(id)) {
+    if (n.op != p.op || n.payload != p.payload || n.symbol != 0 ||
+        n.children.size() != p.children.size()) {
+      continue;
+    }
+    std::vector<Rewrite::Bindings> partial = {b};
+    for (size_t i = 0; i < p.children.size() && !partial.empty(); ++i) {
+      std::vector<Rewrite::Bindings> next;
+      for (const Rewrite::Bindings& pb : partial) {
+        MatchInto(g, p.children[i], n.children[i], pb, next);
+      }
+      partial = std::move(next);
+    }
+    out.insert(out.end(), partial.begin(), partial.end());
+  }
+}
+
+EClassId Instantiate(EGraph& g, const Rewrite::Pattern& p,
+                     const Rewrite::Bindings& b) {
+  using Kind = Rewrite::Pattern::Kind;
+  switch (p.kind) {
+    case Kind::kVar:
+      return b[p.var];
+    case Kind::kConstant:
+      return g.AddConstant(p.op, p.payload);
+    case Kind::kNode:
+      break;
+  }
+  ENode n;
+  n.op = p.op;
+  n.payload = p.payload;
+  for (const Rewrite::Pattern& c : p.children) {
+    n.children.push_back(Instantiate(g, c, b));
+  }
+  return g.Add(std::move(n));
+}
+
+}  // namespace
+
+Rewrite Rewrite::Parse(const std::string& name, const std::string& lhs,
+                       const std::string& rhs) {
+  Rewrite r;
+  r.name = name;
+  r.lhs = std::make_shared<Pattern>(
+      PatternParser(lhs, r.variables, true).Parse());
+  r.rhs = std::make_shared<Pattern>(
+      PatternParser(rhs, r.variables, false).Parse());
+  return r;
+}
+
+Rewrite Rewrite::Parse(const std::string& name, const std::string& lhs,
+                       Builder build) {
+  Rewrite r;
+  r.name = name;
+  r.lhs = std::make_shared<Pattern>(
+      PatternParser(lhs, r.variables, true).Parse());
+  r.build = std::move(build);
+  return r;
+}
+
+std::vector<Rewrite::Bindings> Rewrite::Match(const EGraph& g,
+                                              EClassId id) const {
+  std::vector<Bindings> out;
+  MatchInto(g, *lhs, id, Bindings(variables.size(), kUnbound), out);
+  return out;
+}
+
+std::optional<EClassId> Rewrite::Apply(EGraph& g, const Bindings& b) const {
+  if (build) return build(g, b);
+  return Instantiate(g, *rhs, b);
+}
+
+// ========== Rules ==========
+
+const std::vector<Rewrite>& JavaIntegerRewrites() {
+  static const std::vector<Rewrite> rules = [] {
+    std::vector<Rewrite> r;
+    for (const char* w : {"I", "L"}) {
+      const std::string x = w;
+      auto op = [&](const char* name) { return std::string(name) + x; };
+      auto con = [&](int v) {
+        return "(Con" + x + " " + std::to_string(v) + ")";
+      };
+      for (const char* c : {"Add", "Mul", "And", "Or", "Xor"}) {
+        const std::string o = op(c);
+        r.push_back(Rewrite::Parse(o + "-commute", "(" + o + " ?a ?b)",
+                                   "(" + o + " ?b ?a)"));
+        r.push_back(Rewrite::Parse(o + "-assoc",
+                                   "(" + o + " (" + o + " ?a ?b) ?c)",
+                                   "(" + o + " ?a (" + o + " ?b ?c))"));
+        r.push_back(Rewrite::Parse(o + "-assoc-rev",
+                                   "(" + o + " ?a (" + o + " ?b ?c))",
+                                   "(" + o + " (" + o + " ?a ?b) ?c)"));
+      }
+      const std::string add = op("Add"), sub = op("Sub"), mul = op("Mul");
+      r.push_back(Rewrite::Parse(add + "-zero",
+                                 "(" + add + " ?a " + con(0) + ")", "?a"));
+      r.push_back(Rewrite::Parse(sub + "-zero",
+                                 "(" + sub + " ?a " + con(0) + ")", "?a"));
+      r.push_back(Rewrite::Parse(mul + "-one",
+                                 "(" + mul + " ?a " + con(1) + ")", "?a"));
+      r.push_back(Rewrite::Parse(mul + "-zero",
+                                 "(" + mul + " ?a " + con(0) + ")", con(0)));
+      r.push_back(Rewrite::Parse(op("Or") + "-zero",
+                                 "(" + op("Or") + " ?a " + con(0) + ")", "?a"));
+      r.push_back(Rewrite::Parse(
+          op("Xor") + "-zero", "(" + op("Xor") + " ?a " + con(0) + ")", "?a"));
+      r.push_back(Rewrite::Parse(op("And") + "-ones",
+                                 "(" + op("And") + " ?a " + con(-1) + ")",
+                                 "?a"));
+      r.push_back(Rewrite::Parse(
+          op("And") + "-zero", "(" + op("And") + " ?a " + con(0) + ")",
+          con(0)));
+      r.push_back(Rewrite::Parse(op("And") + "-self",
+                                 "(" + op("And") + " ?a ?a)", "?a"));
+      r.push_back(Rewrite::Parse(op("Or") + "-self",
+                                 "(" + op("Or") + " ?a ?a)", "?a"));
+      r.push_back(Rewrite::Parse(op("Xor") + "-self",
+                                 "(" + op("Xor") + " ?a ?a)", con(0)));
+      r.push_back(Rewrite::Parse(sub + "-self", "(" + sub + " ?a ?a)",
+                                 con(0)));
+      r.push_back(Rewrite::Parse(
+          sub + "-as-add", "(" + sub + " ?a ?b)",
+          "(" + add + " ?a (" + sub + " " + con(0) + " ?b))"));
+      r.push_back(Rewrite::Parse(
+          add + "-as-sub", "(" + add + " ?a (" + sub + " " + con(0) + " ?b))",
+          "(" + sub + " ?a ?b)"));
+      r.push_back(Rewrite::Parse(
+          sub + "-neg-neg",
+          "(" + sub + " " + con(0) + " (" + sub + " " + con(0) + " ?a))",
+          "?a"));
+      r.push_back(Rewrite::Parse(add + "-double", "(" + add + " ?a ?a)",
+                                 "(" + mul + " ?a " + con(2) + ")"));
+      r.push_back(Rewrite::Parse(
+          mul + "-distribute", "(" + mul + " ?a (" + add + " ?b ?c))",
+          "(" + add + " (" + mul + " ?a ?b) (" + mul + " ?a ?c))"));
+      r.push_back(Rewrite::Parse(
+          mul + "-factor", "(" + add + " (" + mul + " ?a ?b) (" + mul +
+                               " ?a ?c))",
+          "(" + mul + " ?a (" + add + " ?b ?c))"));
+
+      // x << k == x * 2^k, for the masked shift count
+      const Opcode mul_op = StringToOpcode(mul);
+      const Opcode con_op = x == "I" ? Opcode::kConI : Opcode::kConL;
+      const int mask = x == "I" ? 31 : 63;
+      r.push_back(Rewrite::Parse(
+          op("LShift") + "-as-mul", "(" + op("LShift") + " ?a ?k)",
+          [mul_op, con_op, mask](EGraph& g, const Rewrite::Bindings& b)
+              -> std::optional<EClassId> {
+            const std::optional<EGraph::Constant> k = g.constant(b[1]);
+            if (!k || k->op != Opcode::kConI) return std::nullopt;
+            const uint64_t factor = uint64_t{1} << (k->value & mask);
+            ENode n;
+            n.op = mul_op;
+            n.children = {b[0], g.AddConstant(con_op,
+                                              static_cast<int64_t>(factor))};
+            return g.Add(std::move(n));
+          }));
+    }
+
+    // A two-way Region straight below an If, with nothing on either path,
+    // is the If's control; a Phi on it selects by the If's condition, as
+    // CMove does (in this repo's (condition, true, false) order)
+    const std::string diamonds[] = {
+        "(Region ?s (IfFalse (If ?c ?b)) (IfTrue (If ?c ?b)))",
+        "(Region ?s (IfTrue (If ?c ?b)) (IfFalse (If ?c ?b)))"};
+    r.push_back(Rewrite::Parse("diamond-control", diamonds[0], "?c"));
+    r.push_back(Rewrite::Parse("diamond-control", diamonds[1], "?c"));
+    r.push_back(Rewrite::Parse("diamond-phi",
+                               "(Phi " + diamonds[0] + " ?f ?t)",
+                               "(CMoveI ?b ?t ?f)"));
+    r.push_back(Rewrite::Parse("diamond-phi",
+                               "(Phi " + diamonds[1] + " ?t ?f)",
+                               "(CMoveI ?b ?t ?f)"));
+    // Selection does not depend on the width of what it selects
+    for (const char* cmove : {"CMoveL", "CMoveP"}) {
+      r.push_back(Rewrite::Parse(std::string(cmove) + "-as-CMoveI",
+                                 "(" + std::string(cmove) + " ?b ?t ?f)",
+                                 "(CMoveI ?b ?t ?f)"));
+    }
+
+    for (const char* cast : {"CastII", "CastLL", "CastPP"}) {
+      r.push_back(Rewrite::Parse(std::string(cast) + "-identity",
+                                 "(" + std::string(cast) + " ?a)", "?a"));
+    }
+
+    // Bool masks: LT = 1, EQ = 2, GT = 4; swapping the operands of the
+    // compare swaps LT and GT
+    for (const char* cmp : {"CmpI", "CmpL", "CmpU", "CmpUL", "CmpP"}) {
+      for (int m = 1; m <= 6; ++m) {
+        const int swapped = (m & 2) | ((m & 1) << 2) | ((m & 4) >> 2);
+        const std::string c = cmp;
+        r.push_back(Rewrite::Parse(
+            c + "-swap", "(Bool:" + std::to_string(m) + " (" + c + " ?a ?b))",
+            "(Bool:" + std::to_string(swapped) + " (" + c + " ?b ?a))"));
+      }
+    }
+    return r;
+  }();
+  return rules;
+}
+
+// ========== Read over write ==========
+
+namespace {
+
+// Outcome of comparing the locations a load and a store access
+enum class Alias { kSame, kDistinct, kUnknown };
+
+constexpr EClassId kNoRoot = UINT32_MAX;
+
+// Address as a root plus a constant offset, looking through AddP and
+// integer adds of constants; a constant is an offset from no root
+std::pair<EClassId, int64_t> SplitOffset(const EGraph& g, EClassId id) {
+  int64_t offset = 0;
+  for (int depth = 0; depth < 16; ++depth) {
+    if (std::optional<EGraph::Constant> c = g.constant(id)) {
+      return {kNoRoot, offset + c->value};
+    }
+    std::optional<std::pair<EClassId, int64_t>> step;
+    for (const ENode& n : g.nodes(id)) {
+      // AddP(base, address, offset) and AddI/AddL(value, offset)
+      const size_t k = n.op == Opcode::kAddP ? 2 : 1;
+      if ((n.op != Opcode::kAddP && n.op != Opcode::kAddI &&
+           n.op != Opcode::kAddL) ||
+          n.children.size() != k + 1) {
+        continue;
+      }
+      if (std::optional<EGraph::Constant> c = g.constant(n.children[k])) {
+        step.emplace(n.children[k - 1], c->value);
+        break;
+      }
+    }
+    if (!step) break;
+    id = g.Find(step->first);
+    offset += step->second;
+  }
+  return {g.Find(id), offset};
+}
+
+// Address inputs: those after control and memory, before a stored value
+std::vector<EClassId> Address(const EGraph& g, const ENode& n, bool store) {
+  std::vector<EClassId> out(n.children.begin() + 2,
+                            n.children.end() - (store ? 1 : 0));
+  for (EClassId& c : out) c = g.Find(c);
+  return out;
+}
+
+Alias Compare(const EGraph& g, const ENode& load, const ENode& store) {
+  // Stores never write an array's length
+  if (load.op == Opcode::kLoadRange) return Alias::kDistinct;
+  if (load.symbol != 0 && store.symbol != 0 && load.symbol != store.symbol) {
+    return Alias::kDistinct;
+  }
+  const std::vector<EClassId> a = Address(g, load, false);
+  const std::vector<EClassId> b = Address(g, store, true);
+  if (a.size() != b.size()) return Alias::kUnknown;
+  std::optional<size_t> differs;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i] == b[i]) continue;
+    if (differs) return Alias::kUnknown;
+    differs = i;
+  }
+  if (!differs) {
+    return load.symbol == store.symbol ? Alias::kSame : Alias::kUnknown;
+  }
+  // One address part differs: distinct if it is the same root at another
+  // offset, and the offsets are too close to wrap into each other
+  const auto [ra, oa] = SplitOffset(g, a[*differs]);
+  const auto [rb, ob] = SplitOffset(g, b[*differs]);
+  const int64_t gap = oa > ob ? oa - ob : ob - oa;
+  if (ra == rb && gap > 0 && gap < (int64_t{1} << 31)) {
+    return Alias::kDistinct;
+  }
+  return Alias::kUnknown;
+}
+
+bool SameWidth(Opcode load, Opcode store) {
+  switch (load) {
+    case Opcode::kLoadI: return store == Opcode::kStoreI;
+    case Opcode::kLoadL: return store == Opcode::kStoreL;
+    case Opcode::kLoadF: return store == Opcode::kStoreF;
+    case Opcode::kLoadD: return store == Opcode::kStoreD;
+    case Opcode::kLoadP: return store == Opcode::kStoreP;
+    case Opcode::kLoadN: return store == Opcode::kStoreN;
+    default: return false;
+  }
+}
+
+// A load of class `id` over a store: the stored value if they access the
+// same location, the load from the store's input memory if they access
+// different ones. Steps already taken are skipped, so that a chain of
+// stores is walked one store per saturation iteration.
+std::optional<EClassId> ReadOverWrite(EGraph& g, EClassId id) {
+  id = g.Find(id);
+  const size_t count = g.nodes(id).size();
+  for (size_t i = 0; i < count; ++i) {
+    const ENode load = g.nodes(id)[i];
+    if (!IsLoadOp(load.op) || load.children.size() < 3) continue;
+    const std::vector<ENode> stores = g.nodes(load.children[1]);
+    for (const ENode& store : stores) {
+      if (!IsStoreOp(store.op) || store.children.size() < 4) continue;
+      std::optional<EClassId> step;
+      switch (Compare(g, load, store)) {
+        case Alias::kSame:
+          if (SameWidth(load.op, store.op)) step = store.children.back();
+          break;
+        case Alias::kDistinct: {
+          ENode bypass = load;
+          bypass.children[1] = store.children[1];
+          step = g.Add(std::move(bypass));
+          break;
+        }
+        case Alias::kUnknown:
+          break;
+      }
+      if (step && g.Find(*step) != id) return step;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+const std::vector<Rewrite>& ReadOverWriteRewrites() {
+  static const std::vector<Rewrite> rules = {Rewrite::Parse(
+      "read-over-write", "?x",
+      [](EGraph& g, const Rewrite::Bindings& b) {
+        return ReadOverWrite(g, b[0]);
+      })};
+  return rules;
+}
+
+// ========== Saturation ==========
+
+const char* SaturationStopName(SaturationReport::Stop stop) {
+  switch (stop) {
+    case SaturationReport::Stop::kSaturated:
+      return "saturated";
+    case SaturationReport::Stop::kGoal:
+      return "goal";
+    case SaturationReport::Stop::kNodeLimit:
+      return "node limit";
+    case SaturationReport::Stop::kIterationLimit:
+      return "iteration limit";
+    case SaturationReport::Stop::kTimeLimit:
+      return "time limit";
+  }
+  return "?";
+}
+
+SaturationReport Saturate(EGraph& g, const std::vector<Rewrite>& rules,
+                          const SaturationLimits& limits,
+                          const std::function<bool()>& goal) {
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point start = Clock::now();
+  auto out_of_time = [&] {
+    return std::chrono::duration<double>(Clock::now() - start).count() >
+           limits.max_seconds;
+  };
+
+  SaturationReport report;
+  auto finish = [&](SaturationReport::Stop stop) {
+    report.stop = stop;
+    report.nodes = g.num_nodes();
+    report.classes = g.num_classes();
+    return report;
+  };
+
+  g.Rebuild();
+  while (true) {
+    if (goal && goal()) return finish(SaturationReport::Stop::kGoal);
+    if (report.iterations == limits.max_iterations) {
+      return finish(SaturationReport::Stop::kIterationLimit);
+    }
+
+    // Search everything first, so this iteration's merges do not feed it
+    struct Match {
+      const Rewrite* rule;
+      EClassId id;
+      Rewrite::Bindings bindings;
+    };
+    std::vector<Match> matches;
+    for (EClassId id : g.classes()) {
+      for (const Rewrite& rule : rules) {
+        for (Rewrite::Bindings& b : rule.Match(g, id)) {
+          matches.push_back({&rule, id, std::move(b)});
+        }
+      }
+      if (out_of_time()) return finish(SaturationReport::Stop::kTimeLimit);
+    }
+
+    const size_t nodes_before = g.num_nodes();
+    bool changed = false;
+    for (const Match& m : matches) {
+      std::optional<EClassId> rhs = m.rule->Apply(g, m.bindings);
+      if (rhs && g.Merge(m.id, *rhs)) changed = true;
+      if (g.num_nodes() >= limits.max_nodes) {
+        g.Rebuild();
+        return finish(SaturationReport::Stop::kNodeLimit);
+      }
+    }
+    g.Rebuild();
+    ++report.iterations;
+    if (!changed && g.num_nodes() == nodes_before) {
+      if (goal && goal()) return finish(SaturationReport::Stop::kGoal);
+      return finish(SaturationReport::Stop::kSaturated);
+    }
+    if (out_of_time()) return finish(SaturationReport::Stop::kTimeLimit);
+  }
+}
+
+// ========== Graph terms ==========
+
+namespace {
+
+// Bool condition from "mask" or C2's dump_spec ("[le]"), as the
+// interpreter reads it
+int64_t BoolMask(const Node* n) {
+  if (n->has_prop("mask")) {
+    const Property mask = n->prop("mask");
+    if (const auto* m = std::get_if<int32_t>(&mask)) return *m;
+  }
+  if (!n->has_prop("dump_spec")) return 0;
+  const std::string_view spec = n->interned_prop("dump_spec").view();
+  for (auto [name, mask] : {std::pair{"le", 3}, {"lt", 1}, {"ge", 6},
+                            {"gt", 4}, {"eq", 2}, {"ne", 5}}) {
+    if (spec.find(name) != std::string_view::npos) return mask;
+  }
+  return 0;
+}
+
+std::string StringProp(const Node* n, const char* key) {
+  if (!n->has_prop(key)) return "";
+  const Property p = n->prop(key);
+  if (const auto* s = std::get_if<std::string>(&p)) return *s;
+  if (const auto* i = std::get_if<int32_t>(&p)) return std::to_string(*i);
+  if (const auto* l = std::get_if<int64_t>(&p)) return std::to_string(*l);
+  return std::get<bool>(p) ? "true" : "false";
+}
+
+// Memory slice a load or store accesses: its field, the element type of
+// its array, or C2's alias index ("idx=5" in dump_spec); empty if unknown
+std::string Slice(const Node* n) {
+  if (n->has_prop("field")) return "field " + StringProp(n, "field");
+  if (StringProp(n, "array") == "true") {
+    return "array " + StringProp(n, "elem");
+  }
+  const std::string spec = StringProp(n, "dump_spec");
+  const size_t at = spec.find("idx=");
+  if (at == std::string::npos) return "";
+  return spec.substr(at, spec.find_first_of(";, ", at) - at);
+}
+
+class TermBuilder {
+ public:
+  TermBuilder(EGraph& g, const Graph& graph)
+      : g_(g),
+        nodes_(graph.nodes()),
+        state_(nodes_.size(), kWhite),
+        class_(nodes_.size(), 0) {}
+
+  std::optional<EClassId> Build(const Node* root) {
+    if (!InGraph(root)) return std::nullopt;
+    struct Frame {
+      const Node* n;
+      std::vector<const Node*> children;
+      size_t next = 0;
+    };
+    std::vector<Frame> stack;
+    auto push = [&](const Node* n) -> bool {
+      if (!Supported(n)) return false;
+      state_[n->index()] = kGray;
+      stack.push_back({n, Children(n)});
+      return true;
+    };
+    if (!push(root)) return std::nullopt;
+    while (!stack.empty()) {
+      Frame& f = stack.back();
+      if (f.next < f.children.size()) {
+        const Node* c = f.children[f.next++];
+        if (!c || c == f.n || !InGraph(c)) continue;
+        if (state_[c->index()] == kGray) return std::nullopt;  // Cycle
+        if (state_[c->index()] == kWhite && !push(c)) return std::nullopt;
+        continue;
+      }
+      ENode e = Label(f.n);
+      for (const Node* c : f.children) {
+        if (!c || !InGraph(c)) {
+          e.children.push_back(Leaf(kHole));
+        } else if (c == f.n) {
+          e.children.push_back(Leaf(kSelf));
+        } else {
+          e.children.push_back(class_[c->index()]);
+        }
+      }
+      const EClassId id = g_.Add(std::move(e));
+      // Two allocations with one term (same position, same type) cannot be
+      // told apart, nor matched to the other graph's
+      if (IsAllocation(f.n->opcode()) && !allocations_.insert(id).second) {
+        return std::nullopt;
+      }
+      class_[f.n->index()] = id;
+      state_[f.n->index()] = kBlack;
+      stack.pop_back();
+    }
+    return class_[root->index()];
+  }
+
+ private:
+  enum : uint8_t { kWhite, kGray, kBlack };
+
+  bool InGraph(const Node* n) const {
+    return n->index() < nodes_.size() && nodes_[n->index()] == n;
+  }
+
+  // Nodes of unknown opcode have no semantics to compare
+  static bool Supported(const Node* n) {
+    return n->opcode() != Opcode::kUnknown;
+  }
+
+  static bool IsAllocation(Opcode op) {
+    return op == Opcode::kAllocate || op == Opcode::kAllocateArray;
+  }
+
+  // Pure operators see only their values: a pinning control input does
+  // not change what they compute
+  static std::vector<const Node*> Children(const Node* n) {
+    std::vector<const Node*> out;
+    // Start's inputs (itself, and Root in C2 dumps) carry no meaning
+    if (IsConstantOp(n->opcode()) || n->opcode() == Opcode::kStart) {
+      return out;
+    }
+    if (n->schema() == NodeSchema::kS0_Pure) {
+      for (const Node* v : n->value_inputs()) out.push_back(v);
+      return out;
+    }
+    for (size_t i = 0; i < n->num_inputs(); ++i) out.push_back(n->input(i));
+    return out;
+  }
+
+  ENode Label(const Node* n) {
+    ENode e;
+    e.op = n->opcode();
+    if (IsConstantOp(e.op)) {
+      if (std::optional<int64_t> v = ConstantValue(n)) {
+        e.payload = e.op == Opcode::kConI ? WrapI(*v) : *v;
+      } else if (n->has_prop("dump_spec")) {
+        e.symbol = g_.Intern("constant " + StringProp(n, "dump_spec"));
+      } else {
+        throw std::runtime_error("constant node " + std::to_string(n->id()) +
+                                 " has no value");
+      }
+    } else if (e.op == Opcode::kParm) {
+      if (n->has_prop("index")) {
+        e.payload = std::get<int32_t>(n->prop("index"));
+      } else {
+        e.symbol = g_.Intern(StringProp(n, "dump_spec"));
+      }
+    } else if (e.op == Opcode::kProj) {
+      if (n->has_prop("con")) e.payload = std::get<int32_t>(n->prop("con"));
+    } else if (e.op == Opcode::kBool) {
+      e.payload = BoolMask(n);
+    } else if (IsLoadOp(e.op) || IsStoreOp(e.op)) {
+      const std::string slice = Slice(n);
+      if (!slice.empty()) e.symbol = g_.Intern(slice);
+    } else if (IsMemory(e.op) || e.op == Opcode::kCallStaticJava) {
+      e.symbol = g_.Intern(StringProp(n, "field") + "\n" +
+                           StringProp(n, "array") + "\n" +
+                           StringProp(n, "elem") + "\n" +
+                           StringProp(n, "dump_spec"));
+    }
+    return e;
+  }
+
+  // Value of a constant node; an undecodable one (a ConP of a class, say)
+  // is told apart by its dump_spec instead
+  static std::optional<int64_t> ConstantValue(const Node* n) {
+    if (const sun::Constant* c = n->constant()) return c->value;
+    if (n->has_prop("value")) {
+      const Property p = n->prop("value");
+      if (const auto* i = std::get_if<int32_t>(&p)) return *i;
+      if (const auto* l = std::get_if<int64_t>(&p)) return *l;
+    }
+    if (n->has_prop("dump_spec")) {
+      if (auto v = ConstantPool::DecodeDumpSpec(
+              n->opcode(), n->interned_prop("dump_spec").view())) {
+        return *v;
+      }
+    }
+    return std::nullopt;
+  }
+
+  EClassId Leaf(int64_t kind) {
+    ENode e;
+    e.op = Opcode::kUnknown;
+    e.payload = kind;
+    return g_.Add(std::move(e));
+  }
+
+  EGraph& g_;
+  const std::vector<Node*>& nodes_;
+  std::vector<uint8_t> state_;
+  std::vector<EClassId> class_;
+  std::unordered_set<EClassId> allocations_;
+};
+
+}  // namespace
+
+std::optional<EClassId> AddGraphTerm(EGraph& g, const Graph& graph,
+                                     const Node* n) {
+  try {
+    return TermBuilder(g, graph).Build(n);
+  } catch (const std::runtime_error&) {
+    return std::nullopt;
+  }
+}
+
+EquivalenceProof ProveEquivalent(const Graph& a, const Graph& b,
+                                 const SaturationLimits& limits) {
+  EquivalenceProof proof;
+  if (!a.root() || !b.root()) {
+    proof.reason = "no Root";
+    return proof;
+  }
+  EGraph g;
+  const std::optional<EClassId> ra = AddGraphTerm(g, a, a.root());
+  const std::optional<EClassId> rb = AddGraphTerm(g, b, b.root());
+  if (!ra || !rb) {
+    proof.reason = "not a term (loop, allocation or unknown node)";
+    return proof;
+  }
+  static const std::vector<Rewrite> rules = [] {
+    std::vector<Rewrite> all = JavaIntegerRewrites();
+    const std::vector<Rewrite>& memory = ReadOverWriteRewrites();
+    all.insert(all.end(), memory.begin(), memory.end());
+    return all;
+  }();
+  proof.saturation = Saturate(g, rules, limits, [&] {
+    return g.Find(*ra) == g.Find(*rb);
+  });
+  proof.proven = g.Find(*ra) == g.Find(*rb);
+  if (!proof.proven) {
+    proof.reason = std::string("not equal at ") +
+                   SaturationStopName(proof.saturation.stop);
+  }
+  return proof;
+}
+
+}  // namespace sun
@@ -7,7 +7,16 @@
 
 namespace sun {
 
-Graph::Graph() : start_(nullptr), root_(nullptr) {}
+Graph::Graph() : Graph(nullptr, nullptr) {}
+
+Graph::Graph(StringInterner* strings, ConstantPool* constants)
+    : own_strings_(arena_),
+      own_constants_(arena_),
+      strings_(strings ? strings : &own_strings_),
+      constants_(constants ? constants : &own_constants_),
+      id_to_node_(&arena_),
+      start_(nullptr),
+      root_(nullptr) {}
 
 Graph::~Graph() = default;
 
@@ -20,10 +29,9 @@ Node* Graph::node(NodeID id) const {
 }
 
 Node* Graph::AddNode(NodeID id, Opcode op) {
-  auto node = std::make_unique<Node>(id, op);
-  Node* ptr = node.get();
+  Node* ptr = arena_.New<Node>(id, op, &arena_, strings_);
 
-  owned_nodes_.push_back(std::move(node));
+  ptr->index_ = static_cast<uint32_t>(node_list_.size());
   node_list_.push_back(ptr);
   id_to_node_[id] = ptr;
 
@@ -37,6 +45,30 @@ Node* Graph::AddNode(NodeID id, Opcode op) {
   return ptr;
 }
 
+Node* Graph::CloneNode(const Node& src, NodeID id) {
+  Node* n = AddNode(id, src.opcode());
+  n->CopyPropsFrom(src);
+  n->set_type(src.type());
+  if (const Constant* c = src.constant()) {
+    // Hash-consed: the same pointer when src shares this graph's pool
+    n->set_constant(constants_->Intern(c->op, c->value));
+  }
+  return n;
+}
+
+GraphMemory Graph::MemoryUsage() const {
+  GraphMemory m;
+  for (const Node* n : node_list_) {
+    m.nodes += sizeof(Node);
+    m.edges += n->input_bytes();
+    m.properties += n->prop_bytes();
+  }
+  m.arena = arena_.bytes_reserved();
+  m.other = sizeof(Graph) + node_list_.capacity() * sizeof(Node*);
+  if (schedule_) m.other += schedule_->bytes();
+  return m;
+}
+
 std::vector<Node*> Graph::GetParameterNodes() const {
   std::vector<Node*> params;
   for (Node* n : node_list_) {
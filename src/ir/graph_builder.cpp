@@ -0,0 +1,98 @@
+#include "suntv/ir/graph_builder.hpp"
+
+namespace sun {
+
+GraphBuilder::GraphBuilder() : graph_(std::make_unique<Graph>()) {
+  Add(Opcode::kRoot, {});
+  Add(Opcode::kStart, {});
+}
+
+Node* GraphBuilder::Add(Opcode op, const std::vector<Node*>& inputs) {
+  Node* n = graph_->AddNode(next_id_++, op);
+  for (Node* in : inputs) n->AddInput(in);
+  return n;
+}
+
+Node* GraphBuilder::Parm(int32_t index) {
+  Node* n = Add(Opcode::kParm, {start()});
+  n->set_prop("index", index);
+  return n;
+}
+
+Node* GraphBuilder::ConI(int32_t value) {
+  auto it = int_constants_.find(value);
+  if (it != int_constants_.end()) return it->second;
+  Node* n = Add(Opcode::kConI, {});
+  n->set_prop("value", value);
+  int_constants_[value] = n;
+  return n;
+}
+
+Node* GraphBuilder::Binary(Opcode op, Node* lhs, Node* rhs) {
+  return Add(op, {lhs, rhs});
+}
+
+Node* GraphBuilder::Compare(Node* lhs, Node* rhs, int32_t mask) {
+  Node* cmp = Add(Opcode::kCmpI, {lhs, rhs});
+  Node* b = Add(Opcode::kBool, {cmp});
+  b->set_prop("mask", mask);
+  return b;
+}
+
+GraphBuilder::Branch GraphBuilder::If(Node* ctrl, Node* cond) {
+  Node* n = Add(Opcode::kIf, {ctrl, cond});
+  return {Add(Opcode::kIfTrue, {n}), Add(Opcode::kIfFalse, {n})};
+}
+
+Node* GraphBuilder::Region(const std::vector<Node*>& preds) {
+  return Add(Opcode::kRegion, preds);
+}
+
+Node* GraphBuilder::Phi(Node* region, const std::vector<Node*>& values) {
+  Node* n = Add(Opcode::kPhi, {region});
+  for (Node* v : values) n->AddInput(v);
+  return n;
+}
+
+Node* GraphBuilder::Allocate(Node* ctrl) {
+  return Add(Opcode::kAllocate, {ctrl});
+}
+
+Node* GraphBuilder::AllocateArray(Node* ctrl, Node* length) {
+  return Add(Opcode::kAllocateArray, {ctrl, length});
+}
+
+Node* GraphBuilder::StoreField(Node* ctrl, Node* mem, Node* base,
+                               const std::string& field, Node* value) {
+  Node* n = Add(Opcode::kStoreI, {ctrl, mem, base, value});
+  n->set_prop("field", field);
+  return n;
+}
+
+Node* GraphBuilder::LoadField(Node* ctrl, Node* mem, Node* base,
+                              const std::string& field) {
+  Node* n = Add(Opcode::kLoadI, {ctrl, mem, base});
+  n->set_prop("field", field);
+  return n;
+}
+
+Node* GraphBuilder::StoreArray(Node* ctrl, Node* mem, Node* base, Node* index,
+                               Node* value) {
+  Node* n = Add(Opcode::kStoreI, {ctrl, mem, base, index, value});
+  n->set_prop("array", true);
+  return n;
+}
+
+Node* GraphBuilder::LoadArray(Node* ctrl, Node* mem, Node* base, Node* index) {
+  Node* n = Add(Opcode::kLoadI, {ctrl, mem, base, index});
+  n->set_prop("array", true);
+  return n;
+}
+
+Node* GraphBuilder::Return(Node* ctrl, Node* mem, Node* value) {
+  Node* n = Add(Opcode::kReturn, {ctrl, start(), mem, start(), start(), value});
+  root()->AddInput(n);
+  return n;
+}
+
+}  // namespace sun
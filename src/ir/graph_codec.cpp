@@ -0,0 +1,274 @@
+#include "suntv/ir/graph_codec.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "suntv/ir/constant_pool.hpp"
+#include "suntv/ir/graph.hpp"
+
+namespace sun {
+
+namespace {
+
+constexpr char kMagic[] = {'S', 'U', 'N', 'G'};
+constexpr uint8_t kVersion = 1;
+
+// Property kinds, in the low two bits of a property's key
+enum PropKind : uint64_t { kInt = 0, kLong = 1, kString = 2, kBool = 3 };
+
+uint64_t ZigZag(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t UnZigZag(uint64_t v) {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+void PutVarint(std::string& out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+class Encoder {
+ public:
+  explicit Encoder(const Graph& g) : g_(g) {}
+
+  std::string Run() {
+    const std::vector<Node*>& nodes = g_.nodes();
+    Put(nodes.size());
+    NodeID prev = 0;
+    for (const Node* n : nodes) {
+      PutSigned(static_cast<int64_t>(n->id()) - prev);
+      prev = n->id();
+      Put(String(OpcodeName(n->opcode())));
+      Put(static_cast<uint64_t>(n->type().kind()));
+      if (const Constant* c = n->constant()) {
+        Put(1 + String(OpcodeName(c->op)));
+        PutSigned(c->value);
+      } else {
+        Put(0);
+      }
+      Put(n->num_props());
+      for (size_t i = 0; i < n->num_props(); ++i) PutProp(*n, i);
+    }
+
+    for (const Node* n : nodes) {
+      Put(n->num_inputs());
+      for (size_t i = 0; i < n->num_inputs(); ++i) {
+        const Node* in = n->input(i);
+        Put(in ? 1 + static_cast<uint64_t>(in->index()) : 0);
+      }
+    }
+
+    const Schedule* schedule = g_.schedule();
+    Put(schedule ? 1 + schedule->blocks().size() : 0);
+    if (schedule) {
+      for (const Schedule::Block& b : schedule->blocks()) PutSigned(b.name);
+      for (const Schedule::Block& b : schedule->blocks()) {
+        Put(b.successors.size());
+        for (uint32_t s : b.successors) Put(s);
+        Put(b.nodes.size());
+        for (const Node* n : b.nodes) Put(n->index());
+      }
+    }
+
+    std::string out(kMagic, sizeof(kMagic));
+    out.push_back(static_cast<char>(kVersion));
+    PutVarint(out, strings_.size());
+    for (std::string_view s : strings_) {
+      PutVarint(out, s.size());
+      out.append(s);
+    }
+    return out + body_;
+  }
+
+ private:
+  void Put(uint64_t v) { PutVarint(body_, v); }
+  void PutSigned(int64_t v) { PutVarint(body_, ZigZag(v)); }
+
+  // Position of s in the string table; the views stay valid as long as
+  // the graph (or, for opcode names, forever)
+  uint64_t String(std::string_view s) {
+    auto [it, added] = index_.try_emplace(s, strings_.size());
+    if (added) strings_.push_back(s);
+    return it->second;
+  }
+
+  void PutProp(const Node& n, size_t i) {
+    const uint64_t key = String(n.prop_key(i)) << 2;
+    std::visit(
+        [&](const auto& v) {
+          using T = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<T, int32_t>) {
+            Put(key | kInt);
+            PutSigned(v);
+          } else if constexpr (std::is_same_v<T, int64_t>) {
+            Put(key | kLong);
+            PutSigned(v);
+          } else if constexpr (std::is_same_v<T, std::string_view>) {
+            Put(key | kString);
+            Put(String(v));
+          } else {
+            Put(key | kBool);
+            Put(v ? 1 : 0);
+          }
+        },
+        n.prop_value(i));
+  }
+
+  const Graph& g_;
+  std::string body_;
+  std::vector<std::string_view> strings_;
+  std::unordered_map<std::string_view, uint64_t> index_;
+};
+
+class Decoder {
+ public:
+  explicit Decoder(std::string_view bytes) : bytes_(bytes) {}
+
+  std::unique_ptr<Graph> Run(StringInterner* strings,
+                             ConstantPool* constants) {
+    if (bytes_.substr(0, sizeof(kMagic)) !=
+        std::string_view(kMagic, sizeof(kMagic))) {
+      Fail("not an encoded graph");
+    }
+    pos_ = sizeof(kMagic);
+    if (Byte() != kVersion) Fail("unsupported version");
+
+    strings_.resize(Count());
+    for (std::string_view& s : strings_) {
+      const size_t size = Count();
+      s = bytes_.substr(pos_, size);
+      pos_ += size;
+    }
+
+    auto g = std::make_unique<Graph>(strings, constants);
+    std::vector<Node*> nodes(Count());
+    int64_t id = 0;
+    for (Node*& n : nodes) {
+      id += Signed();
+      n = g->AddNode(static_cast<NodeID>(id), StringToOpcode(String()));
+      const uint64_t type = Get();
+      if (type > static_cast<uint64_t>(TypeKind::kVoid)) Fail("bad type");
+      n->set_type(TypeStamp(static_cast<TypeKind>(type)));
+      if (const uint64_t op = Get()) {
+        const Opcode c = StringToOpcode(StringAt(op - 1));
+        n->set_constant(g->constants().Intern(c, Signed()));
+      }
+      for (size_t i = Count(); i > 0; --i) GetProp(n);
+    }
+
+    for (Node* n : nodes) {
+      for (size_t i = Count(); i > 0; --i) {
+        const uint64_t in = Get();
+        n->AddInput(in == 0 ? nullptr : NodeAt(nodes, in - 1));
+      }
+    }
+
+    if (const uint64_t scheduled = Get()) {
+      const uint64_t blocks = scheduled - 1;
+      if (blocks > bytes_.size() - pos_) Fail("truncated");
+      auto schedule = std::make_unique<Schedule>();
+      for (uint64_t b = 0; b < blocks; ++b) {
+        schedule->AddBlock(static_cast<int32_t>(Signed()));
+      }
+      for (uint32_t b = 0; b < blocks; ++b) {
+        for (size_t i = Count(); i > 0; --i) {
+          const uint64_t s = Get();
+          if (s >= blocks) Fail("bad successor");
+          schedule->AddSuccessor(b, static_cast<uint32_t>(s));
+        }
+        for (size_t i = Count(); i > 0; --i) {
+          if (!schedule->Place(NodeAt(nodes, Get()), b)) {
+            Fail("node scheduled twice");
+          }
+        }
+      }
+      g->set_schedule(std::move(schedule));
+    }
+
+    if (pos_ != bytes_.size()) Fail("trailing bytes");
+    return g;
+  }
+
+ private:
+  [[noreturn]] static void Fail(const std::string& why) {
+    throw std::runtime_error("bad graph encoding: " + why);
+  }
+
+  uint8_t Byte() {
+    if (pos_ >= bytes_.size()) Fail("truncated");
+    return static_cast<uint8_t>(bytes_[pos_++]);
+  }
+
+  uint64_t Get() {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const uint8_t b = Byte();
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    Fail("overlong varint");
+  }
+
+  int64_t Signed() { return UnZigZag(Get()); }
+
+  // A count of items still to read, each at least a byte long
+  size_t Count() {
+    const uint64_t n = Get();
+    if (n > bytes_.size() - pos_) Fail("truncated");
+    return static_cast<size_t>(n);
+  }
+
+  std::string_view StringAt(uint64_t i) {
+    if (i >= strings_.size()) Fail("bad string index");
+    return strings_[i];
+  }
+  std::string_view String() { return StringAt(Get()); }
+
+  static Node* NodeAt(const std::vector<Node*>& nodes, uint64_t i) {
+    if (i >= nodes.size()) Fail("bad node index");
+    return nodes[i];
+  }
+
+  void GetProp(Node* n) {
+    const uint64_t key = Get();
+    const std::string k(StringAt(key >> 2));
+    switch (key & 3) {
+      case kInt:
+        n->set_prop(k, static_cast<int32_t>(Signed()));
+        break;
+      case kLong:
+        n->set_prop(k, Signed());
+        break;
+      case kString:
+        n->set_prop(k, std::string(String()));
+        break;
+      default:
+        n->set_prop(k, Get() != 0);
+        break;
+    }
+  }
+
+  std::string_view bytes_;
+  size_t pos_ = 0;
+  std::vector<std::string_view> strings_;
+};
+
+}  // namespace
+
+std::string EncodeGraph(const Graph& g) { return Encoder(g).Run(); }
+
+std::unique_ptr<Graph> DecodeGraph(std::string_view bytes,
+                                   StringInterner* strings,
+                                   ConstantPool* constants) {
+  return Decoder(bytes).Run(strings, constants);
+}
+
+}  // namespace sun
@@ -0,0 +1,383 @@
+#include "suntv/ir/inliner.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "suntv/ir/node.hpp"
+#include "suntv/ir/opcode.hpp"
+
+namespace sun {
+
+namespace {
+
+// TypeFunc slots: control, I/O, memory, frame pointer, return address, then
+// the arguments
+constexpr int64_t kControl = 0;
+constexpr int64_t kIO = 1;
+constexpr int64_t kMemory = 2;
+constexpr int64_t kParms = 5;
+
+std::optional<int64_t> IntProp(const Node* n, const std::string& key) {
+  if (!n->has_prop(key)) return std::nullopt;
+  const Property p = n->prop(key);
+  if (std::holds_alternative<int32_t>(p)) return std::get<int32_t>(p);
+  if (std::holds_alternative<int64_t>(p)) return std::get<int64_t>(p);
+  return std::nullopt;
+}
+
+std::optional<std::string> StringProp(const Node* n, const std::string& key) {
+  if (!n->has_prop(key)) return std::nullopt;
+  const Property p = n->prop(key);
+  if (!std::holds_alternative<std::string>(p)) return std::nullopt;
+  return std::get<std::string>(p);
+}
+
+// TypeFunc slot a Parm stands for
+std::optional<int64_t> ParmSlot(const Node* parm) {
+  if (auto con = IntProp(parm, "con")) return *con;
+  if (auto index = IntProp(parm, "index")) return kParms + *index;
+  if (auto type = StringProp(parm, "type")) {
+    if (*type == "control") return kControl;
+    if (*type == "abIO") return kIO;
+    if (*type == "memory") return kMemory;
+    if (*type == "rawptr:") return 3;
+    if (*type == "return_address") return 4;
+  }
+  if (auto spec = StringProp(parm, "dump_spec")) {
+    // "Parm1: int"
+    const size_t pos = spec->find("Parm");
+    const size_t colon = spec->find(':', pos);
+    if (pos != std::string::npos && colon != std::string::npos) {
+      try {
+        return kParms + std::stoll(spec->substr(pos + 4, colon - pos - 4));
+      } catch (const std::exception&) {
+        return std::nullopt;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+// Returned value: TypeFunc::Parms in C2 layout, input 1 in the short
+// Return(control, value) form of hand-built graphs
+const Node* ReturnValue(const Node* ret) {
+  if (ret->num_inputs() > static_cast<size_t>(kParms)) {
+    return ret->input(kParms);
+  }
+  return ret->num_inputs() == 2 ? ret->input(1) : nullptr;
+}
+
+struct ReturnState {
+  Node* ctrl = nullptr;
+  Node* io = nullptr;
+  Node* mem = nullptr;
+  Node* value = nullptr;
+};
+
+struct Site {
+  const Graph* callee = nullptr;
+  std::vector<const Node*> projs;
+  bool expanding = false;
+  bool done = false;
+};
+
+// One copy of a graph being cloned into the result
+struct Frame {
+  const Graph* graph = nullptr;
+  int depth = 0;
+  std::unordered_map<const Node*, Node*> map;  // Source node -> result
+  std::unordered_map<const Node*, Site> sites;
+  std::unordered_map<const Node*, const Node*> site_of_proj;
+};
+
+class Inliner {
+ public:
+  Inliner(const CalleeLibrary& library, const InlineOptions& options,
+          InlineStats& stats, Graph& out, NodeID next_id)
+      : library_(library),
+        options_(options),
+        stats_(stats),
+        out_(out),
+        next_id_(next_id) {}
+
+  ReturnState Expand(Frame& frame);
+
+  // Exits of inlined bodies, added to the Root once it is wired
+  const std::vector<Node*>& exits() const { return exits_; }
+
+ private:
+  const CalleeLibrary& library_;
+  const InlineOptions& options_;
+  InlineStats& stats_;
+  Graph& out_;
+  NodeID next_id_;
+  std::vector<Node*> exits_;
+
+  void FindSites(Frame& frame);
+  bool Fits(const Node* call, const Graph& callee,
+            const std::vector<const Node*>& projs) const;
+  Node* Resolve(Frame& frame, const Node* n);
+  void ExpandSite(Frame& frame, const Node* call);
+  ReturnState MergeReturns(Frame& frame);
+};
+
+void Inliner::FindSites(Frame& frame) {
+  std::unordered_map<const Node*, std::vector<const Node*>> users;
+  for (const Node* n : frame.graph->nodes()) {
+    for (size_t i = 0; i < n->num_inputs(); ++i) {
+      const Node* in = n->input(i);
+      if (in && in->opcode() == Opcode::kCallStaticJava) {
+        users[in].push_back(n);
+      }
+    }
+  }
+
+  for (const Node* call : frame.graph->nodes()) {
+    if (call->opcode() != Opcode::kCallStaticJava) continue;
+    auto spec = StringProp(call, "dump_spec");
+    auto sig = spec ? MethodSignature::Parse(*spec) : std::nullopt;
+    if (!sig) continue;  // Uncommon trap
+    const Graph* callee = library_.Find(*sig);
+    if (!callee) {
+      ++stats_.unknown;
+      continue;
+    }
+    if (frame.depth >= options_.max_depth ||
+        out_.nodes().size() >= options_.max_nodes) {
+      ++stats_.depth_limited;
+      continue;
+    }
+    const std::vector<const Node*>& projs = users[call];
+    if (!Fits(call, *callee, projs)) {
+      ++stats_.unsupported;
+      continue;
+    }
+    Site& site = frame.sites[call];
+    site.callee = callee;
+    site.projs = projs;
+    for (const Node* proj : projs) frame.site_of_proj[proj] = call;
+  }
+}
+
+bool Inliner::Fits(const Node* call, const Graph& callee,
+                   const std::vector<const Node*>& projs) const {
+  if (!callee.start()) return false;
+  bool returns = false;
+  bool all_return_value = true;
+  for (const Node* n : callee.nodes()) {
+    if (n->opcode() == Opcode::kReturn) {
+      returns = true;
+      all_return_value = all_return_value && ReturnValue(n) != nullptr;
+    } else if (n->opcode() == Opcode::kParm) {
+      // Every argument the callee reads must be passed
+      auto slot = ParmSlot(n);
+      if (!slot) return false;
+      if (*slot < kParms) continue;
+      if (*slot >= static_cast<int64_t>(call->num_inputs()) ||
+          !call->input(*slot)) {
+        return false;
+      }
+    }
+  }
+  if (!returns) return false;
+
+  // Only the control, I/O, memory and result projections can be rewired
+  for (const Node* user : projs) {
+    if (user->opcode() != Opcode::kProj || user->input(0) != call) return false;
+    auto con = IntProp(user, "con");
+    if (!con || (*con != kControl && *con != kIO && *con != kMemory &&
+                 *con != kParms)) {
+      return false;
+    }
+    if (*con == kParms && !all_return_value) return false;
+  }
+  return true;
+}
+
+Node* Inliner::Resolve(Frame& frame, const Node* n) {
+  if (!n) return nullptr;
+  auto it = frame.map.find(n);
+  if (it != frame.map.end()) return it->second;
+  auto site = frame.site_of_proj.find(n);
+  if (site != frame.site_of_proj.end()) {
+    ExpandSite(frame, site->second);
+    return frame.map.at(n);
+  }
+  throw std::logic_error("Inliner: node " + std::to_string(n->id()) +
+                         " has no copy");
+}
+
+void Inliner::ExpandSite(Frame& frame, const Node* call) {
+  Site& site = frame.sites.at(call);
+  if (site.done) return;
+  if (site.expanding) {
+    throw std::runtime_error("Inliner: call " + std::to_string(call->id()) +
+                             " depends on its own result");
+  }
+  site.expanding = true;
+
+  auto input = [&](int64_t slot) -> Node* {
+    if (slot >= static_cast<int64_t>(call->num_inputs())) return nullptr;
+    return Resolve(frame, call->input(slot));
+  };
+
+  Frame body;
+  body.graph = site.callee;
+  body.depth = frame.depth + 1;
+  body.map[site.callee->start()] = input(kControl);
+  if (site.callee->root()) body.map[site.callee->root()] = out_.root();
+  for (const Node* parm : site.callee->nodes()) {
+    if (parm->opcode() == Opcode::kParm) {
+      body.map[parm] = input(*ParmSlot(parm));
+    }
+  }
+
+  ReturnState ret = Expand(body);
+  // A callee without effects hands the incoming state straight back
+  if (!ret.io) ret.io = input(kIO);
+  if (!ret.mem) ret.mem = input(kMemory);
+
+  for (const Node* proj : site.projs) {
+    switch (*IntProp(proj, "con")) {
+      case kControl:
+        frame.map[proj] = ret.ctrl;
+        break;
+      case kIO:
+        frame.map[proj] = ret.io;
+        break;
+      case kMemory:
+        frame.map[proj] = ret.mem;
+        break;
+      default:
+        frame.map[proj] = ret.value;
+        break;
+    }
+  }
+
+  ++stats_.inlined;
+  stats_.max_depth_seen = std::max(stats_.max_depth_seen, body.depth);
+  site.expanding = false;
+  site.done = true;
+}
+
+ReturnState Inliner::Expand(Frame& frame) {
+  FindSites(frame);
+
+  // Copy everything except the frame boundary and the inlined calls
+  const bool nested = frame.depth > 0;
+  std::vector<const Node*> copied;
+  for (const Node* n : frame.graph->nodes()) {
+    if (frame.map.count(n) || frame.sites.count(n) ||
+        frame.site_of_proj.count(n)) {
+      continue;
+    }
+    if (nested && n->opcode() == Opcode::kReturn) continue;
+    frame.map[n] = out_.CloneNode(*n, nested ? next_id_++ : n->id());
+    copied.push_back(n);
+  }
+
+  for (const Node* n : copied) {
+    Node* copy = frame.map[n];
+    for (size_t i = 0; i < n->num_inputs(); ++i) {
+      copy->set_input(i, Resolve(frame, n->input(i)));
+    }
+  }
+  for (auto& [call, site] : frame.sites) ExpandSite(frame, call);
+
+  if (!nested) return ReturnState();
+
+  // Exits other than Return (uncommon traps, throws) leave through the
+  // caller's Root
+  if (const Node* root = frame.graph->root()) {
+    for (size_t i = 0; i < root->num_inputs(); ++i) {
+      const Node* exit = root->input(i);
+      if (!exit || exit->opcode() == Opcode::kReturn || exit == root) continue;
+      exits_.push_back(Resolve(frame, exit));
+    }
+  }
+  return MergeReturns(frame);
+}
+
+ReturnState Inliner::MergeReturns(Frame& frame) {
+  std::vector<ReturnState> returns;
+  for (const Node* ret : frame.graph->nodes()) {
+    if (ret->opcode() != Opcode::kReturn) continue;
+    ReturnState state;
+    state.ctrl = Resolve(frame, ret->input(0));
+    if (ret->num_inputs() > 2) {
+      state.io = Resolve(frame, ret->input(kIO));
+      state.mem = Resolve(frame, ret->input(kMemory));
+    }
+    state.value = Resolve(frame, ReturnValue(ret));
+    returns.push_back(state);
+  }
+  if (returns.size() == 1) return returns[0];
+
+  // Several Returns: merge control with a Region (self input first, as C2
+  // does) and each differing state with a Phi over it
+  ReturnState merged;
+  Node* region = out_.AddNode(next_id_++, Opcode::kRegion);
+  region->AddInput(region);
+  for (const ReturnState& r : returns) region->AddInput(r.ctrl);
+  merged.ctrl = region;
+
+  auto merge = [&](Node* ReturnState::* field, const char* type) -> Node* {
+    Node* first = returns[0].*field;
+    const bool same =
+        std::all_of(returns.begin(), returns.end(),
+                    [&](const ReturnState& r) { return r.*field == first; });
+    if (same) return first;
+    Node* phi = out_.AddNode(next_id_++, Opcode::kPhi);
+    phi->AddInput(region);
+    for (const ReturnState& r : returns) phi->AddInput(r.*field);
+    if (type) {
+      phi->set_prop("type", std::string(type));
+    } else if (first && first->has_prop("type")) {
+      phi->set_prop("type", first->prop("type"));
+    }
+    return phi;
+  };
+  merged.io = merge(&ReturnState::io, "abIO");
+  merged.mem = merge(&ReturnState::mem, "memory");
+  merged.value = merge(&ReturnState::value, nullptr);
+  return merged;
+}
+
+}  // namespace
+
+void CalleeLibrary::Add(std::string_view method, const Graph& callee) {
+  graphs_[MethodSignature::NormalizeKey(method)] = &callee;
+}
+
+const Graph* CalleeLibrary::Find(const MethodSignature& sig) const {
+  if (sig.has_params) {
+    auto it = graphs_.find(sig.Key());
+    if (it != graphs_.end()) return it->second;
+  }
+  auto it = graphs_.find(MethodSignature::NormalizeKey(sig.ShortKey()));
+  return it == graphs_.end() ? nullptr : it->second;
+}
+
+std::unique_ptr<Graph> InlineCalls(const Graph& caller,
+                                   const CalleeLibrary& library,
+                                   const InlineOptions& options,
+                                   InlineStats* stats) {
+  NodeID max_id = 0;
+  for (const Node* n : caller.nodes()) max_id = std::max(max_id, n->id());
+
+  auto out = std::make_unique<Graph>();
+  InlineStats local;
+  Inliner inliner(library, options, stats ? *stats : local, *out, max_id + 1);
+  Frame top;
+  top.graph = &caller;
+  inliner.Expand(top);
+  if (out->root()) {
+    for (Node* exit : inliner.exits()) out->root()->AddInput(exit);
+  }
+  return out;
+}
+
+}  // namespace sun
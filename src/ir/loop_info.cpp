@@ -0,0 +1,151 @@
+#include "suntv/ir/loop_info.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "suntv/ir/constant_pool.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/node.hpp"
+#include "suntv/ir/opcode.hpp"
+
+namespace sun {
+
+namespace {
+
+std::optional<int64_t> ConstantValue(const Node* n) {
+  if (!n) return std::nullopt;
+  const Opcode op = n->opcode();
+  if (op != Opcode::kConI && op != Opcode::kConL) return std::nullopt;
+  if (const Constant* c = n->constant()) return c->value;
+  if (n->has_prop("value")) {
+    const Property p = n->prop("value");
+    if (std::holds_alternative<int32_t>(p)) return std::get<int32_t>(p);
+    if (std::holds_alternative<int64_t>(p)) return std::get<int64_t>(p);
+  }
+  if (n->has_prop("dump_spec")) {
+    const Property p = n->prop("dump_spec");
+    if (std::holds_alternative<std::string>(p)) {
+      return ConstantPool::DecodeDumpSpec(op, std::get<std::string>(p));
+    }
+  }
+  return std::nullopt;
+}
+
+LoopKind KindOf(const Node* head) {
+  if (!head->has_prop("dump_spec")) return LoopKind::kNormal;
+  const Property p = head->prop("dump_spec");
+  if (!std::holds_alternative<std::string>(p)) return LoopKind::kNormal;
+  // e.g. "inner stride: 16 main of N309 strip mined"
+  const std::string& spec = std::get<std::string>(p);
+  if (spec.find("pre of") != std::string::npos) return LoopKind::kPre;
+  if (spec.find("main of") != std::string::npos) return LoopKind::kMain;
+  if (spec.find("post of") != std::string::npos) return LoopKind::kPost;
+  return LoopKind::kNormal;
+}
+
+// Fill in the trip counter of a loop whose head, end and phis are known.
+bool MatchTripCounter(CountedLoopInfo* loop) {
+  const bool is_long = loop->head->opcode() == Opcode::kLongCountedLoop;
+  const Opcode add_op = is_long ? Opcode::kAddL : Opcode::kAddI;
+  const Opcode cmp_op = is_long ? Opcode::kCmpL : Opcode::kCmpI;
+
+  std::vector<Node*> end_in = loop->end->value_inputs();
+  const Node* test = end_in.empty() ? nullptr : end_in[0];
+  if (!test || test->opcode() != Opcode::kBool) return false;
+  std::vector<Node*> test_in = test->value_inputs();
+  const Node* cmp = test_in.empty() ? nullptr : test_in[0];
+  if (!cmp || cmp->opcode() != cmp_op) return false;
+  std::vector<Node*> cmp_in = cmp->value_inputs();
+  if (cmp_in.size() != 2) return false;
+
+  // incr is compared against the limit; C2 keeps it on the left
+  for (size_t side = 0; side < 2; ++side) {
+    const Node* incr = cmp_in[side];
+    if (!incr || incr->opcode() != add_op) continue;
+    std::vector<Node*> add_in = incr->value_inputs();
+    if (add_in.size() != 2) continue;
+    for (size_t k = 0; k < 2; ++k) {
+      const Node* iv = add_in[k];
+      auto stride = ConstantValue(add_in[1 - k]);
+      if (!iv || !stride || *stride == 0) continue;
+      if (iv->opcode() != Opcode::kPhi || iv->region_input() != loop->head ||
+          iv->num_inputs() < 3 || iv->input(2) != incr) {
+        continue;
+      }
+      loop->test = test;
+      loop->iv = iv;
+      loop->init = iv->input(1);
+      loop->incr = incr;
+      loop->limit = cmp_in[1 - side];
+      loop->stride = *stride;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool CountedLoopInfo::straight_line() const {
+  return end && end->num_inputs() > 0 && end->input(0) == head;
+}
+
+std::vector<CountedLoopInfo> FindCountedLoops(const Graph& g) {
+  std::vector<CountedLoopInfo> loops;
+  std::unordered_map<const Node*, std::vector<const Node*>> phis;
+  std::unordered_map<const Node*, const Node*> exits;
+
+  for (const Node* n : g.nodes()) {
+    if (!n || n->num_inputs() == 0) continue;
+    const Node* in0 = n->input(0);
+    if (!in0) continue;
+    if (n->opcode() == Opcode::kPhi && IsLoopHead(in0->opcode())) {
+      phis[in0].push_back(n);
+    } else if (n->opcode() == Opcode::kIfFalse && IsLoopEnd(in0->opcode())) {
+      exits[in0] = n;
+    }
+  }
+
+  for (const Node* head : g.nodes()) {
+    if (!head) continue;
+    const Opcode op = head->opcode();
+    if (op != Opcode::kCountedLoop && op != Opcode::kLongCountedLoop) continue;
+    if (head->num_inputs() < 3) continue;
+
+    CountedLoopInfo loop;
+    loop.head = head;
+    loop.back_control = head->input(2);
+    if (!loop.back_control || loop.back_control->opcode() != Opcode::kIfTrue ||
+        loop.back_control->num_inputs() == 0) {
+      continue;
+    }
+    loop.end = loop.back_control->input(0);
+    if (!loop.end || !IsLoopEnd(loop.end->opcode())) continue;
+    auto exit = exits.find(loop.end);
+    if (exit == exits.end()) continue;
+    loop.exit = exit->second;
+
+    auto it = phis.find(head);
+    if (it != phis.end()) loop.phis = it->second;
+    std::sort(loop.phis.begin(), loop.phis.end(),
+              [](const Node* a, const Node* b) { return a->id() < b->id(); });
+    if (!MatchTripCounter(&loop)) continue;
+
+    loop.kind = KindOf(head);
+    const Node* entry = head->input(1);
+    if (entry && entry->opcode() == Opcode::kOuterStripMinedLoop) {
+      loop.outer = entry;
+    }
+    loops.push_back(std::move(loop));
+  }
+
+  std::sort(loops.begin(), loops.end(),
+            [](const CountedLoopInfo& a, const CountedLoopInfo& b) {
+              return a.head->id() < b.head->id();
+            });
+  return loops;
+}
+
+}  // namespace sun
@@ -0,0 +1,575 @@
+#include "suntv/ir/mach_lowering.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "suntv/ir/method_signature.hpp"
+#include "suntv/ir/node.hpp"
+#include "suntv/ir/opcode.hpp"
+
+namespace sun {
+
+namespace {
+
+// TypeFunc::Parms: Start projections and call inputs below it are control,
+// I/O, memory, frame pointer and return address
+constexpr int64_t kParms = 5;
+
+// Ideal spelling of Start's projections below TypeFunc::Parms
+constexpr const char* kStartProjSpecs[kParms] = {"Control", "I_O", "Memory",
+                                                 "FramePtr", "ReturnAdr"};
+
+std::optional<int64_t> IntProp(const Node* n, const std::string& key) {
+  if (!n->has_prop(key)) return std::nullopt;
+  const Property p = n->prop(key);
+  if (std::holds_alternative<int32_t>(p)) return std::get<int32_t>(p);
+  if (std::holds_alternative<int64_t>(p)) return std::get<int64_t>(p);
+  return std::nullopt;
+}
+
+std::string StringProp(const Node* n, const std::string& key) {
+  if (!n->has_prop(key)) return {};
+  const Property p = n->prop(key);
+  if (!std::holds_alternative<std::string>(p)) return {};
+  return std::get<std::string>(p);
+}
+
+bool IsInstruction(const Node* n) { return n->has_prop("idealOpcode"); }
+
+// Ideal operator of a node: its idealOpcode if it is an instruction
+Opcode IdealOpcode(const Node* n) {
+  if (!IsInstruction(n)) return n->opcode();
+  return StringToOpcode(StringProp(n, "idealOpcode"));
+}
+
+// "addI_rReg_imm"; the parser keeps the name of unknown nodes
+std::string MachName(const Node* n) {
+  std::string name = StringProp(n, "name");
+  return name.empty() ? OpcodeToString(n->opcode()) : name;
+}
+
+bool EndsWith(std::string_view s, std::string_view suffix) {
+  return s.size() >= suffix.size() &&
+         s.substr(s.size() - suffix.size()) == suffix;
+}
+
+bool IsBranch(Opcode op) {
+  return op == Opcode::kIf || op == Opcode::kRangeCheck ||
+         op == Opcode::kParsePredicate || IsLoopEnd(op);
+}
+
+bool IsCMove(Opcode op) {
+  return op == Opcode::kCMoveI || op == Opcode::kCMoveL ||
+         op == Opcode::kCMoveP || op == Opcode::kCMoveF ||
+         op == Opcode::kCMoveD;
+}
+
+bool IsBinary(Opcode op) {
+  switch (op) {
+    case Opcode::kAddI:
+    case Opcode::kSubI:
+    case Opcode::kMulI:
+    case Opcode::kDivI:
+    case Opcode::kModI:
+    case Opcode::kAddL:
+    case Opcode::kSubL:
+    case Opcode::kMulL:
+    case Opcode::kDivL:
+    case Opcode::kModL:
+    case Opcode::kAndI:
+    case Opcode::kOrI:
+    case Opcode::kXorI:
+    case Opcode::kLShiftI:
+    case Opcode::kRShiftI:
+    case Opcode::kURShiftI:
+    case Opcode::kAndL:
+    case Opcode::kOrL:
+    case Opcode::kXorL:
+    case Opcode::kLShiftL:
+    case Opcode::kRShiftL:
+    case Opcode::kURShiftL:
+    case Opcode::kCmpI:
+    case Opcode::kCmpL:
+    case Opcode::kCmpP:
+    case Opcode::kCmpU:
+    case Opcode::kCmpUL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Constant an immediate operand of op stands for: long operations take
+// long immediates, shift counts are ints
+Opcode ImmediateOpcode(Opcode op) {
+  switch (op) {
+    case Opcode::kAddL:
+    case Opcode::kSubL:
+    case Opcode::kMulL:
+    case Opcode::kDivL:
+    case Opcode::kModL:
+    case Opcode::kAndL:
+    case Opcode::kOrL:
+    case Opcode::kXorL:
+    case Opcode::kCmpL:
+    case Opcode::kCmpUL:
+      return Opcode::kConL;
+    default:
+      return Opcode::kConI;
+  }
+}
+
+// Immediates printed in an instruction's dump_spec: "#16/0x00000010", one
+// per operand, back to back ("#2/0x00000002#16/0x0000000000000010")
+std::vector<int64_t> Immediates(std::string_view spec) {
+  std::vector<int64_t> imms;
+  if (spec.empty() || spec.front() != '#') return imms;
+  const std::string s(spec);
+  for (size_t pos = 0; (pos = s.find('#', pos)) != std::string::npos;) {
+    char* end = nullptr;
+    const long long v = std::strtoll(s.c_str() + pos + 1, &end, 10);
+    if (end == s.c_str() + pos + 1 || *end != '/') break;
+    imms.push_back(v);
+    pos = end - s.c_str();
+  }
+  return imms;
+}
+
+// Bool mask (LT = 1, EQ = 2, GT = 4) of an x86 cmpOp as printed for cmov
+// instructions; unsigned conditions compare through CmpU/CmpUL already
+std::optional<int32_t> CmpOpMask(std::string_view cond) {
+  if (cond == "l" || cond == "b") return 1;
+  if (cond == "le" || cond == "be") return 3;
+  if (cond == "g" || cond == "a") return 4;
+  if (cond == "ge" || cond == "ae") return 6;
+  if (cond == "e") return 2;
+  if (cond == "ne") return 5;
+  return std::nullopt;
+}
+
+[[noreturn]] void Unsupported(const Node* m, const std::string& why) {
+  throw std::runtime_error("LowerMachGraph: " + MachName(m) + " " +
+                           std::to_string(m->id()) + " " + why);
+}
+
+/**
+ * Conditions of the branches of one Mach graph, looked up in its history.
+ */
+class BranchConditions {
+ public:
+  BranchConditions(const Graph& mach,
+                   const std::vector<const Graph*>& history) {
+    for (auto it = history.rbegin(); it != history.rend(); ++it) {
+      if (*it == &mach) continue;
+      if (!IsMachGraph(**it)) {
+        ideal_ = *it;
+        break;
+      }
+      earlier_mach_.push_back(*it);
+    }
+    if (!ideal_) return;
+    for (const Node* n : ideal_->nodes()) {
+      const Node* test = BoolOf(n);
+      if (test && test->num_inputs() > 1 && test->input(1)) {
+        bools_by_cmp_[test->input(1)->id()].push_back(test);
+      }
+    }
+  }
+
+  // Ideal Bool the branch tests
+  const Node* Find(const Node* branch) const {
+    if (!ideal_) {
+      Unsupported(branch, "has no ideal graph to take its test from");
+    }
+    if (const Node* test = BoolOf(ideal_->node(branch->id()))) return test;
+
+    // Every ideal branch on the same compare tests the same condition
+    const Node* cmp = branch->num_inputs() > 1 ? branch->input(1) : nullptr;
+    if (cmp) {
+      auto it = bools_by_cmp_.find(cmp->id());
+      if (it != bools_by_cmp_.end()) {
+        const Node* first = it->second.front();
+        bool unique = true;
+        for (const Node* test : it->second) {
+          unique = unique && test->interned_prop("dump_spec") ==
+                                 first->interned_prop("dump_spec");
+        }
+        if (unique) return first;
+      }
+    }
+
+    // Block layout renumbers branches: find the same branch (same control
+    // and compare) in an earlier Mach graph and look up its ID
+    for (const Graph* g : earlier_mach_) {
+      for (const Node* n : g->nodes()) {
+        if (n->id() == branch->id() || !IsBranch(IdealOpcode(n)) ||
+            n->num_inputs() < 2 || !n->input(0) || !n->input(1) ||
+            !branch->input(0) || !cmp ||
+            n->input(0)->id() != branch->input(0)->id() ||
+            n->input(1)->id() != cmp->id()) {
+          continue;
+        }
+        if (const Node* test = BoolOf(ideal_->node(n->id()))) return test;
+      }
+    }
+    Unsupported(branch, "tests a condition not found in the ideal graph");
+  }
+
+ private:
+  static const Node* BoolOf(const Node* branch) {
+    if (!branch || !IsBranch(branch->opcode()) || branch->num_inputs() < 2) {
+      return nullptr;
+    }
+    const Node* test = branch->input(1);
+    return test && test->opcode() == Opcode::kBool ? test : nullptr;
+  }
+
+  const Graph* ideal_ = nullptr;
+  std::vector<const Graph*> earlier_mach_;  // Latest first
+  std::unordered_map<NodeID, std::vector<const Node*>> bools_by_cmp_;
+};
+
+class MachLowering {
+ public:
+  MachLowering(const Graph& mach, const std::vector<const Graph*>& history)
+      : mach_(mach),
+        conditions_(mach, history),
+        result_(std::make_unique<Graph>()) {
+    for (const Node* n : mach.nodes()) {
+      next_id_ = std::max(next_id_, n->id() + 1);
+      if (n->opcode() == Opcode::kPhi && n->num_inputs() > 0 && n->input(0)) {
+        phi_regions_.insert(n->input(0));
+      }
+    }
+  }
+
+  std::unique_ptr<Graph> Run() {
+    if (!mach_.root()) {
+      throw std::runtime_error("LowerMachGraph: graph has no Root");
+    }
+    Lower(mach_.root());
+    // Every parameter, used or not, so the run sees the full signature
+    if (const Node* start = mach_.start()) {
+      for (const Node* n : mach_.nodes()) {
+        if (n->opcode() == Opcode::kProj && n->num_inputs() > 0 &&
+            n->input(0) == start) {
+          Lower(n);
+        }
+      }
+    }
+    if (const Schedule* schedule = mach_.schedule()) CopySchedule(*schedule);
+    return std::move(result_);
+  }
+
+ private:
+  // The lowered node standing for `m` as an input; null for operands that
+  // are not values (MachTemp). Control inputs bypass Gotos and Regions
+  // that merge a single path.
+  Node* Input(const Node* m, bool control) {
+    m = Forward(m);
+    if (m && control) m = SkipTrivialControl(m);
+    return m ? Lower(m) : nullptr;
+  }
+
+  // Spill copies are their input
+  const Node* Forward(const Node* m) const {
+    while (m && IsInstruction(m) && StringProp(m, "idealOpcode") == "Node") {
+      const std::string name = MachName(m);
+      if (name == "MachTemp") return nullptr;
+      if (!EndsWith(name, "SpillCopy")) Unsupported(m, "has no ideal form");
+      m = m->num_inputs() > 1 ? m->input(1) : nullptr;
+    }
+    return m;
+  }
+
+  const Node* SkipTrivialControl(const Node* m) const {
+    while (true) {
+      if (IdealOpcode(m) == Opcode::kGoto && IsInstruction(m) &&
+          m->num_inputs() > 0 && m->input(0)) {
+        m = m->input(0);
+        continue;
+      }
+      if (m->opcode() != Opcode::kRegion || phi_regions_.count(m)) return m;
+      const Node* pred = nullptr;
+      size_t preds = 0;
+      for (size_t i = 0; i < m->num_inputs(); ++i) {
+        const Node* in = m->input(i);
+        if (in && in != m) {
+          pred = in;
+          ++preds;
+        }
+      }
+      if (preds != 1) return m;
+      m = pred;
+    }
+  }
+
+  Node* Lower(const Node* m) {
+    auto it = lowered_.find(m);
+    if (it != lowered_.end()) return it->second;
+    if (m->opcode() == Opcode::kProj) return LowerProj(m);
+    if (IsInstruction(m)) return LowerInstruction(m);
+    return LowerIdeal(m);
+  }
+
+  // A node of `op` standing for m; registered before its inputs are
+  // lowered so cycles through Phis and loop heads close on it
+  Node* Emit(const Node* m, Opcode op) {
+    Node* n = result_->AddNode(m->id(), op);
+    for (const char* key : {"type", "dump_spec", "con", "idx", "bci"}) {
+      if (m->has_prop(key)) n->set_prop(key, m->prop(key));
+    }
+    if (IsInstruction(m)) n->set_prop("mach", MachName(m));
+    n->set_type(m->type());
+    lowered_[m] = n;
+    return n;
+  }
+
+  Node* NewNode(Opcode op) { return result_->AddNode(next_id_++, op); }
+
+  Node* Constant(Opcode op, int64_t value) {
+    Node* c = NewNode(op);
+    if (op == Opcode::kConL) {
+      c->set_prop("value", value);
+    } else {
+      c->set_prop("value", static_cast<int32_t>(value));
+    }
+    return c;
+  }
+
+  // Ideal nodes (Root, Start, Region, Phi, projections, constants) keep
+  // their inputs
+  Node* LowerIdeal(const Node* m) {
+    if (m->opcode() == Opcode::kUnknown) Unsupported(m, "has no idealOpcode");
+    Node* n = Emit(m, m->opcode());
+    const bool merge = IsRegion(m->opcode());
+    for (size_t i = 0; i < m->num_inputs(); ++i) {
+      const Node* in = m->input(i);
+      n->set_input(i, in ? Input(in, merge || i == 0) : nullptr);
+    }
+    return n;
+  }
+
+  Node* LowerProj(const Node* m) {
+    const Node* parent = m->num_inputs() > 0 ? m->input(0) : nullptr;
+    if (!parent) Unsupported(m, "projects nothing");
+    if (parent->opcode() != Opcode::kStart) {
+      Node* n = Emit(m, Opcode::kProj);
+      n->set_input(0, Lower(parent));
+      return n;
+    }
+
+    // Start's projections are Parms in the ideal graph
+    const int64_t con = IntProp(m, "con").value_or(-1);
+    if (con < 0) Unsupported(m, "has no projection number");
+    Node* n = Emit(m, Opcode::kParm);
+    n->set_input(0, Lower(parent));
+    if (con < kParms) {
+      n->set_prop("dump_spec", std::string(kStartProjSpecs[con]));
+    } else {
+      std::string type = StringProp(m, "type");
+      type = type.substr(0, type.find(':'));
+      n->set_prop("index", static_cast<int32_t>(con - kParms));
+      n->set_prop("dump_spec",
+                  "Parm" + std::to_string(con - kParms) + ": " + type);
+    }
+    return n;
+  }
+
+  Node* LowerInstruction(const Node* m) {
+    const Opcode op = IdealOpcode(m);
+    if (op == Opcode::kUnknown) {
+      Unsupported(m, "has no ideal form (" + StringProp(m, "idealOpcode") +
+                         ")");
+    }
+    const std::string spec = StringProp(m, "dump_spec");
+
+    switch (op) {
+      case Opcode::kConI:
+      case Opcode::kConL: {
+        const std::vector<int64_t> imms = Immediates(spec);
+        if (imms.size() != 1) Unsupported(m, "has no immediate");
+        Node* n = Emit(m, op);
+        if (op == Opcode::kConL) {
+          n->set_prop("value", imms[0]);
+        } else {
+          n->set_prop("value", static_cast<int32_t>(imms[0]));
+        }
+        return n;
+      }
+      case Opcode::kConP:
+        if (spec.find("null") == std::string::npos) {
+          Unsupported(m, "loads a non-null pointer constant");
+        }
+        return Emit(m, op);
+      case Opcode::kSafePoint: {
+        // The poll and JVM state are not part of the computation
+        Node* n = Emit(m, op);
+        n->set_input(0, Input(m->input(0), true));
+        return n;
+      }
+      case Opcode::kCallStaticJava:
+        return LowerCall(m);
+      case Opcode::kReturn:
+      case Opcode::kHalt:
+        return LowerIdealInputs(m, op);
+      default:
+        break;
+    }
+    if (IsBranch(op)) return LowerBranch(m, op);
+    if (IsCMove(op)) return LowerCMove(m, op);
+    if (IsMemory(op)) Unsupported(m, "accesses memory");
+    return LowerArithmetic(m, op, spec);
+  }
+
+  // Instructions whose inputs are those of their ideal node
+  Node* LowerIdealInputs(const Node* m, Opcode op) {
+    Node* n = Emit(m, op);
+    for (size_t i = 0; i < m->num_inputs(); ++i) {
+      const Node* in = m->input(i);
+      n->set_input(i, in ? Input(in, i == 0) : nullptr);
+    }
+    return n;
+  }
+
+  Node* LowerCall(const Node* m) {
+    // Control, I/O, memory, frame, return address, then the arguments;
+    // the debug info after them is not needed to run the call
+    size_t inputs = kParms;
+    const auto sig = MethodSignature::Parse(StringProp(m, "dump_spec"));
+    if (sig && sig->has_params) inputs += sig->params.size();
+    Node* n = Emit(m, Opcode::kCallStaticJava);
+    for (size_t i = 0; i < inputs && i < m->num_inputs(); ++i) {
+      const Node* in = m->input(i);
+      n->set_input(i, in ? Input(in, i == 0) : nullptr);
+    }
+    return n;
+  }
+
+  Node* LowerBranch(const Node* m, Opcode op) {
+    if (m->num_inputs() < 2 || !m->input(1)) {
+      Unsupported(m, "has no compare input");
+    }
+    const Node* ideal_test = conditions_.Find(m);
+    Node* n = Emit(m, op);
+    n->set_input(0, Input(m->input(0), true));
+    Node* test = NewNode(Opcode::kBool);
+    for (const char* key : {"dump_spec", "mask", "type"}) {
+      if (ideal_test->has_prop(key)) test->set_prop(key, ideal_test->prop(key));
+    }
+    test->set_input(1, Input(m->input(1), false));
+    n->set_input(1, test);
+    return n;
+  }
+
+  // cmov(flags, dst, src) moves src when the condition holds
+  Node* LowerCMove(const Node* m, Opcode op) {
+    const auto mask = CmpOpMask(StringProp(m, "dump_spec"));
+    if (!mask || m->num_inputs() < 4) {
+      Unsupported(m, "has an unknown condition or operand shape");
+    }
+    Node* n = Emit(m, op);
+    Node* test = NewNode(Opcode::kBool);
+    test->set_prop("mask", *mask);
+    test->set_input(1, Input(m->input(1), false));
+    n->set_input(1, test);
+    n->set_input(2, Input(m->input(3), false));
+    n->set_input(3, Input(m->input(2), false));
+    return n;
+  }
+
+  Node* LowerArithmetic(const Node* m, Opcode op, const std::string& spec) {
+    std::vector<const Node*> regs;
+    for (size_t i = 1; i < m->num_inputs(); ++i) {
+      const Node* in = m->input(i) ? Forward(m->input(i)) : nullptr;
+      if (!in) continue;
+      if (StringProp(in, "type") == "memory") {
+        Unsupported(m, "has a memory operand");
+      }
+      regs.push_back(in);
+    }
+    const std::vector<int64_t> imms = Immediates(spec);
+    const std::string name = MachName(m);
+
+    Node* n = Emit(m, op);
+    if (m->num_inputs() > 0 && m->input(0)) {
+      n->set_input(0, Input(m->input(0), true));
+    }
+    size_t slot = 1;
+    auto add = [&](Node* in) { n->set_input(slot++, in); };
+
+    if (imms.empty()) {
+      for (const Node* r : regs) add(Lower(r));
+    } else if (IsBinary(op) && regs.size() == 1 && imms.size() == 1) {
+      add(Lower(regs[0]));
+      add(Constant(ImmediateOpcode(op), imms[0]));
+    } else if (IsBinary(op) && regs.size() == 2 && imms.size() == 1 &&
+               name.find("_immI2") != std::string::npos) {
+      // lea base + (index << scale); the commuted "_0" form lists the
+      // index first
+      const bool index_first = EndsWith(name, "_0");
+      Node* shift = NewNode(op == Opcode::kAddL ? Opcode::kLShiftL
+                                                : Opcode::kLShiftI);
+      shift->set_input(1, Lower(regs[index_first ? 0 : 1]));
+      shift->set_input(2, Constant(Opcode::kConI, imms[0]));
+      add(shift);
+      add(Lower(regs[index_first ? 1 : 0]));
+    } else {
+      Unsupported(m, "has an unsupported operand shape (" +
+                         std::to_string(regs.size()) + " register(s), " +
+                         std::to_string(imms.size()) + " immediate(s))");
+    }
+
+    // CmpP against null prints the constant instead of an immediate
+    if (op == Opcode::kCmpP && slot == 2 &&
+        spec.find("null") != std::string::npos) {
+      add(NewNode(Opcode::kConP));
+    }
+    return n;
+  }
+
+  void CopySchedule(const Schedule& schedule) {
+    auto lowered = std::make_unique<Schedule>();
+    for (const Schedule::Block& b : schedule.blocks()) {
+      lowered->AddBlock(b.name);
+    }
+    for (uint32_t i = 0; i < schedule.blocks().size(); ++i) {
+      const Schedule::Block& b = schedule.block(i);
+      for (uint32_t s : b.successors) lowered->AddSuccessor(i, s);
+      for (const Node* m : b.nodes) {
+        auto it = lowered_.find(m);
+        if (it != lowered_.end()) lowered->Place(it->second, i);
+      }
+    }
+    result_->set_schedule(std::move(lowered));
+  }
+
+  const Graph& mach_;
+  BranchConditions conditions_;
+  std::unique_ptr<Graph> result_;
+  std::unordered_map<const Node*, Node*> lowered_;
+  std::unordered_set<const Node*> phi_regions_;  // Regions merged by Phis
+  NodeID next_id_ = 0;
+};
+
+}  // namespace
+
+bool IsMachGraph(const Graph& g) {
+  for (const Node* n : g.nodes()) {
+    if (IsInstruction(n)) return true;
+  }
+  return false;
+}
+
+std::unique_ptr<Graph> LowerMachGraph(
+    const Graph& mach, const std::vector<const Graph*>& history) {
+  return MachLowering(mach, history).Run();
+}
+
+}  // namespace sun
@@ -0,0 +1,98 @@
+#include "suntv/ir/method_signature.hpp"
+
+#include <cctype>
+
+namespace sun {
+
+namespace {
+
+std::string_view Trim(std::string_view s) {
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+}  // namespace
+
+std::optional<MethodSignature> MethodSignature::Parse(
+    std::string_view dump_spec) {
+  if (dump_spec.find("uncommon_trap") != std::string_view::npos) {
+    return std::nullopt;
+  }
+  size_t pos = dump_spec.find("# Static");
+  pos = pos == std::string_view::npos ? 0 : pos + 8;
+
+  // The method is the first token with "::"
+  std::string_view rest = dump_spec.substr(pos);
+  std::string_view method;
+  while (true) {
+    rest = Trim(rest);
+    if (rest.empty()) return std::nullopt;
+    size_t end = 0;
+    while (end < rest.size() &&
+           !std::isspace(static_cast<unsigned char>(rest[end]))) {
+      ++end;
+    }
+    std::string_view token = rest.substr(0, end);
+    rest.remove_prefix(end);
+    if (token.find("::") != std::string_view::npos) {
+      method = token;
+      break;
+    }
+    if (token.find('(') != std::string_view::npos) return std::nullopt;
+  }
+
+  MethodSignature sig;
+  const size_t sep = method.find("::");
+  sig.holder = NormalizeKey(method.substr(0, sep));
+  sig.name = std::string(method.substr(sep + 2));
+  if (sig.holder.empty() || sig.name.empty()) return std::nullopt;
+
+  // "int ( int, half )": the return type, then the argument slots
+  const size_t open = rest.find('(');
+  sig.ret = std::string(Trim(rest.substr(0, open)));
+  if (sig.ret.empty()) sig.ret = "void";
+  if (open == std::string_view::npos) return sig;
+  const size_t close = rest.find(')', open);
+  if (close == std::string_view::npos) return sig;
+
+  std::string_view list = rest.substr(open + 1, close - open - 1);
+  while (!Trim(list).empty()) {
+    const size_t comma = list.find(',');
+    sig.params.emplace_back(Trim(list.substr(0, comma)));
+    if (comma == std::string_view::npos) break;
+    list.remove_prefix(comma + 1);
+  }
+  sig.has_params = true;
+  return sig;
+}
+
+std::string MethodSignature::Key() const {
+  std::string key = ShortKey() + "(";
+  bool first = true;
+  for (const std::string& p : params) {
+    if (p == "half") continue;
+    if (!first) key += ",";
+    key += p;
+    first = false;
+  }
+  return NormalizeKey(key + ")");
+}
+
+std::string MethodSignature::ShortKey() const { return holder + "::" + name; }
+
+std::string MethodSignature::NormalizeKey(std::string_view method) {
+  std::string key;
+  key.reserve(method.size());
+  for (char c : method) {
+    if (std::isspace(static_cast<unsigned char>(c))) continue;
+    key += c == '/' ? '.' : c;
+  }
+  return key;
+}
+
+}  // namespace sun
@@ -1,12 +1,33 @@
 #include "suntv/ir/node.hpp"
 
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 
 namespace sun {
 
+struct Node::StandaloneStorage {
+  Arena arena{/*initial_chunk_size=*/1024};
+  StringInterner strings{arena};
+};
+
 Node::Node(NodeID id, Opcode opcode)
-    : id_(id), opcode_(opcode), type_(TypeKind::kTop) {}
+    : standalone_(std::make_unique<StandaloneStorage>()),
+      id_(id),
+      opcode_(opcode),
+      strings_(&standalone_->strings),
+      type_(TypeKind::kTop) {}
+
+Node::Node(NodeID id, Opcode opcode, Arena* arena, StringInterner* strings)
+    : id_(id),
+      opcode_(opcode),
+      inputs_(arena),
+      props_(arena),
+      strings_(strings),
+      type_(TypeKind::kTop) {}
+
+Node::~Node() = default;
 
 Node* Node::input(size_t i) const {
   if (i >= inputs_.size()) {
@@ -24,20 +45,95 @@ void Node::set_input(size_t i, Node* n) {
   inputs_[i] = n;
 }
 
+const Node::PropSlot* Node::FindProp(const std::string& key) const {
+  for (const PropSlot& slot : props_) {
+    if (slot.key.view() == key) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
 bool Node::has_prop(const std::string& key) const {
-  return props_.find(key) != props_.end();
+  return FindProp(key) != nullptr;
 }
 
 Property Node::prop(const std::string& key) const {
-  auto it = props_.find(key);
-  if (it == props_.end()) {
+  const PropSlot* slot = FindProp(key);
+  if (!slot) {
     throw std::runtime_error("Property not found: " + key);
   }
-  return it->second;
+  return std::visit(
+      [](const auto& v) -> Property {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, InternedString>) {
+          return std::string(v.view());
+        } else {
+          return v;
+        }
+      },
+      slot->value);
+}
+
+PropertyView Node::prop_value(size_t i) const {
+  return std::visit(
+      [](const auto& v) -> PropertyView {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, InternedString>) {
+          return v.view();
+        } else {
+          return v;
+        }
+      },
+      props_[i].value);
+}
+
+InternedString Node::interned_prop(const std::string& key) const {
+  const PropSlot* slot = FindProp(key);
+  if (!slot || !std::holds_alternative<InternedString>(slot->value)) {
+    return InternedString();
+  }
+  return std::get<InternedString>(slot->value);
 }
 
 void Node::set_prop(const std::string& key, Property value) {
-  props_[key] = value;
+  StoredProperty stored = std::visit(
+      [this](auto&& v) -> StoredProperty {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+          return strings_->Intern(v);
+        } else {
+          return v;
+        }
+      },
+      std::move(value));
+
+  for (PropSlot& slot : props_) {
+    if (slot.key.view() == key) {
+      slot.value = stored;
+      return;
+    }
+  }
+  props_.push_back(PropSlot{strings_->Intern(key), stored});
+}
+
+void Node::CopyPropsFrom(const Node& other) {
+  for (const PropSlot& slot : other.props_) {
+    StoredProperty stored = slot.value;
+    if (const auto* str = std::get_if<InternedString>(&slot.value)) {
+      stored = strings_->Intern(str->view());
+    }
+    const InternedString key = strings_->Intern(slot.key.view());
+    bool replaced = false;
+    for (PropSlot& mine : props_) {
+      if (mine.key.view() == key.view()) {
+        mine.value = stored;
+        replaced = true;
+        break;
+      }
+    }
+    if (!replaced) props_.push_back(PropSlot{key, stored});
+  }
 }
 
 std::string Node::ToString() const {
@@ -85,8 +181,7 @@ Node* Node::memory_input() const {
   }
 }
 
-std::vector<Node*> Node::value_inputs() const {
-  std::vector<Node*> result;
+size_t Node::value_inputs_begin() const {
   auto s = schema();
 
   size_t start_idx = 0;
@@ -117,7 +212,7 @@ std::vector<Node*> Node::value_inputs() const {
         start_idx = 1;
       } else {
         // Region/MergeMem don't have "value" inputs in the S0 sense
-        return result;
+        return num_inputs();
       }
       break;
 
@@ -155,15 +250,18 @@ std::vector<Node*> Node::value_inputs() const {
 
     default:
       // Unknown schema or no value inputs
-      return result;
+      return num_inputs();
   }
+  return std::min(start_idx, num_inputs());
+}
 
-  for (size_t i = start_idx; i < num_inputs(); ++i) {
+std::vector<Node*> Node::value_inputs() const {
+  std::vector<Node*> result;
+  for (size_t i = value_inputs_begin(); i < num_inputs(); ++i) {
     if (inputs_[i] != nullptr) {
       result.push_back(inputs_[i]);
     }
   }
-
   return result;
 }
 
@@ -192,8 +290,8 @@ std::vector<Node*> Node::phi_values() const {
 
 std::vector<Node*> Node::region_preds() const {
   std::vector<Node*> result;
-  // Valid only for Region nodes (S2)
-  if (opcode_ == Opcode::kRegion || opcode_ == Opcode::kMergeMem) {
+  // Valid only for Region-like nodes and MergeMem (S2)
+  if (IsRegion(opcode_) || opcode_ == Opcode::kMergeMem) {
     for (size_t i = 0; i < num_inputs(); ++i) {
       if (inputs_[i] != nullptr) {
         result.push_back(inputs_[i]);
@@ -265,11 +363,9 @@ bool Node::ValidateInputs() const {
       return true;
 
     case NodeSchema::kS5_Allocate:
-      // Allocate must have: control, memory (minimum 2)
-      if (num_inputs() < 2) {
-        return false;
-      }
-      return true;
+      // Allocate must have control; C2 adds memory, but graphs built
+      // without a memory chain (GraphBuilder) leave it out
+      return num_inputs() >= 1;
 
     case NodeSchema::kS6_Return:
       // Return must have at least control
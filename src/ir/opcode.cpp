@@ -1,590 +1,212 @@
 #include "suntv/ir/opcode.hpp"
 
-#include <unordered_map>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iterator>
 
 namespace sun {
 
-std::string OpcodeToString(Opcode op) {
-  switch (op) {
-    // Control
-    case Opcode::kStart:
-      return "Start";
-    case Opcode::kIf:
-      return "If";
-    case Opcode::kIfTrue:
-      return "IfTrue";
-    case Opcode::kIfFalse:
-      return "IfFalse";
-    case Opcode::kRegion:
-      return "Region";
-    case Opcode::kGoto:
-      return "Goto";
-    case Opcode::kReturn:
-      return "Return";
-    case Opcode::kRoot:
-      return "Root";
-    case Opcode::kHalt:
-      return "Halt";
-
-    // Constants
-    case Opcode::kConI:
-      return "ConI";
-    case Opcode::kConL:
-      return "ConL";
-    case Opcode::kConP:
-      return "ConP";
-
-    // Arithmetic - Int32
-    case Opcode::kAddI:
-      return "AddI";
-    case Opcode::kSubI:
-      return "SubI";
-    case Opcode::kMulI:
-      return "MulI";
-    case Opcode::kDivI:
-      return "DivI";
-    case Opcode::kModI:
-      return "ModI";
-    case Opcode::kAbsI:
-      return "AbsI";
-
-    // Arithmetic - Int64
-    case Opcode::kAddL:
-      return "AddL";
-    case Opcode::kSubL:
-      return "SubL";
-    case Opcode::kMulL:
-      return "MulL";
-    case Opcode::kDivL:
-      return "DivL";
-    case Opcode::kModL:
-      return "ModL";
-    case Opcode::kAbsL:
-      return "AbsL";
-
-    // Bitwise - Int32
-    case Opcode::kAndI:
-      return "AndI";
-    case Opcode::kOrI:
-      return "OrI";
-    case Opcode::kXorI:
-      return "XorI";
-    case Opcode::kLShiftI:
-      return "LShiftI";
-    case Opcode::kRShiftI:
-      return "RShiftI";
-    case Opcode::kURShiftI:
-      return "URShiftI";
-
-    // Bitwise - Int64
-    case Opcode::kAndL:
-      return "AndL";
-    case Opcode::kOrL:
-      return "OrL";
-    case Opcode::kXorL:
-      return "XorL";
-    case Opcode::kLShiftL:
-      return "LShiftL";
-    case Opcode::kRShiftL:
-      return "RShiftL";
-    case Opcode::kURShiftL:
-      return "URShiftL";
-
-    // Comparison
-    case Opcode::kCmpI:
-      return "CmpI";
-    case Opcode::kCmpL:
-      return "CmpL";
-    case Opcode::kCmpP:
-      return "CmpP";
-    case Opcode::kCmpU:
-      return "CmpU";
-    case Opcode::kCmpUL:
-      return "CmpUL";
-    case Opcode::kBool:
-      return "Bool";
-
-    // Casts/Conversions
-    case Opcode::kConvI2L:
-      return "ConvI2L";
-    case Opcode::kConvL2I:
-      return "ConvL2I";
-    case Opcode::kConv2B:
-      return "Conv2B";
-    case Opcode::kCastII:
-      return "CastII";
-    case Opcode::kCastLL:
-      return "CastLL";
-    case Opcode::kCastPP:
-      return "CastPP";
-    case Opcode::kCastX2P:
-      return "CastX2P";
-    case Opcode::kCastP2X:
-      return "CastP2X";
-
-    // Conditional move
-    case Opcode::kCMoveI:
-      return "CMoveI";
-    case Opcode::kCMoveL:
-      return "CMoveL";
-    case Opcode::kCMoveP:
-      return "CMoveP";
-
-    // Memory - Loads
-    case Opcode::kLoadB:
-      return "LoadB";
-    case Opcode::kLoadUB:
-      return "LoadUB";
-    case Opcode::kLoadS:
-      return "LoadS";
-    case Opcode::kLoadUS:
-      return "LoadUS";
-    case Opcode::kLoadI:
-      return "LoadI";
-    case Opcode::kLoadL:
-      return "LoadL";
-    case Opcode::kLoadP:
-      return "LoadP";
-    case Opcode::kLoadN:
-      return "LoadN";
-
-    // Memory - Stores
-    case Opcode::kStoreB:
-      return "StoreB";
-    case Opcode::kStoreC:
-      return "StoreC";
-    case Opcode::kStoreI:
-      return "StoreI";
-    case Opcode::kStoreL:
-      return "StoreL";
-    case Opcode::kStoreP:
-      return "StoreP";
-    case Opcode::kStoreN:
-      return "StoreN";
-
-    // Memory - Merge
-    case Opcode::kMergeMem:
-      return "MergeMem";
-
-    // Allocation
-    case Opcode::kAllocate:
-      return "Allocate";
-    case Opcode::kAllocateArray:
-      return "AllocateArray";
-
-    // Array operations
-    case Opcode::kLoadRange:
-      return "LoadRange";
-    case Opcode::kRangeCheck:
-      return "RangeCheck";
-
-    // Parameters
-    case Opcode::kParm:
-      return "Parm";
-
-    // Merge/Phi
-    case Opcode::kPhi:
-      return "Phi";
-
-    // Projection
-    case Opcode::kProj:
-      return "Proj";
-
-    // Address calculation
-    case Opcode::kAddP:
-      return "AddP";
-
-    // Runtime/Optimization markers
-    case Opcode::kSafePoint:
-      return "SafePoint";
-    case Opcode::kOpaque1:
-      return "Opaque1";
-    case Opcode::kParsePredicate:
-      return "ParsePredicate";
-    case Opcode::kThreadLocal:
-      return "ThreadLocal";
-    case Opcode::kCallStaticJava:
-      return "CallStaticJava";
-
-    // Unknown
-    case Opcode::kUnknown:
-      return "Unknown";
-
-    default:
-      return "Unknown";
+namespace {
+
+// Category bits referenced by the Flags column of opcodes.def
+enum OpcodeFlag : uint8_t {
+  kOpControl = 1 << 0,
+  kOpPure = 1 << 1,
+  kOpMemory = 1 << 2,
+  kOpMerge = 1 << 3,
+  kOpLoop = 1 << 4,
+};
+
+struct OpcodeInfo {
+  std::string_view name;
+  NodeSchema schema;
+  uint8_t flags;
+};
+
+constexpr std::array<OpcodeInfo, kNumOpcodes> kOpcodeInfo = {{
+#define SUN_OPCODE(Name, Schema, Flags) \
+  {#Name, NodeSchema::Schema, static_cast<uint8_t>(Flags)},
+#include "suntv/ir/opcodes.def"
+}};
+
+static_assert(kOpcodeInfo.back().name == "Unknown",
+              "Unknown must be the last row of opcodes.def");
+
+/**
+ * Fixed-size bitset over opcodes, built at compile time from one flag.
+ */
+class OpcodeSet {
+ public:
+  constexpr explicit OpcodeSet(uint8_t flag) {
+    for (size_t i = 0; i < kNumOpcodes; ++i) {
+      if (kOpcodeInfo[i].flags & flag) {
+        words_[i / 64] |= uint64_t{1} << (i % 64);
+      }
+    }
   }
-}
 
-Opcode StringToOpcode(const std::string& name) {
-  // Build static map on first call
-  static std::unordered_map<std::string, Opcode> map = []() {
-    std::unordered_map<std::string, Opcode> m;
-    // Control
-    m["Start"] = Opcode::kStart;
-    m["StartOSR"] = Opcode::kStart;  // OSR (On-Stack Replacement) start
-    m["If"] = Opcode::kIf;
-    m["IfTrue"] = Opcode::kIfTrue;
-    m["IfFalse"] = Opcode::kIfFalse;
-    m["Region"] = Opcode::kRegion;
-    m["Goto"] = Opcode::kGoto;
-    m["Return"] = Opcode::kReturn;
-    m["Root"] = Opcode::kRoot;
-    m["Halt"] = Opcode::kHalt;
-
-    // Constants
-    m["ConI"] = Opcode::kConI;
-    m["ConL"] = Opcode::kConL;
-    m["ConP"] = Opcode::kConP;
-    m["Con"] = Opcode::kConI;  // Generic constant (assume int for now)
-
-    // Arithmetic - Int32
-    m["AddI"] = Opcode::kAddI;
-    m["SubI"] = Opcode::kSubI;
-    m["MulI"] = Opcode::kMulI;
-    m["DivI"] = Opcode::kDivI;
-    m["ModI"] = Opcode::kModI;
-    m["AbsI"] = Opcode::kAbsI;
-
-    // Arithmetic - Int64
-    m["AddL"] = Opcode::kAddL;
-    m["SubL"] = Opcode::kSubL;
-    m["MulL"] = Opcode::kMulL;
-    m["DivL"] = Opcode::kDivL;
-    m["ModL"] = Opcode::kModL;
-    m["AbsL"] = Opcode::kAbsL;
-
-    // Bitwise - Int32
-    m["AndI"] = Opcode::kAndI;
-    m["OrI"] = Opcode::kOrI;
-    m["XorI"] = Opcode::kXorI;
-    m["LShiftI"] = Opcode::kLShiftI;
-    m["RShiftI"] = Opcode::kRShiftI;
-    m["URShiftI"] = Opcode::kURShiftI;
-
-    // Bitwise - Int64
-    m["AndL"] = Opcode::kAndL;
-    m["OrL"] = Opcode::kOrL;
-    m["XorL"] = Opcode::kXorL;
-    m["LShiftL"] = Opcode::kLShiftL;
-    m["RShiftL"] = Opcode::kRShiftL;
-    m["URShiftL"] = Opcode::kURShiftL;
-
-    // Comparison
-    m["CmpI"] = Opcode::kCmpI;
-    m["CmpL"] = Opcode::kCmpL;
-    m["CmpP"] = Opcode::kCmpP;
-    m["CmpU"] = Opcode::kCmpU;
-    m["CmpUL"] = Opcode::kCmpUL;
-    m["Bool"] = Opcode::kBool;
-
-    // Casts/Conversions
-    m["ConvI2L"] = Opcode::kConvI2L;
-    m["ConvL2I"] = Opcode::kConvL2I;
-    m["Conv2B"] = Opcode::kConv2B;
-    m["CastII"] = Opcode::kCastII;
-    m["CastLL"] = Opcode::kCastLL;
-    m["CastPP"] = Opcode::kCastPP;
-    m["CastX2P"] = Opcode::kCastX2P;
-    m["CastP2X"] = Opcode::kCastP2X;
-
-    // Conditional move
-    m["CMoveI"] = Opcode::kCMoveI;
-    m["CMoveL"] = Opcode::kCMoveL;
-    m["CMoveP"] = Opcode::kCMoveP;
-
-    // Memory - Loads
-    m["LoadB"] = Opcode::kLoadB;
-    m["LoadUB"] = Opcode::kLoadUB;
-    m["LoadS"] = Opcode::kLoadS;
-    m["LoadUS"] = Opcode::kLoadUS;
-    m["LoadI"] = Opcode::kLoadI;
-    m["LoadL"] = Opcode::kLoadL;
-    m["LoadP"] = Opcode::kLoadP;
-    m["LoadN"] = Opcode::kLoadN;
-
-    // Memory - Stores
-    m["StoreB"] = Opcode::kStoreB;
-    m["StoreC"] = Opcode::kStoreC;
-    m["StoreI"] = Opcode::kStoreI;
-    m["StoreL"] = Opcode::kStoreL;
-    m["StoreP"] = Opcode::kStoreP;
-    m["StoreN"] = Opcode::kStoreN;
-
-    // Memory - Merge
-    m["MergeMem"] = Opcode::kMergeMem;
-
-    // Allocation
-    m["Allocate"] = Opcode::kAllocate;
-    m["AllocateArray"] = Opcode::kAllocateArray;
-
-    // Array operations
-    m["LoadRange"] = Opcode::kLoadRange;
-    m["RangeCheck"] = Opcode::kRangeCheck;
-
-    // Parameters
-    m["Parm"] = Opcode::kParm;
-
-    // Merge/Phi
-    m["Phi"] = Opcode::kPhi;
-
-    // Projection
-    m["Proj"] = Opcode::kProj;
-
-    // Address calculation
-    m["AddP"] = Opcode::kAddP;
-
-    // Runtime/Optimization markers
-    m["SafePoint"] = Opcode::kSafePoint;
-    m["Opaque1"] = Opcode::kOpaque1;
-    m["ParsePredicate"] = Opcode::kParsePredicate;
-    m["ThreadLocal"] = Opcode::kThreadLocal;
-    m["CallStaticJava"] = Opcode::kCallStaticJava;
-
-    // Common backend/scheduled forms present in IGV dumps.
-    // For the concrete interpreter we treat these as projections or control
-    // pass-throughs.
-    m["MachProj"] = Opcode::kProj;
-    m["Ret"] = Opcode::kReturn;
-
-    return m;
-  }();
-
-  auto it = map.find(name);
-  if (it != map.end()) {
-    return it->second;
+  constexpr bool Contains(Opcode op) const {
+    size_t i = static_cast<size_t>(op);
+    return i < kNumOpcodes && ((words_[i / 64] >> (i % 64)) & 1);
   }
-  return Opcode::kUnknown;
-}
 
-bool IsControl(Opcode op) {
-  switch (op) {
-    case Opcode::kStart:
-    case Opcode::kIf:
-    case Opcode::kIfTrue:
-    case Opcode::kIfFalse:
-    case Opcode::kRegion:
-    case Opcode::kGoto:
-    case Opcode::kReturn:
-    case Opcode::kRoot:
-    case Opcode::kHalt:
-    case Opcode::kSafePoint:
-      return true;
-    default:
-      return false;
+ private:
+  std::array<uint64_t, (kNumOpcodes + 63) / 64> words_{};
+};
+
+constexpr OpcodeSet kControlSet(kOpControl);
+constexpr OpcodeSet kPureSet(kOpPure);
+constexpr OpcodeSet kMemorySet(kOpMemory);
+constexpr OpcodeSet kMergeSet(kOpMerge);
+constexpr OpcodeSet kLoopSet(kOpLoop);
+
+// ========== Name -> Opcode perfect hash ==========
+//
+// Two-level "hash and displace": a key's bucket is chosen by Hash(key, 0);
+// each bucket stores the seed that sends all of its keys to distinct empty
+// slots of the table. Lookup is two hashes and one string compare. The table
+// is built by the compiler; a duplicate name in opcodes.def fails the build.
+
+struct NameEntry {
+  std::string_view name;
+  Opcode op;
+};
+
+constexpr NameEntry kNames[] = {
+#define SUN_OPCODE(Name, Schema, Flags) {#Name, Opcode::k##Name},
+#define SUN_OPCODE_ALIAS(Spelling, Name) {#Spelling, Opcode::k##Name},
+#include "suntv/ir/opcodes.def"
+};
+
+constexpr size_t kNumNames = std::size(kNames);
+constexpr size_t kNumSlots = std::bit_ceil(kNumNames * 2);
+constexpr size_t kNumBuckets = std::bit_ceil(kNumNames / 2);
+
+// FNV-1a with a seeded basis and a murmur3 finalizer for avalanche
+constexpr uint32_t Hash(std::string_view s, uint32_t seed) {
+  uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (char c : s) {
+    h ^= static_cast<uint8_t>(c);
+    h *= 16777619u;
   }
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
 }
 
-bool IsPure(Opcode op) {
-  // Pure operations have no side effects
-  switch (op) {
-    // Constants
-    case Opcode::kConI:
-    case Opcode::kConL:
-    case Opcode::kConP:
-    // Arithmetic
-    case Opcode::kAddI:
-    case Opcode::kSubI:
-    case Opcode::kMulI:
-    case Opcode::kDivI:
-    case Opcode::kModI:
-    case Opcode::kAbsI:
-    case Opcode::kAddL:
-    case Opcode::kSubL:
-    case Opcode::kMulL:
-    case Opcode::kDivL:
-    case Opcode::kModL:
-    case Opcode::kAbsL:
-    // Bitwise
-    case Opcode::kAndI:
-    case Opcode::kOrI:
-    case Opcode::kXorI:
-    case Opcode::kLShiftI:
-    case Opcode::kRShiftI:
-    case Opcode::kURShiftI:
-    case Opcode::kAndL:
-    case Opcode::kOrL:
-    case Opcode::kXorL:
-    case Opcode::kLShiftL:
-    case Opcode::kRShiftL:
-    case Opcode::kURShiftL:
-    // Comparison
-    case Opcode::kCmpI:
-    case Opcode::kCmpL:
-    case Opcode::kCmpP:
-    case Opcode::kCmpU:
-    case Opcode::kCmpUL:
-    case Opcode::kBool:
-    // Casts
-    case Opcode::kConvI2L:
-    case Opcode::kConvL2I:
-    case Opcode::kCastII:
-    case Opcode::kCastLL:
-    case Opcode::kCastPP:
-    case Opcode::kCastX2P:
-    case Opcode::kCastP2X:
-    // Conditional move
-    case Opcode::kCMoveI:
-    case Opcode::kCMoveL:
-    case Opcode::kCMoveP:
-    // Address calculation (pure computation)
-    case Opcode::kAddP:
-      return true;
-    default:
-      return false;
-  }
+constexpr size_t BucketOf(std::string_view s) {
+  return Hash(s, 0) & (kNumBuckets - 1);
+}
+
+constexpr size_t SlotOf(std::string_view s, uint32_t seed) {
+  return Hash(s, seed) & (kNumSlots - 1);
 }
 
-bool IsMemory(Opcode op) {
-  switch (op) {
-    // Loads
-    case Opcode::kLoadB:
-    case Opcode::kLoadUB:
-    case Opcode::kLoadS:
-    case Opcode::kLoadUS:
-    case Opcode::kLoadI:
-    case Opcode::kLoadL:
-    case Opcode::kLoadP:
-    case Opcode::kLoadN:
-    // Stores
-    case Opcode::kStoreB:
-    case Opcode::kStoreC:
-    case Opcode::kStoreI:
-    case Opcode::kStoreL:
-    case Opcode::kStoreP:
-    case Opcode::kStoreN:
-    // Merge
-    case Opcode::kMergeMem:
-    // Allocation
-    case Opcode::kAllocate:
-    case Opcode::kAllocateArray:
-      return true;
-    default:
-      return false;
+struct PerfectHash {
+  std::array<uint32_t, kNumBuckets> seeds{};
+  std::array<int16_t, kNumSlots> slots{};  // Index into kNames, or -1
+  bool ok = false;
+};
+
+consteval PerfectHash BuildPerfectHash() {
+  constexpr uint32_t kMaxSeed = 1u << 16;
+  PerfectHash ph;
+  for (auto& slot : ph.slots) slot = -1;
+
+  std::array<size_t, kNumBuckets> bucket_size{};
+  for (const NameEntry& e : kNames) ++bucket_size[BucketOf(e.name)];
+
+  // Place the largest buckets first, while the table is emptiest
+  std::array<bool, kNumBuckets> placed{};
+  for (size_t round = 0; round < kNumBuckets; ++round) {
+    size_t b = 0;
+    while (placed[b]) ++b;
+    for (size_t c = b + 1; c < kNumBuckets; ++c) {
+      if (!placed[c] && bucket_size[c] > bucket_size[b]) b = c;
+    }
+    placed[b] = true;
+    if (bucket_size[b] == 0) continue;
+
+    bool found = false;
+    for (uint32_t seed = 1; seed < kMaxSeed && !found; ++seed) {
+      std::array<size_t, kNumNames> taken{};
+      size_t num_taken = 0;
+      bool fits = true;
+      for (size_t k = 0; k < kNumNames && fits; ++k) {
+        if (BucketOf(kNames[k].name) != b) continue;
+        size_t slot = SlotOf(kNames[k].name, seed);
+        fits = ph.slots[slot] < 0;
+        for (size_t t = 0; t < num_taken && fits; ++t) {
+          fits = taken[t] != slot;
+        }
+        taken[num_taken++] = slot;
+      }
+      if (!fits) continue;
+
+      for (size_t k = 0; k < kNumNames; ++k) {
+        if (BucketOf(kNames[k].name) == b) {
+          ph.slots[SlotOf(kNames[k].name, seed)] = static_cast<int16_t>(k);
+        }
+      }
+      ph.seeds[b] = seed;
+      found = true;
+    }
+    if (!found) return ph;  // Only possible with duplicate names
   }
+  ph.ok = true;
+  return ph;
 }
 
-bool IsMerge(Opcode op) {
-  return op == Opcode::kPhi || op == Opcode::kRegion || op == Opcode::kMergeMem;
+constexpr PerfectHash kPerfectHash = BuildPerfectHash();
+
+static_assert(kPerfectHash.ok,
+              "No perfect hash for opcode names; is a name in opcodes.def "
+              "duplicated?");
+
+const OpcodeInfo& Info(Opcode op) {
+  size_t i = static_cast<size_t>(op);
+  return kOpcodeInfo[i < kNumOpcodes ? i : kNumOpcodes - 1];
 }
 
-NodeSchema GetSchema(Opcode op) {
-  switch (op) {
-    // S7: Start node
-    case Opcode::kStart:
-    case Opcode::kRoot:
-      return NodeSchema::kS7_Start;
-
-    // S1: Control nodes (control input + optional condition)
-    case Opcode::kIf:
-    case Opcode::kParsePredicate:  // ParsePredicate branches like If
-    case Opcode::kRangeCheck:      // RangeCheck branches like If on bounds
-    case Opcode::kIfTrue:
-    case Opcode::kIfFalse:
-    case Opcode::kGoto:
-    case Opcode::kHalt:
-    case Opcode::kSafePoint:
-      return NodeSchema::kS1_Control;
-
-    // S2: Merge/Phi nodes (control predecessors + values/states)
-    case Opcode::kRegion:
-    case Opcode::kPhi:
-    case Opcode::kMergeMem:
-      return NodeSchema::kS2_Merge;
-
-    // S3: Load operations (control + memory + address)
-    case Opcode::kLoadB:
-    case Opcode::kLoadUB:
-    case Opcode::kLoadS:
-    case Opcode::kLoadUS:
-    case Opcode::kLoadI:
-    case Opcode::kLoadL:
-    case Opcode::kLoadP:
-    case Opcode::kLoadN:
-      return NodeSchema::kS3_Load;
-
-    // S4: Store operations (control + memory + address + value)
-    case Opcode::kStoreB:
-    case Opcode::kStoreC:
-    case Opcode::kStoreI:
-    case Opcode::kStoreL:
-    case Opcode::kStoreP:
-    case Opcode::kStoreN:
-      return NodeSchema::kS4_Store;
-
-    // S5: Allocation (control + memory + properties)
-    case Opcode::kAllocate:
-    case Opcode::kAllocateArray:
-      return NodeSchema::kS5_Allocate;
-
-    // S6: Return (control + memory + optional value)
-    case Opcode::kReturn:
-      return NodeSchema::kS6_Return;
-
-    // S8: Projection (multi-output source)
-    case Opcode::kProj:
-      return NodeSchema::kS8_Projection;
-
-    // S9: Parameter (Start node)
-    case Opcode::kParm:
-      return NodeSchema::kS9_Parameter;
-
-    // S0: Pure computations (value inputs only)
-    case Opcode::kConI:
-    case Opcode::kConL:
-    case Opcode::kConP:
-    case Opcode::kAddI:
-    case Opcode::kSubI:
-    case Opcode::kMulI:
-    case Opcode::kDivI:
-    case Opcode::kModI:
-    case Opcode::kAbsI:
-    case Opcode::kAddL:
-    case Opcode::kSubL:
-    case Opcode::kMulL:
-    case Opcode::kDivL:
-    case Opcode::kModL:
-    case Opcode::kAbsL:
-    case Opcode::kAndI:
-    case Opcode::kOrI:
-    case Opcode::kXorI:
-    case Opcode::kLShiftI:
-    case Opcode::kRShiftI:
-    case Opcode::kURShiftI:
-    case Opcode::kAndL:
-    case Opcode::kOrL:
-    case Opcode::kXorL:
-    case Opcode::kLShiftL:
-    case Opcode::kRShiftL:
-    case Opcode::kURShiftL:
-    case Opcode::kCmpI:
-    case Opcode::kCmpL:
-    case Opcode::kCmpP:
-    case Opcode::kCmpU:
-    case Opcode::kCmpUL:
-    case Opcode::kBool:
-    case Opcode::kConvI2L:
-    case Opcode::kConvL2I:
-    case Opcode::kConv2B:
-    case Opcode::kCastII:
-    case Opcode::kCastLL:
-    case Opcode::kCastPP:
-    case Opcode::kCastX2P:
-    case Opcode::kCastP2X:
-    case Opcode::kCMoveI:
-    case Opcode::kCMoveL:
-    case Opcode::kCMoveP:
-    case Opcode::kAddP:
-    case Opcode::kOpaque1:
-    // case Opcode::kParsePredicate:  // REMOVED - moved to kS1_Control
-    case Opcode::kThreadLocal:
-      return NodeSchema::kS0_Pure;
-
-    // Unknown or special cases
-    case Opcode::kCallStaticJava:
-    case Opcode::kUnknown:
-    default:
-      return NodeSchema::kUnknown;
+}  // namespace
+
+std::string OpcodeToString(Opcode op) { return std::string(Info(op).name); }
+
+std::string_view OpcodeName(Opcode op) { return Info(op).name; }
+
+Opcode StringToOpcode(std::string_view name) {
+  uint32_t seed = kPerfectHash.seeds[BucketOf(name)];
+  int16_t index = kPerfectHash.slots[SlotOf(name, seed)];
+  if (index >= 0 && kNames[index].name == name) {
+    return kNames[index].op;
   }
+  return Opcode::kUnknown;
 }
 
+bool IsControl(Opcode op) { return kControlSet.Contains(op); }
+
+bool IsPure(Opcode op) { return kPureSet.Contains(op); }
+
+bool IsMemory(Opcode op) { return kMemorySet.Contains(op); }
+
+bool IsMerge(Opcode op) { return kMergeSet.Contains(op); }
+
+bool IsRegion(Opcode op) {
+  return kControlSet.Contains(op) && kMergeSet.Contains(op);
+}
+
+bool IsLoopHead(Opcode op) {
+  return kLoopSet.Contains(op) && kMergeSet.Contains(op);
+}
+
+bool IsLoopEnd(Opcode op) {
+  return kLoopSet.Contains(op) && !kMergeSet.Contains(op);
+}
+
+NodeSchema GetSchema(Opcode op) { return Info(op).schema; }
+
 }  // namespace sun
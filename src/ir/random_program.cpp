@@ -0,0 +1,530 @@
+#include "suntv/ir/random_program.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+#include "suntv/ir/graph_builder.hpp"
+#include "suntv/util/random.hpp"
+
+namespace sun {
+
+namespace {
+
+using Operand = RandomProgram::Operand;
+using Stmt = RandomProgram::Stmt;
+using StmtKind = RandomProgram::StmtKind;
+
+constexpr Opcode kArithOps[] = {
+    Opcode::kAddI, Opcode::kSubI,    Opcode::kMulI,    Opcode::kAndI,
+    Opcode::kOrI,  Opcode::kXorI,    Opcode::kLShiftI, Opcode::kRShiftI,
+    Opcode::kURShiftI};
+constexpr Opcode kThrowingOps[] = {Opcode::kDivI, Opcode::kModI};
+constexpr int32_t kMasks[] = {GraphBuilder::kLt, GraphBuilder::kEq,
+                              GraphBuilder::kLe, GraphBuilder::kGt,
+                              GraphBuilder::kNe, GraphBuilder::kGe};
+constexpr int32_t kArrayLength = 8;  // Indices are masked with & 7
+constexpr int kNumFields = 3;
+
+// ----- Generation -----------------------------------------------------------
+
+class Generator {
+ public:
+  Generator(uint64_t seed, const RandomProgramOptions& options)
+      : rng_(seed), options_(options) {}
+
+  RandomProgram Run() {
+    program_.num_params = 1 + static_cast<int>(rng_.Below(
+                                  std::max(options_.max_params, 1)));
+    int locals = 1 + static_cast<int>(rng_.Below(
+                         std::max(options_.max_locals, 1)));
+    for (int i = 0; i < locals; ++i) program_.locals.push_back(Constant());
+    program_.body = Block(0);
+    program_.result =
+        program_.num_params + static_cast<int>(rng_.Below(locals));
+    return program_;
+  }
+
+ private:
+  int32_t Constant() {
+    static constexpr int32_t kInteresting[] = {
+        0,  1,  -1, 2,   3,
+        7,  8,  31, 32,  100,
+        -5, 13, std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::max()};
+    if (rng_.Chance(3, 4)) {
+      return kInteresting[rng_.Below(std::size(kInteresting))];
+    }
+    return static_cast<int32_t>(rng_.Next());
+  }
+
+  int Var() { return static_cast<int>(rng_.Below(program_.num_vars())); }
+
+  Operand Pick() {
+    if (rng_.Chance(1, 5)) return {-1, Constant()};
+    return {Var(), 0};
+  }
+
+  std::vector<Stmt> Block(int depth) {
+    int max = std::max(options_.max_stmts >> depth, 1);
+    int n = (depth == 0 ? 1 : 0) + static_cast<int>(rng_.Below(max));
+    std::vector<Stmt> block;
+    for (int i = 0; i < n; ++i) block.push_back(Statement(depth));
+    return block;
+  }
+
+  Stmt Statement(int depth) {
+    Stmt s;
+    uint64_t r = rng_.Below(100);
+    bool nest = depth < options_.max_depth;
+    if (nest && r < 15) {
+      s.kind = StmtKind::kIf;
+      s.mask = kMasks[rng_.Below(std::size(kMasks))];
+      s.a = Pick();
+      s.b = Pick();
+      s.body = Block(depth + 1);
+      s.orelse = Block(depth + 1);
+      return s;
+    }
+    if (nest && options_.loops && r < 25) {
+      s.kind = StmtKind::kLoop;
+      s.a = Pick();
+      s.body = Block(depth + 1);
+      return s;
+    }
+    // Memory stays at the top level: one memory state, no memory Phis
+    if (depth == 0 && options_.memory && r < 45) {
+      static constexpr StmtKind kMemory[] = {
+          StmtKind::kStoreField, StmtKind::kLoadField, StmtKind::kStoreArray,
+          StmtKind::kLoadArray};
+      s.kind = kMemory[rng_.Below(std::size(kMemory))];
+      s.dst = Var();
+      s.field = static_cast<int>(rng_.Below(kNumFields));
+      s.a = Pick();
+      s.b = Pick();
+      return s;
+    }
+    s.kind = StmtKind::kAssign;
+    s.dst = Var();
+    if (options_.exceptions && rng_.Chance(1, 8)) {
+      s.op = kThrowingOps[rng_.Below(std::size(kThrowingOps))];
+    } else {
+      s.op = kArithOps[rng_.Below(std::size(kArithOps))];
+    }
+    s.a = Pick();
+    s.b = Pick();
+    return s;
+  }
+
+  SplitMix64 rng_;
+  const RandomProgramOptions& options_;
+  RandomProgram program_;
+};
+
+// ----- Lowering -------------------------------------------------------------
+
+void CollectAssigned(const std::vector<Stmt>& block, std::vector<bool>* out) {
+  for (const Stmt& s : block) {
+    switch (s.kind) {
+      case StmtKind::kAssign:
+      case StmtKind::kLoadField:
+      case StmtKind::kLoadArray:
+        (*out)[s.dst] = true;
+        break;
+      case StmtKind::kIf:
+        CollectAssigned(s.orelse, out);
+        [[fallthrough]];
+      case StmtKind::kLoop:
+        CollectAssigned(s.body, out);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+class Lowering {
+ public:
+  explicit Lowering(const RandomProgram& program) : program_(program) {}
+
+  std::unique_ptr<Graph> Run() {
+    ctrl_ = builder_.start();
+    mem_ = builder_.start();
+    for (int i = 0; i < program_.num_params; ++i) {
+      env_.push_back(builder_.Parm(i));
+    }
+    for (int32_t v : program_.locals) env_.push_back(builder_.ConI(v));
+    Block(program_.body);
+    builder_.Return(ctrl_, mem_, env_[program_.result]);
+    return builder_.Finish();
+  }
+
+ private:
+  Node* Value(const Operand& o) {
+    return o.var < 0 ? builder_.ConI(o.value) : env_[o.var];
+  }
+
+  Node* Index(const Operand& o) {
+    return builder_.Binary(Opcode::kAndI, Value(o),
+                           builder_.ConI(kArrayLength - 1));
+  }
+
+  Node* Object() {
+    if (!object_) object_ = builder_.Allocate(builder_.start());
+    return object_;
+  }
+
+  Node* Array() {
+    if (!array_) {
+      array_ = builder_.AllocateArray(builder_.start(),
+                                      builder_.ConI(kArrayLength));
+    }
+    return array_;
+  }
+
+  void Block(const std::vector<Stmt>& block) {
+    for (const Stmt& s : block) Statement(s);
+  }
+
+  void Statement(const Stmt& s) {
+    switch (s.kind) {
+      case StmtKind::kAssign:
+        env_[s.dst] = builder_.Binary(s.op, Value(s.a), Value(s.b));
+        break;
+      case StmtKind::kIf:
+        If(s);
+        break;
+      case StmtKind::kLoop:
+        Loop(s);
+        break;
+      case StmtKind::kStoreField:
+        mem_ = builder_.StoreField(ctrl_, mem_, Object(),
+                                   "f" + std::to_string(s.field), Value(s.a));
+        break;
+      case StmtKind::kLoadField:
+        env_[s.dst] = builder_.LoadField(ctrl_, mem_, Object(),
+                                         "f" + std::to_string(s.field));
+        break;
+      case StmtKind::kStoreArray:
+        mem_ = builder_.StoreArray(ctrl_, mem_, Array(), Index(s.a),
+                                   Value(s.b));
+        break;
+      case StmtKind::kLoadArray:
+        env_[s.dst] = builder_.LoadArray(ctrl_, mem_, Array(), Index(s.a));
+        break;
+    }
+  }
+
+  void If(const Stmt& s) {
+    Node* cond = builder_.Compare(Value(s.a), Value(s.b), s.mask);
+    GraphBuilder::Branch branch = builder_.If(ctrl_, cond);
+    std::vector<Node*> entry = env_;
+
+    ctrl_ = branch.if_true;
+    Block(s.body);
+    Node* then_ctrl = ctrl_;
+    std::vector<Node*> then_env = env_;
+
+    env_ = entry;
+    ctrl_ = branch.if_false;
+    Block(s.orelse);
+
+    Node* region = builder_.Region({then_ctrl, ctrl_});
+    for (size_t v = 0; v < env_.size(); ++v) {
+      if (then_env[v] != env_[v]) {
+        env_[v] = builder_.Phi(region, {then_env[v], env_[v]});
+      }
+    }
+    ctrl_ = region;
+  }
+
+  void Loop(const Stmt& s) {
+    Node* trips = builder_.Binary(
+        Opcode::kAddI,
+        builder_.Binary(Opcode::kAndI, Value(s.a), builder_.ConI(7)),
+        builder_.ConI(1));
+    std::vector<bool> assigned(env_.size());
+    CollectAssigned(s.body, &assigned);
+
+    Node* head = builder_.Region({ctrl_});
+    Node* counter = builder_.Phi(head, {builder_.ConI(0)});
+    std::vector<std::pair<size_t, Node*>> phis;
+    for (size_t v = 0; v < env_.size(); ++v) {
+      if (!assigned[v]) continue;
+      env_[v] = builder_.Phi(head, {env_[v]});
+      phis.emplace_back(v, env_[v]);
+    }
+
+    ctrl_ = head;
+    Block(s.body);
+
+    // Exit test at the bottom: the body has run i + 1 times
+    Node* next = builder_.Binary(Opcode::kAddI, counter, builder_.ConI(1));
+    GraphBuilder::Branch branch =
+        builder_.If(ctrl_, builder_.Compare(next, trips, GraphBuilder::kLt));
+    head->AddInput(branch.if_true);
+    counter->AddInput(next);
+    for (auto& [v, phi] : phis) phi->AddInput(env_[v]);
+    // The last trip's values are live after the loop
+    ctrl_ = branch.if_false;
+  }
+
+  const RandomProgram& program_;
+  GraphBuilder builder_;
+  Node* ctrl_ = nullptr;
+  Node* mem_ = nullptr;
+  Node* object_ = nullptr;
+  Node* array_ = nullptr;
+  std::vector<Node*> env_;
+};
+
+// ----- Shrinking ------------------------------------------------------------
+
+std::vector<Operand> OperandShrinks(const Operand& o) {
+  if (o.var >= 0) return {{-1, 0}};
+  if (o.value == 0) return {};
+  std::vector<Operand> out = {{-1, 0}};
+  if (o.value / 2 != 0) out.push_back({-1, o.value / 2});
+  return out;
+}
+
+std::vector<std::vector<Stmt>> BlockShrinks(const std::vector<Stmt>& block);
+
+std::vector<Stmt> StmtShrinks(const Stmt& s) {
+  std::vector<Stmt> out;
+  // An operation becomes a copy of either operand: dst = a + 0
+  bool is_copy = s.op == Opcode::kAddI && s.b.var < 0 && s.b.value == 0;
+  if (s.kind == StmtKind::kAssign && !is_copy) {
+    for (const Operand& from : {s.a, s.b}) {
+      out.push_back(s);
+      out.back().op = Opcode::kAddI;
+      out.back().a = from;
+      out.back().b = Operand{};
+    }
+  }
+  for (const Operand& a : OperandShrinks(s.a)) {
+    out.push_back(s);
+    out.back().a = a;
+  }
+  bool uses_b = s.kind == StmtKind::kAssign || s.kind == StmtKind::kIf ||
+                s.kind == StmtKind::kStoreArray;
+  if (uses_b) {
+    for (const Operand& b : OperandShrinks(s.b)) {
+      out.push_back(s);
+      out.back().b = b;
+    }
+  }
+  for (std::vector<Stmt>& body : BlockShrinks(s.body)) {
+    out.push_back(s);
+    out.back().body = std::move(body);
+  }
+  for (std::vector<Stmt>& orelse : BlockShrinks(s.orelse)) {
+    out.push_back(s);
+    out.back().orelse = std::move(orelse);
+  }
+  return out;
+}
+
+std::vector<std::vector<Stmt>> BlockShrinks(const std::vector<Stmt>& block) {
+  std::vector<std::vector<Stmt>> out;
+  // Drop one statement
+  for (size_t i = 0; i < block.size(); ++i) {
+    out.push_back(block);
+    out.back().erase(out.back().begin() + i);
+  }
+  // Replace an if or loop by one of its blocks
+  for (size_t i = 0; i < block.size(); ++i) {
+    const Stmt& s = block[i];
+    if (s.kind != StmtKind::kIf && s.kind != StmtKind::kLoop) continue;
+    for (const std::vector<Stmt>* inner : {&s.body, &s.orelse}) {
+      if (inner == &s.orelse && s.kind == StmtKind::kLoop) continue;
+      std::vector<Stmt> spliced(block.begin(), block.begin() + i);
+      spliced.insert(spliced.end(), inner->begin(), inner->end());
+      spliced.insert(spliced.end(), block.begin() + i + 1, block.end());
+      out.push_back(std::move(spliced));
+    }
+  }
+  // Simplify one statement in place
+  for (size_t i = 0; i < block.size(); ++i) {
+    for (Stmt& s : StmtShrinks(block[i])) {
+      out.push_back(block);
+      out.back()[i] = std::move(s);
+    }
+  }
+  return out;
+}
+
+bool UsesMemory(const std::vector<Stmt>& block) {
+  for (const Stmt& s : block) {
+    if (s.kind != StmtKind::kAssign && s.kind != StmtKind::kIf &&
+        s.kind != StmtKind::kLoop) {
+      return true;
+    }
+    if (UsesMemory(s.body) || UsesMemory(s.orelse)) return true;
+  }
+  return false;
+}
+
+size_t CountStmts(const std::vector<Stmt>& block) {
+  size_t n = 0;
+  for (const Stmt& s : block) {
+    n += 1 + CountStmts(s.body) + CountStmts(s.orelse);
+  }
+  return n;
+}
+
+// ----- Printing -------------------------------------------------------------
+
+const char* OpSymbol(Opcode op) {
+  switch (op) {
+    case Opcode::kAddI:
+      return "+";
+    case Opcode::kSubI:
+      return "-";
+    case Opcode::kMulI:
+      return "*";
+    case Opcode::kDivI:
+      return "/";
+    case Opcode::kModI:
+      return "%";
+    case Opcode::kAndI:
+      return "&";
+    case Opcode::kOrI:
+      return "|";
+    case Opcode::kXorI:
+      return "^";
+    case Opcode::kLShiftI:
+      return "<<";
+    case Opcode::kRShiftI:
+      return ">>";
+    case Opcode::kURShiftI:
+      return ">>>";
+    default:
+      return "?";
+  }
+}
+
+const char* MaskSymbol(int32_t mask) {
+  switch (mask) {
+    case GraphBuilder::kLt:
+      return "<";
+    case GraphBuilder::kEq:
+      return "==";
+    case GraphBuilder::kLe:
+      return "<=";
+    case GraphBuilder::kGt:
+      return ">";
+    case GraphBuilder::kNe:
+      return "!=";
+    case GraphBuilder::kGe:
+      return ">=";
+    default:
+      return "?";
+  }
+}
+
+class Printer {
+ public:
+  explicit Printer(std::ostringstream* out) : out_(*out) {}
+
+  void Block(const std::vector<Stmt>& block, int depth) {
+    for (const Stmt& s : block) Statement(s, depth);
+  }
+
+ private:
+  static std::string Var(int v) { return "v" + std::to_string(v); }
+
+  static std::string Str(const Operand& o) {
+    return o.var < 0 ? std::to_string(o.value) : Var(o.var);
+  }
+
+  void Statement(const Stmt& s, int depth) {
+    std::string pad(2 * (depth + 1), ' ');
+    switch (s.kind) {
+      case StmtKind::kAssign:
+        out_ << pad << Var(s.dst) << " = " << Str(s.a) << " " << OpSymbol(s.op)
+             << " " << Str(s.b) << ";\n";
+        break;
+      case StmtKind::kIf:
+        out_ << pad << "if (" << Str(s.a) << " " << MaskSymbol(s.mask) << " "
+             << Str(s.b) << ") {\n";
+        Block(s.body, depth + 1);
+        out_ << pad << "} else {\n";
+        Block(s.orelse, depth + 1);
+        out_ << pad << "}\n";
+        break;
+      case StmtKind::kLoop: {
+        std::string i = "i" + std::to_string(depth);
+        std::string n = "n" + std::to_string(depth);
+        out_ << pad << "for (int " << i << " = 0, " << n << " = (" << Str(s.a)
+             << " & 7) + 1; " << i << " < " << n << "; " << i << "++) {\n";
+        Block(s.body, depth + 1);
+        out_ << pad << "}\n";
+        break;
+      }
+      case StmtKind::kStoreField:
+        out_ << pad << "o.f" << s.field << " = " << Str(s.a) << ";\n";
+        break;
+      case StmtKind::kLoadField:
+        out_ << pad << Var(s.dst) << " = o.f" << s.field << ";\n";
+        break;
+      case StmtKind::kStoreArray:
+        out_ << pad << "a[" << Str(s.a) << " & 7] = " << Str(s.b) << ";\n";
+        break;
+      case StmtKind::kLoadArray:
+        out_ << pad << Var(s.dst) << " = a[" << Str(s.a) << " & 7];\n";
+        break;
+    }
+  }
+
+  std::ostringstream& out_;
+};
+
+}  // namespace
+
+size_t RandomProgram::size() const { return CountStmts(body); }
+
+RandomProgram RandomProgram::Generate(uint64_t seed,
+                                      const RandomProgramOptions& options) {
+  return Generator(seed, options).Run();
+}
+
+std::unique_ptr<Graph> RandomProgram::Lower() const {
+  return Lowering(*this).Run();
+}
+
+std::vector<RandomProgram> RandomProgram::Shrinks() const {
+  std::vector<RandomProgram> out;
+  for (std::vector<Stmt>& block : BlockShrinks(body)) {
+    out.push_back(*this);
+    out.back().body = std::move(block);
+  }
+  for (size_t i = 0; i < locals.size(); ++i) {
+    for (const Operand& o : OperandShrinks({-1, locals[i]})) {
+      out.push_back(*this);
+      out.back().locals[i] = o.value;
+    }
+  }
+  return out;
+}
+
+std::string RandomProgram::ToString() const {
+  std::ostringstream out;
+  out << "int f(";
+  for (int i = 0; i < num_params; ++i) {
+    out << (i ? ", " : "") << "int v" << i;
+  }
+  out << ") {\n";
+  for (size_t i = 0; i < locals.size(); ++i) {
+    out << "  int v" << num_params + i << " = " << locals[i] << ";\n";
+  }
+  if (UsesMemory(body)) {
+    out << "  Obj o = new Obj();\n  int[] a = new int[8];\n";
+  }
+  Printer(&out).Block(body, 0);
+  out << "  return v" << result << ";\n}\n";
+  return out.str();
+}
+
+}  // namespace sun
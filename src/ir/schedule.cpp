@@ -0,0 +1,61 @@
+#include "suntv/ir/schedule.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "suntv/ir/node.hpp"
+#include "suntv/util/memory_usage.hpp"
+
+namespace sun {
+
+uint32_t Schedule::AddBlock(int32_t name) {
+  blocks_.push_back(Block{name, {}, {}});
+  return static_cast<uint32_t>(blocks_.size() - 1);
+}
+
+void Schedule::AddSuccessor(uint32_t block, uint32_t successor) {
+  blocks_.at(block).successors.push_back(successor);
+}
+
+bool Schedule::Place(const Node* n, uint32_t block) {
+  const uint32_t i = n->index();
+  if (i == Node::kNoIndex) {
+    throw std::invalid_argument("Schedule: node " + std::to_string(n->id()) +
+                                " belongs to no graph");
+  }
+  if (i >= placement_.size()) placement_.resize(i + 1);
+  if (placement_[i].block != kNoBlock) return false;
+
+  std::vector<const Node*>& nodes = blocks_.at(block).nodes;
+  placement_[i] = {block, static_cast<uint32_t>(nodes.size())};
+  nodes.push_back(n);
+  return true;
+}
+
+uint32_t Schedule::FindBlock(int32_t name) const {
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    if (blocks_[i].name == name) return static_cast<uint32_t>(i);
+  }
+  return kNoBlock;
+}
+
+uint32_t Schedule::block_of(const Node* n) const {
+  const uint32_t i = n->index();
+  return i < placement_.size() ? placement_[i].block : kNoBlock;
+}
+
+uint32_t Schedule::position_of(const Node* n) const {
+  const uint32_t i = n->index();
+  return i < placement_.size() ? placement_[i].position : 0;
+}
+
+size_t Schedule::bytes() const {
+  size_t total = sizeof(Schedule) + memory::VectorBytes(blocks_) +
+                 memory::VectorBytes(placement_);
+  for (const Block& b : blocks_) {
+    total += memory::VectorBytes(b.successors) + memory::VectorBytes(b.nodes);
+  }
+  return total;
+}
+
+}  // namespace sun
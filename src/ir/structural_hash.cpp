@@ -0,0 +1,146 @@
+#include "suntv/ir/structural_hash.hpp"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include "suntv/ir/constant_pool.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/util/memory_usage.hpp"
+
+namespace sun {
+
+namespace {
+
+// Properties that change what a node computes; IDs, bytecode indices and
+// the like are left out
+constexpr const char* kSemanticProps[] = {"name",  "con",  "index", "mask",
+                                         "field", "array", "elem", "value",
+                                         "type",  "dump_spec"};
+
+// splitmix64's finalizer over the running hash and the next word
+uint64_t Mix(uint64_t h, uint64_t v) {
+  uint64_t z = h ^ (v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2));
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// FNV-1a: stable across runs and standard libraries, unlike std::hash
+uint64_t HashString(std::string_view s) {
+  uint64_t h = 0xCBF29CE484222325ull;
+  for (unsigned char c : s) h = (h ^ c) * 0x100000001B3ull;
+  return h;
+}
+
+uint64_t HashProperty(const Property& p) {
+  uint64_t h = p.index();
+  if (const auto* i = std::get_if<int32_t>(&p)) {
+    return Mix(h, static_cast<uint32_t>(*i));
+  }
+  if (const auto* l = std::get_if<int64_t>(&p)) {
+    return Mix(h, static_cast<uint64_t>(*l));
+  }
+  if (const auto* s = std::get_if<std::string>(&p)) {
+    return Mix(h, HashString(*s));
+  }
+  return Mix(h, std::get<bool>(p) ? 1 : 0);
+}
+
+// What a node is, without its inputs
+uint64_t Label(const Node* n) {
+  uint64_t h = Mix(0, static_cast<uint64_t>(n->opcode()));
+  for (const char* key : kSemanticProps) {
+    if (!n->has_prop(key)) continue;
+    h = Mix(Mix(h, HashString(key)), HashProperty(n->prop(key)));
+  }
+  if (const Constant* c = n->constant()) {
+    h = Mix(Mix(h, static_cast<uint64_t>(c->op)),
+            static_cast<uint64_t>(c->value));
+  }
+  return h;
+}
+
+}  // namespace
+
+StructuralHashes::StructuralHashes(const Graph& g) {
+  const std::vector<Node*>& nodes = g.nodes();
+  hashes_.assign(nodes.size(), 0);
+  if (!g.root()) return;
+
+  auto in_graph = [&](const Node* n) {
+    return n->index() < nodes.size() && nodes[n->index()] == n;
+  };
+
+  // Depth on the stack of each gray node; kDone once hashed
+  constexpr uint32_t kWhite = UINT32_MAX;
+  constexpr uint32_t kDone = UINT32_MAX - 1;
+  std::vector<uint32_t> depth(nodes.size(), kWhite);
+  struct Frame {
+    const Node* n;
+    size_t next;
+    uint64_t hash;
+  };
+  std::vector<Frame> stack;
+
+  auto push = [&](const Node* n) {
+    depth[n->index()] = static_cast<uint32_t>(stack.size());
+    stack.push_back({n, 0, Label(n)});
+  };
+  push(g.root());
+  while (!stack.empty()) {
+    Frame& f = stack.back();
+    if (f.next == f.n->num_inputs()) {
+      const uint32_t i = f.n->index();
+      hashes_[i] = f.hash;
+      depth[i] = kDone;
+      sorted_.push_back(f.hash);
+      stack.pop_back();
+      if (!stack.empty()) {
+        stack.back().hash = Mix(stack.back().hash, hashes_[i]);
+      }
+      continue;
+    }
+    const Node* in = f.n->input(f.next++);
+    if (!in || !in_graph(in)) {
+      f.hash = Mix(f.hash, 0);
+      continue;
+    }
+    const uint32_t d = depth[in->index()];
+    if (d == kDone) {
+      f.hash = Mix(f.hash, hashes_[in->index()]);
+    } else if (d != kWhite) {
+      // Back edge: the target is not hashed yet
+      f.hash = Mix(Mix(f.hash, Label(in)), stack.size() - d);
+    } else {
+      push(in);  // Invalidates f; the child mixes itself in when done
+    }
+  }
+  graph_ = hashes_[g.root()->index()];
+  std::sort(sorted_.begin(), sorted_.end());
+}
+
+uint64_t StructuralHashes::of(const Node* n) const {
+  return n->index() < hashes_.size() ? hashes_[n->index()] : 0;
+}
+
+size_t StructuralHashes::CountChanged(const StructuralHashes& before) const {
+  size_t changed = 0;
+  auto it = before.sorted_.begin();
+  for (uint64_t h : sorted_) {
+    while (it != before.sorted_.end() && *it < h) ++it;
+    if (it != before.sorted_.end() && *it == h) {
+      ++it;
+    } else {
+      ++changed;
+    }
+  }
+  return changed;
+}
+
+size_t StructuralHashes::bytes() const {
+  return sizeof(StructuralHashes) + memory::VectorBytes(hashes_) +
+         memory::VectorBytes(sorted_);
+}
+
+}  // namespace sun
@@ -12,6 +12,10 @@ std::string TypeStamp::ToString() const {
       return "int32";
     case TypeKind::kInt64:
       return "int64";
+    case TypeKind::kFloat:
+      return "float";
+    case TypeKind::kDouble:
+      return "double";
     case TypeKind::kBool:
       return "bool";
     case TypeKind::kPtr:
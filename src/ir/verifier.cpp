@@ -0,0 +1,302 @@
+#include "suntv/ir/verifier.hpp"
+
+#include <cstdint>
+#include <utility>
+
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/opcode.hpp"
+
+namespace sun {
+
+namespace {
+
+// Value inputs an operator needs beyond what its schema checks
+size_t MinValueInputs(Opcode op) {
+  switch (op) {
+    case Opcode::kAddI:
+    case Opcode::kSubI:
+    case Opcode::kMulI:
+    case Opcode::kDivI:
+    case Opcode::kModI:
+    case Opcode::kAddL:
+    case Opcode::kSubL:
+    case Opcode::kMulL:
+    case Opcode::kDivL:
+    case Opcode::kModL:
+    case Opcode::kAndI:
+    case Opcode::kOrI:
+    case Opcode::kXorI:
+    case Opcode::kLShiftI:
+    case Opcode::kRShiftI:
+    case Opcode::kURShiftI:
+    case Opcode::kAndL:
+    case Opcode::kOrL:
+    case Opcode::kXorL:
+    case Opcode::kLShiftL:
+    case Opcode::kRShiftL:
+    case Opcode::kURShiftL:
+    case Opcode::kAddF:
+    case Opcode::kSubF:
+    case Opcode::kMulF:
+    case Opcode::kDivF:
+    case Opcode::kModF:
+    case Opcode::kMinF:
+    case Opcode::kMaxF:
+    case Opcode::kAddD:
+    case Opcode::kSubD:
+    case Opcode::kMulD:
+    case Opcode::kDivD:
+    case Opcode::kModD:
+    case Opcode::kMinD:
+    case Opcode::kMaxD:
+    case Opcode::kCmpI:
+    case Opcode::kCmpL:
+    case Opcode::kCmpP:
+    case Opcode::kCmpU:
+    case Opcode::kCmpUL:
+    case Opcode::kCmpF:
+    case Opcode::kCmpD:
+    case Opcode::kCmpF3:
+    case Opcode::kCmpD3:
+      return 2;
+    case Opcode::kCMoveI:
+    case Opcode::kCMoveL:
+    case Opcode::kCMoveP:
+    case Opcode::kCMoveF:
+    case Opcode::kCMoveD:
+      return 3;
+    case Opcode::kBool:
+    case Opcode::kConv2B:
+    case Opcode::kIf:
+    case Opcode::kRangeCheck:
+    case Opcode::kCountedLoopEnd:
+    case Opcode::kLongCountedLoopEnd:
+    case Opcode::kOuterStripMinedLoopEnd:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+size_t CountValueInputs(const Node* n) {
+  size_t count = 0;
+  for (size_t i = n->value_inputs_begin(); i < n->num_inputs(); ++i) {
+    if (n->input(i)) ++count;
+  }
+  return count;
+}
+
+// Nodes whose users may take them as control input
+bool CarriesControl(const Node* n) {
+  const Opcode op = n->opcode();
+  if (IsControl(op) || op == Opcode::kCallStaticJava ||
+      op == Opcode::kUnknown) {
+    return true;
+  }
+  const NodeSchema s = n->schema();
+  return s == NodeSchema::kS1_Control || s == NodeSchema::kS8_Projection ||
+         s == NodeSchema::kS9_Parameter;
+}
+
+class Verifier {
+ public:
+  explicit Verifier(const Graph& g) : g_(g), nodes_(g.nodes()) {}
+
+  std::vector<GraphIssue> Run() {
+    CheckInputs();
+    CheckPhis();
+    CheckValueCycles();
+    CheckControlReachability();
+    return std::move(issues_);
+  }
+
+ private:
+  bool InGraph(const Node* n) const {
+    return n->index() < nodes_.size() && nodes_[n->index()] == n;
+  }
+
+  void Report(GraphIssue::Kind kind, const Node* n, std::string message) {
+    issues_.push_back({kind, n->id(), std::move(message)});
+  }
+
+  void CheckInputs() {
+    for (const Node* n : nodes_) {
+      bool dangling = false;
+      for (size_t i = 0; i < n->num_inputs(); ++i) {
+        const Node* in = n->input(i);
+        if (in && !InGraph(in)) {
+          Report(GraphIssue::Kind::kDanglingInput, n,
+                 "input " + std::to_string(i) + " (node " +
+                     std::to_string(in->id()) + ") is not in the graph");
+          dangling = true;
+        }
+      }
+      if (dangling || n->opcode() == Opcode::kUnknown) continue;
+
+      if (!n->ValidateInputs()) {
+        Report(GraphIssue::Kind::kArity, n,
+               OpcodeToString(n->opcode()) + " has only " +
+                   std::to_string(n->num_inputs()) + " input(s)");
+        continue;
+      }
+      const size_t need = MinValueInputs(n->opcode());
+      const size_t have = need ? CountValueInputs(n) : 0;
+      if (have < need) {
+        Report(GraphIssue::Kind::kArity, n,
+               OpcodeToString(n->opcode()) + " needs " + std::to_string(need) +
+                   " value input(s), has " + std::to_string(have));
+      }
+    }
+  }
+
+  void CheckPhis() {
+    for (const Node* n : nodes_) {
+      if (n->opcode() != Opcode::kPhi || n->num_inputs() == 0) continue;
+      const Node* region = n->region_input();
+      if (!region || !IsRegion(region->opcode())) {
+        Report(GraphIssue::Kind::kPhiRegion, n,
+               region ? "input 0 is " + OpcodeToString(region->opcode()) +
+                            " " + std::to_string(region->id()) +
+                            ", not a Region"
+                      : "has no Region");
+        continue;
+      }
+      const size_t phi_n = n->num_inputs();
+      const size_t region_n = region->num_inputs();
+      if (phi_n != region_n && phi_n != region_n + 1) {
+        Report(GraphIssue::Kind::kPhiRegion, n,
+               "has " + std::to_string(phi_n) + " inputs but Region " +
+                   std::to_string(region->id()) + " has " +
+                   std::to_string(region_n));
+      }
+    }
+  }
+
+  // Iterative three-color DFS over data edges between nodes that may not
+  // close a value cycle; an edge to a node still on the stack closes one
+  void CheckValueCycles() {
+    enum : uint8_t { kWhite, kGray, kBlack };
+    std::vector<uint8_t> color(nodes_.size(), kWhite);
+    std::vector<std::pair<const Node*, size_t>> stack;
+
+    for (const Node* root : nodes_) {
+      if (color[root->index()] != kWhite || MayCloseValueCycle(root)) {
+        continue;
+      }
+      color[root->index()] = kGray;
+      stack.emplace_back(root, 0);
+      while (!stack.empty()) {
+        auto& [n, next] = stack.back();
+        if (next == n->num_inputs()) {
+          color[n->index()] = kBlack;
+          stack.pop_back();
+          continue;
+        }
+        const Node* in = n->input(next++);
+        if (!in || !InGraph(in) || MayCloseValueCycle(in)) continue;
+        if (color[in->index()] == kGray) {
+          Report(GraphIssue::Kind::kValueCycle, in,
+                 "reaches itself through node " + std::to_string(n->id()) +
+                     " without passing a Phi");
+        } else if (color[in->index()] == kWhite) {
+          color[in->index()] = kGray;
+          stack.emplace_back(in, 0);
+        }
+      }
+    }
+  }
+
+  // Breadth-first from Start over control edges: input 0 of most nodes,
+  // every input of a Region
+  void CheckControlReachability() {
+    const Node* start = g_.start();
+    if (!start) return;
+
+    // Control users of each node, in CSR form
+    std::vector<uint32_t> offsets(nodes_.size() + 1, 0);
+    auto for_each_control_input = [&](const Node* u, auto&& fn) {
+      if (IsRegion(u->opcode())) {
+        for (size_t i = 0; i < u->num_inputs(); ++i) {
+          const Node* p = u->input(i);
+          if (p && p != u && InGraph(p)) fn(p);
+        }
+      } else if (u->num_inputs() > 0 && u->input(0) &&
+                 InGraph(u->input(0))) {
+        fn(u->input(0));
+      }
+    };
+    for (const Node* u : nodes_) {
+      for_each_control_input(u, [&](const Node* p) { ++offsets[p->index()]; });
+    }
+    for (size_t i = 0; i < nodes_.size(); ++i) offsets[i + 1] += offsets[i];
+    std::vector<const Node*> users(offsets.back());
+    for (const Node* u : nodes_) {
+      for_each_control_input(
+          u, [&](const Node* p) { users[--offsets[p->index()]] = u; });
+    }
+
+    std::vector<bool> reached(nodes_.size(), false);
+    std::vector<const Node*> queue{start};
+    reached[start->index()] = true;
+    for (size_t head = 0; head < queue.size(); ++head) {
+      const Node* p = queue[head];
+      if (!CarriesControl(p)) continue;
+      for (uint32_t i = offsets[p->index()]; i < offsets[p->index() + 1];
+           ++i) {
+        const Node* u = users[i];
+        if (!reached[u->index()]) {
+          reached[u->index()] = true;
+          queue.push_back(u);
+        }
+      }
+    }
+
+    for (const Node* n : nodes_) {
+      if (reached[n->index()] || !IsControl(n->opcode()) ||
+          n->opcode() == Opcode::kRoot) {
+        continue;
+      }
+      Report(GraphIssue::Kind::kUnreachableControl, n,
+             OpcodeToString(n->opcode()) + " is not reachable from Start " +
+                 std::to_string(start->id()));
+    }
+  }
+
+  const Graph& g_;
+  const std::vector<Node*>& nodes_;
+  std::vector<GraphIssue> issues_;
+};
+
+}  // namespace
+
+bool MayCloseValueCycle(const Node* n) {
+  const Opcode op = n->opcode();
+  return op == Opcode::kUnknown || op == Opcode::kPhi || IsControl(op);
+}
+
+const char* GraphIssueKindName(GraphIssue::Kind kind) {
+  switch (kind) {
+    case GraphIssue::Kind::kDanglingInput:
+      return "dangling input";
+    case GraphIssue::Kind::kArity:
+      return "arity";
+    case GraphIssue::Kind::kPhiRegion:
+      return "Phi/Region mismatch";
+    case GraphIssue::Kind::kValueCycle:
+      return "value cycle";
+    case GraphIssue::Kind::kUnreachableControl:
+      return "unreachable control";
+  }
+  return "?";
+}
+
+std::string GraphIssue::ToString() const {
+  return std::string(GraphIssueKindName(kind)) + " at node " +
+         std::to_string(node) + ": " + message;
+}
+
+std::vector<GraphIssue> VerifyGraph(const Graph& g) {
+  return Verifier(g).Run();
+}
+
+}  // namespace sun
@@ -0,0 +1,97 @@
+#include "suntv/util/arena.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace sun {
+
+static char* AlignUp(char* p, size_t align) {
+  const uintptr_t v = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char*>((v + align - 1) & ~(uintptr_t{align} - 1));
+}
+
+Arena::Arena(size_t initial_chunk_size)
+    : next_chunk_size_(initial_chunk_size),
+      initial_chunk_size_(initial_chunk_size) {}
+
+Arena::~Arena() { Release(); }
+
+void* Arena::Allocate(size_t bytes, size_t align) {
+  if (bytes == 0) bytes = 1;
+  char* p = AlignUp(cursor_, align);
+  if (cursor_ != nullptr && p + bytes <= limit_) {
+    bytes_used_ += static_cast<size_t>(p + bytes - cursor_);
+    cursor_ = p + bytes;
+    return p;
+  }
+  return AllocateSlow(bytes, align);
+}
+
+void* Arena::AllocateSlow(size_t bytes, size_t align) {
+  // Oversized requests get a dedicated chunk so they don't waste the tail of
+  // the current one or inflate the growth schedule.
+  const size_t needed = bytes + align;
+  size_t chunk_size = next_chunk_size_;
+  const bool dedicated = needed > chunk_size / 4;
+  if (dedicated) {
+    chunk_size = needed;
+  } else if (next_chunk_size_ < kMaxChunkSize) {
+    next_chunk_size_ *= 2;
+  }
+
+  void* raw = std::malloc(sizeof(Chunk) + chunk_size);
+  if (raw == nullptr) {
+    throw std::bad_alloc();
+  }
+  Chunk* chunk = static_cast<Chunk*>(raw);
+  chunk->size = chunk_size;
+  bytes_reserved_ += chunk_size;
+  ++num_chunks_;
+
+  char* begin = reinterpret_cast<char*>(chunk + 1);
+  char* p = AlignUp(begin, align);
+  bytes_used_ += static_cast<size_t>(p + bytes - begin);
+
+  if (dedicated && head_ != nullptr) {
+    // Keep bumping in the current chunk; link the dedicated one behind it.
+    chunk->next = head_->next;
+    head_->next = chunk;
+    return p;
+  }
+
+  chunk->next = head_;
+  head_ = chunk;
+  cursor_ = p + bytes;
+  limit_ = begin + chunk_size;
+  return p;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t align) {
+  return Allocate(bytes, align);
+}
+
+std::string_view Arena::CopyString(std::string_view s) {
+  if (s.empty()) return std::string_view();
+  char* p = static_cast<char*>(Allocate(s.size(), 1));
+  std::memcpy(p, s.data(), s.size());
+  return std::string_view(p, s.size());
+}
+
+void Arena::Release() {
+  Chunk* c = head_;
+  while (c != nullptr) {
+    Chunk* next = c->next;
+    std::free(c);
+    c = next;
+  }
+  head_ = nullptr;
+  cursor_ = nullptr;
+  limit_ = nullptr;
+  next_chunk_size_ = initial_chunk_size_;
+  bytes_used_ = 0;
+  bytes_reserved_ = 0;
+  num_chunks_ = 0;
+}
+
+}  // namespace sun
@@ -0,0 +1,40 @@
+#include "suntv/util/interner.hpp"
+
+namespace sun {
+
+StringInterner::StringInterner(Arena& arena)
+    : arena_(arena), table_(&arena), by_id_(&arena) {}
+
+InternedString StringInterner::Intern(std::string_view s) {
+  auto it = table_.find(s);
+  if (it != table_.end()) {
+    return InternedString(it->second);
+  }
+
+  std::string_view stored = arena_.CopyString(s);
+  auto* entry = arena_.New<InternedString::Entry>();
+  entry->data = stored.data();
+  entry->size = static_cast<uint32_t>(stored.size());
+  entry->id = static_cast<uint32_t>(by_id_.size());
+
+  table_.emplace(stored, entry);
+  by_id_.push_back(entry);
+  return InternedString(entry);
+}
+
+InternedString StringInterner::Find(std::string_view s) const {
+  auto it = table_.find(s);
+  if (it == table_.end()) {
+    return InternedString();
+  }
+  return InternedString(it->second);
+}
+
+InternedString StringInterner::Lookup(uint32_t id) const {
+  if (id >= by_id_.size()) {
+    return InternedString();
+  }
+  return InternedString(by_id_[id]);
+}
+
+}  // namespace sun
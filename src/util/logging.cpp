@@ -1,39 +1,341 @@
 #include "suntv/util/logging.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace sun {
 
-LogLevel Logger::level_ = LogLevel::INFO;
+namespace {
 
-void Logger::SetLevel(LogLevel level) { level_ = level; }
+using Clock = std::chrono::steady_clock;
 
-LogLevel Logger::GetLevel() { return level_; }
+// A thread hands its buffer to the writer at this many records, or when
+// the oldest one is this old
+constexpr size_t kBatchRecords = 64;
+constexpr auto kMaxBatchAge = std::chrono::milliseconds(50);
 
-void Logger::Log(LogLevel level, const std::string& prefix,
-                 const std::string& msg) {
-  if (level < level_) {
-    return;
+std::atomic<LogLevel> g_level{LogLevel::INFO};
+const Clock::time_point g_start = Clock::now();
+
+struct ThreadContext {
+  std::string graph;
+  int64_t node = -1;
+};
+
+thread_local ThreadContext t_context;
+
+struct Batch {
+  std::atomic<Batch*> next{nullptr};
+  std::vector<LogRecord> records;
+  std::atomic<bool>* written = nullptr;  // Set once on the sink, if any
+};
+
+// Vyukov's multi-producer single-consumer queue. Push is one exchange and
+// never waits; a batch whose link is not stored yet just looks like the
+// end of the queue to Pop until it is.
+class BatchQueue {
+ public:
+  BatchQueue() : head_(new Batch), tail_(head_.load()) {}
+  ~BatchQueue() {
+    while (Pop()) {
+    }
+    delete tail_;
+  }
+
+  void Push(Batch* batch) {
+    Batch* prev = head_.exchange(batch, std::memory_order_acq_rel);
+    prev->next.store(batch, std::memory_order_release);
+  }
+
+  // Consumer only. The returned batch stays owned by the queue (it is the
+  // new stub) and is valid until the next Pop.
+  Batch* Pop() {
+    Batch* next = tail_->next.load(std::memory_order_acquire);
+    if (!next) return nullptr;
+    delete tail_;
+    tail_ = next;
+    return next;
+  }
+
+ private:
+  std::atomic<Batch*> head_;
+  Batch* tail_;
+};
+
+class Backend {
+ public:
+  static Backend& Get() {
+    static Backend backend;
+    return backend;
+  }
+
+  ~Backend() {
+    if (writer_.joinable()) {
+      stop_.store(true, std::memory_order_release);
+      submitted_.fetch_add(1, std::memory_order_release);
+      submitted_.notify_one();
+      writer_.join();
+    }
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    Drain();
+  }
+
+  // Hands records to the writer; with `wait`, returns once they (and all
+  // batches submitted before) are on the sink
+  void Submit(std::vector<LogRecord> records, bool wait) {
+    auto* batch = new Batch;
+    batch->records = std::move(records);
+    std::atomic<bool> written{false};
+    if (wait) batch->written = &written;
+
+    std::call_once(started_,
+                   [this] { writer_ = std::thread(&Backend::Run, this); });
+    queue_.Push(batch);
+    submitted_.fetch_add(1, std::memory_order_release);
+    submitted_.notify_one();
+    while (wait && !written.load(std::memory_order_acquire)) {
+      written.wait(false, std::memory_order_acquire);
+    }
+  }
+
+  void SetSink(std::unique_ptr<LogSink> sink) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    sink_->Flush();
+    sink_ = sink ? std::move(sink) : std::make_unique<TextLogSink>(std::cerr);
+  }
+
+ private:
+  Backend() : sink_(std::make_unique<TextLogSink>(std::cerr)) {}
+
+  void Run() {
+    for (;;) {
+      uint64_t seen = submitted_.load(std::memory_order_acquire);
+      bool wrote;
+      {
+        std::lock_guard<std::mutex> lock(sink_mutex_);
+        wrote = Drain();
+      }
+      if (stop_.load(std::memory_order_acquire)) break;
+      if (!wrote) submitted_.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+  // Requires sink_mutex_
+  bool Drain() {
+    bool any = false;
+    while (Batch* batch = queue_.Pop()) {
+      any = true;
+      for (const LogRecord& record : batch->records) sink_->Write(record);
+      batch->records.clear();
+      if (batch->written) {
+        sink_->Flush();
+        batch->written->store(true, std::memory_order_release);
+        batch->written->notify_one();
+        batch->written = nullptr;
+      }
+    }
+    if (any) sink_->Flush();
+    return any;
+  }
+
+  BatchQueue queue_;
+  std::atomic<uint64_t> submitted_{0};
+  std::atomic<bool> stop_{false};
+  std::once_flag started_;
+  std::thread writer_;
+
+  std::mutex sink_mutex_;  // Writer vs. SetSink and shutdown
+  std::unique_ptr<LogSink> sink_;
+};
+
+struct ThreadBuffer {
+  // Constructing the backend first keeps it alive past this destructor
+  ThreadBuffer() : backend(Backend::Get()) {
+    static std::atomic<uint32_t> next_thread{0};
+    thread = next_thread.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~ThreadBuffer() {
+    if (!records.empty()) backend.Submit(std::move(records), false);
+  }
+
+  void Submit(bool wait) {
+    backend.Submit(std::move(records), wait);
+    records.clear();
+    records.reserve(kBatchRecords);
+  }
+
+  Backend& backend;
+  uint32_t thread;
+  std::vector<LogRecord> records;
+  Clock::time_point oldest;
+};
+
+ThreadBuffer& LocalBuffer() {
+  thread_local ThreadBuffer buffer;
+  return buffer;
+}
+
+void PutU32(std::string& out, uint32_t v) {
+  out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void PutU64(std::string& out, uint64_t v) {
+  out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void PutString(std::string& out, const std::string& s) {
+  PutU32(out, static_cast<uint32_t>(s.size()));
+  out += s;
+}
+
+template <typename T>
+bool Get(const std::string& in, size_t* pos, T* v) {
+  if (in.size() - *pos < sizeof(T)) return false;
+  std::memcpy(v, in.data() + *pos, sizeof(T));
+  *pos += sizeof(T);
+  return true;
+}
+
+bool GetString(const std::string& in, size_t* pos, std::string* s) {
+  uint32_t size;
+  if (!Get(in, pos, &size) || in.size() - *pos < size) return false;
+  s->assign(in, *pos, size);
+  *pos += size;
+  return true;
+}
+
+const char* LevelName(LogLevel level) {
+  switch (level) {
+    case LogLevel::TRACE:
+      return "TRACE";
+    case LogLevel::DEBUG:
+      return "DEBUG";
+    case LogLevel::INFO:
+      return "INFO";
+    case LogLevel::WARN:
+      return "WARN";
+    case LogLevel::ERROR:
+      return "ERROR";
   }
-  std::cerr << prefix << msg << std::endl;
+  return "?";
+}
+
+}  // namespace
+
+void TextLogSink::Write(const LogRecord& record) {
+  out_ << "[" << LevelName(record.level) << "] ";
+  if (record.thread != 0 || !record.graph.empty() || record.node >= 0) {
+    out_ << "[t" << record.thread;
+    if (!record.graph.empty()) out_ << " " << record.graph;
+    if (record.node >= 0) out_ << " #" << record.node;
+    out_ << "] ";
+  }
+  out_ << record.message << "\n";
+}
+
+void BinaryLogSink::Write(const LogRecord& record) {
+  std::string body;
+  PutU64(body, record.time_ns);
+  body += static_cast<char>(record.level);
+  PutU32(body, record.thread);
+  PutU64(body, static_cast<uint64_t>(record.node));
+  PutString(body, record.graph);
+  PutString(body, record.message);
+
+  std::string header;
+  PutU32(header, static_cast<uint32_t>(body.size()));
+  out_.write(header.data(), header.size());
+  out_.write(body.data(), body.size());
 }
 
-void Logger::Trace(const std::string& msg) {
-  Log(LogLevel::TRACE, "[TRACE] ", msg);
+std::optional<LogRecord> BinaryLogSink::Read(std::istream& in) {
+  uint32_t size;
+  if (!in.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+    return std::nullopt;
+  }
+  std::string body(size, '\0');
+  if (!in.read(body.data(), size)) return std::nullopt;
+
+  LogRecord record;
+  size_t pos = 0;
+  uint8_t level;
+  uint64_t node;
+  if (!Get(body, &pos, &record.time_ns) || !Get(body, &pos, &level) ||
+      !Get(body, &pos, &record.thread) || !Get(body, &pos, &node) ||
+      !GetString(body, &pos, &record.graph) ||
+      !GetString(body, &pos, &record.message) ||
+      level > static_cast<uint8_t>(LogLevel::ERROR)) {
+    return std::nullopt;
+  }
+  record.level = static_cast<LogLevel>(level);
+  record.node = static_cast<int64_t>(node);
+  return record;
 }
 
-void Logger::Debug(const std::string& msg) {
-  Log(LogLevel::DEBUG, "[DEBUG] ", msg);
+void Logger::SetLevel(LogLevel level) {
+  g_level.store(level, std::memory_order_relaxed);
 }
 
-void Logger::Info(const std::string& msg) {
-  Log(LogLevel::INFO, "[INFO] ", msg);
+LogLevel Logger::GetLevel() { return g_level.load(std::memory_order_relaxed); }
+
+void Logger::SetSink(std::unique_ptr<LogSink> sink) {
+  Flush();
+  Backend::Get().SetSink(std::move(sink));
 }
 
-void Logger::Warn(const std::string& msg) {
-  Log(LogLevel::WARN, "[WARN] ", msg);
+void Logger::Flush() { LocalBuffer().Submit(true); }
+
+void Logger::Log(LogLevel level, const std::string& msg) {
+  if (level < GetLevel()) {
+    return;
+  }
+  ThreadBuffer& buffer = LocalBuffer();
+  Clock::time_point now = Clock::now();
+  if (buffer.records.empty()) buffer.oldest = now;
+
+  LogRecord& record = buffer.records.emplace_back();
+  record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       now - g_start)
+                       .count();
+  record.level = level;
+  record.thread = buffer.thread;
+  record.graph = t_context.graph;
+  record.node = t_context.node;
+  record.message = msg;
+
+  if (level >= LogLevel::WARN || buffer.records.size() >= kBatchRecords ||
+      now - buffer.oldest >= kMaxBatchAge) {
+    buffer.Submit(level == LogLevel::ERROR);
+  }
 }
 
-void Logger::Error(const std::string& msg) {
-  Log(LogLevel::ERROR, "[ERROR] ", msg);
+void Logger::Trace(const std::string& msg) { Log(LogLevel::TRACE, msg); }
+
+void Logger::Debug(const std::string& msg) { Log(LogLevel::DEBUG, msg); }
+
+void Logger::Info(const std::string& msg) { Log(LogLevel::INFO, msg); }
+
+void Logger::Warn(const std::string& msg) { Log(LogLevel::WARN, msg); }
+
+void Logger::Error(const std::string& msg) { Log(LogLevel::ERROR, msg); }
+
+LogContext::LogContext(std::string graph, int64_t node)
+    : saved_graph_(std::exchange(t_context.graph, std::move(graph))),
+      saved_node_(std::exchange(t_context.node, node)) {}
+
+LogContext::~LogContext() {
+  t_context.graph = std::move(saved_graph_);
+  t_context.node = saved_node_;
 }
 
+LogContext::Node::Node(int64_t node)
+    : saved_(std::exchange(t_context.node, node)) {}
+
+LogContext::Node::~Node() { t_context.node = saved_; }
+
 }  // namespace sun
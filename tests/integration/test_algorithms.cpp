@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "suntv/igv/parser.hpp"
+#include "suntv/igv/session.hpp"
 #include "suntv/interp/interpreter.hpp"
 #include "suntv/interp/value.hpp"
 #include "suntv/ir/graph.hpp"
@@ -144,6 +145,27 @@ TEST_F(AlgorithmTest, Factorial) {
   }
 }
 
+// Factorial after loop opts: strip-mined 16x-unrolled main loop + post loop.
+// Large n needs more trips than generic Region stepping allows.
+TEST_F(AlgorithmTest, Factorial_AfterLoopOpts) {
+  GraphSession session;
+  ASSERT_TRUE(session.Load(base_path_ + "Factorial.xml"));
+  const Graph* graph = session.FindGraph("Optimize finished");
+  ASSERT_NE(graph, nullptr);
+
+  // Java int arithmetic wraps
+  const std::vector<std::pair<int32_t, int32_t>> cases = {
+      {0, 1}, {1, 1}, {2, 2}, {5, 120}, {13, 1932053504}, {20, -2102132736},
+      {33, INT32_MIN}, {1000, 0}};
+  for (const auto& [n, expected] : cases) {
+    Interpreter interp(*graph);
+    auto outcome = interp.Execute({Value::MakeI32(n)});
+    ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn) << "n=" << n;
+    ASSERT_TRUE(outcome.return_value.has_value());
+    EXPECT_EQ(outcome.return_value->as_i32(), expected) << "n=" << n;
+  }
+}
+
 // Test GCD computation
 TEST_F(AlgorithmTest, GCD) {
   // gcd(48, 18) = 6
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "suntv/igv/graph_store.hpp"
+#include "suntv/igv/igv_pipeline.hpp"
+#include "suntv/igv/parser.hpp"
+#include "suntv/igv/session.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/structural_hash.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+namespace fs = std::filesystem;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+class GraphStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetLevel(LogLevel::ERROR);
+    dir_ = (fs::temp_directory_path() /
+            ("sun_store_" +
+             std::string(::testing::UnitTest::GetInstance()
+                             ->current_test_info()
+                             ->name())))
+               .string();
+    fs::remove_all(dir_);
+    for (const char* name : {"Abs", "Max", "Fibonacci", "Abs"}) {
+      files_.push_back(getFixturePath(std::string("igv/") + name + ".xml"));
+    }
+  }
+  void TearDown() override {
+    fs::remove_all(dir_);
+    Logger::SetLevel(level_);
+  }
+
+  LogLevel level_ = LogLevel::INFO;
+  std::string dir_;
+  std::vector<std::string> files_;  // Abs twice
+};
+
+}  // namespace
+
+TEST_F(GraphStoreTest, ImportsEachStructureOnce) {
+  std::set<uint64_t> keys;
+  size_t graphs = 0;  // Of the three distinct dumps
+  size_t imported = 0;
+  for (size_t f = 0; f < files_.size(); ++f) {
+    IGVParser parser;
+    for (const ParsedGraph& g : parser.ParseAll(files_[f])) {
+      keys.insert(StructuralHashes(*g.graph).graph());
+      if (f + 1 < files_.size()) ++graphs;
+      ++imported;
+    }
+  }
+  ASSERT_LT(keys.size(), graphs);  // Phases that change nothing
+
+  PipelineOptions options;
+  options.parse_threads = 2;
+  options.execute_threads = 3;
+  {
+    GraphStore store(dir_);
+    StoreImportStats stats = store.Import(files_, options);
+    EXPECT_EQ(stats.added, keys.size());
+    EXPECT_EQ(stats.duplicates, imported - keys.size());
+    EXPECT_EQ(stats.rejected, 0u);
+    EXPECT_EQ(stats.compilations, 3u);  // The second Abs repeats the first
+    EXPECT_EQ(store.size(), keys.size());
+    EXPECT_EQ(store.num_packs(), 1u);
+  }
+  EXPECT_TRUE(GraphStore::IsStore(dir_));
+  EXPECT_FALSE(GraphStore::IsStore(getFixturePath("igv")));
+
+  // Reopened: every key loads, structurally unchanged
+  GraphStore store(dir_);
+  EXPECT_EQ(store.size(), keys.size());
+  for (uint64_t key : keys) {
+    std::unique_ptr<Graph> g = store.Load(key);
+    ASSERT_NE(g, nullptr);
+    EXPECT_EQ(GraphStore::Key(*g), key);
+  }
+  EXPECT_EQ(store.Load(0), nullptr);
+
+  // Compilations keep every phase, in dump order
+  ASSERT_EQ(store.compilations().size(), 3u);
+  size_t phases = 0;
+  for (const StoredCompilation& c : store.compilations()) {
+    phases += c.phases.size();
+    for (const StoredPhase& p : c.phases) EXPECT_TRUE(store.Contains(p.key));
+  }
+  EXPECT_EQ(phases, graphs);
+  IGVParser parser;
+  std::vector<ParsedGraph> abs = parser.ParseAll(files_[0]);
+  const StoredCompilation& first = store.compilations()[0];
+  EXPECT_EQ(first.method, abs[0].method);
+  EXPECT_EQ(first.source, files_[0]);
+  ASSERT_EQ(first.phases.size(), abs.size());
+  for (size_t i = 0; i < abs.size(); ++i) {
+    EXPECT_EQ(first.phases[i].name, abs[i].name);
+    EXPECT_EQ(first.phases[i].key, GraphStore::Key(*abs[i].graph));
+  }
+
+  // Importing again adds nothing
+  StoreImportStats again = store.Import(files_);
+  EXPECT_EQ(again.added, 0u);
+  EXPECT_EQ(again.compilations, 0u);
+  EXPECT_EQ(store.num_packs(), 1u);
+}
+
+TEST_F(GraphStoreTest, ResolvesUniqueKeyPrefixes) {
+  GraphStore store(dir_);
+  store.Import({files_[1]});
+  ASSERT_GT(store.size(), 1u);
+  const uint64_t key = store.compilations()[0].phases[0].key;
+  const std::string hex = GraphStore::KeyString(key);
+  EXPECT_EQ(hex.size(), 16u);
+  EXPECT_EQ(store.Resolve(hex), key);
+  EXPECT_EQ(store.Resolve(hex.substr(0, 12)), key);
+  EXPECT_EQ(store.Resolve(""), std::nullopt);
+  EXPECT_EQ(store.Resolve("xyz"), std::nullopt);
+  EXPECT_EQ(store.Resolve(hex + "0"), std::nullopt);
+}
+
+TEST_F(GraphStoreTest, ScansPacksInTheOrderAdded) {
+  std::vector<std::string> added;
+  {
+    // Tiny packs: every graph seals one
+    GraphStore store(dir_, 1);
+    GraphSession session;
+    ASSERT_GT(session.Load(files_[2]), 0u);
+    for (size_t i = 0; i < session.num_graphs(); ++i) {
+      if (store.Add(*session.graph(i), session.method_name(i),
+                    session.graph_name(i))) {
+        added.push_back(session.graph_name(i));
+      }
+    }
+    EXPECT_EQ(store.num_packs(), added.size());
+  }
+
+  // An interrupted write leaves a pack without an index
+  std::ofstream(fs::path(dir_) / "pack-000999.pack") << "partial";
+  GraphStore store(dir_);
+  EXPECT_EQ(store.size(), added.size());
+  std::vector<std::string> scanned;
+  EXPECT_TRUE(store.Scan([&](const StoredGraph& g) {
+    EXPECT_TRUE(store.Contains(g.key));
+    scanned.push_back(std::string(g.name));
+    return true;
+  }));
+  EXPECT_EQ(scanned, added);
+
+  size_t visited = 0;
+  EXPECT_FALSE(store.Scan([&](const StoredGraph&) { return ++visited < 2; }));
+  EXPECT_EQ(visited, 2u);
+}
+
+TEST_F(GraphStoreTest, PipelineReadsStoredGraphs) {
+  {
+    GraphStore store(dir_);
+    store.Import({files_[1]});
+  }
+  std::vector<std::string> from_xml;
+  std::vector<std::string> from_store;
+  auto collect = [](std::vector<std::string>& out) {
+    return [&out](const PipelineGraph& g) {
+      EXPECT_TRUE(g.error.empty()) << g.error;
+      out.push_back(g.name + ": " + g.output);
+    };
+  };
+  auto execute = [](PipelineGraph& g, size_t) {
+    g.output = std::to_string(GraphStore::Key(*g.graph));
+  };
+  IGVPipeline::Run({files_[1]}, execute, collect(from_xml));
+  PipelineStats stats =
+      IGVPipeline::Run({dir_}, execute, collect(from_store));
+  EXPECT_EQ(stats.files_failed, 0u);
+  EXPECT_EQ(stats.graphs, from_store.size());
+
+  // Each stored graph once, under the phase it was first seen as
+  std::vector<std::string> first_seen;
+  std::set<std::string> keys;
+  for (const std::string& line : from_xml) {
+    if (keys.insert(line.substr(line.find(": "))).second) {
+      first_seen.push_back(line);
+    }
+  }
+  EXPECT_EQ(from_store, first_seen);
+}
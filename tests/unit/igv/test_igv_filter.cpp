@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "suntv/igv/igv_filter.hpp"
+#include "suntv/igv/igv_util.hpp"
+
+using namespace sun;
+namespace fs = std::filesystem;
+
+// Helper to get test fixture path
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+static std::string readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::ostringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+TEST(IGVFilterTest, SelectsPhasesByRegex) {
+  std::string path = getFixturePath("igv/Fibonacci.xml");
+  std::string output_path = "/tmp/test_filter_phases.xml";
+
+  IGVFilterSpec spec;
+  spec.phase = std::regex("^(After Parsing|Final Code)$");
+  IGVFilterStats stats;
+  ASSERT_TRUE(IGVFilter::Filter(path, spec, output_path, &stats));
+  EXPECT_EQ(stats.groups_seen, 1u);
+  EXPECT_EQ(stats.graphs_written, 2u);
+  EXPECT_EQ(stats.graphs_seen, IGVUtil::ListGraphs(path).size());
+
+  auto graphs = IGVUtil::ListGraphs(output_path);
+  ASSERT_EQ(graphs.size(), 2u);
+  EXPECT_EQ(graphs[0].name, "After Parsing");
+  EXPECT_EQ(graphs[1].name, "Final Code");
+
+  fs::remove(output_path);
+}
+
+TEST(IGVFilterTest, CopiesGraphBytesVerbatim) {
+  std::string path = getFixturePath("igv/Fibonacci.xml");
+  std::string output_path = "/tmp/test_filter_verbatim.xml";
+
+  IGVFilterSpec spec;
+  spec.index_ranges = {{0, 0}};
+  ASSERT_TRUE(IGVFilter::Filter(path, spec, output_path));
+
+  std::string input = readFile(path);
+  size_t begin = input.find("<graph ");
+  size_t end = input.find("</graph>", begin) + std::strlen("</graph>");
+  std::string first_graph = input.substr(begin, end - begin);
+  EXPECT_NE(readFile(output_path).find(first_graph), std::string::npos);
+
+  fs::remove(output_path);
+}
+
+TEST(IGVFilterTest, PassThroughAcrossChunks) {
+  // Larger than one read chunk, so tags straddle chunk boundaries
+  std::string path = getFixturePath("igv/ArraySum.xml");
+  std::string output_path = "/tmp/test_filter_all.xml";
+  ASSERT_GT(fs::file_size(path), 1u << 20);
+
+  ASSERT_TRUE(IGVFilter::Filter(path, IGVFilterSpec(), output_path));
+
+  auto expected = IGVUtil::ListGraphs(path);
+  auto actual = IGVUtil::ListGraphs(output_path);
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(actual[i].name, expected[i].name);
+    EXPECT_EQ(actual[i].num_nodes, expected[i].num_nodes);
+    EXPECT_EQ(actual[i].num_edges, expected[i].num_edges);
+  }
+
+  fs::remove(output_path);
+}
+
+TEST(IGVFilterTest, MethodMismatchSelectsNothing) {
+  std::string path = getFixturePath("igv/Fibonacci.xml");
+  std::string output_path = "/tmp/test_filter_none.xml";
+
+  IGVFilterSpec spec;
+  spec.methods = {"NoSuchClass.method"};
+  IGVFilterStats stats;
+  ASSERT_TRUE(IGVFilter::Filter(path, spec, output_path, &stats));
+  EXPECT_EQ(stats.graphs_written, 0u);
+  EXPECT_TRUE(IGVUtil::ListGraphs(output_path).empty());
+
+  fs::remove(output_path);
+}
+
+TEST(IGVFilterTest, SplitWritesOneFilePerMethod) {
+  std::string path = getFixturePath("igv/Fibonacci.xml");
+  std::string output_dir = "/tmp/test_filter_split";
+  fs::remove_all(output_dir);
+
+  IGVFilterSpec spec;
+  spec.methods = {"Fibonacci.compute"};
+  spec.index_ranges = {{0, 1}};
+  IGVFilterStats stats;
+  ASSERT_TRUE(IGVFilter::Split(path, spec, output_dir, &stats));
+  ASSERT_EQ(stats.outputs.size(), 1u);
+  EXPECT_EQ(fs::path(stats.outputs[0]).filename().string().substr(0, 5),
+            "0000-");
+  EXPECT_EQ(IGVUtil::ListGraphs(stats.outputs[0]).size(), 2u);
+
+  fs::remove_all(output_dir);
+}
+
+TEST(IGVFilterTest, NonexistentFile) {
+  EXPECT_FALSE(IGVFilter::Filter("/nonexistent/file.xml", IGVFilterSpec(),
+                                 "/tmp/test_filter_missing.xml"));
+}
+
+TEST(IGVFilterTest, ParseIndexRanges) {
+  std::vector<std::pair<size_t, size_t>> ranges;
+  ASSERT_TRUE(IGVFilter::ParseIndexRanges("0-3, 7,10-12", &ranges));
+  ASSERT_EQ(ranges.size(), 3u);
+  EXPECT_EQ(ranges[0], std::make_pair(size_t{0}, size_t{3}));
+  EXPECT_EQ(ranges[1], std::make_pair(size_t{7}, size_t{7}));
+  EXPECT_EQ(ranges[2], std::make_pair(size_t{10}, size_t{12}));
+
+  EXPECT_FALSE(IGVFilter::ParseIndexRanges("", &ranges));
+  EXPECT_FALSE(IGVFilter::ParseIndexRanges("3-1", &ranges));
+  EXPECT_FALSE(IGVFilter::ParseIndexRanges("a-b", &ranges));
+  EXPECT_FALSE(IGVFilter::ParseIndexRanges("1,,2", &ranges));
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "suntv/igv/igv_pipeline.hpp"
+#include "suntv/igv/parser.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+class IGVPipelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetLevel(LogLevel::ERROR);
+  }
+  void TearDown() override { Logger::SetLevel(level_); }
+
+  LogLevel level_ = LogLevel::INFO;
+};
+
+// "<method> <name>: <nodes>" for each graph, as a sequential load sees it
+std::vector<std::string> Sequential(const std::vector<std::string>& files) {
+  std::vector<std::string> out;
+  for (const std::string& file : files) {
+    IGVParser parser;
+    for (const ParsedGraph& g : parser.ParseAll(file)) {
+      out.push_back(g.method + " " + g.name + ": " +
+                    std::to_string(g.graph->nodes().size()));
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST_F(IGVPipelineTest, MatchesSequentialLoadInOrder) {
+  std::vector<std::string> files;
+  for (const char* name : {"Abs", "Fibonacci", "BubbleSort", "Max", "GCD"}) {
+    files.push_back(getFixturePath(std::string("igv/") + name + ".xml"));
+  }
+  const std::vector<std::string> expected = Sequential(files);
+  ASSERT_GT(expected.size(), files.size());
+
+  // One-slot queues and several threads per pool: every stage blocks
+  PipelineOptions options;
+  options.queue_capacity = 1;
+  options.parse_threads = 3;
+  options.canonicalize_threads = 2;
+  options.execute_threads = 4;
+  std::vector<std::string> seen;
+  std::vector<uint64_t> sequence;
+  PipelineStats stats = IGVPipeline::Run(
+      files,
+      [](PipelineGraph& g, size_t worker) {
+        EXPECT_LT(worker, 4u);
+        g.output = std::to_string(g.graph->nodes().size());
+      },
+      [&](const PipelineGraph& g) {
+        EXPECT_TRUE(g.error.empty()) << g.error;
+        seen.push_back(g.method + " " + g.name + ": " + g.output);
+        sequence.push_back(g.sequence);
+      },
+      options);
+  EXPECT_EQ(seen, expected);
+  for (size_t i = 0; i < sequence.size(); ++i) EXPECT_EQ(sequence[i], i);
+  EXPECT_EQ(stats.files, files.size());
+  EXPECT_EQ(stats.files_failed, 0u);
+  EXPECT_EQ(stats.graphs, expected.size());
+  ASSERT_EQ(stats.stages.size(), 5u);
+  for (const PipelineStageStats& s : stats.stages) {
+    EXPECT_EQ(s.items, expected.size()) << s.name;
+  }
+}
+
+TEST_F(IGVPipelineTest, SelectsGraphsAndReportsFailures) {
+  std::vector<std::string> files = {getFixturePath("igv/Abs.xml"),
+                                    getFixturePath("igv/NoSuchFile.xml"),
+                                    getFixturePath("igv/Max.xml")};
+  PipelineOptions options;
+  options.select = [](const IGVGraphRef& ref) {
+    return ref.name == "Final Code";
+  };
+  std::vector<size_t> from;
+  PipelineStats stats = IGVPipeline::Run(
+      files,
+      [](PipelineGraph& g, size_t) {
+        if (g.file == 2) throw std::runtime_error("refused");
+      },
+      [&](const PipelineGraph& g) {
+        EXPECT_EQ(g.name, "Final Code");
+        EXPECT_EQ(g.error, g.file == 2 ? "refused" : "");
+        from.push_back(g.file);
+      },
+      options);
+  EXPECT_EQ(from, (std::vector<size_t>{0, 2}));
+  EXPECT_EQ(stats.files_failed, 1u);
+  EXPECT_EQ(stats.graphs_failed, 0u);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "suntv/igv/igv_stats.hpp"
+#include "suntv/igv/igv_util.hpp"
+
+using namespace sun;
+
+// Helper to get test fixture path
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+static std::string node(int id, const std::string& name) {
+  return "<node id='" + std::to_string(id) + "'><properties><p name='name'>" +
+         name + "</p></properties></node>";
+}
+
+static std::string edge(int from, int to, int index) {
+  return "<edge from='" + std::to_string(from) + "' to='" +
+         std::to_string(to) + "' index='" + std::to_string(index) + "'/>";
+}
+
+TEST(IGVStatsTest, AddGraphCountsShapes) {
+  // Start -> StoreI(1) -> StoreI(2) memory chain, a 3-way Phi and a Loop
+  std::string xml = "<graph name='g'><nodes>" + node(0, "Start") +
+                    node(1, "StoreI") + node(2, "StoreI") + node(3, "Phi") +
+                    node(4, "Region") + node(5, "Loop") + "</nodes><edges>" +
+                    edge(0, 1, 1) + edge(1, 2, 1) + edge(4, 3, 0) +
+                    edge(0, 3, 1) + edge(1, 3, 2) + edge(2, 3, 3) +
+                    "</edges></graph>";
+
+  CorpusStats stats;
+  ASSERT_TRUE(IGVStats::AddGraph(xml, &stats));
+  EXPECT_EQ(stats.graphs, 1u);
+  EXPECT_EQ(stats.nodes, 6u);
+  EXPECT_EQ(stats.edges, 6u);
+  EXPECT_EQ(stats.opcodes[static_cast<size_t>(Opcode::kStoreI)], 2u);
+  EXPECT_EQ(stats.opcodes[static_cast<size_t>(Opcode::kLoop)], 1u);
+  EXPECT_TRUE(stats.unknown_opcodes.empty());
+  EXPECT_EQ(stats.loops, 1u);
+  EXPECT_EQ(stats.phis, 1u);
+  EXPECT_EQ(stats.max_phi_arity, 3u);
+  EXPECT_EQ(stats.memory_chain.max, 2u);
+  EXPECT_EQ(stats.graph_nodes.max, 6u);
+}
+
+TEST(IGVStatsTest, ParallelCollectMatchesSerial) {
+  std::vector<std::string> files = {getFixturePath("igv/Fibonacci.xml"),
+                                    getFixturePath("igv/BubbleSort.xml"),
+                                    getFixturePath("igv/Abs.xml")};
+  CorpusStats serial;
+  CorpusStats parallel;
+  ASSERT_TRUE(IGVStats::Collect(files, 1, &serial));
+  ASSERT_TRUE(IGVStats::Collect(files, 3, &parallel));
+
+  size_t expected_graphs = 0;
+  for (const auto& f : files) expected_graphs += IGVUtil::ListGraphs(f).size();
+  EXPECT_EQ(serial.files, 3u);
+  EXPECT_EQ(serial.graphs, expected_graphs);
+  EXPECT_EQ(serial.graphs_failed, 0u);
+  EXPECT_GT(serial.loops, 0u);  // BubbleSort has loops
+  EXPECT_EQ(serial.ToJson(), parallel.ToJson());
+}
+
+TEST(IGVStatsTest, MissingFileIsReported) {
+  CorpusStats stats;
+  EXPECT_FALSE(IGVStats::Collect(
+      {"/nonexistent/file.xml", getFixturePath("igv/Abs.xml")}, 2, &stats));
+  EXPECT_EQ(stats.files, 2u);
+  EXPECT_EQ(stats.files_failed, 1u);
+  EXPECT_GT(stats.graphs, 0u);
+}
+
+TEST(IGVStatsTest, JsonContainsSections) {
+  CorpusStats stats;
+  ASSERT_TRUE(IGVStats::Collect({getFixturePath("igv/Abs.xml")}, 1, &stats));
+  std::string json = stats.ToJson();
+  for (const char* key :
+       {"\"opcodes\"", "\"unknown_opcodes\"", "\"graph_nodes\"", "\"loops\"",
+        "\"phis\"", "\"memory_chain\"", "\"buckets\""}) {
+    EXPECT_NE(json.find(key), std::string::npos) << key;
+  }
+}
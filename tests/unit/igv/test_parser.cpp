@@ -3,7 +3,9 @@
 #include <filesystem>
 
 #include "suntv/igv/parser.hpp"
+#include "suntv/igv/session.hpp"
 #include "suntv/ir/graph.hpp"
+#include "suntv/ir/schedule.hpp"
 
 using namespace sun;
 namespace fs = std::filesystem;
@@ -158,3 +160,76 @@ TEST(IGVParserTest, ParseNonexistentFile) {
   auto graph = parser.Parse(path);
   EXPECT_EQ(graph, nullptr);
 }
+
+TEST(IGVParserTest, ParseAllReturnsEveryPhase) {
+  IGVParser parser;
+  auto graphs = parser.ParseAll(getFixturePath("igv/Fibonacci.xml"));
+  ASSERT_GT(graphs.size(), 5u);
+  EXPECT_EQ(graphs[0].index, 0u);
+  EXPECT_NE(graphs[0].method.find("Fibonacci.compute"), std::string::npos);
+  for (const auto& pg : graphs) {
+    ASSERT_NE(pg.graph, nullptr);
+    EXPECT_NE(pg.graph->start(), nullptr);
+  }
+}
+
+TEST(IGVParserTest, ParseControlFlowBlocks) {
+  IGVParser parser;
+  auto graphs = parser.ParseAll(getFixturePath("igv/Abs.xml"));
+  const Graph* gcm = nullptr;
+  for (const auto& pg : graphs) {
+    if (pg.name == "Global code motion") {
+      gcm = pg.graph.get();
+    } else if (pg.name == "After Parsing") {
+      EXPECT_EQ(pg.graph->schedule(), nullptr);
+    }
+  }
+  ASSERT_NE(gcm, nullptr);
+  const Schedule* schedule = gcm->schedule();
+  ASSERT_NE(schedule, nullptr);
+
+  // B1 holds Root; B2 runs from Start (3) to Ret (32) and returns to B1
+  ASSERT_EQ(schedule->blocks().size(), 2u);
+  const uint32_t b1 = schedule->FindBlock(1);
+  const uint32_t b2 = schedule->FindBlock(2);
+  ASSERT_NE(b1, Schedule::kNoBlock);
+  ASSERT_NE(b2, Schedule::kNoBlock);
+  EXPECT_EQ(schedule->block(b1).successors, std::vector<uint32_t>{b2});
+  EXPECT_EQ(schedule->block(b2).successors, std::vector<uint32_t>{b1});
+  EXPECT_EQ(schedule->block_of(gcm->node(0)), b1);
+
+  const Schedule::Block& body = schedule->block(b2);
+  ASSERT_EQ(body.nodes.size(), 12u);
+  EXPECT_EQ(body.nodes.front(), gcm->node(3));
+  EXPECT_EQ(body.nodes.back(), gcm->node(32));
+  EXPECT_EQ(schedule->block_of(gcm->node(32)), b2);
+  EXPECT_EQ(schedule->position_of(gcm->node(32)), 11u);
+}
+
+TEST(GraphSessionTest, SharesStringsAndConstantsAcrossGraphs) {
+  GraphSession session;
+  size_t loaded = session.Load(getFixturePath("igv/Fibonacci.xml"));
+  ASSERT_GT(loaded, 5u);
+  ASSERT_EQ(session.num_graphs(), loaded);
+
+  // The same ConI payload from two phases resolves to one pooled Constant
+  auto find_const = [](Graph* g) -> const Constant* {
+    for (Node* n : g->nodes()) {
+      if (n->opcode() == Opcode::kConI && n->constant()) return n->constant();
+    }
+    return nullptr;
+  };
+  const Constant* first = find_const(session.graph(0));
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(session.constants().Intern(first->op, first->value), first);
+
+  // Interned property handles are identical across graphs
+  Node* s0 = session.graph(0)->start();
+  Node* s1 = session.graph(1)->start();
+  ASSERT_TRUE(s0->has_prop("dump_spec") && s1->has_prop("dump_spec"));
+  EXPECT_EQ(s0->interned_prop("dump_spec"), s1->interned_prop("dump_spec"));
+  EXPECT_EQ(&session.graph(0)->strings(), &session.strings());
+
+  EXPECT_EQ(session.FindGraph(session.graph_name(1)), session.graph(1));
+  EXPECT_EQ(session.FindGraph("no such phase"), nullptr);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+
+#include "suntv/igv/session.hpp"
+#include "suntv/interp/bisect.hpp"
+#include "suntv/ir/graph_builder.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+// Return(Parm0 + k)
+std::unique_ptr<Graph> AddConstant(int32_t k) {
+  GraphBuilder b;
+  b.Return(b.start(), b.start(),
+           b.Binary(Opcode::kAddI, b.Parm(0), b.ConI(k)));
+  return b.Finish();
+}
+
+// Returns a node the interpreter has no semantics for
+std::unique_ptr<Graph> Unrunnable() {
+  GraphBuilder b;
+  b.Return(b.start(), b.start(), b.graph().AddNode(1000, Opcode::kUnknown));
+  return b.Finish();
+}
+
+// A compilation whose phases compute Parm0 + k[i]; null k means unrunnable
+struct Compilation {
+  std::vector<std::unique_ptr<Graph>> graphs;
+
+  explicit Compilation(const std::vector<const int32_t*>& k) {
+    for (const int32_t* ki : k) {
+      graphs.push_back(ki ? AddConstant(*ki) : Unrunnable());
+    }
+  }
+
+  std::vector<const Graph*> phases() const {
+    std::vector<const Graph*> out;
+    for (const auto& g : graphs) out.push_back(g.get());
+    return out;
+  }
+};
+
+// The interpreter engine, counting the runs of each graph
+DiffEngine Counting(std::map<const Graph*, int>& runs) {
+  DiffEngine inner = DifferentialTester::Engines().front();
+  return {"counting", [inner, &runs](const Graph& g, const auto& inputs) {
+            ++runs[&g];
+            return inner.run(g, inputs);
+          }};
+}
+
+class BisectTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetLevel(LogLevel::WARN);
+  }
+  void TearDown() override { Logger::SetLevel(level_); }
+
+  LogLevel level_ = LogLevel::INFO;
+};
+
+}  // namespace
+
+TEST_F(BisectTest, FindsFirstDifferingPhaseInLogarithmicRuns) {
+  const int32_t ok = 0;
+  const int32_t wrong = 1;
+  for (size_t first_bad = 1; first_bad < 64; ++first_bad) {
+    std::vector<const int32_t*> k(64, &ok);
+    for (size_t i = first_bad; i < k.size(); ++i) k[i] = &wrong;
+    Compilation c(k);
+    std::map<const Graph*, int> runs;
+    BisectReport report =
+        BisectPhases(c.phases(), {Value::MakeI32(41)}, Counting(runs));
+
+    ASSERT_TRUE(report.found()) << first_bad;
+    EXPECT_EQ(*report.bad, first_bad);
+    EXPECT_EQ(*report.good, first_bad - 1);
+    EXPECT_EQ(report.reference.ToString(), "return i32:41");
+    EXPECT_LE(report.steps.size(), 8u) << first_bad;  // 2 + log2(64)
+    EXPECT_EQ(runs.size(), report.steps.size());
+    for (const auto& [graph, n] : runs) EXPECT_EQ(n, 1);
+  }
+}
+
+TEST_F(BisectTest, AgreeingPhasesRunOnlyFirstAndLast) {
+  const int32_t ok = 7;
+  Compilation c(std::vector<const int32_t*>(20, &ok));
+  BisectReport report = BisectPhases(c.phases(), {Value::MakeI32(1)});
+  EXPECT_FALSE(report.found());
+  ASSERT_EQ(report.steps.size(), 2u);
+  EXPECT_EQ(report.steps[0].phase, 0u);
+  EXPECT_EQ(report.steps[1].phase, 19u);
+}
+
+TEST_F(BisectTest, SkipsPhasesThatCannotRun) {
+  // 0-4 agree, 5-7 cannot run, 8-9 differ and 10-11 cannot run
+  const int32_t ok = 0;
+  const int32_t wrong = 1;
+  Compilation c({&ok, &ok, &ok, &ok, &ok, nullptr, nullptr, nullptr, &wrong,
+                 &wrong, nullptr, nullptr});
+  BisectReport report = BisectPhases(c.phases(), {Value::MakeI32(3)});
+  ASSERT_TRUE(report.found());
+  EXPECT_EQ(*report.good, 4u);
+  EXPECT_EQ(*report.bad, 8u);
+
+  // Nothing to compare against
+  Compilation broken({nullptr, &ok});
+  report = BisectPhases(broken.phases(), {Value::MakeI32(3)});
+  EXPECT_FALSE(report.found());
+  EXPECT_EQ(report.reference.kind, EngineResult::Kind::kError);
+}
+
+// Every phase of a real dump, including the lowered post-matching ones
+TEST_F(BisectTest, FixturePhasesAgree) {
+  GraphSession session;
+  ASSERT_GT(session.Load(getFixturePath("igv/GCD.xml")), 0u);
+  std::vector<const Graph*> phases;
+  for (size_t i = 0; i < session.num_graphs(); ++i) {
+    phases.push_back(session.graph(i));
+  }
+  BisectReport report =
+      BisectPhases(phases, {Value::MakeI32(12), Value::MakeI32(18)});
+  EXPECT_FALSE(report.found());
+  EXPECT_EQ(report.reference.ToString(), "return i32:6");
+  EXPECT_EQ(report.steps.size(), 2u);
+}
@@ -0,0 +1,345 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "suntv/interp/interpreter.hpp"
+#include "suntv/interp/method_registry.hpp"
+#include "suntv/ir/graph.hpp"
+
+using namespace sun;
+
+static Node* AddConI(Graph& g, NodeID id, int32_t v) {
+  Node* n = g.AddNode(id, Opcode::kConI);
+  n->set_prop("value", v);
+  return n;
+}
+
+static Node* AddParm(Graph& g, NodeID id, Node* start, int32_t index) {
+  Node* n = g.AddNode(id, Opcode::kParm);
+  n->set_input(0, start);
+  n->set_prop("index", index);
+  return n;
+}
+
+static Node* AddProj(Graph& g, NodeID id, Node* src, int32_t con) {
+  Node* n = g.AddNode(id, Opcode::kProj);
+  n->set_input(0, src);
+  n->set_prop("con", con);
+  return n;
+}
+
+// CallStaticJava in C2 layout: control, I/O, memory, frame pointer, return
+// address, then one input per argument slot
+static Node* AddCall(Graph& g, NodeID id, Node* ctrl, Node* mem,
+                     const std::string& spec, std::vector<Node*> args) {
+  Node* call = g.AddNode(id, Opcode::kCallStaticJava);
+  call->set_input(0, ctrl);
+  call->set_input(1, ctrl);
+  call->set_input(2, mem);
+  call->set_input(3, ctrl);
+  call->set_input(4, ctrl);
+  for (size_t i = 0; i < args.size(); ++i) call->set_input(5 + i, args[i]);
+  call->set_prop("dump_spec", spec);
+  return call;
+}
+
+// int add(int a, int b) { return a + b; }
+static void BuildAdd(Graph& g) {
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* a = AddParm(g, 2, start, 0);
+  Node* b = AddParm(g, 3, start, 1);
+  Node* add = g.AddNode(4, Opcode::kAddI);
+  add->set_input(0, a);
+  add->set_input(1, b);
+  Node* ret = g.AddNode(5, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, start);
+  ret->set_input(1, add);
+}
+
+// int fact(int n) { return n > 1 ? n * fact(n - 1) : 1; }
+static void BuildFact(Graph& g) {
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* n = AddParm(g, 2, start, 0);
+  Node* one = AddConI(g, 3, 1);
+  Node* cmp = g.AddNode(4, Opcode::kCmpI);
+  cmp->set_input(0, n);
+  cmp->set_input(1, one);
+  Node* test = g.AddNode(5, Opcode::kBool);
+  test->set_input(0, cmp);
+  test->set_prop("mask", static_cast<int32_t>(4));  // GT
+  Node* iff = g.AddNode(6, Opcode::kIf);
+  iff->set_input(0, start);
+  iff->set_input(1, test);
+  Node* if_true = g.AddNode(7, Opcode::kIfTrue);
+  if_true->set_input(0, iff);
+  Node* if_false = g.AddNode(8, Opcode::kIfFalse);
+  if_false->set_input(0, iff);
+
+  Node* sub = g.AddNode(9, Opcode::kSubI);
+  sub->set_input(0, n);
+  sub->set_input(1, one);
+  Node* call = AddCall(g, 10, if_true, start,
+                       "# Static  Rec::fact int ( int ) C=0.000100", {sub});
+  Node* call_ctrl = AddProj(g, 11, call, 0);
+  Node* call_res = AddProj(g, 12, call, 5);
+  Node* mul = g.AddNode(13, Opcode::kMulI);
+  mul->set_input(0, n);
+  mul->set_input(1, call_res);
+
+  Node* region = g.AddNode(14, Opcode::kRegion);
+  region->set_input(0, call_ctrl);
+  region->set_input(1, if_false);
+  Node* phi = g.AddNode(15, Opcode::kPhi);
+  phi->set_input(0, region);
+  phi->set_input(1, mul);
+  phi->set_input(2, one);
+  Node* ret = g.AddNode(16, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, region);
+  ret->set_input(1, phi);
+}
+
+TEST(MethodRegistryTest, ParsesCallSignatures) {
+  auto sig = MethodSignature::Parse(
+      "# Static  java/lang/Math::max int ( int, int ) C=0.000100 A::f @ bci:3");
+  ASSERT_TRUE(sig.has_value());
+  EXPECT_EQ(sig->holder, "java.lang.Math");
+  EXPECT_EQ(sig->name, "max");
+  EXPECT_EQ(sig->ret, "int");
+  EXPECT_TRUE(sig->has_params);
+  EXPECT_EQ(sig->Key(), "java.lang.Math::max(int,int)");
+  EXPECT_EQ(sig->ShortKey(), "java.lang.Math::max");
+
+  // Long and double arguments take two slots
+  sig = MethodSignature::Parse("# Static  A::g void ( long, half, int )");
+  ASSERT_TRUE(sig.has_value());
+  EXPECT_EQ(sig->ret, "void");
+  ASSERT_EQ(sig->params.size(), 3u);
+  EXPECT_EQ(sig->params[1], "half");
+  EXPECT_EQ(sig->Key(), "A::g(long,int)");
+
+  // A spec cut before the argument list still names the method
+  sig = MethodSignature::Parse("# Static  A::h int");
+  ASSERT_TRUE(sig.has_value());
+  EXPECT_FALSE(sig->has_params);
+
+  EXPECT_FALSE(MethodSignature::Parse(
+      "# Static uncommon_trap(reason='null_check' action='maybe_recompile')  "
+      "void ( int ) C=0.000100 ArraySum::co"));
+  EXPECT_FALSE(MethodSignature::Parse("# Static  void ( int )"));
+}
+
+TEST(MethodRegistryTest, FindsExactBeforeAnyOverload) {
+  Graph callee;
+  BuildAdd(callee);
+  MethodRegistry registry;
+  registry.AddGraph("A::f", callee);
+  registry.AddNative("A::f( int, int )",
+                     [](std::span<const Value>, ConcreteHeap&) {
+                       return Value::MakeI32(0);
+                     });
+  EXPECT_EQ(registry.size(), 2u);
+
+  auto exact = MethodSignature::Parse("# Static  A::f int ( int, int )");
+  auto other = MethodSignature::Parse("# Static  A::f int ( long, half )");
+  auto missing = MethodSignature::Parse("# Static  A::g int ( int, int )");
+  ASSERT_TRUE(exact && other && missing);
+  ASSERT_NE(registry.Find(*exact), nullptr);
+  EXPECT_TRUE(registry.Find(*exact)->native);
+  ASSERT_NE(registry.Find(*other), nullptr);
+  EXPECT_EQ(registry.Find(*other)->graph, &callee);
+  EXPECT_EQ(registry.Find(*missing), nullptr);
+}
+
+// return Callee.add(a, b) + Math.max(a, b)
+TEST(MethodRegistryTest, RunsGraphAndNativeCallees) {
+  Graph callee;
+  BuildAdd(callee);
+
+  Graph g;
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* a = AddParm(g, 2, start, 0);
+  Node* b = AddParm(g, 3, start, 1);
+  Node* add_call =
+      AddCall(g, 4, start, start, "# Static  Callee::add int ( int, int )",
+              {a, b});
+  Node* add_ctrl = AddProj(g, 5, add_call, 0);
+  Node* add_res = AddProj(g, 6, add_call, 5);
+  Node* max_call = AddCall(g, 7, add_ctrl, start,
+                           "# Static  java/lang/Math::max int ( int, int ) "
+                           "C=0.000100",
+                           {a, b});
+  Node* max_ctrl = AddProj(g, 8, max_call, 0);
+  Node* max_res = AddProj(g, 9, max_call, 5);
+  Node* sum = g.AddNode(10, Opcode::kAddI);
+  sum->set_input(0, add_res);
+  sum->set_input(1, max_res);
+  Node* ret = g.AddNode(11, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, max_ctrl);
+  ret->set_input(1, sum);
+
+  MethodRegistry registry;
+  registry.AddGraph("Callee::add", callee);
+  registry.AddJavaLangMath();
+
+  Interpreter interp(g, &registry);
+  Outcome outcome = interp.Execute({Value::MakeI32(3), Value::MakeI32(9)});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  ASSERT_TRUE(outcome.return_value.has_value());
+  EXPECT_EQ(outcome.return_value->as_i32(), 12 + 9);
+
+  // Without a registry both calls pass through and project nothing
+  Interpreter plain(g);
+  outcome = plain.Execute({Value::MakeI32(3), Value::MakeI32(9)});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  EXPECT_EQ(outcome.return_value->as_i32(), 0);
+}
+
+TEST(MethodRegistryTest, RecursionReusesCachedFrames) {
+  Graph fact;
+  BuildFact(fact);
+  MethodRegistry registry;
+  registry.AddGraph("Rec::fact(int)", fact);
+
+  Interpreter interp(fact, &registry);
+  Outcome outcome = interp.Execute({Value::MakeI32(5)});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  EXPECT_EQ(outcome.return_value->as_i32(), 120);
+
+  auto sig = MethodSignature::Parse("# Static  Rec::fact int ( int )");
+  MethodRegistry::Method* method = registry.Find(*sig);
+  ASSERT_NE(method, nullptr);
+  EXPECT_EQ(method->frames.size(), 4u);  // fact(4) .. fact(1)
+  EXPECT_EQ(method->active, 0u);
+
+  outcome = interp.Execute({Value::MakeI32(3)});
+  EXPECT_EQ(outcome.return_value->as_i32(), 6);
+  EXPECT_EQ(method->frames.size(), 4u);
+
+  // Runaway recursion stops at the depth limit and unwinds every frame
+  EXPECT_THROW(interp.Execute({Value::MakeI32(1000)}), std::runtime_error);
+  EXPECT_EQ(method->active, 0u);
+}
+
+TEST(MethodRegistryTest, FrameCacheLimitEvictsIdleFrames) {
+  Graph fact;
+  BuildFact(fact);
+  MethodRegistry registry;
+  registry.AddGraph("Rec::fact(int)", fact);
+  auto sig = MethodSignature::Parse("# Static  Rec::fact int ( int )");
+  MethodRegistry::Method* method = registry.Find(*sig);
+
+  Interpreter interp(fact, &registry);
+  interp.Execute({Value::MakeI32(5)});
+  EXPECT_EQ(method->frames.size(), 4u);
+  size_t cached = registry.frame_cache_bytes();
+  EXPECT_GT(cached, 4 * sizeof(Interpreter));
+  EXPECT_EQ(registry.frame_cache_evictions(), 0u);
+
+  // Room for about two frames: deeper ones are dropped as they return and
+  // rebuilt by the next call, with the same result
+  registry.set_frame_cache_limit(cached / 2);
+  Outcome outcome = interp.Execute({Value::MakeI32(5)});
+  EXPECT_EQ(outcome.return_value->as_i32(), 120);
+  EXPECT_LE(registry.frame_cache_bytes(), cached / 2);
+  EXPECT_LT(method->frames.size(), 4u);
+  EXPECT_GT(registry.frame_cache_evictions(), 0u);
+  EXPECT_EQ(interp.Execute({Value::MakeI32(5)}).return_value->as_i32(), 120);
+}
+
+// Callee.fill(a) stores 7 into a[1]; the caller reads it back
+TEST(MethodRegistryTest, CalleeSharesCallerHeap) {
+  Graph fill;
+  {
+    Node* root = fill.AddNode(0, Opcode::kRoot);
+    Node* start = fill.AddNode(1, Opcode::kStart);
+    Node* arr = AddParm(fill, 2, start, 0);
+    Node* store = fill.AddNode(5, Opcode::kStoreI);
+    store->set_input(0, start);
+    store->set_input(1, start);
+    store->set_input(2, arr);
+    store->set_input(3, AddConI(fill, 3, 1));
+    store->set_input(4, AddConI(fill, 4, 7));
+    store->set_prop("array", true);
+    Node* ret = fill.AddNode(6, Opcode::kReturn);
+    root->set_input(0, ret);
+    ret->set_input(0, start);
+    ret->set_input(1, start);
+    ret->set_input(2, store);  // Final memory state; no value input
+  }
+
+  Graph g;
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* arr = g.AddNode(2, Opcode::kAllocateArray);
+  arr->set_input(0, start);
+  arr->set_input(1, AddConI(g, 3, 4));
+  Node* call = AddCall(g, 4, start, start,
+                       "# Static  Callee::fill void ( int[int+]:NotNull * )",
+                       {arr});
+  Node* call_ctrl = AddProj(g, 5, call, 0);
+  Node* call_mem = AddProj(g, 6, call, 2);
+  Node* load = g.AddNode(7, Opcode::kLoadI);
+  load->set_input(0, call_ctrl);
+  load->set_input(1, call_mem);
+  load->set_input(2, arr);
+  load->set_input(3, AddConI(g, 8, 1));
+  load->set_prop("array", true);
+  Node* ret = g.AddNode(9, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, call_ctrl);
+  ret->set_input(1, load);
+
+  MethodRegistry registry;
+  registry.AddGraph("Callee::fill", fill);
+  Interpreter interp(g, &registry);
+  Outcome outcome = interp.Execute({});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  EXPECT_EQ(outcome.return_value->as_i32(), 7);
+}
+
+TEST(MethodRegistryTest, JavaLangMathIntrinsics) {
+  MethodRegistry registry;
+  registry.AddJavaLangMath();
+  ConcreteHeap heap;
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  auto call = [&](const std::string& spec, std::vector<Value> args) {
+    auto sig = MethodSignature::Parse(spec);
+    MethodRegistry::Method* m = sig ? registry.Find(*sig) : nullptr;
+    if (!m || !m->native) throw std::runtime_error("no stub: " + spec);
+    return m->native(args, heap);
+  };
+
+  EXPECT_EQ(call("# Static  java/lang/Math::abs int ( int )",
+                 {Value::MakeI32(INT32_MIN)})
+                .as_i32(),
+            INT32_MIN);
+  EXPECT_EQ(call("# Static  java/lang/Math::min long ( long, half, long, "
+                 "half )",
+                 {Value::MakeI64(-4), Value::MakeI64(2)})
+                .as_i64(),
+            -4);
+  EXPECT_TRUE(std::signbit(call("# Static  java/lang/Math::min double ( "
+                                "double, half, double, half )",
+                                {Value::MakeF64(0.0), Value::MakeF64(-0.0)})
+                               .as_f64()));
+  EXPECT_TRUE(std::isnan(call("# Static  java/lang/Math::max float ( float, "
+                              "float )",
+                              {Value::MakeF32(nan), Value::MakeF32(1.0f)})
+                             .as_f32()));
+  EXPECT_EQ(call("# Static  java/lang/Math::sqrt double ( double, half )",
+                 {Value::MakeF64(2.25)})
+                .as_f64(),
+            1.5);
+  EXPECT_THROW(call("# Static  java/lang/Math::pow double ( double, half, "
+                    "double, half )",
+                    {}),
+               std::runtime_error);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+
+#include "suntv/interp/conformance.hpp"
+#include "suntv/interp/evaluator.hpp"
+
+using namespace sun;
+
+namespace {
+
+constexpr int32_t kMinI = std::numeric_limits<int32_t>::min();
+constexpr int64_t kMinL = std::numeric_limits<int64_t>::min();
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+Value I(int32_t v) { return Value::MakeI32(v); }
+Value L(int64_t v) { return Value::MakeI64(v); }
+
+int32_t RefI(ConformanceOp op, Value a, Value b = Value::MakeNull()) {
+  return Conformance::Reference(op, a, b)->as_i32();
+}
+
+int64_t RefL(ConformanceOp op, Value a, Value b = Value::MakeNull()) {
+  return Conformance::Reference(op, a, b)->as_i64();
+}
+
+// Small budget: the whole grid plus a few thousand samples per op
+ConformanceOptions Quick() {
+  ConformanceOptions options;
+  options.samples = 4096;
+  return options;
+}
+
+// Wrong at MIN_VALUE / -1 only, like a naive hardware divide
+Value DivIWithoutMinCase(Value a, Value b) {
+  if (a.as_i32() == kMinI && b.as_i32() == -1) return I(0);
+  return Evaluator::EvalDivI(a, b);
+}
+
+// Masks the count with 63 instead of 31
+Value LShiftIWideMask(Value a, Value b) {
+  int n = b.as_i32() & 63;
+  return I(n >= 32 ? 0 : Evaluator::EvalLShiftI(a, I(n)).as_i32());
+}
+
+}  // namespace
+
+TEST(ConformanceTest, ReferenceFollowsJava) {
+  using Op = ConformanceOp;
+  EXPECT_EQ(RefI(Op::kAddI, I(INT32_MAX), I(1)), kMinI);
+  EXPECT_EQ(RefI(Op::kMulI, I(0x10000), I(0x10000)), 0);
+  EXPECT_EQ(RefI(Op::kDivI, I(kMinI), I(-1)), kMinI);
+  EXPECT_EQ(RefI(Op::kModI, I(kMinI), I(-1)), 0);
+  EXPECT_EQ(RefI(Op::kModI, I(-7), I(2)), -1);
+  EXPECT_EQ(RefI(Op::kAbsI, I(kMinI)), kMinI);
+  EXPECT_EQ(RefI(Op::kLShiftI, I(1), I(33)), 2);
+  EXPECT_EQ(RefI(Op::kRShiftI, I(-8), I(-31)), -4);
+  EXPECT_EQ(RefI(Op::kURShiftI, I(-1), I(28)), 0xF);
+  EXPECT_FALSE(Conformance::Reference(Op::kDivI, I(1), I(0)));
+  EXPECT_FALSE(Conformance::Reference(Op::kModL, L(1), L(0)));
+
+  EXPECT_EQ(RefL(Op::kDivL, L(kMinL), L(-1)), kMinL);
+  EXPECT_EQ(RefL(Op::kDivL, L(-7), L(2)), -3);
+  EXPECT_EQ(RefL(Op::kModL, L(-7), L(2)), -1);
+  EXPECT_EQ(RefL(Op::kAbsL, L(kMinL)), kMinL);
+  EXPECT_EQ(RefL(Op::kRShiftL, L(kMinL), I(63)), -1);
+  EXPECT_EQ(RefL(Op::kURShiftL, L(-1), I(64)), -1);
+  EXPECT_EQ(RefL(Op::kLShiftL, L(1), I(65)), 2);
+  EXPECT_TRUE(Conformance::Reference(Op::kCmpLtL, L(kMinL), L(0))->as_bool());
+
+  EXPECT_EQ(RefI(Op::kConvL2I, L(0x1FFFFFFFFll)), -1);
+  EXPECT_EQ(RefI(Op::kConvD2I, Value::MakeF64(kNaN)), 0);
+  EXPECT_EQ(RefL(Op::kConvF2L, Value::MakeF32(-1e30f)), kMinL);
+  EXPECT_EQ(RefI(Op::kCmpD3, Value::MakeF64(kNaN), Value::MakeF64(0)),
+            -1);
+}
+
+TEST(ConformanceTest, EvaluatorConforms) {
+  ConformanceReport report =
+      Conformance::Run(Conformance::EvaluatorEngine(), Quick());
+  for (const ConformanceFailure& f : report.failures) {
+    ADD_FAILURE() << Conformance::OpName(f.op) << "(" << f.lhs.ToString()
+                  << ", " << f.rhs.ToString() << "): expected " << f.expected
+                  << ", got " << f.actual;
+  }
+  EXPECT_TRUE(report.ok());
+  EXPECT_TRUE(report.skipped.empty());
+  // Grid pairs alone are well over a million
+  EXPECT_GT(report.checks, 1000000u);
+}
+
+TEST(ConformanceTest, CatchesBrokenEngine) {
+  ConformanceEngine engine = Conformance::EvaluatorEngine();
+  engine.binary[static_cast<size_t>(ConformanceOp::kDivI)] =
+      DivIWithoutMinCase;
+  engine.binary[static_cast<size_t>(ConformanceOp::kLShiftI)] =
+      LShiftIWideMask;
+
+  ConformanceOptions options = Quick();
+  options.ops = {ConformanceOp::kAddI, ConformanceOp::kDivI,
+                 ConformanceOp::kLShiftI};
+  options.max_failures = 4;
+  ConformanceReport report = Conformance::Run(engine, options);
+
+  EXPECT_FALSE(report.ok());
+  ASSERT_EQ(report.failures.size(), 4u);
+  EXPECT_GT(report.mismatches, 4u);
+  // Failures come in op order, so the DivI corner case is reported first
+  const ConformanceFailure& first = report.failures[0];
+  EXPECT_EQ(first.op, ConformanceOp::kDivI);
+  EXPECT_EQ(first.lhs.as_i32(), kMinI);
+  EXPECT_EQ(first.rhs.as_i32(), -1);
+  EXPECT_EQ(first.actual, "i32:0");
+  for (const ConformanceFailure& f : report.failures) {
+    EXPECT_NE(f.op, ConformanceOp::kAddI);
+  }
+}
+
+TEST(ConformanceTest, SkipsUnboundOpsAndIgnoresThreadCount) {
+  ConformanceEngine engine = Conformance::EvaluatorEngine();
+  engine.unary[static_cast<size_t>(ConformanceOp::kAbsL)] = nullptr;
+
+  ConformanceOptions options = Quick();
+  options.ops = {ConformanceOp::kMulL, ConformanceOp::kAbsL};
+  options.num_threads = 1;
+  ConformanceReport serial = Conformance::Run(engine, options);
+  options.num_threads = 4;
+  ConformanceReport parallel = Conformance::Run(engine, options);
+
+  ASSERT_EQ(serial.skipped.size(), 1u);
+  EXPECT_EQ(serial.skipped[0], ConformanceOp::kAbsL);
+  EXPECT_GT(serial.checks, 0u);
+  EXPECT_EQ(serial.checks, parallel.checks);
+  EXPECT_TRUE(parallel.ok());
+}
+
+TEST(ConformanceTest, OpNamesRoundTrip) {
+  for (size_t i = 0; i < kNumConformanceOps; ++i) {
+    auto op = static_cast<ConformanceOp>(i);
+    EXPECT_EQ(Conformance::OpFromName(Conformance::OpName(op)), op);
+  }
+  EXPECT_FALSE(Conformance::OpFromName("NoSuchOp"));
+}
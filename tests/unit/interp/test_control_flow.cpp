@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <memory>
+
 #include "suntv/interp/interpreter.hpp"
 #include "suntv/ir/graph.hpp"
+#include "suntv/ir/schedule.hpp"
 
 using namespace sun;
 
@@ -350,3 +353,108 @@ TEST(ControlFlowTest, ConditionalMove) {
   EXPECT_EQ(outcome.return_value->kind, Value::Kind::kI32);
   EXPECT_EQ(outcome.return_value->as_i32(), 100);
 }
+
+// Counted loop: sum = 0; i = 0; do { sum += i; i++; } while (i < n);
+// 1000 trips is far beyond what generic Region stepping allows, so this
+// exercises the counted-loop fast path.
+TEST(ControlFlowTest, CountedLoopFastPath) {
+  Graph g;
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+
+  Node* n = g.AddNode(2, Opcode::kParm);
+  n->set_prop("index", static_cast<int32_t>(0));
+  n->set_input(0, start);
+
+  Node* con0 = g.AddNode(3, Opcode::kConI);
+  con0->set_prop("value", static_cast<int32_t>(0));
+  Node* con1 = g.AddNode(4, Opcode::kConI);
+  con1->set_prop("value", static_cast<int32_t>(1));
+
+  Node* head = g.AddNode(5, Opcode::kCountedLoop);
+  Node* i = g.AddNode(6, Opcode::kPhi);
+  Node* i_next = g.AddNode(7, Opcode::kAddI);
+  Node* sum = g.AddNode(8, Opcode::kPhi);
+  Node* sum_next = g.AddNode(9, Opcode::kAddI);
+  Node* cmp = g.AddNode(10, Opcode::kCmpI);
+  Node* test = g.AddNode(11, Opcode::kBool);
+  test->set_prop("mask", static_cast<int32_t>(1));  // LT
+  Node* end = g.AddNode(12, Opcode::kCountedLoopEnd);
+  Node* back = g.AddNode(13, Opcode::kIfTrue);
+  Node* exit = g.AddNode(14, Opcode::kIfFalse);
+  Node* ret = g.AddNode(15, Opcode::kReturn);
+
+  head->set_input(0, head);
+  head->set_input(1, start);
+  head->set_input(2, back);
+  i->set_input(0, head);
+  i->set_input(1, con0);
+  i->set_input(2, i_next);
+  i_next->set_input(0, i);
+  i_next->set_input(1, con1);
+  sum->set_input(0, head);
+  sum->set_input(1, con0);
+  sum->set_input(2, sum_next);
+  sum_next->set_input(0, sum);
+  sum_next->set_input(1, i);
+  cmp->set_input(0, i_next);
+  cmp->set_input(1, n);
+  test->set_input(0, cmp);
+  end->set_input(0, head);
+  end->set_input(1, test);
+  back->set_input(0, end);
+  exit->set_input(0, end);
+  root->set_input(0, ret);
+  ret->set_input(0, exit);
+  ret->set_input(1, sum_next);
+
+  for (int32_t trips : {1, 5, 1000}) {
+    Interpreter interp(g);
+    Outcome outcome = interp.Execute({Value::MakeI32(trips)});
+    ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+    ASSERT_TRUE(outcome.return_value.has_value());
+    EXPECT_EQ(outcome.return_value->as_i32(), trips * (trips - 1) / 2)
+        << "n=" << trips;
+  }
+}
+
+// Start has two Proj users; only the schedule tells which one control takes
+TEST(ControlFlowTest, ScheduleChoosesControlSuccessor) {
+  auto build = [](Graph& g, bool scheduled) {
+    Node* root = g.AddNode(0, Opcode::kRoot);
+    Node* start = g.AddNode(1, Opcode::kStart);
+    Node* mem = g.AddNode(2, Opcode::kProj);  // Memory: no control users
+    mem->set_input(0, start);
+    Node* ctrl = g.AddNode(3, Opcode::kProj);
+    ctrl->set_input(0, start);
+    Node* con = g.AddNode(4, Opcode::kConI);
+    con->set_prop("value", static_cast<int32_t>(42));
+    Node* ret = g.AddNode(5, Opcode::kReturn);
+    ret->set_input(0, ctrl);
+    ret->set_input(1, con);
+    root->set_input(0, ret);
+    if (!scheduled) return;
+
+    auto schedule = std::make_unique<Schedule>();
+    const uint32_t entry = schedule->AddBlock(1);
+    const uint32_t exit = schedule->AddBlock(2);
+    schedule->AddSuccessor(entry, exit);
+    for (const Node* n : {start, mem, ctrl, con, ret}) {
+      schedule->Place(n, entry);
+    }
+    schedule->Place(root, exit);
+    g.set_schedule(std::move(schedule));
+  };
+
+  // Without a schedule the lowest-ID Proj wins and control gets stuck
+  Graph plain;
+  build(plain, false);
+  EXPECT_THROW(Interpreter(plain).Execute({}), std::runtime_error);
+
+  Graph scheduled;
+  build(scheduled, true);
+  Outcome outcome = Interpreter(scheduled).Execute({});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  ASSERT_TRUE(outcome.return_value.has_value());
+  EXPECT_EQ(outcome.return_value->as_i32(), 42);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include "suntv/interp/differential.hpp"
+#include "suntv/interp/interpreter.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+namespace {
+
+class DifferentialTest : public ::testing::Test {
+ protected:
+  // The interpreter logs every node at INFO
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetLevel(LogLevel::WARN);
+  }
+  void TearDown() override { Logger::SetLevel(level_); }
+
+  LogLevel level_ = LogLevel::INFO;
+};
+
+DiffOptions Quick(uint64_t cases) {
+  DiffOptions options;
+  options.cases = cases;
+  options.inputs_per_case = 4;
+  options.num_threads = 1;
+  return options;
+}
+
+// The interpreter, except that odd return values come back off by one
+DiffEngine OffByOneOnOdd() {
+  return {"broken", [](const Graph& g, const auto& inputs) {
+            std::vector<EngineResult> out =
+                DifferentialTester::Engines()[0].run(g, inputs);
+            for (EngineResult& r : out) {
+              if (r.value && r.value->is_i32() && r.value->as_i32() % 2 != 0) {
+                r.value = Value::MakeI32(r.value->as_i32() + 1);
+              }
+            }
+            return out;
+          }};
+}
+
+}  // namespace
+
+TEST_F(DifferentialTest, GenerationIsReproducible) {
+  RandomProgram a = RandomProgram::Generate(42);
+  RandomProgram b = RandomProgram::Generate(42);
+  EXPECT_EQ(a.ToString(), b.ToString());
+  EXPECT_NE(a.ToString(), RandomProgram::Generate(43).ToString());
+  EXPECT_NE(DifferentialTester::CaseSeed(1, 0),
+            DifferentialTester::CaseSeed(1, 1));
+}
+
+TEST_F(DifferentialTest, LoweredProgramsRun) {
+  DiffReport report =
+      DifferentialTester::Run(DifferentialTester::Engines(), Quick(100));
+  ASSERT_TRUE(report.ok()) << report.failure->ToString();
+  EXPECT_EQ(report.cases, 100u);
+  EXPECT_EQ(report.runs, 400u);
+  EXPECT_EQ(report.errors, 0u);
+  // Most programs return; division by zero makes some throw
+  EXPECT_GT(report.returns, report.runs / 2);
+  EXPECT_GT(report.throws, 0u);
+}
+
+TEST_F(DifferentialTest, ShrinksDisagreementAndReplays) {
+  std::vector<DiffEngine> engines = DifferentialTester::Engines();
+  engines.push_back(OffByOneOnOdd());
+  DiffReport report = DifferentialTester::Run(engines, Quick(100));
+  ASSERT_FALSE(report.ok());
+  const DiffFailure& f = *report.failure;
+  EXPECT_EQ(f.engine_a, "interpreter");
+  EXPECT_EQ(f.engine_b, "broken");
+  // At most a copy chain from an input, which shrinks to 1 or -1
+  EXPECT_LE(f.program.size(), 2u) << f.ToString();
+  EXPECT_EQ(std::abs(f.result_a.value->as_i32()), 1) << f.ToString();
+  EXPECT_GT(f.shrink_steps, 0);
+
+  DiffOptions unshrunk = Quick(1);
+  unshrunk.shrink = false;
+  auto replay = DifferentialTester::CheckCase(engines, f.case_seed, unshrunk);
+  ASSERT_TRUE(replay.has_value());
+  EXPECT_EQ(replay->shrink_steps, 0);
+  EXPECT_GE(replay->program.size(), f.program.size());
+}
+
+TEST_F(DifferentialTest, ReportDoesNotDependOnThreadCount) {
+  std::vector<DiffEngine> engines = DifferentialTester::Engines();
+  engines.push_back(OffByOneOnOdd());
+  DiffOptions options = Quick(50);
+  options.shrink = false;
+  DiffReport one = DifferentialTester::Run(engines, options);
+  options.num_threads = 4;
+  DiffReport four = DifferentialTester::Run(engines, options);
+  ASSERT_FALSE(one.ok());
+  ASSERT_FALSE(four.ok());
+  EXPECT_EQ(one.failure->case_seed, four.failure->case_seed);
+  EXPECT_EQ(one.failure->ToString(), four.failure->ToString());
+
+  DiffReport clean = DifferentialTester::Run(DifferentialTester::Engines(),
+                                             options);
+  options.num_threads = 1;
+  DiffReport clean_one = DifferentialTester::Run(DifferentialTester::Engines(),
+                                                 options);
+  EXPECT_EQ(clean.runs, clean_one.runs);
+  EXPECT_EQ(clean.returns, clean_one.returns);
+  EXPECT_EQ(clean.throws, clean_one.throws);
+}
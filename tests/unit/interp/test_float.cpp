@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "suntv/interp/evaluator.hpp"
+#include "suntv/interp/float_kernels.hpp"
+#include "suntv/interp/interpreter.hpp"
+#include "suntv/ir/constant_pool.hpp"
+#include "suntv/ir/graph.hpp"
+
+using namespace sun;
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr float kNaNf = std::numeric_limits<float>::quiet_NaN();
+
+Value D(double d) { return Value::MakeF64(d); }
+Value F(float f) { return Value::MakeF32(f); }
+uint64_t Bits(Value v) { return std::bit_cast<uint64_t>(v.as_f64()); }
+uint32_t BitsF(Value v) { return std::bit_cast<uint32_t>(v.as_f32()); }
+
+}  // namespace
+
+// Results below are what HotSpot prints for the equivalent Java expressions
+
+TEST(FloatTest, ArithmeticRoundsInDeclaredPrecision) {
+  // 0.1 + 0.2 == 0.30000000000000004
+  EXPECT_EQ(Bits(Evaluator::EvalAddD(D(0.1), D(0.2))), 0x3FD3333333333334u);
+  // 16777216f + 1f == 16777216f (no double-precision intermediate)
+  EXPECT_EQ(Evaluator::EvalAddF(F(16777216.0f), F(1.0f)).as_f32(),
+            16777216.0f);
+  EXPECT_EQ(Evaluator::EvalMulD(D(1e308), D(10)).as_f64(), kInf);
+  EXPECT_EQ(Evaluator::EvalDivF(F(std::numeric_limits<float>::denorm_min()),
+                                F(2.0f))
+                .as_f32(),
+            0.0f);
+  EXPECT_EQ(Evaluator::EvalDivD(D(-1.0), D(0.0)).as_f64(), -kInf);
+  EXPECT_TRUE(std::isnan(Evaluator::EvalDivD(D(0.0), D(0.0)).as_f64()));
+  EXPECT_EQ(Bits(Evaluator::EvalSqrtD(D(2.0))), 0x3FF6A09E667F3BCDu);
+  EXPECT_TRUE(std::isnan(Evaluator::EvalSqrtD(D(-1.0)).as_f64()));
+  EXPECT_EQ(Bits(Evaluator::EvalNegD(D(0.0))), 0x8000000000000000u);
+  EXPECT_EQ(Bits(Evaluator::EvalAbsD(D(-0.0))), 0u);
+}
+
+TEST(FloatTest, RemainderTruncates) {
+  struct Case {
+    double a, b, expected;
+  };
+  const Case cases[] = {
+      {5.5, 2.0, 1.5},   {-5.5, 2.0, -1.5}, {5.0, -3.0, 2.0},
+      {1.0, kInf, 1.0},  {-0.0, 1.0, -0.0}, {-7.0, 0.5, -0.0},
+  };
+  for (const Case& c : cases) {
+    Value r = Evaluator::EvalModD(D(c.a), D(c.b));
+    EXPECT_EQ(Bits(r), std::bit_cast<uint64_t>(c.expected))
+        << c.a << " % " << c.b;
+  }
+  EXPECT_TRUE(std::isnan(Evaluator::EvalModD(D(1.0), D(0.0)).as_f64()));
+  EXPECT_TRUE(std::isnan(Evaluator::EvalModD(D(kInf), D(1.0)).as_f64()));
+  EXPECT_EQ(Evaluator::EvalModF(F(-7.5f), F(2.0f)).as_f32(), -1.5f);
+}
+
+TEST(FloatTest, FloatToIntegralSaturates) {
+  struct Case {
+    double in;
+    int32_t i;
+    int64_t l;
+  };
+  const int32_t imax = std::numeric_limits<int32_t>::max();
+  const int32_t imin = std::numeric_limits<int32_t>::min();
+  const int64_t lmax = std::numeric_limits<int64_t>::max();
+  const int64_t lmin = std::numeric_limits<int64_t>::min();
+  const Case cases[] = {
+      {kNaN, 0, 0},
+      {3.99, 3, 3},
+      {-3.99, -3, -3},
+      {-0.0, 0, 0},
+      {1e10, imax, 10000000000},
+      {-1e10, imin, -10000000000},
+      {2147483647.9, imax, 2147483647},
+      {-2147483648.9, imin, -2147483648},
+      {1e18, imax, 1000000000000000000},
+      {9.3e18, imax, lmax},
+      {-9.3e18, imin, lmin},
+      {kInf, imax, lmax},
+      {-kInf, imin, lmin},
+  };
+  for (const Case& c : cases) {
+    EXPECT_EQ(Evaluator::EvalConvD2I(D(c.in)).as_i32(), c.i) << c.in;
+    EXPECT_EQ(Evaluator::EvalConvD2L(D(c.in)).as_i64(), c.l) << c.in;
+  }
+  EXPECT_EQ(Evaluator::EvalConvF2I(F(kNaNf)).as_i32(), 0);
+  EXPECT_EQ(Evaluator::EvalConvF2I(F(3e9f)).as_i32(), imax);
+  EXPECT_EQ(Evaluator::EvalConvF2L(F(1e20f)).as_i64(), lmax);
+  EXPECT_EQ(Evaluator::EvalConvF2L(F(-1e20f)).as_i64(), lmin);
+}
+
+TEST(FloatTest, ConversionsRoundToNearest) {
+  // (float) Integer.MAX_VALUE == 2.14748365E9
+  EXPECT_EQ(BitsF(Evaluator::EvalConvI2F(Value::MakeI32(2147483647))),
+            0x4F000000u);
+  // (float) Long.MAX_VALUE == 9.223372E18
+  EXPECT_EQ(BitsF(Evaluator::EvalConvL2F(
+                Value::MakeI64(std::numeric_limits<int64_t>::max()))),
+            0x5F000000u);
+  EXPECT_EQ(Evaluator::EvalConvI2F(Value::MakeI32(16777217)).as_f32(),
+            16777216.0f);
+  EXPECT_EQ(Evaluator::EvalConvL2D(Value::MakeI64((int64_t{1} << 53) + 1))
+                .as_f64(),
+            9007199254740992.0);
+  EXPECT_EQ(Evaluator::EvalConvD2F(D(1e40)).as_f32(),
+            std::numeric_limits<float>::infinity());
+  EXPECT_EQ(Evaluator::EvalConvF2D(F(0.1f)).as_f64(), 0.10000000149011612);
+  EXPECT_EQ(Evaluator::EvalConvI2D(Value::MakeI32(-7)).as_f64(), -7.0);
+}
+
+TEST(FloatTest, ThreeWayCompareTreatsNaNAsLess) {
+  EXPECT_EQ(Evaluator::EvalCmpD3(D(kNaN), D(0.0)).as_i32(), -1);
+  EXPECT_EQ(Evaluator::EvalCmpD3(D(0.0), D(kNaN)).as_i32(), -1);
+  EXPECT_EQ(Evaluator::EvalCmpD3(D(-0.0), D(0.0)).as_i32(), 0);
+  EXPECT_EQ(Evaluator::EvalCmpD3(D(1.0), D(0.0)).as_i32(), 1);
+  EXPECT_EQ(Evaluator::EvalCmpD3(D(-kInf), D(kInf)).as_i32(), -1);
+  EXPECT_EQ(Evaluator::EvalCmpF3(F(kNaNf), F(kNaNf)).as_i32(), -1);
+  EXPECT_EQ(Evaluator::EvalCmpF3(F(2.0f), F(1.0f)).as_i32(), 1);
+}
+
+TEST(FloatTest, MinMaxFollowMath) {
+  EXPECT_EQ(Bits(Evaluator::EvalMinD(D(-0.0), D(0.0))), 0x8000000000000000u);
+  EXPECT_EQ(Bits(Evaluator::EvalMinD(D(0.0), D(-0.0))), 0x8000000000000000u);
+  EXPECT_EQ(Bits(Evaluator::EvalMaxD(D(-0.0), D(0.0))), 0u);
+  EXPECT_EQ(Bits(Evaluator::EvalMaxD(D(0.0), D(-0.0))), 0u);
+  EXPECT_TRUE(std::isnan(Evaluator::EvalMinD(D(kNaN), D(1.0)).as_f64()));
+  EXPECT_TRUE(std::isnan(Evaluator::EvalMinD(D(1.0), D(kNaN)).as_f64()));
+  EXPECT_TRUE(std::isnan(Evaluator::EvalMaxF(F(1.0f), F(kNaNf)).as_f32()));
+  EXPECT_EQ(Evaluator::EvalMaxF(F(1.0f), F(2.0f)).as_f32(), 2.0f);
+}
+
+TEST(FloatTest, RawBitMoves) {
+  EXPECT_EQ(Evaluator::EvalMoveF2I(F(-0.0f)).as_i32(),
+            static_cast<int32_t>(0x80000000u));
+  EXPECT_EQ(Evaluator::EvalMoveD2L(D(1.0)).as_i64(), 0x3FF0000000000000);
+  // NaN payloads survive a round trip
+  Value nan = Evaluator::EvalMoveI2F(Value::MakeI32(0x7fc00001));
+  EXPECT_EQ(Evaluator::EvalMoveF2I(nan).as_i32(), 0x7fc00001);
+  Value d = Evaluator::EvalMoveL2D(Value::MakeI64(0x7ff8000000000123));
+  EXPECT_EQ(Evaluator::EvalMoveD2L(d).as_i64(), 0x7ff8000000000123);
+}
+
+TEST(FloatTest, BatchMatchesScalar) {
+  const std::vector<double> a = {0.1, -5.5, kNaN, 1e10, -kInf, -0.0, 3.99};
+  const std::vector<double> b = {0.2, 2.0, 1.0, 3.0, kInf, 0.0, kNaN};
+  const size_t n = a.size();
+
+  std::vector<double> sum(n), quot(n);
+  std::vector<int32_t> cmp(n), ints(n);
+  std::vector<int64_t> longs(n);
+  FloatKernels::AddD(a, b, sum);
+  FloatKernels::DivD(a, b, quot);
+  FloatKernels::CmpD3(a, b, cmp);
+  FloatKernels::D2I(a, ints);
+  FloatKernels::D2L(a, longs);
+
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(std::bit_cast<uint64_t>(sum[i]),
+              Bits(Evaluator::EvalAddD(D(a[i]), D(b[i]))));
+    EXPECT_EQ(std::bit_cast<uint64_t>(quot[i]),
+              Bits(Evaluator::EvalDivD(D(a[i]), D(b[i]))));
+    EXPECT_EQ(cmp[i], Evaluator::EvalCmpD3(D(a[i]), D(b[i])).as_i32());
+    EXPECT_EQ(ints[i], Evaluator::EvalConvD2I(D(a[i])).as_i32());
+    EXPECT_EQ(longs[i], Evaluator::EvalConvD2L(D(a[i])).as_i64());
+  }
+
+  std::vector<double> short_out(n - 1);
+  EXPECT_THROW(FloatKernels::AddD(a, b, short_out), std::invalid_argument);
+}
+
+TEST(FloatTest, DecodesFloatConstants) {
+  auto bits = [](Opcode op, const char* spec) {
+    return ConstantPool::DecodeDumpSpec(op, spec);
+  };
+  EXPECT_EQ(bits(Opcode::kConF, " #ftcon:1.500000"),
+            std::bit_cast<uint32_t>(1.5f));
+  EXPECT_EQ(bits(Opcode::kConF, " #ftcon:0.100000"),
+            std::bit_cast<uint32_t>(0.1f));
+  EXPECT_EQ(bits(Opcode::kConD, " #dblcon:-2.250000"),
+            std::bit_cast<int64_t>(-2.25));
+  EXPECT_EQ(bits(Opcode::kConD, " #dblcon:-inf"),
+            std::bit_cast<int64_t>(-kInf));
+  EXPECT_EQ(bits(Opcode::kConD, " #dblcon:-Infinity"),
+            std::bit_cast<int64_t>(-kInf));
+  EXPECT_EQ(bits(Opcode::kConD, " #dblcon:-0.000000"),
+            std::bit_cast<int64_t>(-0.0));
+  auto nan = bits(Opcode::kConD, " #double:NaN");
+  ASSERT_TRUE(nan);
+  EXPECT_TRUE(std::isnan(std::bit_cast<double>(*nan)));
+  EXPECT_FALSE(bits(Opcode::kConD, " #dblcon:1.5x"));
+  EXPECT_FALSE(bits(Opcode::kConF, " #ftcon:"));
+}
+
+// return (a != a) ? -1 : (int) (a * 2.5), over a double parameter
+TEST(FloatTest, InterpretsDoubleGraph) {
+  Graph g;
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* parm = g.AddNode(2, Opcode::kParm);
+  parm->set_prop("index", static_cast<int32_t>(0));
+  parm->set_prop("type", std::string("double"));
+  parm->set_input(0, start);
+  Node* scale = g.AddNode(3, Opcode::kConD);
+  scale->set_prop("dump_spec", std::string(" #dblcon:2.500000"));
+
+  Node* mul = g.AddNode(4, Opcode::kMulD);
+  mul->set_input(0, parm);
+  mul->set_input(1, scale);
+  Node* conv = g.AddNode(5, Opcode::kConvD2I);
+  conv->set_input(1, mul);
+
+  // Unordered compares as less, so [ne] holds only for NaN when comparing
+  // a against itself
+  Node* cmp = g.AddNode(6, Opcode::kCmpD);
+  cmp->set_input(0, parm);
+  cmp->set_input(1, parm);
+  Node* test = g.AddNode(7, Opcode::kBool);
+  test->set_prop("dump_spec", std::string("[ne]"));
+  test->set_input(0, cmp);
+  Node* minus1 = g.AddNode(8, Opcode::kConI);
+  minus1->set_prop("value", static_cast<int32_t>(-1));
+  Node* cmove = g.AddNode(9, Opcode::kCMoveI);
+  cmove->set_input(0, test);
+  cmove->set_input(1, minus1);
+  cmove->set_input(2, conv);
+
+  Node* ret = g.AddNode(10, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, start);
+  ret->set_input(1, cmove);
+
+  auto run = [&](double a) {
+    Interpreter interp(g);
+    Outcome outcome = interp.Execute({Value::MakeF64(a)});
+    EXPECT_EQ(outcome.kind, Outcome::Kind::kReturn);
+    return outcome.return_value->as_i32();
+  };
+  EXPECT_EQ(run(3.0), 7);
+  EXPECT_EQ(run(-1.1), -2);
+  EXPECT_EQ(run(1e10), std::numeric_limits<int32_t>::max());
+  EXPECT_EQ(run(kNaN), -1);
+}
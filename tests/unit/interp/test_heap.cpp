@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 #include "suntv/interp/heap.hpp"
+#include "suntv/util/memory_usage.hpp"
 
 using namespace sun;
 
@@ -76,3 +79,134 @@ TEST(HeapTest, Dump) {
   EXPECT_NE(dump.find("ref:1.value"), std::string::npos);
   EXPECT_NE(dump.find("i32:99"), std::string::npos);
 }
+
+TEST(HeapTest, CanonicalDumpIgnoresAllocationOrder) {
+  ConcreteHeap a;
+  Ref obj = a.AllocateObject();
+  Ref arr = a.AllocateArray(2);
+  a.WriteField(obj, "next", Value::MakeRef(arr));
+  a.WriteArray(arr, 1, Value::MakeI32(7));
+
+  ConcreteHeap b;
+  arr = b.AllocateArray(2);
+  obj = b.AllocateObject();
+  b.WriteArray(arr, 1, Value::MakeI32(7));
+  b.WriteField(obj, "next", Value::MakeRef(arr));
+
+  EXPECT_NE(a.Dump(), b.Dump());
+  EXPECT_EQ(a.CanonicalDump(), b.CanonicalDump());
+
+  b.WriteArray(arr, 0, Value::MakeI32(1));
+  EXPECT_NE(a.CanonicalDump(), b.CanonicalDump());
+}
+
+TEST(HeapTest, CanonicalDumpKeepsSharing) {
+  // Two objects sharing one array, and two objects with an array each
+  ConcreteHeap a;
+  Ref arr = a.AllocateArray(1);
+  for (int i = 0; i < 2; ++i) {
+    a.WriteField(a.AllocateObject(), "x", Value::MakeRef(arr));
+  }
+  ConcreteHeap b;
+  for (int i = 0; i < 2; ++i) {
+    b.WriteField(b.AllocateObject(), "x", Value::MakeRef(b.AllocateArray(1)));
+  }
+  EXPECT_NE(a.CanonicalDump(), b.CanonicalDump());
+}
+
+TEST(HeapTest, CanonicalNumberingFollowsRoots) {
+  ConcreteHeap a;
+  Ref head = a.AllocateObject();
+  Ref tail = a.AllocateObject();
+  Ref loose = a.AllocateArray(1);
+  a.WriteField(head, "next", Value::MakeRef(tail));
+  a.WriteField(tail, "value", Value::MakeI32(3));
+
+  ConcreteHeap b;
+  Ref loose_b = b.AllocateArray(1);
+  Ref tail_b = b.AllocateObject();
+  Ref head_b = b.AllocateObject();
+  b.WriteField(tail_b, "value", Value::MakeI32(3));
+  b.WriteField(head_b, "next", Value::MakeRef(tail_b));
+
+  const Value roots_a[] = {Value::MakeRef(head), Value::MakeI32(0)};
+  const Value roots_b[] = {Value::MakeRef(head_b), Value::MakeI32(0)};
+  std::map<Ref, Ref> number = a.CanonicalNumbering(roots_a);
+  EXPECT_EQ(number.at(head), 1);
+  EXPECT_EQ(number.at(tail), 2);
+  EXPECT_EQ(number.at(loose), 3);
+  EXPECT_EQ(b.CanonicalNumbering(roots_b).at(loose_b), 3);
+  EXPECT_EQ(a.CanonicalDump(roots_a), b.CanonicalDump(roots_b));
+
+  // Rooted at the tail instead, the heaps are not the same object graph
+  const Value tail_root[] = {Value::MakeRef(tail)};
+  EXPECT_NE(a.CanonicalDump(roots_a), a.CanonicalDump(tail_root));
+}
+
+TEST(HeapTest, TypedFloatArrays) {
+  ConcreteHeap heap;
+  Ref f = heap.AllocateArray(3, Value::Kind::kF32);
+  Ref d = heap.AllocateArray(2, Value::Kind::kF64);
+
+  EXPECT_EQ(heap.ArrayElementKind(f), Value::Kind::kF32);
+  EXPECT_EQ(heap.ArrayElementKind(d), Value::Kind::kF64);
+  EXPECT_EQ(heap.ArrayLength(f), 3);
+  // Default init is +0.0 of the element type
+  EXPECT_TRUE(heap.ReadArray(f, 0).is_f32());
+  EXPECT_FALSE(std::signbit(heap.ReadArray(d, 1).as_f64()));
+
+  heap.WriteArray(f, 1, Value::MakeF32(1.5f));
+  heap.WriteArray(d, 0, Value::MakeF64(-0.0));
+  EXPECT_EQ(heap.ReadArray(f, 1).as_f32(), 1.5f);
+  EXPECT_TRUE(std::signbit(heap.ReadArray(d, 0).as_f64()));
+
+  // Stores of another kind are rejected rather than converted
+  EXPECT_THROW(heap.WriteArray(f, 0, Value::MakeF64(1.0)), std::runtime_error);
+  EXPECT_THROW(heap.WriteArray(d, 0, Value::MakeI32(1)), std::runtime_error);
+
+  // Unboxed storage is visible through the span view
+  std::span<float> data = heap.FloatArrayData(f);
+  ASSERT_EQ(data.size(), 3u);
+  data[2] = 4.0f;
+  EXPECT_EQ(heap.GetArrayContents(f)[2].as_f32(), 4.0f);
+  EXPECT_THROW(heap.DoubleArrayData(f), std::runtime_error);
+  EXPECT_NE(heap.Dump().find("f32:1.5"), std::string::npos);
+}
+
+TEST(HeapTest, MemoryUsageMatchesRunningCount) {
+  ConcreteHeap heap;
+  EXPECT_EQ(heap.bytes(), 0u);
+  Ref obj = heap.AllocateObject();
+  heap.WriteField(obj, "x", Value::MakeI32(1));
+  size_t one_field = heap.bytes();
+  EXPECT_GT(one_field, sizeof(Value));
+  heap.WriteField(obj, "x", Value::MakeI32(2));  // Overwrite: no new storage
+  EXPECT_EQ(heap.bytes(), one_field);
+  heap.WriteField(obj, "field_name_past_the_inline_buffer",
+                  Value::MakeI32(3));
+  heap.AllocateArray(1000);
+  heap.AllocateArray(1000, Value::Kind::kF32);
+
+  HeapMemory m = heap.MemoryUsage();
+  EXPECT_EQ(m.objects, 1u);
+  EXPECT_EQ(m.arrays, 2u);
+  EXPECT_GE(m.array_bytes, 1000 * (sizeof(Value) + sizeof(float)));
+  EXPECT_GT(m.field_bytes, 2 * one_field);  // The long name is on the heap
+  EXPECT_EQ(m.total(), heap.bytes());
+}
+
+TEST(HeapTest, LimitFailsAllocationWithoutSideEffects) {
+  ConcreteHeap heap;
+  heap.set_limit(64 * 1024);
+  Ref small = heap.AllocateArray(100);
+  size_t before = heap.bytes();
+  EXPECT_THROW(heap.AllocateArray(1 << 20), MemoryLimitExceeded);
+  EXPECT_EQ(heap.bytes(), before);
+  EXPECT_EQ(heap.MemoryUsage().arrays, 1u);
+  heap.WriteArray(small, 0, Value::MakeI32(5));  // Existing storage still works
+
+  // Copies keep the limit, so a run on a copied heap is bounded as well
+  ConcreteHeap copy = heap;
+  EXPECT_EQ(copy.limit(), heap.limit());
+  EXPECT_THROW(copy.AllocateArray(1 << 20), MemoryLimitExceeded);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "suntv/interp/interpreter.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/random_program.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+// Every allocation of the test binary goes through these, so a test can
+// count the ones made while it runs
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+class InterpreterReuseTest : public ::testing::Test {
+ protected:
+  // Dropped records must not allocate, so log below the interpreter's INFO
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetLevel(LogLevel::WARN);
+  }
+  void TearDown() override { Logger::SetLevel(level_); }
+
+  LogLevel level_ = LogLevel::INFO;
+};
+
+RandomProgramOptions ScalarOnly() {
+  RandomProgramOptions options;
+  options.memory = false;
+  options.exceptions = false;
+  return options;
+}
+
+}  // namespace
+
+TEST_F(InterpreterReuseTest, ScalarRunsDoNotAllocateAfterWarmUp) {
+  int checked = 0;
+  for (uint64_t seed = 1; seed <= 50; ++seed) {
+    RandomProgram program = RandomProgram::Generate(seed, ScalarOnly());
+    std::unique_ptr<Graph> graph = program.Lower();
+    std::vector<Value> inputs;
+    for (int i = 0; i < program.num_params; ++i) {
+      inputs.push_back(Value::MakeI32(3 * i - 2));
+    }
+
+    Interpreter interp(*graph);
+    Outcome first;
+    const uint64_t warm_up = g_allocations.load();
+    try {
+      first = interp.Execute(inputs);
+    } catch (const std::exception&) {
+      continue;  // E.g. a loop over the iteration limit
+    }
+    ASSERT_TRUE(first.return_value.has_value());
+    // The first run prepares the graph (and shows the counter works)
+    EXPECT_GT(g_allocations.load() - warm_up, 0u);
+
+    const uint64_t before = g_allocations.load();
+    for (int run = 0; run < 20; ++run) {
+      Outcome outcome = interp.Execute(inputs);
+      ASSERT_TRUE(outcome.return_value.has_value());
+      EXPECT_EQ(outcome.return_value->as_i32(),
+                first.return_value->as_i32());
+    }
+    EXPECT_EQ(g_allocations.load() - before, 0u)
+        << "seed " << seed << ":\n"
+        << program.ToString();
+    ++checked;
+  }
+  EXPECT_GT(checked, 40);
+}
+
+TEST_F(InterpreterReuseTest, ReusedRunsStartFromCleanState) {
+  // A run must not see values cached by the previous one
+  RandomProgram program = RandomProgram::Generate(7, ScalarOnly());
+  std::unique_ptr<Graph> graph = program.Lower();
+  Interpreter reused(*graph);
+  for (int32_t x = -3; x <= 3; ++x) {
+    std::vector<Value> inputs(program.num_params, Value::MakeI32(x));
+    Interpreter fresh(*graph);
+    Outcome expected = fresh.Execute(inputs);
+    Outcome actual = reused.Execute(inputs);
+    ASSERT_TRUE(actual.return_value.has_value());
+    EXPECT_EQ(actual.return_value->as_i32(), expected.return_value->as_i32());
+  }
+}
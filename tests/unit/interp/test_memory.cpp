@@ -2,6 +2,7 @@
 
 #include "suntv/interp/interpreter.hpp"
 #include "suntv/ir/graph.hpp"
+#include "suntv/util/memory_usage.hpp"
 
 using namespace sun;
 
@@ -72,6 +73,40 @@ TEST(MemoryTest, AllocateArray) {
   EXPECT_EQ(outcome.heap.ArrayLength(arr_ref), 10);
 }
 
+// new int[n], under a heap limit
+TEST(MemoryTest, HeapLimitFailsRunGracefully) {
+  Graph g;
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* len = g.AddNode(2, Opcode::kParm);
+  len->set_input(0, start);
+  len->set_prop("index", static_cast<int32_t>(0));
+  Node* alloc = g.AddNode(3, Opcode::kAllocateArray);
+  alloc->set_input(0, start);
+  alloc->set_input(1, len);
+  alloc->set_prop("elem_type", std::string("int"));
+  Node* ret = g.AddNode(4, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, start);
+  ret->set_input(1, alloc);
+
+  Interpreter interp(g);
+  interp.set_heap_limit(1 << 20);
+  Outcome outcome = interp.Execute({Value::MakeI32(1000)});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  InterpreterMemory m = interp.MemoryUsage();
+  EXPECT_EQ(m.heap.arrays, 1u);
+  EXPECT_EQ(m.heap.total(), outcome.heap.bytes());
+  EXPECT_GT(m.run, 0u);
+  EXPECT_GT(m.prepared, 0u);
+  EXPECT_GE(m.total(), m.heap.total() + sizeof(Interpreter));
+
+  // A billion elements would take gigabytes: the run fails instead
+  EXPECT_THROW(interp.Execute({Value::MakeI32(1 << 30)}), MemoryLimitExceeded);
+  // The interpreter stays usable
+  EXPECT_EQ(interp.Execute({Value::MakeI32(10)}).kind, Outcome::Kind::kReturn);
+}
+
 // Test 3: Store and load field
 // obj = allocate; obj.field = 42; return obj.field
 TEST(MemoryTest, StoreAndLoadField) {
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+
+#include "suntv/interp/minimize.hpp"
+#include "suntv/ir/graph_builder.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+namespace {
+
+// Return(op(Parm0[3], 1) + Parm1): DivI and RShiftI round negative odd
+// elements apart
+std::unique_ptr<Graph> Halve(Opcode op) {
+  GraphBuilder b;
+  Node* elem = b.LoadArray(b.start(), b.start(), b.Parm(0), b.ConI(3));
+  Node* half = b.Binary(op, elem, b.ConI(op == Opcode::kDivI ? 2 : 1));
+  b.Return(b.start(), b.start(), b.Binary(Opcode::kAddI, half, b.Parm(1)));
+  return b.Finish();
+}
+
+// Return(op(Parm1, 1)); Parm0 is not used
+std::unique_ptr<Graph> HalveScalar(Opcode op) {
+  GraphBuilder b;
+  b.Return(b.start(), b.start(),
+           b.Binary(op, b.Parm(1), b.ConI(op == Opcode::kDivI ? 2 : 1)));
+  return b.Finish();
+}
+
+class MinimizeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetLevel(LogLevel::ERROR);
+  }
+  void TearDown() override { Logger::SetLevel(level_); }
+
+  LogLevel level_ = LogLevel::INFO;
+};
+
+}  // namespace
+
+TEST_F(MinimizeTest, WitnessRoundTrips) {
+  Witness w = Witness::Parse({"3", "-7L", "1.5f", "NaN", "-0.0", "null",
+                              "[1,-2]", "long[3,4L]", "float[0.5]",
+                              "double[]"});
+  ASSERT_EQ(w.args.size(), 10u);
+  EXPECT_EQ(w.args[1].value.as_i64(), -7);
+  EXPECT_TRUE(w.args[5].value.is_null());
+  EXPECT_EQ(w.args[7].array, Value::Kind::kI64);
+  EXPECT_EQ(w.args[7].elements[0].as_i64(), 3);
+  const std::string text =
+      "3 -7L 1.5f NaN -0.0 null [1,-2] long[3L,4L] float[0.5f] double[]";
+  EXPECT_EQ(w.ToString(), text);
+
+  ConcreteHeap heap;
+  std::vector<Value> inputs = w.Materialize(heap);
+  ASSERT_TRUE(inputs[6].is_ref());
+  EXPECT_EQ(heap.ArrayLength(inputs[6].as_ref()), 2);
+  EXPECT_EQ(heap.ReadArray(inputs[6].as_ref(), 1).as_i32(), -2);
+  EXPECT_EQ(heap.ArrayElementKind(inputs[8].as_ref()), Value::Kind::kF32);
+
+  for (const char* bad : {"[1,2", "short[1]", "[1L]", "[1,]", "1x"}) {
+    EXPECT_THROW(Witness::Parse({bad}), std::invalid_argument) << bad;
+  }
+}
+
+TEST_F(MinimizeTest, ShrinksArraysAndValues) {
+  std::unique_ptr<Graph> div = Halve(Opcode::kDivI);
+  std::unique_ptr<Graph> shift = Halve(Opcode::kRShiftI);
+  Witness start =
+      Witness::Parse({"[5,9,-7,-12345,8,100,2,3,40,-41]", "77"});
+  std::optional<MinimizeResult> min = MinimizeWitness(*div, *shift, start);
+  ASSERT_TRUE(min.has_value());
+  // The element read must stay, and be odd and negative
+  EXPECT_EQ(min->witness.ToString(), "[0,0,0,-1] 0");
+  EXPECT_EQ(min->before.value->as_i32(), 0);
+  EXPECT_EQ(min->after.value->as_i32(), -1);
+  EXPECT_GT(min->steps, 0u);
+
+  // An unused array is dropped
+  std::unique_ptr<Graph> div1 = HalveScalar(Opcode::kDivI);
+  std::unique_ptr<Graph> shift1 = HalveScalar(Opcode::kRShiftI);
+  min = MinimizeWitness(*div1, *shift1, Witness::Parse({"[1,2,3]", "-999"}));
+  ASSERT_TRUE(min.has_value());
+  EXPECT_EQ(min->witness.ToString(), "null -1");
+
+  // Nothing to shrink when the graphs agree
+  EXPECT_FALSE(
+      MinimizeWitness(*div, *shift, Witness::Parse({"[1,2,3,4]", "5"}))
+          .has_value());
+  // The run budget is respected
+  MinimizeOptions options;
+  options.max_runs = 3;
+  min = MinimizeWitness(*div, *shift, start, options);
+  ASSERT_TRUE(min.has_value());
+  EXPECT_EQ(min->runs, 3u);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "suntv/igv/session.hpp"
+#include "suntv/interp/phase_pipeline.hpp"
+#include "suntv/ir/graph_builder.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+// Return(Parm0 op k)
+std::unique_ptr<Graph> Arith(Opcode op, int32_t k) {
+  GraphBuilder b;
+  b.Return(b.start(), b.start(), b.Binary(op, b.Parm(0), b.ConI(k)));
+  return b.Finish();
+}
+
+class PhasePipelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetLevel(LogLevel::ERROR);
+  }
+  void TearDown() override { Logger::SetLevel(level_); }
+
+  LogLevel level_ = LogLevel::INFO;
+};
+
+}  // namespace
+
+TEST_F(PhasePipelineTest, ReusesSignaturesAlongTheChain) {
+  std::unique_ptr<Graph> phases[] = {
+      Arith(Opcode::kAddI, 0), Arith(Opcode::kAddI, 0),
+      Arith(Opcode::kSubI, 0), Arith(Opcode::kSubI, 1)};
+  PhasePipeline pipeline(
+      {{Value::MakeI32(0)}, {Value::MakeI32(5)}, {Value::MakeI32(-9)}});
+  pipeline.set_proof_limits(std::nullopt);
+
+  EXPECT_FALSE(pipeline.Add(*phases[0]).has_value());
+  std::optional<PhasePair> pair = pipeline.Add(*phases[1]);
+  ASSERT_TRUE(pair.has_value());
+  EXPECT_EQ(pair->verdict, PhasePair::Verdict::kIdentical);
+  EXPECT_EQ(pair->changed_nodes, 0u);
+  EXPECT_EQ(pipeline.executions(), 0u);
+
+  pair = pipeline.Add(*phases[2]);
+  EXPECT_EQ(pair->verdict, PhasePair::Verdict::kAgree);
+  EXPECT_EQ(pair->before, 1u);
+  EXPECT_EQ(pair->after, 2u);
+  EXPECT_EQ(pipeline.executions(), 2u);
+
+  // Phase 2 is not run again
+  pair = pipeline.Add(*phases[3]);
+  EXPECT_EQ(pair->verdict, PhasePair::Verdict::kDiffer);
+  EXPECT_EQ(pipeline.executions(), 3u);
+  ASSERT_TRUE(pair->input.has_value());
+  EXPECT_EQ(*pair->input, 0u);
+  EXPECT_EQ(pair->before_result.ToString(), "return i32:0");
+  EXPECT_EQ(pair->after_result.ToString(), "return i32:-1");
+  EXPECT_EQ(pipeline.num_phases(), 4u);
+}
+
+TEST_F(PhasePipelineTest, ProvenPairsAreNotRun) {
+  std::unique_ptr<Graph> phases[] = {
+      Arith(Opcode::kAddI, 0), Arith(Opcode::kSubI, 0),
+      Arith(Opcode::kXorI, 0), Arith(Opcode::kOrI, 1)};
+  PhasePipeline pipeline({{Value::MakeI32(6)}, {Value::MakeI32(-1)}});
+  pipeline.Add(*phases[0]);
+  EXPECT_EQ(pipeline.Add(*phases[1])->verdict, PhasePair::Verdict::kProven);
+  EXPECT_EQ(pipeline.Add(*phases[2])->verdict, PhasePair::Verdict::kProven);
+  EXPECT_EQ(pipeline.executions(), 0u);
+
+  std::optional<PhasePair> pair = pipeline.Add(*phases[3]);
+  EXPECT_EQ(pair->verdict, PhasePair::Verdict::kDiffer);
+  EXPECT_EQ(pipeline.executions(), 2u);
+  EXPECT_EQ(pair->before_result.ToString(), "return i32:6");
+  EXPECT_EQ(pair->after_result.ToString(), "return i32:7");
+}
+
+TEST_F(PhasePipelineTest, FixtureChainAgrees) {
+  GraphSession session;
+  ASSERT_GT(session.Load(getFixturePath("igv/GCD.xml")), 0u);
+  PhasePipeline pipeline({{Value::MakeI32(12), Value::MakeI32(18)},
+                          {Value::MakeI32(7), Value::MakeI32(0)},
+                          {Value::MakeI32(-4), Value::MakeI32(6)}});
+  size_t identical = 0;
+  for (size_t i = 0; i < session.num_graphs(); ++i) {
+    std::optional<PhasePair> pair = pipeline.Add(*session.graph(i));
+    if (!pair) continue;
+    EXPECT_NE(pair->verdict, PhasePair::Verdict::kDiffer)
+        << session.graph_name(i) << ": " << pair->before_result.ToString()
+        << " vs " << pair->after_result.ToString();
+    if (pair->verdict == PhasePair::Verdict::kIdentical) ++identical;
+  }
+  // Each phase ran at most once, and unchanged phases not at all
+  EXPECT_LE(pipeline.executions(), session.num_graphs() - identical);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+
 #include "suntv/interp/value.hpp"
 
 using namespace sun;
@@ -54,3 +57,20 @@ TEST(ValueTest, TypeCheckErrors) {
   EXPECT_THROW(v.as_bool(), std::runtime_error);
   EXPECT_THROW(v.as_ref(), std::runtime_error);
 }
+
+TEST(ValueTest, MakeFloat) {
+  Value f = Value::MakeF32(1.5f);
+  Value d = Value::MakeF64(-0.1);
+  EXPECT_TRUE(f.is_f32());
+  EXPECT_TRUE(d.is_f64());
+  EXPECT_EQ(f.as_f32(), 1.5f);
+  EXPECT_EQ(d.as_f64(), -0.1);
+  EXPECT_THROW(f.as_f64(), std::runtime_error);
+  EXPECT_THROW(d.as_i64(), std::runtime_error);
+
+  EXPECT_EQ(f.ToString(), "f32:1.5");
+  EXPECT_EQ(d.ToString(), "f64:-0.10000000000000001");
+  EXPECT_EQ(Value::MakeF64(-std::numeric_limits<double>::infinity()).ToString(),
+            "f64:-Infinity");
+  EXPECT_EQ(Value::MakeF32(std::nanf("")).ToString(), "f32:NaN");
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "suntv/ir/graph.hpp"
+#include "suntv/ir/node_table.hpp"
 
 using namespace sun;
 
@@ -115,3 +116,75 @@ TEST(GraphTest, BuildSimpleGraph) {
   EXPECT_EQ(ret->input(0), start);
   EXPECT_EQ(ret->input(1), add);
 }
+
+TEST(GraphTest, NodeStorageComesFromArena) {
+  Graph g;
+  const size_t before = g.arena().bytes_used();
+
+  Node* n = g.AddNode(1, Opcode::kConI);
+  n->set_prop("dump_spec", std::string(" #int:42 and a long trailing comment"));
+  n->set_prop("value", static_cast<int32_t>(42));
+  Node* add = g.AddNode(2, Opcode::kAddI);
+  add->AddInput(n);
+  add->AddInput(n);
+
+  EXPECT_GT(g.arena().bytes_used(), before + 2 * sizeof(Node));
+  EXPECT_EQ(std::get<std::string>(n->prop("dump_spec")),
+            " #int:42 and a long trailing comment");
+  EXPECT_EQ(std::get<int32_t>(n->prop("value")), 42);
+  EXPECT_EQ(add->input(1), n);
+}
+
+TEST(GraphTest, MemoryUsageCoversArenaAndNodes) {
+  Graph g;
+  GraphMemory empty = g.MemoryUsage();
+  EXPECT_EQ(empty.nodes, 0u);
+  EXPECT_EQ(empty.total(), empty.arena + empty.other);
+
+  Node* a = g.AddNode(1, Opcode::kConI);
+  a->set_prop("value", static_cast<int32_t>(1));
+  Node* add = g.AddNode(2, Opcode::kAddI);
+  add->AddInput(a);
+  add->AddInput(a);
+
+  GraphMemory m = g.MemoryUsage();
+  EXPECT_EQ(m.nodes, 2 * sizeof(Node));
+  EXPECT_GE(m.edges, 2 * sizeof(Node*));
+  EXPECT_GT(m.properties, 0u);
+  EXPECT_EQ(m.arena, g.arena().bytes_reserved());
+  EXPECT_LE(m.nodes + m.edges + m.properties, g.arena().bytes_used());
+  EXPECT_GE(m.other, sizeof(Graph) + 2 * sizeof(Node*));
+}
+
+TEST(GraphTest, NodeTablesAreIndexedByPosition) {
+  Graph g;
+  Node* a = g.AddNode(10, Opcode::kConI);
+  Node* b = g.AddNode(5, Opcode::kConI);
+  EXPECT_EQ(a->index(), 0u);
+  EXPECT_EQ(b->index(), 1u);
+
+  NodeTable<int> table;
+  table[b] = 7;
+  EXPECT_FALSE(table.contains(a));
+  ASSERT_NE(table.find(b), nullptr);
+  EXPECT_EQ(*table.find(b), 7);
+  EXPECT_FALSE(table.insert(b, 8));
+
+  // Cleared entries are gone and come back value-initialized
+  table.Clear();
+  EXPECT_FALSE(table.contains(b));
+  EXPECT_EQ(table[b], 0);
+  table.erase(b);
+  EXPECT_FALSE(table.contains(b));
+
+  NodeSet set;
+  EXPECT_TRUE(set.insert(a));
+  EXPECT_FALSE(set.insert(a));
+  set.Clear();
+  EXPECT_FALSE(set.contains(a));
+
+  Node standalone(1, Opcode::kConI);
+  EXPECT_EQ(standalone.index(), Node::kNoIndex);
+  EXPECT_FALSE(table.contains(&standalone));
+  EXPECT_THROW(table[&standalone], std::invalid_argument);
+}
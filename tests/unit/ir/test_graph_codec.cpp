@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "suntv/igv/session.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/graph_builder.hpp"
+#include "suntv/ir/graph_codec.hpp"
+#include "suntv/ir/structural_hash.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+// Everything EncodeGraph keeps, compared node by node
+void ExpectSameGraph(const Graph& a, const Graph& b) {
+  ASSERT_EQ(a.nodes().size(), b.nodes().size());
+  for (size_t i = 0; i < a.nodes().size(); ++i) {
+    const Node* x = a.nodes()[i];
+    const Node* y = b.nodes()[i];
+    EXPECT_EQ(x->id(), y->id());
+    EXPECT_EQ(x->opcode(), y->opcode());
+    EXPECT_EQ(x->type().kind(), y->type().kind());
+    ASSERT_EQ(x->constant() != nullptr, y->constant() != nullptr);
+    if (x->constant()) {
+      EXPECT_EQ(x->constant()->op, y->constant()->op);
+      EXPECT_EQ(x->constant()->value, y->constant()->value);
+    }
+    ASSERT_EQ(x->num_props(), y->num_props());
+    for (size_t p = 0; p < x->num_props(); ++p) {
+      EXPECT_EQ(x->prop_key(p), y->prop_key(p));
+      EXPECT_EQ(x->prop_value(p), y->prop_value(p));
+    }
+    ASSERT_EQ(x->num_inputs(), y->num_inputs());
+    for (size_t j = 0; j < x->num_inputs(); ++j) {
+      const Node* in = x->input(j);
+      EXPECT_EQ(in ? in->index() : Node::kNoIndex,
+                y->input(j) ? y->input(j)->index() : Node::kNoIndex);
+    }
+  }
+  EXPECT_EQ(a.start() ? a.start()->index() : Node::kNoIndex,
+            b.start() ? b.start()->index() : Node::kNoIndex);
+  EXPECT_EQ(a.root() ? a.root()->index() : Node::kNoIndex,
+            b.root() ? b.root()->index() : Node::kNoIndex);
+  ASSERT_EQ(a.schedule() != nullptr, b.schedule() != nullptr);
+  if (!a.schedule()) return;
+  const auto& blocks = a.schedule()->blocks();
+  ASSERT_EQ(blocks.size(), b.schedule()->blocks().size());
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    const Schedule::Block& y = b.schedule()->block(static_cast<uint32_t>(i));
+    EXPECT_EQ(blocks[i].name, y.name);
+    EXPECT_EQ(blocks[i].successors, y.successors);
+    ASSERT_EQ(blocks[i].nodes.size(), y.nodes.size());
+    for (size_t j = 0; j < y.nodes.size(); ++j) {
+      EXPECT_EQ(blocks[i].nodes[j]->index(), y.nodes[j]->index());
+    }
+  }
+}
+
+}  // namespace
+
+TEST(GraphCodecTest, RoundTripsEveryPhaseOfADump) {
+  LogLevel level = Logger::GetLevel();
+  Logger::SetLevel(LogLevel::ERROR);
+  GraphSession session;
+  ASSERT_GT(session.Load(getFixturePath("igv/BubbleSort.xml")), 0u);
+  Logger::SetLevel(level);
+
+  size_t scheduled = 0;
+  for (size_t i = 0; i < session.num_graphs(); ++i) {
+    const Graph& g = *session.graph(i);
+    const std::string bytes = EncodeGraph(g);
+    std::unique_ptr<Graph> back = DecodeGraph(bytes);
+    SCOPED_TRACE(session.graph_name(i));
+    ExpectSameGraph(g, *back);
+    EXPECT_EQ(StructuralHashes(*back).graph(), StructuralHashes(g).graph());
+    EXPECT_EQ(EncodeGraph(*back), bytes);
+    if (g.schedule()) ++scheduled;
+  }
+  EXPECT_GT(scheduled, 0u);
+}
+
+TEST(GraphCodecTest, DecodesIntoSharedTables) {
+  GraphBuilder b;
+  Node* con = b.ConI(-7);
+  b.Return(b.start(), b.start(), b.Binary(Opcode::kAddI, b.Parm(0), con));
+  std::unique_ptr<Graph> g = b.Finish();
+  con->set_constant(g->constants().Intern(Opcode::kConI, -7));
+  g->root()->set_prop("label", std::string("entry"));
+  g->root()->set_prop("wide", int64_t{1} << 40);
+  g->root()->set_prop("flag", true);
+  const std::string bytes = EncodeGraph(*g);
+
+  GraphSession session;
+  std::unique_ptr<Graph> x =
+      DecodeGraph(bytes, &session.strings(), &session.constants());
+  std::unique_ptr<Graph> y =
+      DecodeGraph(bytes, &session.strings(), &session.constants());
+  ExpectSameGraph(*g, *x);
+  EXPECT_EQ(x->root()->interned_prop("label"),
+            y->root()->interned_prop("label"));
+  const Node* decoded = x->nodes()[con->index()];
+  ASSERT_NE(decoded->constant(), nullptr);
+  EXPECT_EQ(decoded->constant()->value, -7);
+  EXPECT_EQ(decoded->constant(), y->nodes()[con->index()]->constant());
+}
+
+TEST(GraphCodecTest, RejectsMalformedBytes) {
+  GraphBuilder b;
+  b.Return(b.start(), b.start(), b.Parm(0));
+  const std::string bytes = EncodeGraph(*b.Finish());
+  EXPECT_THROW(DecodeGraph("not a graph"), std::runtime_error);
+  for (size_t cut = 0; cut < bytes.size(); ++cut) {
+    EXPECT_THROW(DecodeGraph(std::string_view(bytes).substr(0, cut)),
+                 std::runtime_error);
+  }
+  EXPECT_THROW(DecodeGraph(bytes + "x"), std::runtime_error);
+}
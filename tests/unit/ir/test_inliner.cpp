@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include "suntv/interp/interpreter.hpp"
+#include "suntv/interp/method_registry.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/inliner.hpp"
+
+using namespace sun;
+
+static Node* AddConI(Graph& g, NodeID id, int32_t v) {
+  Node* n = g.AddNode(id, Opcode::kConI);
+  n->set_prop("value", v);
+  return n;
+}
+
+static Node* AddParm(Graph& g, NodeID id, Node* start, int32_t index) {
+  Node* n = g.AddNode(id, Opcode::kParm);
+  n->set_input(0, start);
+  n->set_prop("index", index);
+  return n;
+}
+
+static Node* AddProj(Graph& g, NodeID id, Node* src, int32_t con) {
+  Node* n = g.AddNode(id, Opcode::kProj);
+  n->set_input(0, src);
+  n->set_prop("con", con);
+  return n;
+}
+
+static Node* AddCall(Graph& g, NodeID id, Node* ctrl, Node* mem,
+                     const std::string& spec, std::vector<Node*> args) {
+  Node* call = g.AddNode(id, Opcode::kCallStaticJava);
+  call->set_input(0, ctrl);
+  call->set_input(1, ctrl);
+  call->set_input(2, mem);
+  call->set_input(3, ctrl);
+  call->set_input(4, ctrl);
+  for (size_t i = 0; i < args.size(); ++i) call->set_input(5 + i, args[i]);
+  call->set_prop("dump_spec", spec);
+  return call;
+}
+
+static size_t CountOpcode(const Graph& g, Opcode op) {
+  size_t count = 0;
+  for (const Node* n : g.nodes()) count += n->opcode() == op;
+  return count;
+}
+
+// int max(int a, int b) { if (a > b) return a; return b; }
+static void BuildMax(Graph& g) {
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* a = AddParm(g, 2, start, 0);
+  Node* b = AddParm(g, 3, start, 1);
+  Node* cmp = g.AddNode(4, Opcode::kCmpI);
+  cmp->set_input(0, a);
+  cmp->set_input(1, b);
+  Node* test = g.AddNode(5, Opcode::kBool);
+  test->set_input(0, cmp);
+  test->set_prop("mask", static_cast<int32_t>(4));  // GT
+  Node* iff = g.AddNode(6, Opcode::kIf);
+  iff->set_input(0, start);
+  iff->set_input(1, test);
+  Node* if_true = g.AddNode(7, Opcode::kIfTrue);
+  if_true->set_input(0, iff);
+  Node* if_false = g.AddNode(8, Opcode::kIfFalse);
+  if_false->set_input(0, iff);
+  Node* ret_a = g.AddNode(9, Opcode::kReturn);
+  ret_a->set_input(0, if_true);
+  ret_a->set_input(1, a);
+  Node* ret_b = g.AddNode(10, Opcode::kReturn);
+  ret_b->set_input(0, if_false);
+  ret_b->set_input(1, b);
+  root->set_input(0, ret_a);
+  root->set_input(1, ret_b);
+}
+
+// int fact(int n) { return n > 1 ? n * fact(n - 1) : 1; }
+static void BuildFact(Graph& g) {
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* n = AddParm(g, 2, start, 0);
+  Node* one = AddConI(g, 3, 1);
+  Node* cmp = g.AddNode(4, Opcode::kCmpI);
+  cmp->set_input(0, n);
+  cmp->set_input(1, one);
+  Node* test = g.AddNode(5, Opcode::kBool);
+  test->set_input(0, cmp);
+  test->set_prop("mask", static_cast<int32_t>(4));  // GT
+  Node* iff = g.AddNode(6, Opcode::kIf);
+  iff->set_input(0, start);
+  iff->set_input(1, test);
+  Node* if_true = g.AddNode(7, Opcode::kIfTrue);
+  if_true->set_input(0, iff);
+  Node* if_false = g.AddNode(8, Opcode::kIfFalse);
+  if_false->set_input(0, iff);
+
+  Node* sub = g.AddNode(9, Opcode::kSubI);
+  sub->set_input(0, n);
+  sub->set_input(1, one);
+  Node* call = AddCall(g, 10, if_true, start,
+                       "# Static  Rec::fact int ( int ) C=0.000100", {sub});
+  Node* call_ctrl = AddProj(g, 11, call, 0);
+  Node* call_res = AddProj(g, 12, call, 5);
+  Node* mul = g.AddNode(13, Opcode::kMulI);
+  mul->set_input(0, n);
+  mul->set_input(1, call_res);
+
+  Node* region = g.AddNode(14, Opcode::kRegion);
+  region->set_input(0, call_ctrl);
+  region->set_input(1, if_false);
+  Node* phi = g.AddNode(15, Opcode::kPhi);
+  phi->set_input(0, region);
+  phi->set_input(1, mul);
+  phi->set_input(2, one);
+  Node* ret = g.AddNode(16, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, region);
+  ret->set_input(1, phi);
+}
+
+// return M.max(a, b) * 10 (call result through Proj #5)
+static void BuildCallsMax(Graph& g) {
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* a = AddParm(g, 2, start, 0);
+  Node* b = AddParm(g, 3, start, 1);
+  Node* call =
+      AddCall(g, 4, start, start, "# Static  M::max int ( int, int )", {a, b});
+  Node* ctrl = AddProj(g, 5, call, 0);
+  Node* res = AddProj(g, 6, call, 5);
+  Node* mul = g.AddNode(7, Opcode::kMulI);
+  mul->set_input(0, res);
+  mul->set_input(1, AddConI(g, 8, 10));
+  Node* ret = g.AddNode(9, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, ctrl);
+  ret->set_input(1, mul);
+}
+
+static int32_t Interpret(const Graph& g, std::vector<Value> args,
+                         MethodRegistry* registry = nullptr) {
+  Interpreter interp(g, registry);
+  Outcome outcome = interp.Execute(args);
+  EXPECT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  return outcome.return_value.value_or(Value::MakeI32(-1)).as_i32();
+}
+
+TEST(InlinerTest, MergesCalleeReturns) {
+  Graph callee;
+  BuildMax(callee);
+  Graph caller;
+  BuildCallsMax(caller);
+  CalleeLibrary library;
+  library.Add("M::max(int,int)", callee);
+
+  InlineStats stats;
+  std::unique_ptr<Graph> out = InlineCalls(caller, library, {}, &stats);
+  EXPECT_EQ(stats.inlined, 1);
+  EXPECT_EQ(stats.max_depth_seen, 1);
+  EXPECT_EQ(CountOpcode(*out, Opcode::kCallStaticJava), 0u);
+  EXPECT_EQ(CountOpcode(*out, Opcode::kReturn), 1u);
+
+  // Caller nodes keep their IDs; callee nodes are numbered above them
+  ASSERT_NE(out->node(9), nullptr);
+  EXPECT_EQ(out->node(9)->opcode(), Opcode::kReturn);
+  EXPECT_EQ(out->node(4), nullptr);  // The call is gone
+  for (const Node* n : out->nodes()) {
+    if (n->opcode() == Opcode::kIf) {
+      EXPECT_GT(n->id(), 9);
+    }
+  }
+
+  EXPECT_EQ(Interpret(*out, {Value::MakeI32(7), Value::MakeI32(3)}), 70);
+  EXPECT_EQ(Interpret(*out, {Value::MakeI32(-2), Value::MakeI32(5)}), 50);
+}
+
+TEST(InlinerTest, RecursionStopsAtDepthLimit) {
+  Graph fact;
+  BuildFact(fact);
+  CalleeLibrary library;
+  library.Add("Rec::fact", fact);
+
+  InlineOptions options;
+  options.max_depth = 3;
+  InlineStats stats;
+  std::unique_ptr<Graph> out = InlineCalls(fact, library, options, &stats);
+  EXPECT_EQ(stats.inlined, 3);
+  EXPECT_EQ(stats.depth_limited, 1);
+  EXPECT_EQ(stats.max_depth_seen, 3);
+  EXPECT_EQ(CountOpcode(*out, Opcode::kCallStaticJava), 1u);
+
+  // Shallow inputs never reach the remaining call; deeper ones run it
+  EXPECT_EQ(Interpret(*out, {Value::MakeI32(4)}), 24);
+  MethodRegistry registry;
+  registry.AddGraph("Rec::fact", fact);
+  EXPECT_EQ(Interpret(*out, {Value::MakeI32(7)}, &registry), 5040);
+}
+
+// Callee.fill(a) stores 7 into a[1]; the caller loads it through Proj #2
+TEST(InlinerTest, WiresMemoryThroughVoidCallee) {
+  Graph fill;
+  {
+    Node* root = fill.AddNode(0, Opcode::kRoot);
+    Node* start = fill.AddNode(1, Opcode::kStart);
+    Node* arr = AddParm(fill, 2, start, 0);
+    Node* store = fill.AddNode(5, Opcode::kStoreI);
+    store->set_input(0, start);
+    store->set_input(1, start);
+    store->set_input(2, arr);
+    store->set_input(3, AddConI(fill, 3, 1));
+    store->set_input(4, AddConI(fill, 4, 7));
+    store->set_prop("array", true);
+    Node* ret = fill.AddNode(6, Opcode::kReturn);
+    root->set_input(0, ret);
+    ret->set_input(0, start);
+    ret->set_input(1, start);
+    ret->set_input(2, store);
+  }
+
+  Graph g;
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* arr = g.AddNode(2, Opcode::kAllocateArray);
+  arr->set_input(0, start);
+  arr->set_input(1, AddConI(g, 3, 4));
+  Node* call = AddCall(g, 4, start, start,
+                       "# Static  Callee::fill void ( int[int+]:NotNull * )",
+                       {arr});
+  Node* call_ctrl = AddProj(g, 5, call, 0);
+  Node* call_mem = AddProj(g, 6, call, 2);
+  Node* load = g.AddNode(7, Opcode::kLoadI);
+  load->set_input(0, call_ctrl);
+  load->set_input(1, call_mem);
+  load->set_input(2, arr);
+  load->set_input(3, AddConI(g, 8, 1));
+  load->set_prop("array", true);
+  Node* ret = g.AddNode(9, Opcode::kReturn);
+  root->set_input(0, ret);
+  ret->set_input(0, call_ctrl);
+  ret->set_input(1, load);
+
+  CalleeLibrary library;
+  library.Add("Callee::fill", fill);
+  std::unique_ptr<Graph> out = InlineCalls(g, library);
+  EXPECT_EQ(CountOpcode(*out, Opcode::kCallStaticJava), 0u);
+  const Node* copy = out->node(7);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(copy->input(1)->opcode(), Opcode::kStoreI);
+  EXPECT_EQ(Interpret(*out, {}), 7);
+}
+
+TEST(InlinerTest, KeepsCallsItCannotRewire) {
+  Graph callee;
+  BuildMax(callee);
+  // A halting exit of the callee must survive inlining
+  Node* halt = callee.AddNode(11, Opcode::kHalt);
+  halt->set_input(0, callee.start());
+  callee.root()->AddInput(halt);
+
+  Graph caller;
+  BuildCallsMax(caller);
+  CalleeLibrary library;
+  library.Add("M::max", callee);
+
+  std::unique_ptr<Graph> out = InlineCalls(caller, library);
+  EXPECT_EQ(CountOpcode(*out, Opcode::kHalt), 1u);
+  bool root_has_halt = false;
+  for (size_t i = 0; i < out->root()->num_inputs(); ++i) {
+    const Node* in = out->root()->input(i);
+    root_has_halt = root_has_halt || (in && in->opcode() == Opcode::kHalt);
+  }
+  EXPECT_TRUE(root_has_halt);
+
+  // An exception-path user of the call is not one of the rewired outputs
+  Node* other = AddProj(caller, 20, caller.node(4), 7);
+  (void)other;
+  InlineStats stats;
+  out = InlineCalls(caller, library, {}, &stats);
+  EXPECT_EQ(stats.inlined, 0);
+  EXPECT_EQ(stats.unsupported, 1);
+  EXPECT_EQ(CountOpcode(*out, Opcode::kCallStaticJava), 1u);
+
+  // Unknown callees and uncommon traps stay as they are
+  CalleeLibrary empty;
+  stats = InlineStats();
+  out = InlineCalls(caller, empty, {}, &stats);
+  EXPECT_EQ(stats.unknown, 1);
+  EXPECT_EQ(out->nodes().size(), caller.nodes().size());
+}
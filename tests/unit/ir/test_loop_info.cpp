@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "suntv/igv/session.hpp"
+#include "suntv/ir/constant_pool.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/loop_info.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+static Node* AddConI(Graph& g, NodeID id, int32_t v) {
+  Node* n = g.AddNode(id, Opcode::kConI);
+  n->set_prop("value", v);
+  return n;
+}
+
+// for (i = init; i + stride < limit; i += stride) with a straight-line body
+TEST(LoopInfoTest, FindsCanonicalCountedLoop) {
+  Graph g;
+  Node* start = g.AddNode(1, Opcode::kStart);
+  Node* limit = g.AddNode(2, Opcode::kParm);
+  limit->set_input(0, start);
+  Node* init = AddConI(g, 3, 0);
+  Node* stride = AddConI(g, 4, 2);
+
+  Node* head = g.AddNode(5, Opcode::kCountedLoop);
+  head->set_prop("dump_spec", std::string("stride: 2 post of N7"));
+  Node* iv = g.AddNode(6, Opcode::kPhi);
+  Node* incr = g.AddNode(7, Opcode::kAddI);
+  Node* cmp = g.AddNode(8, Opcode::kCmpI);
+  Node* test = g.AddNode(9, Opcode::kBool);
+  Node* end = g.AddNode(10, Opcode::kCountedLoopEnd);
+  Node* back = g.AddNode(11, Opcode::kIfTrue);
+  Node* exit = g.AddNode(12, Opcode::kIfFalse);
+
+  head->set_input(0, head);
+  head->set_input(1, start);
+  head->set_input(2, back);
+  iv->set_input(0, head);
+  iv->set_input(1, init);
+  iv->set_input(2, incr);
+  incr->set_input(0, iv);
+  incr->set_input(1, stride);
+  cmp->set_input(0, incr);
+  cmp->set_input(1, limit);
+  test->set_input(0, cmp);
+  end->set_input(0, head);
+  end->set_input(1, test);
+  back->set_input(0, end);
+  exit->set_input(0, end);
+
+  std::vector<CountedLoopInfo> loops = FindCountedLoops(g);
+  ASSERT_EQ(loops.size(), 1u);
+  const CountedLoopInfo& loop = loops[0];
+  EXPECT_EQ(loop.head, head);
+  EXPECT_EQ(loop.end, end);
+  EXPECT_EQ(loop.back_control, back);
+  EXPECT_EQ(loop.exit, exit);
+  EXPECT_EQ(loop.test, test);
+  EXPECT_EQ(loop.iv, iv);
+  EXPECT_EQ(loop.init, init);
+  EXPECT_EQ(loop.incr, incr);
+  EXPECT_EQ(loop.limit, limit);
+  EXPECT_EQ(loop.stride, 2);
+  EXPECT_EQ(loop.kind, LoopKind::kPost);
+  EXPECT_EQ(loop.outer, nullptr);
+  EXPECT_TRUE(loop.straight_line());
+  ASSERT_EQ(loop.phis.size(), 1u);
+  EXPECT_EQ(loop.phis[0], iv);
+
+  // A trip counter that is not stepped by a constant is not counted
+  Node* step = g.AddNode(13, Opcode::kParm);
+  step->set_input(0, start);
+  incr->set_input(1, step);
+  EXPECT_TRUE(FindCountedLoops(g).empty());
+}
+
+// Factorial after loop opts: a strip-mined main loop unrolled 16x and a
+// post loop, each closing with CountedLoopEnd.
+TEST(LoopInfoTest, FindsSplitLoopsInC2Graph) {
+  GraphSession session;
+  ASSERT_TRUE(session.Load(getFixturePath("igv/Factorial.xml")));
+  const Graph* g = session.FindGraph("Optimize finished");
+  ASSERT_NE(g, nullptr);
+
+  std::vector<CountedLoopInfo> loops = FindCountedLoops(*g);
+  ASSERT_EQ(loops.size(), 2u);
+
+  const CountedLoopInfo& post = loops[0];
+  EXPECT_EQ(post.kind, LoopKind::kPost);
+  EXPECT_EQ(post.stride, 1);
+  EXPECT_EQ(post.outer, nullptr);
+  EXPECT_EQ(post.end->opcode(), Opcode::kCountedLoopEnd);
+
+  const CountedLoopInfo& main = loops[1];
+  EXPECT_EQ(main.kind, LoopKind::kMain);
+  EXPECT_EQ(main.stride, 16);
+  ASSERT_NE(main.outer, nullptr);
+  EXPECT_EQ(main.outer->opcode(), Opcode::kOuterStripMinedLoop);
+
+  for (const CountedLoopInfo& loop : loops) {
+    EXPECT_TRUE(loop.straight_line());
+    EXPECT_EQ(loop.iv->region_input(), loop.head);
+    EXPECT_EQ(loop.exit->opcode(), Opcode::kIfFalse);
+    EXPECT_NE(loop.limit, nullptr);
+  }
+}
+
+TEST(LoopInfoTest, DecodesSymbolicConstantBounds) {
+  EXPECT_EQ(ConstantPool::DecodeDumpSpec(Opcode::kConI, " #int:max"),
+            INT32_MAX);
+  EXPECT_EQ(ConstantPool::DecodeDumpSpec(Opcode::kConI, " #int:max-1"),
+            INT32_MAX - 1);
+  EXPECT_EQ(ConstantPool::DecodeDumpSpec(Opcode::kConI, " #int:min+3"),
+            INT32_MIN + 3);
+  EXPECT_EQ(ConstantPool::DecodeDumpSpec(Opcode::kConL, " #long:minint"),
+            INT32_MIN);
+  EXPECT_EQ(ConstantPool::DecodeDumpSpec(Opcode::kConL, " #long:maxint-15"),
+            INT32_MAX - 15);
+  EXPECT_EQ(ConstantPool::DecodeDumpSpec(Opcode::kConL, " #long:min"),
+            INT64_MIN);
+  EXPECT_EQ(ConstantPool::DecodeDumpSpec(Opcode::kConI, " #int:-146"), -146);
+  EXPECT_FALSE(ConstantPool::DecodeDumpSpec(Opcode::kConI, " #int:maxx"));
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "suntv/igv/session.hpp"
+#include "suntv/interp/interpreter.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/loop_info.hpp"
+#include "suntv/ir/mach_lowering.hpp"
+#include "suntv/ir/verifier.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+Node* AddInstruction(Graph& g, NodeID id, const std::string& name,
+                     const std::string& ideal, const std::string& spec = "") {
+  Node* n = g.AddNode(id, Opcode::kUnknown);
+  n->set_prop("name", name);
+  n->set_prop("idealOpcode", ideal);
+  n->set_prop("dump_spec", spec);
+  return n;
+}
+
+Node* AddStartProj(Graph& g, NodeID id, Node* start, int32_t con,
+                   const std::string& type) {
+  Node* n = g.AddNode(id, Opcode::kProj);
+  n->set_input(0, start);
+  n->set_prop("con", con);
+  n->set_prop("type", type);
+  return n;
+}
+
+// Every phase of one compilation, and the graphs before each
+struct Phases {
+  GraphSession session;
+
+  std::vector<const Graph*> Before(size_t i) const {
+    std::vector<const Graph*> history;
+    for (size_t j = 0; j < i; ++j) history.push_back(session.graph(j));
+    return history;
+  }
+};
+
+std::string RunToString(const Graph& g, const std::vector<Value>& inputs) {
+  try {
+    Interpreter interp(g);
+    return interp.Execute(inputs).ToString();
+  } catch (const std::exception& e) {
+    return std::string("error: ") + e.what();
+  }
+}
+
+}  // namespace
+
+TEST(MachLoweringTest, ImmediatesAndSpillCopies) {
+  // Ret(addI_rReg_imm #16 (TwoAddressSpillCopy (Parm0)))
+  Graph g;
+  Node* root = g.AddNode(0, Opcode::kRoot);
+  Node* start = g.AddNode(3, Opcode::kStart);
+  Node* ctrl = AddStartProj(g, 5, start, 0, "control");
+  Node* parm = AddStartProj(g, 10, start, 5, "int:");
+  Node* copy = AddInstruction(g, 20, "TwoAddressSpillCopy", "Node");
+  copy->set_input(1, parm);
+  Node* add =
+      AddInstruction(g, 21, "addI_rReg_imm", "AddI", "#16/0x00000010");
+  add->set_input(1, copy);
+  Node* ret = AddInstruction(g, 22, "Ret", "Return");
+  ret->set_input(0, ctrl);
+  ret->set_input(5, add);
+  root->set_input(0, root);
+  root->set_input(1, ret);
+  ASSERT_TRUE(IsMachGraph(g));
+
+  std::unique_ptr<Graph> lowered = LowerMachGraph(g, {});
+  EXPECT_FALSE(IsMachGraph(*lowered));
+  EXPECT_TRUE(VerifyGraph(*lowered).empty());
+  const Node* sum = lowered->node(21);
+  ASSERT_NE(sum, nullptr);
+  EXPECT_EQ(sum->opcode(), Opcode::kAddI);
+  EXPECT_EQ(sum->input(1), lowered->node(10));
+  EXPECT_EQ(sum->input(2)->opcode(), Opcode::kConI);
+  EXPECT_EQ(lowered->node(10)->opcode(), Opcode::kParm);
+  EXPECT_EQ(lowered->node(20), nullptr);
+
+  Interpreter interp(*lowered);
+  Outcome outcome = interp.Execute({Value::MakeI32(5)});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  EXPECT_EQ(outcome.return_value->as_i32(), 21);
+}
+
+// Post-matching phases of the scalar fixtures compute what the parsed
+// method does
+TEST(MachLoweringTest, MachPhasesAgreeWithParsedGraph) {
+  const std::vector<std::vector<Value>> inputs = {
+      {Value::MakeI32(-7), Value::MakeI32(12)},
+      {Value::MakeI32(0), Value::MakeI32(12)},
+      {Value::MakeI32(1), Value::MakeI32(3)},
+      {Value::MakeI32(5), Value::MakeI32(-12)},
+      {Value::MakeI32(13), Value::MakeI32(26)},
+      {Value::MakeI32(97), Value::MakeI32(2)}};
+  for (const char* file : {"Abs", "Factorial", "Fibonacci", "GCD", "IsPrime",
+                           "Max", "Power", "Sign"}) {
+    Phases p;
+    ASSERT_GT(p.session.Load(getFixturePath("igv/") + file + ".xml"), 0u);
+    const Graph* parsed = p.session.FindGraph("After Parsing");
+    ASSERT_NE(parsed, nullptr) << file;
+
+    int mach_phases = 0;
+    for (size_t i = 0; i < p.session.num_graphs(); ++i) {
+      const Graph* g = p.session.graph(i);
+      if (!IsMachGraph(*g)) continue;
+      ++mach_phases;
+      const std::string where = std::string(file) + " [" +
+                                p.session.graph_name(i) + "]";
+      std::unique_ptr<Graph> lowered = LowerMachGraph(*g, p.Before(i));
+      EXPECT_TRUE(VerifyGraph(*lowered).empty()) << where;
+      for (const auto& in : inputs) {
+        EXPECT_EQ(RunToString(*lowered, in), RunToString(*parsed, in))
+            << where << " on " << in[0].as_i32();
+      }
+    }
+    EXPECT_EQ(mach_phases, 3) << file;
+  }
+}
+
+TEST(MachLoweringTest, FinalCodeKeepsScheduleAndCountedLoops) {
+  Phases p;
+  ASSERT_GT(p.session.Load(getFixturePath("igv/Factorial.xml")), 0u);
+  size_t final_code = p.session.num_graphs();
+  for (size_t i = 0; i < p.session.num_graphs(); ++i) {
+    if (p.session.graph_name(i) == "Final Code") final_code = i;
+  }
+  ASSERT_LT(final_code, p.session.num_graphs());
+
+  std::unique_ptr<Graph> lowered =
+      LowerMachGraph(*p.session.graph(final_code), p.Before(final_code));
+  ASSERT_NE(lowered->schedule(), nullptr);
+  const Node* ret = lowered->node(105);
+  ASSERT_NE(ret, nullptr);
+  EXPECT_NE(lowered->schedule()->block_of(ret), Schedule::kNoBlock);
+
+  // Gotos and single-path Regions are bypassed, so the unrolled main loop
+  // is a canonical counted loop again and runs past the stepping limit
+  EXPECT_FALSE(FindCountedLoops(*lowered).empty());
+  Interpreter interp(*lowered);
+  Outcome outcome = interp.Execute({Value::MakeI32(1000)});
+  ASSERT_EQ(outcome.kind, Outcome::Kind::kReturn);
+  EXPECT_EQ(outcome.return_value->as_i32(), 0);
+}
+
+TEST(MachLoweringTest, ReportsWhatItCannotLower) {
+  Phases p;
+  ASSERT_GT(p.session.Load(getFixturePath("igv/ArraySum.xml")), 0u);
+  size_t matched = p.session.num_graphs();
+  for (size_t i = 0; i < p.session.num_graphs(); ++i) {
+    if (p.session.graph_name(i) == "After matching") matched = i;
+  }
+  ASSERT_LT(matched, p.session.num_graphs());
+  try {
+    LowerMachGraph(*p.session.graph(matched), p.Before(matched));
+    FAIL() << "memory operands are not lowered";
+  } catch (const std::runtime_error& e) {
+    EXPECT_NE(std::string(e.what()).find("memory"), std::string::npos)
+        << e.what();
+  }
+
+  // Branch conditions come from the ideal phases
+  Phases sign;
+  ASSERT_GT(sign.session.Load(getFixturePath("igv/Sign.xml")), 0u);
+  const Graph* final_code = sign.session.FindGraph("Final Code");
+  ASSERT_NE(final_code, nullptr);
+  EXPECT_THROW(LowerMachGraph(*final_code, {}), std::runtime_error);
+}
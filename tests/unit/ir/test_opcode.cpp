@@ -54,3 +54,64 @@ TEST(OpcodeTest, IsMemory) {
   EXPECT_FALSE(IsMemory(Opcode::kAddI));
   EXPECT_FALSE(IsMemory(Opcode::kReturn));
 }
+
+TEST(OpcodeTest, NameRoundTripForEveryOpcode) {
+  for (size_t i = 0; i < kNumOpcodes; ++i) {
+    Opcode op = static_cast<Opcode>(i);
+    EXPECT_EQ(StringToOpcode(OpcodeName(op)), op) << OpcodeName(op);
+    EXPECT_EQ(OpcodeToString(op), OpcodeName(op));
+  }
+}
+
+TEST(OpcodeTest, AliasesAndNearMisses) {
+  EXPECT_EQ(StringToOpcode("StartOSR"), Opcode::kStart);
+  EXPECT_EQ(StringToOpcode("Con"), Opcode::kConI);
+  EXPECT_EQ(StringToOpcode("MachProj"), Opcode::kProj);
+  EXPECT_EQ(StringToOpcode("Ret"), Opcode::kReturn);
+
+  // Lookup is exact: no case folding, trimming or prefix matching
+  EXPECT_EQ(StringToOpcode("addi"), Opcode::kUnknown);
+  EXPECT_EQ(StringToOpcode("AddI "), Opcode::kUnknown);
+  EXPECT_EQ(StringToOpcode("Add"), Opcode::kUnknown);
+  EXPECT_EQ(StringToOpcode("AddIX"), Opcode::kUnknown);
+}
+
+TEST(OpcodeTest, CategoriesAgreeWithSchemas) {
+  for (size_t i = 0; i < kNumOpcodes; ++i) {
+    Opcode op = static_cast<Opcode>(i);
+    NodeSchema s = GetSchema(op);
+    if (IsMerge(op)) {
+      EXPECT_EQ(s, NodeSchema::kS2_Merge) << OpcodeName(op);
+    }
+    if (IsPure(op)) {
+      EXPECT_EQ(s, NodeSchema::kS0_Pure) << OpcodeName(op);
+    }
+    if (s == NodeSchema::kS3_Load || s == NodeSchema::kS4_Store) {
+      EXPECT_TRUE(IsMemory(op)) << OpcodeName(op);
+    }
+    EXPECT_FALSE(IsPure(op) && IsMemory(op)) << OpcodeName(op);
+  }
+}
+
+TEST(OpcodeTest, LoopFamily) {
+  for (Opcode op : {Opcode::kLoop, Opcode::kCountedLoop,
+                    Opcode::kLongCountedLoop, Opcode::kOuterStripMinedLoop}) {
+    EXPECT_TRUE(IsRegion(op)) << OpcodeName(op);
+    EXPECT_TRUE(IsLoopHead(op)) << OpcodeName(op);
+    EXPECT_FALSE(IsLoopEnd(op)) << OpcodeName(op);
+    EXPECT_EQ(GetSchema(op), NodeSchema::kS2_Merge) << OpcodeName(op);
+  }
+  for (Opcode op : {Opcode::kCountedLoopEnd, Opcode::kLongCountedLoopEnd,
+                    Opcode::kOuterStripMinedLoopEnd}) {
+    EXPECT_TRUE(IsControl(op)) << OpcodeName(op);
+    EXPECT_TRUE(IsLoopEnd(op)) << OpcodeName(op);
+    EXPECT_FALSE(IsRegion(op)) << OpcodeName(op);
+    EXPECT_EQ(GetSchema(op), NodeSchema::kS1_Control) << OpcodeName(op);
+  }
+
+  EXPECT_TRUE(IsRegion(Opcode::kRegion));
+  EXPECT_FALSE(IsLoopHead(Opcode::kRegion));
+  EXPECT_FALSE(IsRegion(Opcode::kPhi));
+  EXPECT_FALSE(IsRegion(Opcode::kMergeMem));
+  EXPECT_FALSE(IsLoopEnd(Opcode::kIf));
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "suntv/igv/session.hpp"
+#include "suntv/ir/graph_builder.hpp"
+#include "suntv/ir/random_program.hpp"
+#include "suntv/ir/structural_hash.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+// Return(Parm0 * k + Parm1), with `dead` unused constants created first so
+// that node IDs shift
+std::unique_ptr<Graph> Build(int32_t k, int dead = 0) {
+  GraphBuilder b;
+  for (int i = 0; i < dead; ++i) b.ConI(1000 + i);
+  Node* scaled = b.Binary(Opcode::kMulI, b.Parm(0), b.ConI(k));
+  b.Return(b.start(), b.start(),
+           b.Binary(Opcode::kAddI, scaled, b.Parm(1)));
+  return b.Finish();
+}
+
+}  // namespace
+
+TEST(StructuralHashTest, IgnoresNodeIdsAndDeadNodes) {
+  std::unique_ptr<Graph> a = Build(3);
+  std::unique_ptr<Graph> b = Build(3, 5);
+  StructuralHashes ha(*a);
+  StructuralHashes hb(*b);
+  EXPECT_NE(ha.graph(), 0u);
+  EXPECT_EQ(ha.graph(), hb.graph());
+  EXPECT_EQ(ha.size(), hb.size());
+  EXPECT_EQ(hb.CountChanged(ha), 0u);
+
+  // The dead constants are not reachable
+  EXPECT_EQ(hb.of(b->nodes()[2]), 0u);
+}
+
+TEST(StructuralHashTest, ChangesPropagateToUsers) {
+  std::unique_ptr<Graph> a = Build(3);
+  std::unique_ptr<Graph> b = Build(4);
+  StructuralHashes ha(*a);
+  StructuralHashes hb(*b);
+  EXPECT_NE(ha.graph(), hb.graph());
+  // ConI, MulI, AddI, Return and Root
+  EXPECT_EQ(hb.CountChanged(ha), 5u);
+  EXPECT_EQ(ha.CountChanged(ha), 0u);
+}
+
+TEST(StructuralHashTest, LoopsHashDeterministically) {
+  int distinct = 0;
+  for (uint64_t seed = 1; seed <= 50; ++seed) {
+    RandomProgram program = RandomProgram::Generate(seed);
+    StructuralHashes a(*program.Lower());
+    StructuralHashes b(*program.Lower());
+    EXPECT_EQ(a.graph(), b.graph()) << seed;
+    StructuralHashes other(*RandomProgram::Generate(seed + 1000).Lower());
+    if (other.graph() != a.graph()) ++distinct;
+  }
+  EXPECT_EQ(distinct, 50);
+}
+
+TEST(StructuralHashTest, SharedPhasesOfADump) {
+  GraphSession session;
+  ASSERT_GT(session.Load(getFixturePath("igv/Factorial.xml")), 1u);
+  GraphSession again;
+  ASSERT_EQ(again.Load(getFixturePath("igv/Factorial.xml")),
+            session.num_graphs());
+  for (size_t i = 0; i < session.num_graphs(); ++i) {
+    EXPECT_EQ(StructuralHashes(*session.graph(i)).graph(),
+              StructuralHashes(*again.graph(i)).graph());
+  }
+  StructuralHashes parsed(*session.graph(0));
+  StructuralHashes last(*session.graph(session.num_graphs() - 1));
+  EXPECT_NE(parsed.graph(), last.graph());
+  EXPECT_GT(last.CountChanged(parsed), 0u);
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "suntv/igv/session.hpp"
+#include "suntv/ir/graph.hpp"
+#include "suntv/ir/random_program.hpp"
+#include "suntv/ir/verifier.hpp"
+
+using namespace sun;
+
+static std::string getFixturePath(const std::string& filename) {
+#ifndef SUN_TEST_FIXTURE_DIR
+#define SUN_TEST_FIXTURE_DIR "tests/fixtures"
+#endif
+  return std::string(SUN_TEST_FIXTURE_DIR) + "/" + filename;
+}
+
+namespace {
+
+// Start -> Return(Parm + 1) -> Root
+struct SmallGraph {
+  Graph g;
+  Node* start;
+  Node* parm;
+  Node* one;
+  Node* add;
+  Node* ret;
+
+  SmallGraph() {
+    start = g.AddNode(1, Opcode::kStart);
+    parm = g.AddNode(2, Opcode::kParm);
+    parm->set_input(0, start);
+    one = g.AddNode(3, Opcode::kConI);
+    one->set_prop("value", 1);
+    add = g.AddNode(4, Opcode::kAddI);
+    add->set_input(1, parm);
+    add->set_input(2, one);
+    ret = g.AddNode(5, Opcode::kReturn);
+    ret->set_input(0, start);
+    ret->set_input(1, add);
+    Node* root = g.AddNode(0, Opcode::kRoot);
+    root->set_input(0, ret);
+  }
+};
+
+std::vector<GraphIssue::Kind> Kinds(const std::vector<GraphIssue>& issues) {
+  std::vector<GraphIssue::Kind> kinds;
+  for (const GraphIssue& issue : issues) kinds.push_back(issue.kind);
+  return kinds;
+}
+
+}  // namespace
+
+TEST(VerifierTest, WellFormedGraphHasNoIssues) {
+  SmallGraph s;
+  EXPECT_TRUE(VerifyGraph(s.g).empty());
+}
+
+TEST(VerifierTest, ReportsDanglingInput) {
+  SmallGraph s;
+  Graph other;
+  Node* foreign = other.AddNode(4, Opcode::kConI);
+  s.add->set_input(2, foreign);
+
+  std::vector<GraphIssue> issues = VerifyGraph(s.g);
+  ASSERT_EQ(issues.size(), 1u);
+  EXPECT_EQ(issues[0].kind, GraphIssue::Kind::kDanglingInput);
+  EXPECT_EQ(issues[0].node, 4u);
+  EXPECT_EQ(issues[0].ToString(),
+            "dangling input at node 4: input 2 (node 4) is not in the graph");
+}
+
+TEST(VerifierTest, ReportsMissingValueInput) {
+  SmallGraph s;
+  s.add->set_input(2, nullptr);
+
+  std::vector<GraphIssue> issues = VerifyGraph(s.g);
+  ASSERT_EQ(issues.size(), 1u);
+  EXPECT_EQ(issues[0].kind, GraphIssue::Kind::kArity);
+  EXPECT_EQ(issues[0].node, 4u);
+}
+
+TEST(VerifierTest, ReportsPhiRegionMismatch) {
+  SmallGraph s;
+  Node* region = s.g.AddNode(10, Opcode::kRegion);
+  region->set_input(0, region);
+  region->set_input(1, s.start);
+  region->set_input(2, s.start);
+  Node* phi = s.g.AddNode(11, Opcode::kPhi);
+  phi->set_input(0, region);
+  phi->set_input(1, s.parm);
+  phi->set_input(2, s.one);
+  phi->set_input(3, s.add);
+  s.ret->set_input(0, region);
+  s.ret->set_input(1, phi);
+  EXPECT_TRUE(VerifyGraph(s.g).empty());
+
+  phi->AddInput(s.one);
+  std::vector<GraphIssue> issues = VerifyGraph(s.g);
+  ASSERT_EQ(issues.size(), 1u);
+  EXPECT_EQ(issues[0].kind, GraphIssue::Kind::kPhiRegion);
+  EXPECT_EQ(issues[0].node, 11u);
+
+  phi->set_input(0, s.start);
+  issues = VerifyGraph(s.g);
+  ASSERT_EQ(issues.size(), 1u);
+  EXPECT_EQ(issues[0].kind, GraphIssue::Kind::kPhiRegion);
+}
+
+TEST(VerifierTest, ValueCyclesMustPassAPhi) {
+  SmallGraph s;
+  Node* region = s.g.AddNode(10, Opcode::kLoop);
+  region->set_input(0, region);
+  region->set_input(1, s.start);
+  region->set_input(2, region);
+  Node* phi = s.g.AddNode(11, Opcode::kPhi);
+  phi->set_input(0, region);
+  phi->set_input(1, s.parm);
+  phi->set_input(2, s.add);
+  s.add->set_input(1, phi);
+  EXPECT_TRUE(VerifyGraph(s.g).empty());
+
+  // AddI 4 -> SubI 12 -> AddI 4
+  Node* sub = s.g.AddNode(12, Opcode::kSubI);
+  sub->set_input(1, s.add);
+  sub->set_input(2, s.one);
+  s.add->set_input(1, sub);
+  std::vector<GraphIssue> issues = VerifyGraph(s.g);
+  EXPECT_EQ(Kinds(issues),
+            std::vector<GraphIssue::Kind>{GraphIssue::Kind::kValueCycle});
+}
+
+TEST(VerifierTest, ReportsUnreachableControl) {
+  SmallGraph s;
+  Node* region = s.g.AddNode(10, Opcode::kRegion);
+  region->set_input(0, region);
+  Node* orphan = s.g.AddNode(11, Opcode::kIfTrue);
+  orphan->set_input(0, region);
+
+  std::vector<GraphIssue> issues = VerifyGraph(s.g);
+  ASSERT_EQ(issues.size(), 2u);
+  EXPECT_EQ(issues[0].kind, GraphIssue::Kind::kUnreachableControl);
+  EXPECT_EQ(issues[0].node, 10u);
+  EXPECT_EQ(issues[1].node, 11u);
+}
+
+TEST(VerifierTest, RandomProgramsVerify) {
+  for (uint64_t seed = 1; seed <= 200; ++seed) {
+    std::unique_ptr<Graph> graph = RandomProgram::Generate(seed).Lower();
+    std::vector<GraphIssue> issues = VerifyGraph(*graph);
+    EXPECT_TRUE(issues.empty())
+        << "seed " << seed << ": " << issues.front().ToString();
+  }
+}
+
+TEST(VerifierTest, IdealPhasesOfFixtureVerify) {
+  GraphSession session;
+  ASSERT_GT(session.Load(getFixturePath("igv/Factorial.xml")), 0u);
+  for (size_t i = 0; i < session.num_graphs(); ++i) {
+    // The CMoves of this dump lose a value input from here on
+    if (session.graph_name(i) == "Before matching") break;
+    std::vector<GraphIssue> issues = VerifyGraph(*session.graph(i));
+    EXPECT_TRUE(issues.empty())
+        << session.graph_name(i) << ": " << issues.front().ToString();
+  }
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "suntv/util/arena.hpp"
+
+using namespace sun;
+
+TEST(ArenaTest, AllocateRespectsAlignment) {
+  Arena arena;
+  for (size_t align : {1, 2, 4, 8, 16, 64}) {
+    arena.Allocate(3, 1);  // Skew the cursor
+    void* p = arena.Allocate(24, align);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % align, 0u);
+  }
+}
+
+TEST(ArenaTest, GrowsAcrossChunks) {
+  Arena arena(/*initial_chunk_size=*/256);
+  std::vector<int32_t*> ptrs;
+  for (int32_t i = 0; i < 1000; ++i) {
+    ptrs.push_back(arena.New<int32_t>(i));
+  }
+  for (int32_t i = 0; i < 1000; ++i) {
+    EXPECT_EQ(*ptrs[i], i);
+  }
+  EXPECT_GT(arena.num_chunks(), 1u);
+  EXPECT_GE(arena.bytes_reserved(), arena.bytes_used());
+  EXPECT_GE(arena.bytes_used(), 1000 * sizeof(int32_t));
+}
+
+TEST(ArenaTest, OversizedAllocationKeepsCurrentChunk) {
+  Arena arena(/*initial_chunk_size=*/1024);
+  char* a = static_cast<char*>(arena.Allocate(16, 1));
+  arena.Allocate(64 * 1024, 8);  // Dedicated chunk
+  char* b = static_cast<char*>(arena.Allocate(16, 1));
+  // Small allocations keep bumping in the original chunk.
+  EXPECT_EQ(b, a + 16);
+}
+
+TEST(ArenaTest, CopyString) {
+  Arena arena;
+  std::string src = "a string longer than the small-string buffer";
+  std::string_view copy = arena.CopyString(src);
+  src.assign(src.size(), 'x');
+  EXPECT_EQ(copy, "a string longer than the small-string buffer");
+  EXPECT_TRUE(arena.CopyString("").empty());
+}
+
+TEST(ArenaTest, BacksPmrContainers) {
+  Arena arena;
+  std::pmr::vector<std::pmr::string> v(&arena);
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back("element number " + std::to_string(i) + " of the vector");
+  }
+  EXPECT_EQ(v[42], "element number 42 of the vector");
+  EXPECT_EQ(v[42].get_allocator().resource(), &arena);
+  EXPECT_GT(arena.bytes_used(), 100 * sizeof(std::pmr::string));
+}
+
+TEST(ArenaTest, ReleaseResetsStatistics) {
+  Arena arena;
+  arena.Allocate(128);
+  EXPECT_GT(arena.bytes_used(), 0u);
+  arena.Release();
+  EXPECT_EQ(arena.bytes_used(), 0u);
+  EXPECT_EQ(arena.bytes_reserved(), 0u);
+  EXPECT_EQ(arena.num_chunks(), 0u);
+  // Usable again after release.
+  EXPECT_EQ(*arena.New<int64_t>(7), 7);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "suntv/util/bounded_queue.hpp"
+
+using namespace sun;
+
+TEST(BoundedQueueTest, FifoUpToCapacity) {
+  BoundedQueue<int> q(3);
+  EXPECT_EQ(q.capacity(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    int v = i;
+    EXPECT_TRUE(q.TryPush(v));
+  }
+  int extra = 4;
+  EXPECT_FALSE(q.TryPush(extra));
+  int v;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(q.TryPop(v));
+    EXPECT_EQ(v, i);
+  }
+  EXPECT_FALSE(q.TryPop(v));
+
+  // Close drains what is left
+  q.Push(7);
+  q.Close();
+  ASSERT_TRUE(q.Pop(v));
+  EXPECT_EQ(v, 7);
+  EXPECT_FALSE(q.Pop(v));
+}
+
+TEST(BoundedQueueTest, ManyProducersAndConsumers) {
+  // Capacity 2 keeps both sides blocking on each other
+  BoundedQueue<std::unique_ptr<int64_t>> q(2);
+  constexpr int64_t kPerProducer = 20000;
+  constexpr int kProducers = 4;
+  constexpr int kConsumers = 3;
+  std::atomic<int> producing{kProducers};
+  std::atomic<int64_t> sum{0};
+  std::atomic<int64_t> count{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int64_t i = 0; i < kPerProducer; ++i) {
+        q.Push(std::make_unique<int64_t>(p * kPerProducer + i));
+      }
+      if (--producing == 0) q.Close();
+    });
+  }
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      std::unique_ptr<int64_t> v;
+      while (q.Pop(v)) {
+        sum += *v;
+        ++count;
+      }
+    });
+  }
+  for (std::thread& t : threads) t.join();
+
+  const int64_t n = kProducers * kPerProducer;
+  EXPECT_EQ(count.load(), n);
+  EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
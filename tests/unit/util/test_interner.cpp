@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_set>
+
+#include "suntv/util/arena.hpp"
+#include "suntv/util/interner.hpp"
+
+using namespace sun;
+
+TEST(StringInternerTest, EqualStringsShareHandle) {
+  Arena arena;
+  StringInterner strings(arena);
+  std::string a = "dump_spec";
+  std::string b = std::string("dump_") + "spec";
+  InternedString ha = strings.Intern(a);
+  InternedString hb = strings.Intern(b);
+  EXPECT_EQ(ha, hb);
+  EXPECT_EQ(ha.view(), "dump_spec");
+  EXPECT_NE(ha.view().data(), a.data());  // Stored in the arena
+  EXPECT_EQ(strings.size(), 1u);
+}
+
+TEST(StringInternerTest, DistinctStringsGetDenseIds) {
+  Arena arena;
+  StringInterner strings(arena);
+  InternedString x = strings.Intern("x");
+  InternedString y = strings.Intern("y");
+  EXPECT_NE(x, y);
+  EXPECT_EQ(x.id(), 0u);
+  EXPECT_EQ(y.id(), 1u);
+  EXPECT_EQ(strings.Lookup(1), y);
+  EXPECT_FALSE(strings.Lookup(2));
+}
+
+TEST(StringInternerTest, FindDoesNotInsert) {
+  Arena arena;
+  StringInterner strings(arena);
+  EXPECT_FALSE(strings.Find("type"));
+  EXPECT_EQ(strings.size(), 0u);
+  InternedString t = strings.Intern("type");
+  EXPECT_EQ(strings.Find("type"), t);
+}
+
+TEST(StringInternerTest, HandlesAreHashable) {
+  Arena arena;
+  StringInterner strings(arena);
+  std::unordered_set<InternedString> set;
+  set.insert(strings.Intern("a"));
+  set.insert(strings.Intern("a"));
+  set.insert(strings.Intern(""));
+  EXPECT_EQ(set.size(), 2u);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+namespace {
+
+// Keeps what the writer thread hands it; read only after Logger::Flush
+class CaptureSink : public LogSink {
+ public:
+  explicit CaptureSink(std::vector<LogRecord>* out) : out_(out) {}
+  void Write(const LogRecord& record) override { out_->push_back(record); }
+
+ private:
+  std::vector<LogRecord>* out_;
+};
+
+class LoggingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    level_ = Logger::GetLevel();
+    Logger::SetSink(std::make_unique<CaptureSink>(&records_));
+  }
+  void TearDown() override {
+    Logger::SetSink(nullptr);
+    Logger::SetLevel(level_);
+  }
+
+  std::vector<LogRecord> records_;
+  LogLevel level_ = LogLevel::INFO;
+};
+
+}  // namespace
+
+TEST_F(LoggingTest, ThreadsLoseNothingAndKeepTheirOrder) {
+  Logger::SetLevel(LogLevel::DEBUG);
+  constexpr int kThreads = 8;
+  constexpr int kRecords = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t] {
+      LogContext context("g" + std::to_string(t));
+      for (int i = 0; i < kRecords; ++i) Logger::Debug(std::to_string(i));
+    });
+  }
+  for (std::thread& t : threads) t.join();
+  Logger::Flush();
+
+  // Exiting threads hand over what they buffered
+  ASSERT_EQ(records_.size(), static_cast<size_t>(kThreads * kRecords));
+  std::map<std::string, int> next;
+  std::map<std::string, uint32_t> thread_of;
+  for (const LogRecord& r : records_) {
+    EXPECT_EQ(r.level, LogLevel::DEBUG);
+    EXPECT_EQ(r.message, std::to_string(next[r.graph]++));
+    auto [it, fresh] = thread_of.emplace(r.graph, r.thread);
+    EXPECT_EQ(it->second, r.thread);
+  }
+  EXPECT_EQ(next.size(), static_cast<size_t>(kThreads));
+  EXPECT_EQ(thread_of.size(), static_cast<size_t>(kThreads));
+}
+
+TEST_F(LoggingTest, LevelFiltersAtTheCallSite) {
+  Logger::SetLevel(LogLevel::WARN);
+  EXPECT_FALSE(Logger::Enabled(LogLevel::INFO));
+  EXPECT_TRUE(Logger::Enabled(LogLevel::ERROR));
+  Logger::Info("dropped");
+  Logger::Warn("kept");
+  Logger::Error("also kept");
+  ASSERT_EQ(records_.size(), 2u);  // ERROR waits for the writer
+  EXPECT_EQ(records_[0].message, "kept");
+  EXPECT_EQ(records_[1].level, LogLevel::ERROR);
+}
+
+TEST_F(LoggingTest, ContextScopesNest) {
+  Logger::SetLevel(LogLevel::INFO);
+  Logger::Info("none");
+  {
+    LogContext outer("outer.xml", 3);
+    Logger::Info("outer");
+    {
+      LogContext::Node node(7);
+      Logger::Info("node");
+    }
+    Logger::Info("outer again");
+  }
+  Logger::Info("none again");
+  Logger::Flush();
+
+  ASSERT_EQ(records_.size(), 5u);
+  EXPECT_EQ(records_[0].graph, "");
+  EXPECT_EQ(records_[0].node, -1);
+  EXPECT_EQ(records_[1].graph, "outer.xml");
+  EXPECT_EQ(records_[1].node, 3);
+  EXPECT_EQ(records_[2].graph, "outer.xml");
+  EXPECT_EQ(records_[2].node, 7);
+  EXPECT_EQ(records_[3].node, 3);
+  EXPECT_EQ(records_[4].graph, "");
+  EXPECT_EQ(records_[4].node, -1);
+  EXPECT_LE(records_[0].time_ns, records_[4].time_ns);
+}
+
+TEST(LogSinkTest, TextShowsFieldsOnlyWhenSet) {
+  std::ostringstream out;
+  TextLogSink sink(out);
+  LogRecord plain;
+  plain.message = "hello";
+  sink.Write(plain);
+  LogRecord rich = plain;
+  rich.level = LogLevel::WARN;
+  rich.thread = 2;
+  rich.graph = "a.xml";
+  rich.node = 12;
+  sink.Write(rich);
+  EXPECT_EQ(out.str(), "[INFO] hello\n[WARN] [t2 a.xml #12] hello\n");
+}
+
+TEST(LogSinkTest, BinaryRoundTrips) {
+  std::stringstream buffer;
+  BinaryLogSink sink(buffer);
+  LogRecord a;
+  a.time_ns = 123456789;
+  a.level = LogLevel::TRACE;
+  a.thread = 5;
+  a.graph = "g";
+  a.node = 42;
+  a.message = std::string("with\0nul", 8);
+  LogRecord b;
+  b.message = "second";
+  sink.Write(a);
+  sink.Write(b);
+
+  std::string bytes = buffer.str();
+  auto ra = BinaryLogSink::Read(buffer);
+  auto rb = BinaryLogSink::Read(buffer);
+  ASSERT_TRUE(ra && rb);
+  EXPECT_EQ(ra->time_ns, a.time_ns);
+  EXPECT_EQ(ra->level, a.level);
+  EXPECT_EQ(ra->thread, a.thread);
+  EXPECT_EQ(ra->graph, a.graph);
+  EXPECT_EQ(ra->node, a.node);
+  EXPECT_EQ(ra->message, a.message);
+  EXPECT_EQ(rb->message, "second");
+  EXPECT_EQ(rb->node, -1);
+  EXPECT_FALSE(BinaryLogSink::Read(buffer));
+
+  std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+  EXPECT_TRUE(BinaryLogSink::Read(truncated));
+  EXPECT_FALSE(BinaryLogSink::Read(truncated));
+}
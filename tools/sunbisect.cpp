@@ -0,0 +1,256 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "suntv/igv/graph_store.hpp"
+#include "suntv/igv/session.hpp"
+#include "suntv/interp/bisect.hpp"
+#include "suntv/interp/minimize.hpp"
+#include "suntv/interp/phase_pipeline.hpp"
+#include "suntv/interp/value.hpp"
+#include "suntv/ir/mach_lowering.hpp"
+#include "suntv/util/cxxopts.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+// Phase i as the interpreter runs it: post-matching phases are lowered,
+// into `lowered`, using the phases before them
+const Graph& Runnable(const std::vector<const Graph*>& phases, size_t i,
+                      std::unique_ptr<Graph>& lowered) {
+  if (!IsMachGraph(*phases[i])) return *phases[i];
+  std::vector<const Graph*> history(phases.begin(), phases.begin() + i);
+  lowered = LowerMachGraph(*phases[i], history);
+  return *lowered;
+}
+
+// --witness: shrink the inputs on which phase `after` differs from phase
+// `before` and write them as an argument file for suni --args
+bool WriteWitness(const std::string& file,
+                  const std::vector<const Graph*>& phases, size_t before,
+                  size_t after, const std::vector<Value>& inputs,
+                  const std::vector<std::string>& comments) {
+  std::optional<MinimizeResult> min;
+  try {
+    std::unique_ptr<Graph> a;
+    std::unique_ptr<Graph> b;
+    min = MinimizeWitness(Runnable(phases, before, a),
+                          Runnable(phases, after, b),
+                          Witness::FromValues(inputs));
+  } catch (const std::exception& e) {
+    std::cerr << "Error: Cannot minimize: " << e.what() << "\n";
+    return false;
+  }
+  if (!min) {
+    std::cerr << "Error: Phases " << before << " and " << after
+              << " agree when run on their own\n";
+    return false;
+  }
+  std::vector<std::string> lines = comments;
+  lines.push_back("before: " + min->before.ToString());
+  lines.push_back("after:  " + min->after.ToString());
+  std::ofstream out(file);
+  out << WitnessFile(min->witness, lines);
+  if (!out) {
+    std::cerr << "Error: Cannot write '" << file << "'\n";
+    return false;
+  }
+  printf("minimized in %zu runs: %s (written to %s)\n", min->runs,
+         min->witness.ToString().c_str(), file.c_str());
+  return true;
+}
+
+int main(int argc, char** argv) {
+  cxxopts::Options options(
+      "sunbisect", "Find the first phase that changes a method's result");
+  // clang-format off
+  options.add_options()
+    ("igv-file", "IGV XML dump with every phase of the compilation", cxxopts::value<std::string>())
+    ("args", "Arguments: integers, longs (7L), doubles (1.5, NaN), floats (1.5f) or null", cxxopts::value<std::vector<std::string>>())
+    ("m,method", "Compilation to bisect (default: the first in the file)", cxxopts::value<std::string>())
+    ("s,store", "Read the compilation from this graph store instead of an IGV file", cxxopts::value<std::string>())
+    ("l,list", "List the phases and exit")
+    ("p,pairs", "Check every phase against the one before it instead")
+    ("v,verbose", "Print every phase executed")
+    ("w,witness", "Minimize the inputs of a difference and write them to FILE for suni --args", cxxopts::value<std::string>())
+    ("h,help", "Print help");
+  options.parse_positional({"igv-file", "args"});
+  options.positional_help("<igv-file> | --store DIR [-- args...]");
+  // clang-format on
+
+  try {
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help() << "\n";
+      return 0;
+    }
+    if (!result.count("igv-file") && !result.count("store")) {
+      std::cerr << "Error: No IGV file specified\n\n";
+      std::cout << options.help() << "\n";
+      return 1;
+    }
+
+    std::vector<std::string> args;
+    if (result.count("args")) {
+      args = result["args"].as<std::vector<std::string>>();
+    }
+    // With --store there is no file: the first positional is an argument
+    if (result.count("store") && result.count("igv-file")) {
+      args.insert(args.begin(), result["igv-file"].as<std::string>());
+    }
+    std::vector<Value> inputs;
+    for (const std::string& arg : args) {
+      try {
+        inputs.push_back(Value::Parse(arg));
+      } catch (const std::exception& e) {
+        std::cerr << "Error: Failed to parse argument '" << arg
+                  << "' as a number: " << e.what() << "\n";
+        return 1;
+      }
+    }
+
+    // The interpreter logs every node at INFO, and the parser warns about
+    // every post-matching instruction
+    Logger::SetLevel(LogLevel::ERROR);
+
+    // Every phase is loaded once; they share one string table and
+    // constant pool
+    const std::string path = result.count("store")
+                                 ? result["store"].as<std::string>()
+                                 : result["igv-file"].as<std::string>();
+    GraphSession session;
+    std::unique_ptr<GraphStore> store;
+    if (result.count("store")) {
+      // The first stored compilation of the method
+      try {
+        store = std::make_unique<GraphStore>(path);
+        for (const StoredCompilation& c : store->compilations()) {
+          if (!result.count("method") ||
+              c.method == result["method"].as<std::string>()) {
+            session.Load(*store, c);
+            break;
+          }
+        }
+      } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+      }
+    } else {
+      session.Load(path);
+    }
+    if (session.num_graphs() == 0) {
+      std::cerr << "Error: No graphs in '" << path << "'\n";
+      return 1;
+    }
+    const std::string method = result.count("method")
+                                   ? result["method"].as<std::string>()
+                                   : session.method_name(0);
+    std::vector<const Graph*> phases;
+    std::vector<size_t> index;  // Session index of each phase
+    for (size_t i = 0; i < session.num_graphs(); ++i) {
+      if (session.method_name(i) != method) continue;
+      phases.push_back(session.graph(i));
+      index.push_back(i);
+    }
+    if (phases.empty()) {
+      std::cerr << "Error: No compilation of '" << method << "' in '" << path
+                << "'\n";
+      return 1;
+    }
+    auto name = [&](size_t phase) {
+      return "[" + std::to_string(phase) + "] " +
+             session.graph_name(index[phase]);
+    };
+    const std::string witness =
+        result.count("witness") ? result["witness"].as<std::string>() : "";
+    auto write_witness = [&](size_t before, size_t after,
+                             const std::vector<Value>& args) {
+      const std::string replay =
+          store ? "suni --store " + path + " --args " + witness + " " +
+                      GraphStore::KeyString(GraphStore::Key(*phases[after]))
+                : "suni --phase '" + session.graph_name(index[after]) +
+                      "' --args " + witness + " " + path;
+      return WriteWitness(witness, phases, before, after, args,
+                          {"sunbisect: " + method + " " + name(before) +
+                               " -> " + name(after),
+                           "replay: " + replay});
+    };
+
+    if (result.count("list")) {
+      printf("%s: %zu phases\n", method.c_str(), phases.size());
+      for (size_t p = 0; p < phases.size(); ++p) {
+        printf("  %s\n", name(p).c_str());
+      }
+      return 0;
+    }
+
+    if (result.count("pairs")) {
+      PhasePipeline pipeline({inputs});
+      std::optional<PhasePair> first_differ;
+      for (const Graph* phase : phases) {
+        std::optional<PhasePair> pair = pipeline.Add(*phase);
+        if (!pair) continue;
+        printf("  %-40s %-9s %5zu nodes changed\n", name(pair->after).c_str(),
+               PhasePairVerdictName(pair->verdict), pair->changed_nodes);
+        if (pair->verdict != PhasePair::Verdict::kDiffer) continue;
+        if (!first_differ) first_differ = pair;
+        printf("    was %s, now %s\n", pair->before_result.ToString().c_str(),
+               pair->after_result.ToString().c_str());
+      }
+      printf("%s: %zu phases, %zu executed\n", method.c_str(), phases.size(),
+             pipeline.executions());
+      if (!first_differ) return 0;
+      if (!witness.empty()) {
+        write_witness(first_differ->before, first_differ->after, inputs);
+      }
+      return 1;
+    }
+
+    BisectReport report = BisectPhases(phases, inputs);
+    printf("%s: %zu phases, %zu executed\n", method.c_str(), phases.size(),
+           report.steps.size());
+    if (result.count("verbose")) {
+      for (const BisectStep& step : report.steps) {
+        printf("  %-40s %s\n", name(step.phase).c_str(),
+               step.result.ToString().c_str());
+      }
+    }
+    if (report.reference.kind == EngineResult::Kind::kError) {
+      printf("cannot run %s: %s\n", name(0).c_str(),
+             report.reference.message.c_str());
+      return 1;
+    }
+    if (!report.found()) {
+      printf("all runnable phases agree with %s: %s\n", name(0).c_str(),
+             report.reference.ToString().c_str());
+      return 0;
+    }
+
+    const size_t good = *report.good;
+    const size_t bad = *report.bad;
+    printf("first differing phase: %s\n", name(bad).c_str());
+    for (size_t p : {good, bad}) {
+      for (const BisectStep& step : report.steps) {
+        if (step.phase != p) continue;
+        printf("  %-40s %s\n", name(p).c_str(),
+               step.result.ToString().c_str());
+      }
+    }
+    if (bad - good > 1) {
+      printf("  phases %zu to %zu in between could not be run\n", good + 1,
+             bad - 1);
+    }
+    if (!witness.empty()) write_witness(good, bad, inputs);
+    return 1;
+
+  } catch (const cxxopts::exceptions::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    std::cout << options.help() << "\n";
+    return 1;
+  }
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "suntv/interp/conformance.hpp"
+#include "suntv/util/cxxopts.hpp"
+
+using namespace sun;
+
+int main(int argc, char** argv) {
+  cxxopts::Options options(
+      "sunconf", "Check engines against Java integer and conversion semantics");
+  // clang-format off
+  options.add_options()
+    ("e,engine", "Engine to check (repeatable; default: all)", cxxopts::value<std::vector<std::string>>())
+    ("o,op", "Op to check, e.g. DivI (repeatable; default: all)", cxxopts::value<std::vector<std::string>>())
+    ("n,samples", "Random operand pairs per op", cxxopts::value<uint64_t>()->default_value("1048576"))
+    ("s,seed", "Random seed", cxxopts::value<uint64_t>()->default_value("1"))
+    ("j,threads", "Worker threads (0 = hardware concurrency)", cxxopts::value<size_t>()->default_value("0"))
+    ("no-grid", "Skip the boundary grid")
+    ("list", "List engines and ops")
+    ("h,help", "Print help");
+  // clang-format on
+
+  try {
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help() << "\n";
+      return 0;
+    }
+
+    std::vector<ConformanceEngine> engines = Conformance::Engines();
+    if (result.count("list")) {
+      std::cout << "Engines:";
+      for (const ConformanceEngine& engine : engines) {
+        std::cout << " " << engine.name;
+      }
+      std::cout << "\nOps:";
+      for (size_t i = 0; i < kNumConformanceOps; ++i) {
+        std::cout << " " << Conformance::OpName(static_cast<ConformanceOp>(i));
+      }
+      std::cout << "\n";
+      return 0;
+    }
+
+    ConformanceOptions conf;
+    conf.samples = result["samples"].as<uint64_t>();
+    conf.seed = result["seed"].as<uint64_t>();
+    conf.num_threads = result["threads"].as<size_t>();
+    conf.grid = !result.count("no-grid");
+    if (result.count("op")) {
+      for (const std::string& name :
+           result["op"].as<std::vector<std::string>>()) {
+        auto op = Conformance::OpFromName(name);
+        if (!op) {
+          std::cerr << "Error: unknown op " << name << " (see --list)\n";
+          return 1;
+        }
+        conf.ops.push_back(*op);
+      }
+    }
+
+    std::vector<const ConformanceEngine*> selected;
+    if (result.count("engine")) {
+      for (const std::string& name :
+           result["engine"].as<std::vector<std::string>>()) {
+        const ConformanceEngine* found = nullptr;
+        for (const ConformanceEngine& engine : engines) {
+          if (engine.name == name) found = &engine;
+        }
+        if (!found) {
+          std::cerr << "Error: unknown engine " << name << " (see --list)\n";
+          return 1;
+        }
+        selected.push_back(found);
+      }
+    } else {
+      for (const ConformanceEngine& engine : engines) {
+        selected.push_back(&engine);
+      }
+    }
+
+    bool ok = true;
+    for (const ConformanceEngine* engine : selected) {
+      auto start = std::chrono::steady_clock::now();
+      ConformanceReport report = Conformance::Run(*engine, conf);
+      double seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+      printf("%s: %llu checks, %llu mismatches in %.2fs (%.0fM checks/s)\n",
+             engine->name.c_str(),
+             static_cast<unsigned long long>(report.checks),
+             static_cast<unsigned long long>(report.mismatches), seconds,
+             seconds > 0 ? report.checks / seconds / 1e6 : 0.0);
+      for (ConformanceOp op : report.skipped) {
+        printf("  skipped %s\n", std::string(Conformance::OpName(op)).c_str());
+      }
+      for (const ConformanceFailure& f : report.failures) {
+        std::string operands = f.lhs.ToString();
+        if (Conformance::Arity(f.op) == 2) operands += ", " + f.rhs.ToString();
+        printf("  %s(%s): expected %s, got %s\n",
+               std::string(Conformance::OpName(f.op)).c_str(),
+               operands.c_str(), f.expected.c_str(), f.actual.c_str());
+      }
+      ok = ok && report.ok();
+    }
+    return ok ? 0 : 1;
+
+  } catch (const cxxopts::exceptions::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    std::cout << options.help() << "\n";
+    return 1;
+  }
+}
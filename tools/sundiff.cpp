@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "suntv/interp/differential.hpp"
+#include "suntv/util/cxxopts.hpp"
+#include "suntv/util/logging.hpp"
+
+using namespace sun;
+
+int main(int argc, char** argv) {
+  cxxopts::Options options(
+      "sundiff", "Differential testing of engines on random graphs");
+  // clang-format off
+  options.add_options()
+    ("n,cases", "Random programs to generate", cxxopts::value<uint64_t>()->default_value("1000"))
+    ("s,seed", "Random seed", cxxopts::value<uint64_t>()->default_value("1"))
+    ("i,inputs", "Input vectors per program", cxxopts::value<int>()->default_value("8"))
+    ("j,threads", "Worker threads (0 = hardware concurrency)", cxxopts::value<size_t>()->default_value("0"))
+    ("replay", "Rerun one case by its case seed (same generator options)", cxxopts::value<uint64_t>())
+    ("no-shrink", "Report failures unshrunk")
+    ("no-loops", "Generate no loops")
+    ("no-memory", "Generate no field or array accesses")
+    ("no-exceptions", "Generate no DivI/ModI")
+    ("dump", "Dump the graph of the (shrunk) failing program")
+    ("h,help", "Print help");
+  // clang-format on
+
+  try {
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help() << "\n";
+      return 0;
+    }
+
+    // The interpreter logs every node at INFO
+    Logger::SetLevel(LogLevel::WARN);
+
+    DiffOptions diff;
+    diff.cases = result["cases"].as<uint64_t>();
+    diff.seed = result["seed"].as<uint64_t>();
+    diff.inputs_per_case = result["inputs"].as<int>();
+    diff.num_threads = result["threads"].as<size_t>();
+    diff.shrink = !result.count("no-shrink");
+    diff.program.loops = !result.count("no-loops");
+    diff.program.memory = !result.count("no-memory");
+    diff.program.exceptions = !result.count("no-exceptions");
+
+    std::vector<DiffEngine> engines = DifferentialTester::Engines();
+    std::optional<DiffFailure> failure;
+    if (result.count("replay")) {
+      failure = DifferentialTester::CheckCase(
+          engines, result["replay"].as<uint64_t>(), diff);
+      printf("replayed case %llu\n",
+             static_cast<unsigned long long>(result["replay"].as<uint64_t>()));
+    } else {
+      auto start = std::chrono::steady_clock::now();
+      DiffReport report = DifferentialTester::Run(engines, diff);
+      double seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+      printf("%llu cases, %llu runs in %.2fs (%.0f cases/s)\n",
+             static_cast<unsigned long long>(report.cases),
+             static_cast<unsigned long long>(report.runs), seconds,
+             seconds > 0 ? report.cases / seconds : 0.0);
+      printf("  %llu returned, %llu threw, %llu could not run\n",
+             static_cast<unsigned long long>(report.returns),
+             static_cast<unsigned long long>(report.throws),
+             static_cast<unsigned long long>(report.errors));
+      failure = report.failure;
+    }
+
+    if (!failure) {
+      printf("all %zu engines agree\n", engines.size());
+      return 0;
+    }
+    printf("%s", failure->ToString().c_str());
+    printf("replay with: sundiff --replay %llu\n",
+           static_cast<unsigned long long>(failure->case_seed));
+    if (result.count("dump")) failure->program.Lower()->Dump();
+    return 1;
+
+  } catch (const cxxopts::exceptions::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    std::cout << options.help() << "\n";
+    return 1;
+  }
+}
@@ -1,77 +1,413 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "suntv/igv/graph_store.hpp"
+#include "suntv/igv/igv_pipeline.hpp"
 #include "suntv/igv/parser.hpp"
 #include "suntv/interp/interpreter.hpp"
+#include "suntv/interp/method_registry.hpp"
+#include "suntv/interp/minimize.hpp"
 #include "suntv/interp/value.hpp"
 #include "suntv/ir/graph.hpp"
+#include "suntv/ir/inliner.hpp"
+#include "suntv/ir/mach_lowering.hpp"
+#include "suntv/util/logging.hpp"
 
 using namespace sun;
+namespace fs = std::filesystem;
 
-// Parse command-line integer argument to Value
-Value ParseIntArg(const std::string& arg) {
-  try {
-    // Try int32 first
-    int32_t val32 = std::stoi(arg);
-    return Value::MakeI32(val32);
-  } catch (const std::out_of_range&) {
-    // If out of range for int32, try int64
-    int64_t val64 = std::stoll(arg);
-    return Value::MakeI64(val64);
+// --stats: bytes held by the graphs, the interpreter and its last heap
+void PrintStats(const Graph& graph,
+                const std::vector<std::unique_ptr<Graph>>& callees,
+                const Interpreter& interp, const MethodRegistry& registry) {
+  GraphMemory g = graph.MemoryUsage();
+  size_t callee_bytes = 0;
+  for (const auto& callee : callees) {
+    callee_bytes += callee->MemoryUsage().total();
   }
+  InterpreterMemory m = interp.MemoryUsage();
+  printf("Memory (bytes):\n");
+  printf("  graph        %10zu  %zu nodes: %zu node, %zu edge, %zu property"
+         "\n",
+         g.total(), graph.nodes().size(), g.nodes, g.edges, g.properties);
+  printf("  callees      %10zu  %zu graphs\n", callee_bytes, callees.size());
+  printf("  interpreter  %10zu  %zu prepared, %zu last run\n",
+         m.total() - m.heap.total(), m.prepared, m.run);
+  printf("  heap         %10zu  %zu objects, %zu arrays\n", m.heap.total(),
+         m.heap.objects, m.heap.arrays);
+  printf("  frame cache  %10zu  %zu evicted\n", registry.frame_cache_bytes(),
+         registry.frame_cache_evictions());
 }
 
-int main(int argc, char** argv) {
-  if (argc < 2) {
-    std::cerr << "Usage: suni <graph.igv> [args...]\n";
-    std::cerr << "  <graph.igv>  Path to IGV graph file\n";
-    std::cerr << "  [args...]    Integer arguments to pass to the graph\n";
-    return 1;
+// Parse an IGV file, reporting errors on stderr; null on failure.
+std::unique_ptr<Graph> LoadGraph(const std::string& path) {
+  IGVParser parser;
+  try {
+    std::unique_ptr<Graph> graph = parser.Parse(path);
+    if (!graph) {
+      std::cerr << "Error: Failed to parse IGV file (null graph returned)\n";
+    }
+    return graph;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: Failed to parse IGV file '" << path
+              << "': " << e.what() << "\n";
+    return nullptr;
   }
+}
 
-  std::string graph_path = argv[1];
-
-  // Parse input arguments
-  std::vector<Value> inputs;
-  for (int i = 2; i < argc; ++i) {
+// --phase: the first graph of that name in an IGV file; post-matching
+// graphs are lowered to ideal form using the phases before them
+std::unique_ptr<Graph> LoadPhase(const std::string& path,
+                                 const std::string& phase) {
+  IGVParser parser;
+  std::vector<ParsedGraph> graphs;
+  try {
+    graphs = parser.ParseAll(path);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: Failed to parse IGV file '" << path
+              << "': " << e.what() << "\n";
+    return nullptr;
+  }
+  for (size_t i = 0; i < graphs.size(); ++i) {
+    if (graphs[i].name != phase) continue;
+    if (!IsMachGraph(*graphs[i].graph)) return std::move(graphs[i].graph);
+    std::vector<const Graph*> history;
+    for (size_t j = 0; j < i; ++j) {
+      if (graphs[j].method == graphs[i].method) {
+        history.push_back(graphs[j].graph.get());
+      }
+    }
     try {
-      Value v = ParseIntArg(argv[i]);
-      inputs.push_back(v);
+      return LowerMachGraph(*graphs[i].graph, history);
     } catch (const std::exception& e) {
-      std::cerr << "Error: Failed to parse argument '" << argv[i]
-                << "' as integer: " << e.what() << "\n";
-      return 1;
+      std::cerr << "Error: Cannot run '" << phase << "': " << e.what()
+                << "\n";
+      return nullptr;
     }
   }
+  std::cerr << "Error: No graph named '" << phase << "' in '" << path
+            << "'\n";
+  return nullptr;
+}
 
-  // Parse IGV graph
-  IGVParser parser;
-  std::unique_ptr<Graph> graph;
+// --store: the graph stored under a key (or a unique prefix of one); a
+// post-matching graph is lowered using the phases before it in the first
+// compilation that has it
+std::unique_ptr<Graph> LoadStored(const std::string& dir,
+                                  const std::string& prefix) {
   try {
-    graph = parser.Parse(graph_path);
-    if (!graph) {
-      std::cerr << "Error: Failed to parse IGV file (null graph returned)\n";
-      return 1;
+    GraphStore store(dir);
+    std::optional<uint64_t> key = store.Resolve(prefix);
+    if (!key) {
+      std::cerr << "Error: No single graph '" << prefix << "' in store '"
+                << dir << "'\n";
+      return nullptr;
     }
+    std::unique_ptr<Graph> graph = store.Load(*key);
+    if (!IsMachGraph(*graph)) return graph;
+    for (const StoredCompilation& c : store.compilations()) {
+      auto it = std::find_if(
+          c.phases.begin(), c.phases.end(),
+          [&](const StoredPhase& phase) { return phase.key == *key; });
+      if (it == c.phases.end()) continue;
+      std::vector<std::unique_ptr<Graph>> before;
+      std::vector<const Graph*> history;
+      for (auto p = c.phases.begin(); p != it; ++p) {
+        before.push_back(store.Load(p->key));
+        if (!before.back()) throw std::runtime_error("a phase is missing");
+        history.push_back(before.back().get());
+      }
+      return LowerMachGraph(*graph, history);
+    }
+    throw std::runtime_error("post-matching graph of no stored compilation");
   } catch (const std::exception& e) {
-    std::cerr << "Error: Failed to parse IGV file '" << graph_path
+    std::cerr << "Error: Cannot load '" << prefix << "' from store '" << dir
               << "': " << e.what() << "\n";
+    return nullptr;
+  }
+}
+
+// Settings that apply to every graph suni runs
+struct RunSettings {
+  std::vector<std::pair<std::string, const Graph*>> methods;  // --method
+  const CalleeLibrary* library = nullptr;                      // --inline
+  size_t heap_limit = 0;
+  size_t frame_cache_limit = 0;
+  std::string phase;
+};
+
+// --corpus: run every graph (or every graph named --phase) of many dumps
+// and graph stores through the load-and-execute pipeline and print one line
+// per graph, in corpus order
+int RunCorpus(const std::vector<std::string>& inputs, size_t jobs,
+              const RunSettings& settings, const Witness& args,
+              bool stats) {
+  std::vector<std::string> files;
+  for (const std::string& input : inputs) {
+    if (!fs::is_directory(input) || GraphStore::IsStore(input)) {
+      files.push_back(input);
+      continue;
+    }
+    std::vector<std::string> found;
+    for (const auto& entry : fs::recursive_directory_iterator(input)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".xml") {
+        found.push_back(entry.path().string());
+      }
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+  }
+
+  // The interpreter logs every node at INFO
+  Logger::SetLevel(LogLevel::ERROR);
+
+  PipelineOptions options;
+  options.parse_threads = jobs;
+  options.canonicalize_threads = jobs;
+  options.execute_threads = jobs;
+  if (!settings.phase.empty()) {
+    options.select = [&](const IGVGraphRef& ref) {
+      return ref.name == settings.phase;
+    };
+  }
+
+  // Call frames are cached per registry, so each worker gets its own
+  std::vector<std::unique_ptr<MethodRegistry>> registries(
+      IGVPipeline::Threads(jobs));
+  auto execute = [&](PipelineGraph& g, size_t worker) {
+    if (IsMachGraph(*g.graph)) {
+      throw std::runtime_error(
+          "post-matching phase: lowering needs the phases before it "
+          "(run its dump with --phase, or its key with --store)");
+    }
+    std::unique_ptr<MethodRegistry>& registry = registries[worker];
+    if (!registry) {
+      registry = std::make_unique<MethodRegistry>();
+      registry->AddJavaLangMath();
+      registry->set_frame_cache_limit(settings.frame_cache_limit);
+      for (const auto& [method, callee] : settings.methods) {
+        registry->AddGraph(method, *callee);
+      }
+    }
+    std::unique_ptr<Graph> inlined;
+    if (settings.library) inlined = InlineCalls(*g.graph, *settings.library);
+    ConcreteHeap heap;
+    std::vector<Value> inputs = args.Materialize(heap);
+    Interpreter interp(inlined ? *inlined : *g.graph, registry.get());
+    interp.set_heap_limit(settings.heap_limit);
+    g.output = interp.ExecuteWithHeap(inputs, heap).ToString();
+  };
+
+  uint64_t errors = 0;
+  auto write = [&](const PipelineGraph& g) {
+    if (!g.error.empty()) ++errors;
+    // Stored graphs are named by their key
+    const std::string where =
+        g.key != 0 ? GraphStore::KeyString(g.key) + " " + g.method
+                   : g.method + " [" + std::to_string(g.index) + "]";
+    printf("%s: %s %s: %s\n", files[g.file].c_str(), where.c_str(),
+           g.name.c_str(),
+           g.error.empty() ? g.output.c_str()
+                           : ("Error: " + g.error).c_str());
+  };
+
+  PipelineStats result = IGVPipeline::Run(files, execute, write, options);
+  printf("%zu graphs run, %zu errors\n", static_cast<size_t>(result.graphs),
+         static_cast<size_t>(errors));
+  if (stats) printf("%s", result.ToString().c_str());
+  return result.files_failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  // Callees for CallStaticJava: --method Holder::name=callee.igv, run as
+  // nested frames or, with --inline, spliced into the caller
+  MethodRegistry registry;
+  registry.AddJavaLangMath();
+  CalleeLibrary library;
+  std::vector<std::unique_ptr<Graph>> callees;
+  bool inline_calls = false;
+  bool stats = false;
+  size_t heap_limit = 0;
+  RunSettings settings;
+  std::string& phase = settings.phase;
+  std::string args_file;
+  std::string store;
+  std::vector<std::string> corpus;
+  size_t jobs = 0;
+  int first = 1;
+  for (; first < argc; ++first) {
+    const std::string opt = argv[first];
+    if (opt == "--inline") {
+      inline_calls = true;
+      continue;
+    }
+    if (opt == "--stats") {
+      stats = true;
+      continue;
+    }
+    if (opt == "--phase" && first + 1 < argc) {
+      phase = argv[++first];
+      continue;
+    }
+    if (opt == "--args" && first + 1 < argc) {
+      args_file = argv[++first];
+      continue;
+    }
+    if (opt == "--store" && first + 1 < argc) {
+      store = argv[++first];
+      continue;
+    }
+    if (opt == "--corpus" && first + 1 < argc) {
+      corpus.push_back(argv[++first]);
+      continue;
+    }
+    if ((opt == "--heap-limit-mb" || opt == "--frame-cache-mb" ||
+         opt == "--jobs") &&
+        first + 1 < argc) {
+      size_t n;
+      try {
+        n = std::stoul(argv[++first]);
+      } catch (const std::exception&) {
+        std::cerr << "Error: " << opt << " expects a number\n";
+        return 1;
+      }
+      if (opt == "--jobs") {
+        jobs = n;
+      } else if (opt == "--heap-limit-mb") {
+        heap_limit = n << 20;
+      } else {
+        settings.frame_cache_limit = n << 20;
+        registry.set_frame_cache_limit(n << 20);
+      }
+      continue;
+    }
+    if (opt != "--method" || first + 1 >= argc) break;
+    const std::string spec = argv[++first];
+    const size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0) {
+      std::cerr << "Error: --method expects Holder::name=callee.igv, got '"
+                << spec << "'\n";
+      return 1;
+    }
+    std::unique_ptr<Graph> callee = LoadGraph(spec.substr(eq + 1));
+    if (!callee) return 1;
+    registry.AddGraph(spec.substr(0, eq), *callee);
+    library.Add(spec.substr(0, eq), *callee);
+    settings.methods.emplace_back(spec.substr(0, eq), callee.get());
+    callees.push_back(std::move(callee));
+  }
+
+  if (first >= argc && corpus.empty()) {
+    std::cerr << "Usage: suni [--inline] [--stats] [--heap-limit-mb N] "
+                 "[--frame-cache-mb N]\n"
+                 "            [--phase NAME] [--args FILE] "
+                 "[--method Holder::name=callee.igv]... "
+                 "<graph.igv> [args...]\n"
+                 "       suni [options] --store DIR <key> [args...]\n"
+                 "       suni [options] --corpus <igv-file|dir|store>... "
+                 "[--jobs N] [args...]\n";
+    std::cerr << "  --inline     Splice the --method graphs into the caller\n";
+    std::cerr << "               before running instead of calling them\n";
+    std::cerr << "  --method     Run calls to Holder::name (or\n";
+    std::cerr << "               Holder::name(int,long) for one overload) on\n";
+    std::cerr << "               the callee graph; java.lang.Math max, min,\n";
+    std::cerr << "               abs and sqrt are built in\n";
+    std::cerr << "  --phase NAME Run the first graph of that name instead\n";
+    std::cerr << "               of the first graph; post-matching phases\n";
+    std::cerr << "               (\"Final Code\") are lowered to ideal form\n";
+    std::cerr << "  --args FILE  Take the arguments from a witness file\n";
+    std::cerr << "               (as sunbisect --witness writes); lines\n";
+    std::cerr << "               starting with '#' are comments\n";
+    std::cerr << "  --stats      Print the memory held by graphs,\n";
+    std::cerr << "               interpreter and heap after the run\n";
+    std::cerr << "  --store DIR  Run the graph stored under <key> (16 hex\n";
+    std::cerr << "               digits, or a unique prefix) in the graph\n";
+    std::cerr << "               store DIR (see sunigv store)\n";
+    std::cerr << "  --corpus PATH\n";
+    std::cerr << "               Run every graph (every graph named by\n";
+    std::cerr << "               --phase) of the dumps in PATH, a file, a\n";
+    std::cerr << "               graph store or a directory searched for\n";
+    std::cerr << "               *.xml, through a read/parse/canonicalize/\n";
+    std::cerr << "               execute pipeline; repeatable. --stats\n";
+    std::cerr << "               prints stage times\n";
+    std::cerr << "  --jobs N     Threads per --corpus pool (default: all\n";
+    std::cerr << "               cores)\n";
+    std::cerr << "  --heap-limit-mb N\n";
+    std::cerr << "               Fail the run when its heap passes N MiB\n";
+    std::cerr << "  --frame-cache-mb N\n";
+    std::cerr << "               Evict cached callee frames past N MiB\n";
+    std::cerr << "  <graph.igv>  Path to IGV graph file\n";
+    std::cerr << "  [args...]    Arguments to pass to the graph: integers, or\n";
+    std::cerr << "               doubles (1.5, NaN), floats (1.5f), longs\n";
+    std::cerr << "               (7L), null and arrays ([1,2], long[1,2],\n";
+    std::cerr << "               float[..], double[..]) passed by reference\n";
     return 1;
   }
 
+  // Parse input arguments; arrays are allocated on the initial heap
+  std::vector<std::string> tokens(argv + first + (corpus.empty() ? 1 : 0),
+                                  argv + argc);
+  Witness args;
+  try {
+    args = args_file.empty() ? Witness::Parse(tokens)
+                             : Witness::Load(args_file);
+    if (!args_file.empty() && !tokens.empty()) {
+      throw std::invalid_argument("arguments given with --args");
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error: Failed to parse arguments: " << e.what() << "\n";
+    return 1;
+  }
+  if (!corpus.empty()) {
+    if (inline_calls) settings.library = &library;
+    settings.heap_limit = heap_limit;
+    return RunCorpus(corpus, jobs, settings, args, stats);
+  }
+  ConcreteHeap heap;
+  std::vector<Value> inputs = args.Materialize(heap);
+
+  // Parse IGV graph, or load it from the store
+  std::string graph_path = argv[first];
+  std::unique_ptr<Graph> graph =
+      !store.empty()  ? LoadStored(store, graph_path)
+      : phase.empty() ? LoadGraph(graph_path)
+                      : LoadPhase(graph_path, phase);
+  if (!graph) return 1;
+  if (inline_calls) {
+    try {
+      graph = InlineCalls(*graph, library);
+    } catch (const std::exception& e) {
+      std::cerr << "Error: Inlining failed: " << e.what() << "\n";
+      return 1;
+    }
+  }
+
   // Execute graph
-  Interpreter interp(*graph);
+  Interpreter interp(*graph, &registry);
+  interp.set_heap_limit(heap_limit);
   Outcome outcome;
   try {
-    outcome = interp.Execute(inputs);
+    outcome = interp.ExecuteWithHeap(inputs, heap);
   } catch (const std::exception& e) {
     std::cerr << "Error: Interpreter failed: " << e.what() << "\n";
+    if (stats) PrintStats(*graph, callees, interp, registry);
     return 1;
   }
 
   // Print outcome
   std::cout << outcome.ToString() << "\n";
+  if (stats) {
+    std::cout.flush();
+    PrintStats(*graph, callees, interp, registry);
+  }
 
   // Exit code: 0 for Return, 1 for Throw
   return (outcome.kind == Outcome::Kind::kReturn) ? 0 : 1;
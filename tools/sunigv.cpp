@@ -1,10 +1,19 @@
+#include <algorithm>
+#include <cinttypes>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <regex>
 #include <string>
+#include <vector>
 
+#include "suntv/igv/graph_store.hpp"
+#include "suntv/igv/igv_filter.hpp"
+#include "suntv/igv/igv_stats.hpp"
 #include "suntv/igv/igv_util.hpp"
 #include "suntv/igv/java2igv.hpp"
 #include "suntv/util/cxxopts.hpp"
+#include "suntv/util/logging.hpp"
 
 using namespace sun;
 namespace fs = std::filesystem;
@@ -182,13 +191,255 @@ int ExtractCommand(int argc, char** argv) {
   }
 }
 
+int FilterCommand(int argc, char** argv) {
+  cxxopts::Options options("sunigv filter",
+                           "Stream selected graphs out of an IGV file");
+  // clang-format off
+  options.add_options()
+    ("igv-file", "IGV XML file", cxxopts::value<std::string>())
+    ("m,method", "Keep methods whose name contains this text (repeatable)", cxxopts::value<std::vector<std::string>>())
+    ("p,phase", "Keep graphs whose name matches this regex", cxxopts::value<std::string>())
+    ("i,index", "Keep graph indices within a group, e.g. 0-3,7", cxxopts::value<std::string>())
+    ("o,output", "Output IGV XML file", cxxopts::value<std::string>())
+    ("d,split-dir", "Write one IGV XML file per method into this directory", cxxopts::value<std::string>())
+    ("h,help", "Print help");
+  options.parse_positional({"igv-file"});
+  options.positional_help("<igv-file>");
+  // clang-format on
+
+  try {
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help() << "\n";
+      return 0;
+    }
+
+    if (!result.count("igv-file")) {
+      std::cerr << "Error: IGV file not specified\n\n";
+      std::cout << options.help() << "\n";
+      return 1;
+    }
+
+    if (result.count("output") == result.count("split-dir")) {
+      std::cerr << "Error: Must specify exactly one of --output or "
+                   "--split-dir\n\n";
+      std::cout << options.help() << "\n";
+      return 1;
+    }
+
+    IGVFilterSpec spec;
+    if (result.count("method")) {
+      spec.methods = result["method"].as<std::vector<std::string>>();
+    }
+    if (result.count("phase")) {
+      try {
+        spec.phase = std::regex(result["phase"].as<std::string>());
+      } catch (const std::regex_error& e) {
+        std::cerr << "Error: Invalid phase regex: " << e.what() << "\n";
+        return 1;
+      }
+    }
+    if (result.count("index") &&
+        !IGVFilter::ParseIndexRanges(result["index"].as<std::string>(),
+                                     &spec.index_ranges)) {
+      std::cerr << "Error: Invalid index range '"
+                << result["index"].as<std::string>() << "'\n";
+      return 1;
+    }
+
+    std::string igv_file = result["igv-file"].as<std::string>();
+    IGVFilterStats stats;
+    bool success =
+        result.count("output")
+            ? IGVFilter::Filter(igv_file, spec,
+                                result["output"].as<std::string>(), &stats)
+            : IGVFilter::Split(igv_file, spec,
+                               result["split-dir"].as<std::string>(), &stats);
+    if (!success) {
+      return 1;
+    }
+
+    std::cout << "Selected " << stats.graphs_written << " of "
+              << stats.graphs_seen << " graph(s) in " << stats.groups_seen
+              << " group(s); wrote " << stats.outputs.size() << " file(s)\n";
+    return 0;
+
+  } catch (const cxxopts::exceptions::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    std::cout << options.help() << "\n";
+    return 1;
+  }
+}
+
+int StatsCommand(int argc, char** argv) {
+  cxxopts::Options options("sunigv stats",
+                           "Opcode and shape statistics over IGV files");
+  // clang-format off
+  options.add_options()
+    ("inputs", "IGV XML files or directories (searched for *.xml)", cxxopts::value<std::vector<std::string>>())
+    ("j,jobs", "Worker threads (default: all cores)", cxxopts::value<size_t>()->default_value("0"))
+    ("o,output", "Write JSON here instead of stdout", cxxopts::value<std::string>())
+    ("h,help", "Print help");
+  options.parse_positional({"inputs"});
+  options.positional_help("<igv-file|dir>...");
+  // clang-format on
+
+  try {
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help() << "\n";
+      return 0;
+    }
+
+    if (!result.count("inputs")) {
+      std::cerr << "Error: No IGV files specified\n\n";
+      std::cout << options.help() << "\n";
+      return 1;
+    }
+
+    std::vector<std::string> files;
+    for (const std::string& input :
+         result["inputs"].as<std::vector<std::string>>()) {
+      if (!fs::is_directory(input)) {
+        files.push_back(input);
+        continue;
+      }
+      std::vector<std::string> found;
+      for (const auto& entry : fs::recursive_directory_iterator(input)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".xml") {
+          found.push_back(entry.path().string());
+        }
+      }
+      std::sort(found.begin(), found.end());
+      files.insert(files.end(), found.begin(), found.end());
+    }
+
+    CorpusStats stats;
+    bool success =
+        IGVStats::Collect(files, result["jobs"].as<size_t>(), &stats);
+    std::string json = stats.ToJson();
+
+    if (result.count("output")) {
+      std::string output_file = result["output"].as<std::string>();
+      std::ofstream out(output_file);
+      out << json;
+      if (!out) {
+        std::cerr << "Error: Failed to write " << output_file << "\n";
+        return 1;
+      }
+    } else {
+      std::cout << json;
+    }
+    return success ? 0 : 1;
+
+  } catch (const cxxopts::exceptions::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    std::cout << options.help() << "\n";
+    return 1;
+  }
+}
+
+int StoreCommand(int argc, char** argv) {
+  cxxopts::Options options(
+      "sunigv store", "Import IGV files into a content-addressed graph store");
+  // clang-format off
+  options.add_options()
+    ("store", "Store directory (created if missing)", cxxopts::value<std::string>())
+    ("inputs", "IGV XML files or directories (searched for *.xml) to import", cxxopts::value<std::vector<std::string>>())
+    ("j,jobs", "Threads per pipeline pool (default: all cores)", cxxopts::value<size_t>()->default_value("0"))
+    ("l,list", "List the stored compilations and their phases")
+    ("h,help", "Print help");
+  options.parse_positional({"store", "inputs"});
+  options.positional_help("<store-dir> [<igv-file|dir>...]");
+  // clang-format on
+
+  try {
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+      std::cout << options.help() << "\n";
+      return 0;
+    }
+
+    if (!result.count("store")) {
+      std::cerr << "Error: No store directory specified\n\n";
+      std::cout << options.help() << "\n";
+      return 1;
+    }
+
+    std::vector<std::string> files;
+    if (result.count("inputs")) {
+      for (const std::string& input :
+           result["inputs"].as<std::vector<std::string>>()) {
+        if (!fs::is_directory(input) || GraphStore::IsStore(input)) {
+          files.push_back(input);
+          continue;
+        }
+        std::vector<std::string> found;
+        for (const auto& entry : fs::recursive_directory_iterator(input)) {
+          if (entry.is_regular_file() && entry.path().extension() == ".xml") {
+            found.push_back(entry.path().string());
+          }
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+      }
+    }
+
+    // The parser warns about every post-matching instruction
+    Logger::SetLevel(LogLevel::ERROR);
+
+    GraphStore store(result["store"].as<std::string>());
+    bool success = true;
+    if (!files.empty()) {
+      const size_t jobs = result["jobs"].as<size_t>();
+      PipelineOptions pipeline;
+      pipeline.parse_threads = jobs;
+      pipeline.canonicalize_threads = jobs;
+      pipeline.execute_threads = jobs;
+      StoreImportStats stats = store.Import(files, pipeline);
+      printf("imported %" PRIu64 " compilations from %.1f MiB in %.2fs: %"
+             PRIu64 " graphs added, %" PRIu64 " already stored, %" PRIu64
+             " rejected\n",
+             stats.compilations, stats.pipeline.bytes / 1048576.0,
+             stats.pipeline.seconds, stats.added, stats.duplicates,
+             stats.rejected);
+      success = stats.pipeline.files_failed == 0;
+    }
+
+    if (result.count("list")) {
+      for (const StoredCompilation& c : store.compilations()) {
+        printf("%s (%s)\n", c.method.c_str(), c.source.c_str());
+        for (const StoredPhase& p : c.phases) {
+          printf("  %s  %s\n", GraphStore::KeyString(p.key).c_str(),
+                 p.name.c_str());
+        }
+      }
+    }
+    printf("%s: %zu graphs in %zu packs, %.1f MiB, %zu compilations\n",
+           store.dir().c_str(), store.size(), store.num_packs(),
+           store.bytes() / 1048576.0, store.compilations().size());
+    return success ? 0 : 1;
+
+  } catch (const cxxopts::exceptions::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    std::cout << options.help() << "\n";
+    return 1;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+}
+
 int main(int argc, char** argv) {
   // Main options for sunigv
   cxxopts::Options options("sunigv", "IGV utility tool");
 
   // clang-format off
   options.add_options()
-    ("command", "Command to execute (dump, list, extract)", cxxopts::value<std::string>())("h,help", "Print help");
+    ("command", "Command to execute (dump, list, extract, filter, stats, store)", cxxopts::value<std::string>())("h,help", "Print help");
   options.parse_positional({"command"});
   options.positional_help("<command>");
   // clang-format on
@@ -200,6 +451,9 @@ int main(int argc, char** argv) {
       "  dump       Compile Java source and generate IGV XML dump\n"
       "  list       List all graphs in an IGV XML file\n"
       "  extract    Extract a specific graph to a separate IGV XML file\n"
+      "  filter     Stream graphs matching method/phase/index filters\n"
+      "  stats      Print corpus-wide opcode and shape statistics as JSON\n"
+      "  store      Import IGV files into a content-addressed graph store\n"
       "\n"
       "Examples:\n"
       "  sunigv dump Fibonacci.java -o fibonacci.xml -m compute\n"
@@ -207,6 +461,11 @@ int main(int argc, char** argv) {
       "  sunigv extract fibonacci.xml -i 0 -o after_parsing.xml\n"
       "  sunigv extract fibonacci.xml -n \"After Parsing\" -o "
       "after_parsing.xml\n"
+      "  sunigv filter dump.xml -p \"^(After Parsing|Final Code)$\" -o "
+      "corpus.xml\n"
+      "  sunigv filter dump.xml -m Fibonacci -i 0-3 -d out/\n"
+      "  sunigv stats corpus/ -j 8 -o stats.json\n"
+      "  sunigv store graphs/ corpus/ -j 8\n"
       "\n"
       "Use 'sunigv <command> --help' for more information on a command.\n";
 
@@ -224,6 +483,12 @@ int main(int argc, char** argv) {
     return ListCommand(argc - 1, argv + 1);
   } else if (command == "extract") {
     return ExtractCommand(argc - 1, argv + 1);
+  } else if (command == "filter") {
+    return FilterCommand(argc - 1, argv + 1);
+  } else if (command == "stats") {
+    return StatsCommand(argc - 1, argv + 1);
+  } else if (command == "store") {
+    return StoreCommand(argc - 1, argv + 1);
   } else if (command == "-h" || command == "--help") {
     std::cout << options.help() << help_epilog;
     return 0;